@@ -21,8 +21,21 @@
  */
 
 #include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_deadline_internal.h"
+#include "enip_scanner_context_internal.h"
+#include "enip_scanner_session_internal.h"
+#include "enip_scanner_write_queue_internal.h"
+#include "enip_scanner_route_internal.h"
+#include "enip_scanner_profile_internal.h"
+#include "enip_scanner_buffer_internal.h"
+#include "enip_scanner_log_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "enip_scanner_qos_internal.h"
+#include "enip_scanner_link_internal.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 #include "esp_netif_ip_addr.h"
 #include "sdkconfig.h"
 #include "lwip/sockets.h"
@@ -30,6 +43,7 @@
 #include "lwip/inet.h"
 #include "lwip/ip4_addr.h"
 #include "lwip/netif.h"
+#include "lwip/tcpip.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -37,11 +51,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <fcntl.h>
 
 static const char *TAG = "enip_scanner";
-// Made non-static for use by tag operations
-bool s_scanner_initialized = false;
-SemaphoreHandle_t s_scanner_mutex = NULL;
+scanner_context_t s_scanner_ctx = {
+    .state = SCANNER_STATE_DOWN,
+    .connection_counter = 2,
+};
 
 // EtherNet/IP constants
 #define ENIP_PORT 44818  // TCP port for explicit messaging
@@ -97,26 +113,40 @@ typedef struct __attribute__((packed)) {
     // Product name follows (variable length)
 } list_identity_item_t;
 
+// Apply the time left before the deadline as the socket send/receive timeout
+// Returns ESP_ERR_TIMEOUT without touching the socket once the deadline has passed
+// (a zero timeval would mean "block forever" to lwIP)
+// Made non-static for use by tag operations
+esp_err_t set_socket_deadline(int sock, enip_deadline_t deadline)
+{
+    uint32_t remaining_ms = enip_deadline_remaining_ms(deadline);
+    if (remaining_ms == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = remaining_ms / 1000;
+    timeout.tv_usec = (remaining_ms % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return ESP_OK;
+}
+
 // Helper function to create TCP socket and connect
+// The connect is non-blocking and waited on with select() so that an
+// unreachable device cannot hold the caller past its deadline
 // Made non-static for use by tag operations
-int create_tcp_socket(const ip4_addr_t *ip_addr, uint32_t timeout_ms)
+int create_tcp_socket(const ip4_addr_t *ip_addr, enip_deadline_t deadline)
 {
     int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (sock < 0) {
-        ESP_LOGE(TAG, "Failed to create socket: %d", errno);
+        ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Failed to create socket: %d", errno);
         return -1;
     }
     
-    // Set socket timeout
-    struct timeval timeout;
-    timeout.tv_sec = timeout_ms / 1000;
-    timeout.tv_usec = (timeout_ms % 1000) * 1000;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    
     // Set TCP_NODELAY for better performance
     int flag = 1;
     setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    qos_mark_explicit_socket(sock);
     
     // Connect to device
     struct sockaddr_in server_addr;
@@ -125,11 +155,53 @@ int create_tcp_socket(const ip4_addr_t *ip_addr, uint32_t timeout_ms)
     server_addr.sin_port = htons(ENIP_PORT);
     server_addr.sin_addr.s_addr = ip_addr->addr;
     
-    char ip_str[16];
-    snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(ip_addr));
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    
     if (connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-        ESP_LOGE(TAG, "Failed to connect to %s:%d: errno=%d (%s)", ip_str, ENIP_PORT, errno, strerror(errno));
+        if (errno != EINPROGRESS) {
+            ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Failed to connect to " IPSTR ":%d: errno=%d (%s)",
+                             IP2STR(ip_addr), ENIP_PORT, errno, strerror(errno));
+            close(sock);
+            return -1;
+        }
+    
+        uint32_t remaining_ms = enip_deadline_remaining_ms(deadline);
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(sock, &write_fds);
+        struct timeval tv;
+        tv.tv_sec = remaining_ms / 1000;
+        tv.tv_usec = (remaining_ms % 1000) * 1000;
+    
+        int select_result = select(sock + 1, NULL, &write_fds, NULL, &tv);
+        if (select_result <= 0) {
+            ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Connect to " IPSTR ":%d timed out", IP2STR(ip_addr), ENIP_PORT);
+            close(sock);
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    
+        int so_error = 0;
+        socklen_t so_error_len = sizeof(so_error);
+        getsockopt(sock, SOL_SOCKET, SO_ERROR, &so_error, &so_error_len);
+        if (so_error != 0) {
+            ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Failed to connect to " IPSTR ":%d: errno=%d (%s)",
+                             IP2STR(ip_addr), ENIP_PORT, so_error, strerror(so_error));
+            close(sock);
+            errno = so_error;
+            return -1;
+        }
+    }
+    
+    // Back to blocking mode; send/recv are bounded by set_socket_deadline()
+    fcntl(sock, F_SETFL, flags);
+    
+    if (set_socket_deadline(sock, deadline) != ESP_OK) {
+        ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Deadline expired while connecting to " IPSTR ":%d",
+                         IP2STR(ip_addr), ENIP_PORT);
         close(sock);
+        errno = ETIMEDOUT;
         return -1;
     }
     return sock;
@@ -137,12 +209,16 @@ int create_tcp_socket(const ip4_addr_t *ip_addr, uint32_t timeout_ms)
 
 // Helper function to send data
 // Made non-static for use by tag operations
-esp_err_t send_data(int sock, const void *data, size_t len)
+esp_err_t send_data(int sock, const void *data, size_t len, enip_deadline_t deadline)
 {
+    if (set_socket_deadline(sock, deadline) != ESP_OK) {
+        ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Deadline expired before sending %zu bytes", len);
+        return ESP_ERR_TIMEOUT;
+    }
     ssize_t sent = send(sock, data, len, 0);
     if (sent < 0) {
-        ESP_LOGE(TAG, "Failed to send data: errno=%d (%s)", errno, strerror(errno));
-        return ESP_FAIL;
+        ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Failed to send data: errno=%d (%s)", errno, strerror(errno));
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? ESP_ERR_TIMEOUT : ESP_FAIL;
     }
     if ((size_t)sent != len) {
         ESP_LOGE(TAG, "Partial send: sent %zd of %zu bytes", sent, len);
@@ -154,30 +230,36 @@ esp_err_t send_data(int sock, const void *data, size_t len)
 // Helper function to receive data
 // Returns ESP_OK on success, or error code on failure
 // On success, *bytes_received is set to the number of bytes actually received
+// Each recv() only waits for the time left before the deadline
 // Made non-static for use by tag operations
-esp_err_t recv_data(int sock, void *data, size_t len, uint32_t timeout_ms, size_t *bytes_received)
+esp_err_t recv_data(int sock, void *data, size_t len, enip_deadline_t deadline, size_t *bytes_received)
 {
     size_t received = 0;
     while (received < len) {
+        if (set_socket_deadline(sock, deadline) != ESP_OK) {
+            ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Receive deadline expired (expected %zu bytes, got %zu)", len, received);
+            if (bytes_received) *bytes_received = received;
+            return ESP_ERR_TIMEOUT;
+        }
         ssize_t ret = recv(sock, (char *)data + received, len - received, 0);
         if (ret < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                ESP_LOGE(TAG, "Receive timeout (expected %zu bytes, got %zu)", len, received);
+                ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Receive timeout (expected %zu bytes, got %zu)", len, received);
                 if (bytes_received) *bytes_received = received;
                 return ESP_ERR_TIMEOUT;
             }
             if (errno == ECONNRESET) {
-                ESP_LOGE(TAG, "Connection reset by peer (expected %zu bytes, got %zu)", len, received);
+                ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Connection reset by peer (expected %zu bytes, got %zu)", len, received);
             } else if (errno == ECONNABORTED) {
-                ESP_LOGE(TAG, "Connection aborted (expected %zu bytes, got %zu)", len, received);
+                ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Connection aborted (expected %zu bytes, got %zu)", len, received);
             } else {
-                ESP_LOGE(TAG, "Failed to receive data: %d (expected %zu bytes, got %zu)", errno, len, received);
+                ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Failed to receive data: %d (expected %zu bytes, got %zu)", errno, len, received);
             }
             if (bytes_received) *bytes_received = received;
             return ESP_FAIL;
         }
         if (ret == 0) {
-            ESP_LOGE(TAG, "Connection closed by peer (expected %zu bytes, got %zu)", len, received);
+            ENIP_LOG_LIMITED(ESP_LOG_ERROR, TAG, "Connection closed by peer (expected %zu bytes, got %zu)", len, received);
             if (bytes_received) *bytes_received = received;
             return ESP_FAIL;
         }
@@ -187,9 +269,37 @@ esp_err_t recv_data(int sock, void *data, size_t len, uint32_t timeout_ms, size_
     return ESP_OK;
 }
 
+// Read and drop len bytes (e.g. extended status words) through a small stack buffer
+// Made non-static for use by tag operations
+esp_err_t recv_discard(int sock, size_t len, enip_deadline_t deadline)
+{
+    uint8_t chunk[64];
+    while (len > 0) {
+        size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+        esp_err_t ret = recv_data(sock, chunk, n, deadline, NULL);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+// Receive whatever is available (single recv) without waiting past the deadline
+// Behaves like recv(); an expired deadline reports -1 with errno EAGAIN
+// Made non-static for use by tag operations
+ssize_t recv_available(int sock, void *data, size_t len, enip_deadline_t deadline)
+{
+    if (set_socket_deadline(sock, deadline) != ESP_OK) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return recv(sock, data, len, 0);
+}
+
 // Register EtherNet/IP session
 // Made non-static for use by tag operations
-esp_err_t register_session(int sock, uint32_t *session_handle)
+esp_err_t register_session(int sock, uint32_t *session_handle, enip_deadline_t deadline)
 {
     // Build packet explicitly in network byte order
     uint8_t packet[28];  // Header (24 bytes) + protocol_version (2 bytes) + options_flags (2 bytes)
@@ -237,14 +347,14 @@ esp_err_t register_session(int sock, uint32_t *session_handle)
     memcpy(packet + offset, &options_flags, 2);
     offset += 2;
     
-    esp_err_t ret = send_data(sock, packet, offset);
+    esp_err_t ret = send_data(sock, packet, offset, deadline);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to send Register Session packet");
         return ret;
     }
     
     enip_header_t response;
-    ret = recv_data(sock, &response, sizeof(response), 5000, NULL);
+    ret = recv_data(sock, &response, sizeof(response), deadline, NULL);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to receive Register Session response: %s", esp_err_to_name(ret));
         return ret;
@@ -301,56 +411,106 @@ void unregister_session(int sock, uint32_t session_handle)
     memcpy(packet + offset, &options, 4);
     offset += 4;
     
-    send_data(sock, packet, offset);
+    // Best effort and never blocking: the request fits in the send buffer, and the
+    // caller's deadline may already have passed when it is cleaning up.
     // Don't wait for response, just close
+    send(sock, packet, offset, MSG_DONTWAIT);
 }
 
 esp_err_t enip_scanner_init(void)
 {
-    // Create mutex if it doesn't exist
-    if (s_scanner_mutex == NULL) {
-        s_scanner_mutex = xSemaphoreCreateMutex();
-        if (s_scanner_mutex == NULL) {
-            ESP_LOGE(TAG, "Failed to create scanner mutex");
-            return ESP_ERR_NO_MEM;
+    // The caller that moves DOWN to STARTING runs the start-up; others wait for it
+    int state = SCANNER_STATE_DOWN;
+    while (!atomic_compare_exchange_weak(&s_scanner_ctx.state, &state, SCANNER_STATE_STARTING)) {
+        if (state == SCANNER_STATE_READY) {
+            return ESP_OK;
         }
+        if (state == SCANNER_STATE_STARTING) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        state = SCANNER_STATE_DOWN;
     }
     
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        return ESP_FAIL;
+    esp_err_t ret = session_pool_init();
+    if (ret != ESP_OK) {
+        atomic_store(&s_scanner_ctx.state, SCANNER_STATE_DOWN);
+        ESP_LOGE(TAG, "Failed to start session pool: %s", esp_err_to_name(ret));
+        return ret;
     }
     
-    if (s_scanner_initialized) {
-        xSemaphoreGive(s_scanner_mutex);
-        return ESP_OK;
+    ret = write_queue_init();
+    if (ret != ESP_OK) {
+        atomic_store(&s_scanner_ctx.state, SCANNER_STATE_DOWN);
+        ESP_LOGE(TAG, "Failed to start write queue: %s", esp_err_to_name(ret));
+        return ret;
     }
     
-    s_scanner_initialized = true;
-    xSemaphoreGive(s_scanner_mutex);
+    // A missing profile cache only costs probes; keep going without it
+    ret = profile_cache_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Device profile cache unavailable: %s", esp_err_to_name(ret));
+    }
+    
+    // Diagnostics are optional too
+    ret = diag_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Heap trend sampling unavailable: %s", esp_err_to_name(ret));
+    }
+    
+    atomic_store_explicit(&s_scanner_ctx.state, SCANNER_STATE_READY, memory_order_release);
     ESP_LOGI(TAG, "EtherNet/IP Scanner initialized");
     return ESP_OK;
 }
 
-int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devices, uint32_t timeout_ms)
+void enip_scanner_notify_link_down(void)
 {
-    if (devices == NULL || max_devices <= 0) {
-        return 0;
+    if (!scanner_is_ready()) {
+        return;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        ESP_LOGE(TAG, "Scanner not initialized");
-        return 0;
+    ESP_LOGW(TAG, "Link down: closing sessions and suspending connections");
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+    io_link_changed(false);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+    enip_scanner_session_pool_flush(NULL);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    implicit_suspend_all();
+#endif
+}
+
+void enip_scanner_notify_link_up(bool address_changed)
+{
+    if (!scanner_is_ready()) {
+        return;
     }
     
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
+    // Sockets bound to the old address are dead even though the link never dropped
+    if (address_changed) {
+        ESP_LOGW(TAG, "Local address changed: closing sessions and reopening connections");
+#if CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+        enip_scanner_session_pool_flush(NULL);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+        implicit_suspend_all();
+#endif
+    }
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    implicit_resume_all();
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+    io_link_changed(true);
+#endif
+}
+
+int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devices, uint32_t timeout_ms)
+{
+    if (devices == NULL || max_devices <= 0) {
         return 0;
     }
     
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
+    if (!scanner_is_ready()) {
         return 0;
     }
     
@@ -361,32 +521,21 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
     ip4_addr_t netmask = {0};
     ip4_addr_t ip_addr = {0};
     
-    // Take mutex for netif access
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        return 0;
-    }
-    
+    // The netif belongs to the lwIP thread; copy its addresses under the core lock
+    LOCK_TCPIP_CORE();
     netif = netif_default;
-    if (netif == NULL || !netif_is_up(netif)) {
-        xSemaphoreGive(s_scanner_mutex);
-        ESP_LOGE(TAG, "No network interface available");
-        return 0;
+    bool netif_up = netif != NULL && netif_is_up(netif);
+    if (netif_up) {
+        netmask = *netif_ip4_netmask(netif);
+        ip_addr = *netif_ip4_addr(netif);
     }
+    UNLOCK_TCPIP_CORE();
     
-    // Copy netif values while holding mutex
-    const ip4_addr_t *netmask_ptr = netif_ip4_netmask(netif);
-    const ip4_addr_t *ip_addr_ptr = netif_ip4_addr(netif);
-    if (netmask_ptr != NULL && ip_addr_ptr != NULL) {
-        netmask = *netmask_ptr;
-        ip_addr = *ip_addr_ptr;
-    } else {
-        xSemaphoreGive(s_scanner_mutex);
-        ESP_LOGE(TAG, "Failed to get network interface addresses");
+    if (!netif_up) {
+        ESP_LOGE(TAG, "No network interface available");
         return 0;
     }
     
-    xSemaphoreGive(s_scanner_mutex);
-    
     // Calculate network address
     ip4_addr_t network;
     network.addr = ip_addr.addr & netmask.addr;
@@ -424,15 +573,13 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
         return 0;
     }
     
-    // Set socket timeout
-    struct timeval timeout;
-    timeout.tv_sec = timeout_ms / 1000;
-    timeout.tv_usec = (timeout_ms % 1000) * 1000;
-    setsockopt(udp_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    // The whole scan, including every recvfrom() below, ends at one deadline
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
     
     // Enable broadcast
     int broadcast_enable = 1;
     setsockopt(udp_sock, SOL_SOCKET, SO_BROADCAST, &broadcast_enable, sizeof(broadcast_enable));
+    qos_mark_explicit_socket(udp_sock);
     
     // Bind socket to local port (let system choose port)
     struct sockaddr_in local_addr;
@@ -504,10 +651,11 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
     struct sockaddr_in from_addr;
     socklen_t from_len = sizeof(from_addr);
     
-    uint32_t start_time = xTaskGetTickCount();
-    uint32_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-    
     while (device_count < max_devices) {
+        // Each wait only gets the time left in the scan
+        if (set_socket_deadline(udp_sock, deadline) != ESP_OK) {
+            break;  // Timeout
+        }
         ssize_t received = recvfrom(udp_sock, buffer, sizeof(buffer), 0,
                                     (struct sockaddr *)&from_addr, &from_len);
         
@@ -518,10 +666,6 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
             continue;
         }
         
-        if ((xTaskGetTickCount() - start_time) > timeout_ticks) {
-            break;  // Timeout
-        }
-        
         if (received == 0) {
             // Ignore zero-length UDP datagrams
             continue;
@@ -690,6 +834,7 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
                      device_ip_str, device->product_name,
                      device->vendor_id, device->product_code);
             
+            profile_note_identity(device);
             device_count++;
         }
     }
@@ -701,54 +846,41 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
 
 esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance, 
                                      enip_scanner_assembly_result_t *result, uint32_t timeout_ms)
+{
+    return enip_scanner_read_assembly_routed(ip_address, NULL, assembly_instance, result, timeout_ms);
+}
+
+static esp_err_t read_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                      uint16_t assembly_instance, enip_scanner_assembly_result_t *result,
+                                      uint32_t timeout_ms)
 {
     if (ip_address == NULL || result == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        memset(result, 0, sizeof(enip_scanner_assembly_result_t));
-        snprintf(result->error_message, sizeof(result->error_message), "Scanner not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        memset(result, 0, sizeof(enip_scanner_assembly_result_t));
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to acquire mutex");
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        memset(result, 0, sizeof(enip_scanner_assembly_result_t));
-        snprintf(result->error_message, sizeof(result->error_message), "Scanner not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    memset(result, 0, sizeof(enip_scanner_assembly_result_t));
+    // Reset only the fields a caller inspects; the error is a few bytes and
+    // no text is formatted unless enip_scanner_format_error() is called
     result->ip_address = *ip_address;
     result->assembly_instance = assembly_instance;
     result->success = false;
+    result->data = NULL;
+    result->data_length = 0;
+    result->response_time_ms = 0;
+    enip_error_clear(&result->error);
     
-    uint32_t start_time = xTaskGetTickCount();
-    
-    // Create TCP socket
-    int sock = create_tcp_socket(ip_address, timeout_ms);
-    if (sock < 0) {
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to connect to device");
-        return ESP_FAIL;
+    if (!scanner_is_ready()) {
+        enip_error_set(&result->error, ENIP_ERR_NOT_INITIALIZED);
+        return ESP_ERR_INVALID_STATE;
     }
     
-    // Register session
+    uint32_t start_time = xTaskGetTickCount();
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
+    
+    // Connect and register a session, or reuse a pooled one
+    int sock = -1;
     uint32_t session_handle = 0;
-    esp_err_t ret = register_session(sock, &session_handle);
+    esp_err_t ret = session_acquire(ip_address, deadline, &sock, &session_handle, &result->error);
     if (ret != ESP_OK) {
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to register session: %s", esp_err_to_name(ret));
-        ESP_LOGE(TAG, "Session registration failed: %s", esp_err_to_name(ret));
         return ret;
     }
     
@@ -878,6 +1010,7 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     
     // CIP Message format: Service + Path Size + Path
     // According to CIP spec: Service Code comes first, then Path Size, then Path
+    size_t cip_message_offset = offset;
     packet[offset++] = cip_service;  // Service: Get_Attribute_Single (0x0E) comes first
     packet[offset++] = path_size_words;  // Path size in words
     memcpy(packet + offset, cip_path, path_padded_length);  // Copy padded path
@@ -889,13 +1022,20 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
                  enip_header_size + enip_data_length, offset);
     }
     
+    // Targets behind the connected device get the request via Unconnected Send
+    ret = cip_route_wrap(route, packet, &offset, sizeof(packet), cip_message_offset, deadline);
+    if (ret != ESP_OK) {
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_REQUEST_TOO_LARGE);
+        return ret;
+    }
+    
     // Send request
     ESP_LOGD(TAG, "Sending Get_Attribute_Single to " IPSTR ": assembly_instance=%d", IP2STR(ip_address), assembly_instance);
-    ret = send_data(sock, packet, offset);
+    ret = send_data(sock, packet, offset, deadline);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to send request");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SEND);
         return ret;
     }
     
@@ -910,26 +1050,23 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     size_t target_read = max_read;
     
     // Use recv directly to get what's available without blocking for exact amount
-    ssize_t recv_ret = recv(sock, response_buffer, target_read, 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, target_read, deadline);
     if (recv_ret < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             ESP_LOGE(TAG, "Receive timeout waiting for response header");
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Timeout waiting for response");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_TIMEOUT);
             return ESP_ERR_TIMEOUT;
         }
         ESP_LOGE(TAG, "Failed to receive response header: %d", errno);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to receive response header");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_RECV);
         return ESP_FAIL;
     }
     if (recv_ret == 0) {
         ESP_LOGE(TAG, "Connection closed by peer");
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Connection closed by peer");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_PEER_CLOSED);
         return ESP_FAIL;
     }
     
@@ -938,7 +1075,7 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     // If we got less than the minimum, try to read more
     if (bytes_received < min_read) {
         size_t remaining = min_read - bytes_received;
-        recv_ret = recv(sock, response_buffer + bytes_received, remaining, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, remaining, deadline);
         if (recv_ret > 0) {
             bytes_received += recv_ret;
         }
@@ -947,9 +1084,8 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     if (bytes_received < sizeof(enip_header_t) + 4) {  // Need at least header + some padding
         ESP_LOGE(TAG, "Response too short: got %zu bytes, need at least %zu", 
                  bytes_received, sizeof(enip_header_t) + 4);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response too short");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -968,9 +1104,8 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     if (header_offset + sizeof(enip_header_t) > bytes_received) {
         ESP_LOGE(TAG, "Response too short: need %zu bytes at offset %d, got %zu", 
                  sizeof(enip_header_t), header_offset, bytes_received);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response too short");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -981,18 +1116,15 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     uint16_t response_length = response_header.length;
     
     if (response_header.command != ENIP_SEND_RR_DATA) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Unexpected response command: 0x%04X (expected 0x%04X)", 
-                 response_header.command, ENIP_SEND_RR_DATA);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_UNEXPECTED_COMMAND, response_header.command);
         ESP_LOGE(TAG, "Expected command 0x%04X (SendRRData), got 0x%04X", ENIP_SEND_RR_DATA, response_header.command);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     if (response_header.status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response error status: 0x%08lX", (unsigned long)response_header.status);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_ENCAP_STATUS, response_header.status);
         return ESP_FAIL;
     }
     
@@ -1018,12 +1150,11 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         }
         if (remaining > 0) {
             size_t additional_received = 0;
-            ret = recv_data(sock, response_buffer + bytes_received, remaining, timeout_ms, &additional_received);
+            ret = recv_data(sock, response_buffer + bytes_received, remaining, deadline, &additional_received);
             if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
                 ESP_LOGE(TAG, "Failed to receive remaining response data: %s", esp_err_to_name(ret));
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive remaining response data");
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
             if (ret == ESP_ERR_TIMEOUT) {
@@ -1049,11 +1180,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     } else {
         // Need to read it from socket
         ESP_LOGD(TAG, "Reading interface handle from socket...");
-        ret = recv_data(sock, &interface_handle_resp, 4, timeout_ms, NULL);
+        ret = recv_data(sock, &interface_handle_resp, 4, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive interface handle");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
         ESP_LOGD(TAG, "Interface handle from socket: 0x%08lX", (unsigned long)interface_handle_resp);
@@ -1068,11 +1198,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         ESP_LOGD(TAG, "Timeout from buffer: 0x%04X", timeout_resp);
     } else {
         ESP_LOGD(TAG, "Reading timeout from socket...");
-        ret = recv_data(sock, &timeout_resp, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &timeout_resp, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive timeout");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
         ESP_LOGD(TAG, "Timeout from socket: 0x%04X", timeout_resp);
@@ -1085,19 +1214,17 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &item_count_resp, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &item_count_resp, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive item count");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
     
     if (item_count_resp != 2) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Unexpected item count: %d (expected 2)", item_count_resp);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_ITEM_COUNT, item_count_resp);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1109,11 +1236,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &addr_item_type, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &addr_item_type, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive address item type");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1122,11 +1248,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &addr_item_length, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &addr_item_length, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive address item length");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1141,11 +1266,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &resp_data_item_type, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &resp_data_item_type, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data item type");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1154,11 +1278,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &resp_data_item_length, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &resp_data_item_length, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data item length");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1166,9 +1289,8 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     ESP_LOGD(TAG, "Data item: type=0x%04X, length=%d", resp_data_item_type, resp_data_item_length);
     
     if (resp_data_item_type != 0xB2) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Unexpected data item type: 0x%04X (expected 0xB2)", resp_data_item_type);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_ITEM_TYPE, resp_data_item_type);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1180,11 +1302,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &cip_service_resp, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &cip_service_resp, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive CIP service");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1197,11 +1318,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &reserved, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &reserved, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive reserved byte");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1213,11 +1333,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &cip_status, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &cip_status, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive CIP status");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1229,16 +1348,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         // CIP status 0x0C = Object state conflict
         // CIP status 0x0D = Object already exists
         // CIP status 0x14 = Attribute not supported
-        const char* status_msg = (cip_status == 0x05) ? "Object does not exist" :
-                                 (cip_status == 0x06) ? "Attribute does not exist" :
-                                 (cip_status == 0x0A) ? "Attribute not settable" :
-                                 (cip_status == 0x0C) ? "Object state conflict" :
-                                 (cip_status == 0x0D) ? "Object already exists" :
-                                 (cip_status == 0x14) ? "Attribute not supported" : "Unknown error";
-        ESP_LOGD(TAG, "CIP error status 0x%02X for assembly instance %d: %s", cip_status, assembly_instance, status_msg);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "CIP error status: 0x%02X (%s)", cip_status, status_msg);
+        ESP_LOGD(TAG, "CIP error status 0x%02X for assembly instance %d: %s", cip_status, assembly_instance,
+                 enip_scanner_cip_status_name(cip_status));
+        session_release(sock, session_handle, false);
+        enip_error_set_cip(&result->error, cip_status, 0, 0);
         result->success = false;
         return ESP_FAIL;
     }
@@ -1250,11 +1363,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &additional_status_size, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &additional_status_size, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive additional status size");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1262,21 +1374,21 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     
     // Read additional status (if present)
     if (additional_status_size > 0) {
-        uint8_t additional_status[256];
-        size_t status_buf_size = sizeof(additional_status);
-        if ((size_t)additional_status_size > status_buf_size) {
-            status_buf_size = additional_status_size;
-        }
+        uint8_t additional_status[256];         // additional_status_size is at most 255
         if (remaining_in_buffer >= additional_status_size) {
             memcpy(additional_status, response_buffer + bytes_already_read, additional_status_size);
             bytes_already_read += additional_status_size;
             remaining_in_buffer -= additional_status_size;
         } else {
-            ret = recv_data(sock, additional_status, additional_status_size, timeout_ms, NULL);
+            // Part of it may already be buffered; only the rest is still on the socket
+            size_t buffered = remaining_in_buffer;
+            memcpy(additional_status, response_buffer + bytes_already_read, buffered);
+            bytes_already_read += buffered;
+            remaining_in_buffer = 0;
+            ret = recv_data(sock, additional_status + buffered, additional_status_size - buffered, deadline, NULL);
             if (ret != ESP_OK) {
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive additional status");
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
         }
@@ -1290,18 +1402,16 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     // Calculate remaining bytes: resp_data_item_length - (Service + Reserved + Status + Additional Status Size + Additional Status)
     size_t cip_header_bytes = 1 + 1 + 1 + 1 + additional_status_size;  // Service + Reserved + Status + AddStatusSize + AddStatus
     if (resp_data_item_length < cip_header_bytes) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Data item too small: %d bytes", resp_data_item_length);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_ITEM_LENGTH, resp_data_item_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     uint16_t remaining_bytes = resp_data_item_length - cip_header_bytes;
     
     if (remaining_bytes == 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "No data returned");
+        session_release(sock, session_handle, true);
+        enip_error_set(&result->error, ENIP_ERR_NO_DATA);
         result->data_length = 0;
         result->success = true;
         result->response_time_ms = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
@@ -1311,11 +1421,10 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     // Read the remaining data (this is the attribute value - should be 32 bytes for assembly)
     ESP_LOGD(TAG, "Reading assembly data: %d bytes remaining, %zu bytes in buffer", remaining_bytes, remaining_in_buffer);
     
-    uint8_t *data_buffer = malloc(remaining_bytes);
+    uint8_t *data_buffer = enip_buffer_alloc(remaining_bytes);
     if (data_buffer == NULL) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to allocate memory");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_NO_MEMORY);
         return ESP_ERR_NO_MEM;
     }
     
@@ -1338,23 +1447,21 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
             
             // Read the rest from socket
             size_t bytes_needed = remaining_bytes - bytes_from_buffer;
-            ret = recv_data(sock, data_buffer + bytes_from_buffer, bytes_needed, timeout_ms, NULL);
+            ret = recv_data(sock, data_buffer + bytes_from_buffer, bytes_needed, deadline, NULL);
             if (ret != ESP_OK) {
-                free(data_buffer);
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data");
+                enip_buffer_free(data_buffer);
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
             ESP_LOGD(TAG, "Read %zu bytes from buffer, %zu bytes from socket", bytes_from_buffer, bytes_needed);
             data_read_success = true;
         } else {
-            ret = recv_data(sock, data_buffer, remaining_bytes, timeout_ms, NULL);
+            ret = recv_data(sock, data_buffer, remaining_bytes, deadline, NULL);
             if (ret != ESP_OK) {
-                free(data_buffer);
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data");
+                enip_buffer_free(data_buffer);
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
             ESP_LOGD(TAG, "Read %d bytes of assembly data from socket", remaining_bytes);
@@ -1364,10 +1471,9 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
     
     // Ensure data was successfully read before proceeding
     if (!data_read_success) {
-        free(data_buffer);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to read assembly data");
+        enip_buffer_free(data_buffer);
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_RECV);
         return ESP_FAIL;
     }
     
@@ -1395,31 +1501,43 @@ esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t asse
         data_length = remaining_bytes;
         actual_data = malloc(data_length);
         if (actual_data == NULL) {
-            free(data_buffer);
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to allocate memory");
+            enip_buffer_free(data_buffer);
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_NO_MEMORY);
             return ESP_ERR_NO_MEM;
         }
         memcpy(actual_data, data_buffer, data_length);
     }
     
-    free(data_buffer);
+    enip_buffer_free(data_buffer);
     result->data = actual_data;
     
     result->data_length = data_length;
     result->success = true;
+    if (route == NULL || route->size == 0) {
+        profile_note_assembly_size(ip_address, assembly_instance, data_length);
+    }
     result->response_time_ms = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
     
     ESP_LOGD(TAG, "Read assembly %d from " IPSTR ": %d bytes", assembly_instance, IP2STR(ip_address), data_length);
     
-    // Cleanup
-    unregister_session(sock, session_handle);
-    close(sock);
+    // Cleanup (the session goes back to the pool when pooling is enabled)
+    session_release(sock, session_handle, true);
     
     return ESP_OK;
 }
 
+// Every request is timed for the soak monitor, failed ones included
+esp_err_t enip_scanner_read_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                            uint16_t assembly_instance, enip_scanner_assembly_result_t *result,
+                                            uint32_t timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = read_assembly_routed(ip_address, route, assembly_instance, result, timeout_ms);
+    diag_record_request(start_us, ret == ESP_OK);
+    return ret;
+}
+
 void enip_scanner_free_assembly_result(enip_scanner_assembly_result_t *result)
 {
     if (result == NULL) {
@@ -1436,41 +1554,26 @@ void enip_scanner_free_assembly_result(enip_scanner_assembly_result_t *result)
 // Write assembly data to a device
 esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance,
                                      const uint8_t *data, uint16_t data_length, uint32_t timeout_ms,
-                                     char *error_message)
+                                     enip_scanner_error_t *error)
+{
+    return enip_scanner_write_assembly_routed(ip_address, NULL, assembly_instance, data, data_length,
+                                              timeout_ms, error);
+}
+
+static esp_err_t write_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                       uint16_t assembly_instance, const uint8_t *data,
+                                       uint16_t data_length, uint32_t timeout_ms,
+                                       enip_scanner_error_t *error)
 {
     if (ip_address == NULL || data == NULL || data_length == 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid parameters");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (error_message) {
-        error_message[0] = '\0';
-    }
+    enip_error_clear(error);
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to acquire mutex");
-        }
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
+    if (!scanner_is_ready()) {
+        enip_error_set(error, ENIP_ERR_NOT_INITIALIZED);
         return ESP_ERR_INVALID_STATE;
     }
     
@@ -1479,47 +1582,13 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     ESP_LOGD(TAG, "Writing assembly %d to %s: %d bytes", assembly_instance, ip_str, data_length);
     
     TickType_t start_time = xTaskGetTickCount();
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
     
-    // Create TCP socket
-    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (sock < 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to create socket: %d", errno);
-        }
-        return ESP_FAIL;
-    }
-    
-    // Set socket timeout
-    struct timeval timeout;
-    timeout.tv_sec = timeout_ms / 1000;
-    timeout.tv_usec = (timeout_ms % 1000) * 1000;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    
-    // Connect to device
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(ENIP_PORT);
-    server_addr.sin_addr.s_addr = ip_address->addr;
-    
-    esp_err_t ret = connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr));
-    if (ret < 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to connect: %d", errno);
-        }
-        close(sock);
-        return ESP_FAIL;
-    }
-    
-    // Register session
-    uint32_t session_handle;
-    ret = register_session(sock, &session_handle);
+    // Connect and register a session, or reuse a pooled one
+    int sock = -1;
+    uint32_t session_handle = 0;
+    esp_err_t ret = session_acquire(ip_address, deadline, &sock, &session_handle, error);
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to register session");
-        }
-        close(sock);
         return ret;
     }
     
@@ -1573,15 +1642,12 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     // ENIP header is 24 bytes
     const size_t enip_header_size = 24;
     
-    // Build complete packet (allocate dynamically to handle large data)
-    size_t total_packet_size = enip_header_size + enip_data_length;
-    uint8_t *packet = malloc(total_packet_size);
+    // Build complete packet (pool block, or heap for large data)
+    size_t total_packet_size = enip_header_size + enip_data_length + cip_route_overhead(route, cip_message_length);
+    uint8_t *packet = enip_buffer_alloc(total_packet_size);
     if (packet == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to allocate memory for packet");
-        }
-        unregister_session(sock, session_handle);
-        close(sock);
+        enip_error_set(error, ENIP_ERR_NO_MEMORY);
+        session_release(sock, session_handle, false);
         return ESP_ERR_NO_MEM;
     }
     
@@ -1616,7 +1682,7 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     offset += 4;
     
     // Timeout (2 bytes)
-    uint8_t cip_timeout = (timeout_ms / 250) & 0xFF;
+    uint8_t cip_timeout = (enip_deadline_remaining_ms(deadline) / 250) & 0xFF;
     memcpy(packet + offset, &cip_timeout, 1);
     offset += 1;
     packet[offset++] = 0x00;
@@ -1642,6 +1708,7 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     offset += 2;
     
     // CIP Message format: Service + Path Size + Path + Data
+    size_t cip_message_offset = offset;
     packet[offset++] = cip_service;  // Service: Set_Attribute_Single (0x10)
     packet[offset++] = path_size_words;  // Path size in words
     memcpy(packet + offset, cip_path, path_padded_length);  // Copy padded path
@@ -1649,47 +1716,47 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     memcpy(packet + offset, data, data_length);  // Copy data to write
     offset += data_length;
     
+    // Targets behind the connected device get the request via Unconnected Send
+    ret = cip_route_wrap(route, packet, &offset, total_packet_size, cip_message_offset, deadline);
+    if (ret != ESP_OK) {
+        enip_buffer_free(packet);
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_REQUEST_TOO_LARGE);
+        return ret;
+    }
+    
     ESP_LOGD(TAG, "Sending Set_Attribute_Single to %s: assembly_instance=%d, data_length=%d, total_packet=%zu bytes",
              ip_str, assembly_instance, data_length, offset);
     
-    ret = send_data(sock, packet, offset);
-    free(packet);
+    ret = send_data(sock, packet, offset, deadline);
+    enip_buffer_free(packet);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to send write request");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SEND);
         return ret;
     }
     
     // Receive response header - use recv directly to get what's available without blocking for exact amount
     uint8_t response_buffer[256];
-    ssize_t recv_ret = recv(sock, response_buffer, sizeof(response_buffer), 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, sizeof(response_buffer), deadline);
     if (recv_ret < 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to receive response: %d", errno);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_errno(error, ENIP_ERR_RECV, errno);
         return ESP_FAIL;
     }
     size_t bytes_received = (size_t)recv_ret;
     
     // If we got less than expected, try one more recv (non-blocking)
     if (bytes_received < 40) {
-        recv_ret = recv(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, deadline);
         if (recv_ret > 0) {
             bytes_received += (size_t)recv_ret;
         }
     }
     
     if (bytes_received < sizeof(enip_header_t)) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", bytes_received);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, bytes_received);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1704,11 +1771,8 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     }
     
     if (header_offset + sizeof(enip_header_t) > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1717,20 +1781,14 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     memcpy(&response_header, response_buffer + header_offset, sizeof(response_header));
     
     if (response_header.command != ENIP_SEND_RR_DATA) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Unexpected response command: 0x%04X", response_header.command);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_UNEXPECTED_COMMAND, response_header.command);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     if (response_header.status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response error status: 0x%08lX", (unsigned long)response_header.status);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_ENCAP_STATUS, response_header.status);
         return ESP_FAIL;
     }
     
@@ -1745,13 +1803,10 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 4;
         remaining_in_buffer -= 4;
     } else {
-        ret = recv_data(sock, &interface_handle_resp, 4, timeout_ms, NULL);
+        ret = recv_data(sock, &interface_handle_resp, 4, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive interface handle");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1763,13 +1818,10 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &timeout_resp, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &timeout_resp, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive timeout");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1781,23 +1833,17 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &item_count_resp, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &item_count_resp, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive item count");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
     
     if (item_count_resp != 2) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Unexpected item count: %d", item_count_resp);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_ITEM_COUNT, item_count_resp);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1809,16 +1855,13 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 4;
         remaining_in_buffer -= 4;
     } else {
-        ret = recv_data(sock, &addr_item_type, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &addr_item_type, 2, deadline, NULL);
         if (ret == ESP_OK) {
-            ret = recv_data(sock, &addr_item_length, 2, timeout_ms, NULL);
+            ret = recv_data(sock, &addr_item_length, 2, deadline, NULL);
         }
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive address item");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1831,16 +1874,13 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 4;
         remaining_in_buffer -= 4;
     } else {
-        ret = recv_data(sock, &resp_data_item_type, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &resp_data_item_type, 2, deadline, NULL);
         if (ret == ESP_OK) {
-            ret = recv_data(sock, &resp_data_item_length, 2, timeout_ms, NULL);
+            ret = recv_data(sock, &resp_data_item_length, 2, deadline, NULL);
         }
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive data item");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1852,13 +1892,10 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &cip_service_resp, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &cip_service_resp, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive CIP service");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1870,13 +1907,10 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &reserved, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &reserved, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive reserved byte");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -1888,24 +1922,18 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &cip_status, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &cip_status, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive CIP status");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
     
     
     if (cip_status != 0x00) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "CIP error status: 0x%02X", cip_status);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_cip(error, cip_status, 0, 0);
         return ESP_FAIL;
     }
     
@@ -1916,36 +1944,31 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
         bytes_already_read += 1;
         remaining_in_buffer -= 1;
     } else {
-        ret = recv_data(sock, &additional_status_size, 1, timeout_ms, NULL);
+        ret = recv_data(sock, &additional_status_size, 1, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive additional status size");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
     
     // Read additional status if present
     if (additional_status_size > 0) {
-        uint8_t additional_status[256];
-        size_t status_buf_size = sizeof(additional_status);
-        if ((size_t)additional_status_size > status_buf_size) {
-            status_buf_size = additional_status_size;
-        }
+        uint8_t additional_status[256];         // additional_status_size is at most 255
         if (remaining_in_buffer >= additional_status_size) {
             memcpy(additional_status, response_buffer + bytes_already_read, additional_status_size);
             bytes_already_read += additional_status_size;
             remaining_in_buffer -= additional_status_size;
         } else {
-            ret = recv_data(sock, additional_status, additional_status_size, timeout_ms, NULL);
+            // Part of it may already be buffered; only the rest is still on the socket
+            size_t buffered = remaining_in_buffer;
+            memcpy(additional_status, response_buffer + bytes_already_read, buffered);
+            bytes_already_read += buffered;
+            remaining_in_buffer = 0;
+            ret = recv_data(sock, additional_status + buffered, additional_status_size - buffered, deadline, NULL);
             if (ret != ESP_OK) {
-                unregister_session(sock, session_handle);
-                close(sock);
-                if (error_message) {
-                    snprintf(error_message, 128, "Failed to receive additional status");
-                }
+                session_release(sock, session_handle, false);
+                enip_error_set(error, ENIP_ERR_RECV);
                 return ret;
             }
         }
@@ -1955,13 +1978,23 @@ esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t ass
     ESP_LOGD(TAG, "Successfully wrote assembly %d to %s: %d bytes in %lu ms",
              assembly_instance, ip_str, data_length, response_time_ms);
     
-    // Cleanup
-    unregister_session(sock, session_handle);
-    close(sock);
+    // Cleanup (the session goes back to the pool when pooling is enabled)
+    session_release(sock, session_handle, true);
     
     return ESP_OK;
 }
 
+esp_err_t enip_scanner_write_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                             uint16_t assembly_instance, const uint8_t *data,
+                                             uint16_t data_length, uint32_t timeout_ms,
+                                             enip_scanner_error_t *error)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = write_assembly_routed(ip_address, route, assembly_instance, data, data_length, timeout_ms, error);
+    diag_record_request(start_us, ret == ESP_OK);
+    return ret;
+}
+
 // Check if an assembly is writable by attempting to read assembly object attributes
 bool enip_scanner_is_assembly_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint32_t timeout_ms)
 {
@@ -1969,6 +2002,10 @@ bool enip_scanner_is_assembly_writable(const ip4_addr_t *ip_address, uint16_t as
     // If we can read it, assume it's writable (since we can read it, we should be able to write it)
     // In practice, you'd check the assembly object's Instance Type attribute
     
+    if (profile_get_writable(ip_address, assembly_instance)) {
+        return true;
+    }
+    
     enip_scanner_assembly_result_t read_result;
     esp_err_t ret = enip_scanner_read_assembly(ip_address, assembly_instance, &read_result, timeout_ms);
     
@@ -1977,6 +2014,7 @@ bool enip_scanner_is_assembly_writable(const ip4_addr_t *ip_address, uint16_t as
         // If we can read it, try a minimal write to verify writability
         // But this might modify the data, so let's just return true if we can read it
         // In a real implementation, you'd check the assembly object attributes
+        profile_note_writable(ip_address, assembly_instance);
         return true;
     }
     
@@ -1986,7 +2024,7 @@ bool enip_scanner_is_assembly_writable(const ip4_addr_t *ip_address, uint16_t as
 }
 
 // Read Assembly Attribute 4 (Data Size) - shared function for both explicit and implicit messaging
-esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle, uint16_t assembly_instance, uint16_t *data_size, uint32_t timeout_ms)
+esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle, uint16_t assembly_instance, uint16_t *data_size, enip_deadline_t deadline)
 {
     if (sock < 0 || data_size == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -2044,7 +2082,7 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
     uint32_t interface_handle = 0;
     memcpy(packet + offset, &interface_handle, 4);
     offset += 4;
-    uint8_t cip_timeout = (timeout_ms / 250) & 0xFF;
+    uint8_t cip_timeout = (enip_deadline_remaining_ms(deadline) / 250) & 0xFF;
     memcpy(packet + offset, &cip_timeout, 1);
     offset += 1;
     packet[offset++] = 0x00;
@@ -2067,21 +2105,21 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
     memcpy(packet + offset, cip_path, path_padded_length);
     offset += path_padded_length;
     
-    esp_err_t ret = send_data(sock, packet, offset);
+    esp_err_t ret = send_data(sock, packet, offset, deadline);
     if (ret != ESP_OK) {
         return ret;
     }
     
     // Receive response
     uint8_t response_buffer[256];
-    ssize_t recv_ret = recv(sock, response_buffer, sizeof(response_buffer), 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, sizeof(response_buffer), deadline);
     if (recv_ret < 0) {
         return ESP_FAIL;
     }
     size_t bytes_received = (size_t)recv_ret;
     
     if (bytes_received < 40) {
-        recv_ret = recv(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, deadline);
         if (recv_ret > 0) {
             bytes_received += (size_t)recv_ret;
         }
@@ -2119,7 +2157,7 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
     } else {
         // Need to read more
         uint8_t skip_buffer[16];
-        ret = recv_data(sock, skip_buffer, 16, timeout_ms, NULL);
+        ret = recv_data(sock, skip_buffer, 16, deadline, NULL);
         if (ret != ESP_OK) {
             return ret;
         }
@@ -2136,7 +2174,7 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
         remaining_in_buffer -= 4;
     } else {
         uint8_t cip_header[4];
-        ret = recv_data(sock, cip_header, 4, timeout_ms, NULL);
+        ret = recv_data(sock, cip_header, 4, deadline, NULL);
         if (ret != ESP_OK) {
             return ret;
         }
@@ -2163,15 +2201,12 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
             bytes_already_read += additional_status_size;
             remaining_in_buffer -= additional_status_size;
         } else {
-            uint8_t *skip_buf = malloc(additional_status_size);
-            if (skip_buf == NULL) {
-                return ESP_ERR_NO_MEM;
-            }
-            ret = recv_data(sock, skip_buf, additional_status_size, timeout_ms, NULL);
-            free(skip_buf);
+            ret = recv_discard(sock, additional_status_size - remaining_in_buffer, deadline);
             if (ret != ESP_OK) {
                 return ret;
             }
+            bytes_already_read += remaining_in_buffer;
+            remaining_in_buffer = 0;
         }
     }
     
@@ -2180,7 +2215,7 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
     if (remaining_in_buffer >= 2) {
         memcpy(&size_value, response_buffer + bytes_already_read, 2);
     } else {
-        ret = recv_data(sock, &size_value, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &size_value, 2, deadline, NULL);
         if (ret != ESP_OK) {
             return ret;
         }
@@ -2192,7 +2227,7 @@ esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle
 }
 
 // Read Max Instance attribute from Assembly Object class
-static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *max_instance, uint32_t timeout_ms)
+static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *max_instance, enip_deadline_t deadline)
 {
     // Build CIP path: Class 4 (Assembly), Instance 0 (class), Attribute 2 (Max Instance)
     uint8_t cip_path[8];
@@ -2240,7 +2275,7 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
     uint32_t interface_handle = 0;
     memcpy(packet + offset, &interface_handle, 4);
     offset += 4;
-    uint8_t cip_timeout = (timeout_ms / 250) & 0xFF;
+    uint8_t cip_timeout = (enip_deadline_remaining_ms(deadline) / 250) & 0xFF;
     memcpy(packet + offset, &cip_timeout, 1);
     offset += 1;
     packet[offset++] = 0x00;
@@ -2263,21 +2298,21 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
     memcpy(packet + offset, cip_path, path_padded_length);
     offset += path_padded_length;
     
-    esp_err_t ret = send_data(sock, packet, offset);
+    esp_err_t ret = send_data(sock, packet, offset, deadline);
     if (ret != ESP_OK) {
         return ret;
     }
     
     // Receive response
     uint8_t response_buffer[256];
-    ssize_t recv_ret = recv(sock, response_buffer, sizeof(response_buffer), 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, sizeof(response_buffer), deadline);
     if (recv_ret < 0) {
         return ESP_FAIL;
     }
     size_t bytes_received = (size_t)recv_ret;
     
     if (bytes_received < 40) {
-        recv_ret = recv(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, deadline);
         if (recv_ret > 0) {
             bytes_received += (size_t)recv_ret;
         }
@@ -2315,7 +2350,7 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
     } else {
         // Need to read more
         uint8_t skip_buffer[16];
-        ret = recv_data(sock, skip_buffer, 16, timeout_ms, NULL);
+        ret = recv_data(sock, skip_buffer, 16, deadline, NULL);
         if (ret != ESP_OK) {
             return ret;
         }
@@ -2333,7 +2368,7 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
         remaining_in_buffer -= 4;
     } else {
         uint8_t cip_header[4];
-        ret = recv_data(sock, cip_header, 4, timeout_ms, NULL);
+        ret = recv_data(sock, cip_header, 4, deadline, NULL);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to read CIP header for Max Instance: %s", esp_err_to_name(ret));
             return ret;
@@ -2348,10 +2383,8 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
              cip_service_resp, cip_status, additional_status_size);
     
     if (cip_status != 0x00) {
-        const char* status_msg = (cip_status == 0x05) ? "Object does not exist" :
-                                 (cip_status == 0x06) ? "Attribute does not exist" :
-                                 (cip_status == 0x14) ? "Attribute not supported" : "Unknown error";
-        ESP_LOGW(TAG, "Max Instance read failed with CIP status: 0x%02X (%s)", cip_status, status_msg);
+        ESP_LOGW(TAG, "Max Instance read failed with CIP status: 0x%02X (%s)", cip_status,
+                 enip_scanner_cip_status_name(cip_status));
         return ESP_FAIL;
     }
     
@@ -2364,15 +2397,14 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
             bytes_already_read += safe_status_size;
             remaining_in_buffer -= safe_status_size;
         } else {
-            uint8_t *skip_buf = malloc(safe_status_size);
-            if (skip_buf) {
-                esp_err_t skip_ret = recv_data(sock, skip_buf, safe_status_size, timeout_ms, NULL);
-                free(skip_buf);
-                // Continue even if recv fails - we're just skipping data
-                if (skip_ret != ESP_OK && skip_ret != ESP_ERR_TIMEOUT) {
-                    ESP_LOGW(TAG, "Failed to skip additional status, continuing anyway");
-                }
+            // A failed skip leaves the stream out of step; the caller drops the session
+            ret = recv_discard(sock, safe_status_size - remaining_in_buffer, deadline);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Failed to skip additional status: %s", esp_err_to_name(ret));
+                return ret;
             }
+            bytes_already_read += remaining_in_buffer;
+            remaining_in_buffer = 0;
         }
     }
     
@@ -2381,7 +2413,7 @@ static esp_err_t read_max_instance(int sock, uint32_t session_handle, uint16_t *
     if (remaining_in_buffer >= 2) {
         memcpy(&max_inst, response_buffer + bytes_already_read, 2);
     } else {
-        ret = recv_data(sock, &max_inst, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &max_inst, 2, deadline, NULL);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to read Max Instance value: %s", esp_err_to_name(ret));
             return ret;
@@ -2400,20 +2432,7 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
         return 0;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        ESP_LOGE(TAG, "Scanner not initialized");
-        return 0;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        return 0;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
+    if (!scanner_is_ready()) {
         return 0;
     }
     
@@ -2421,8 +2440,17 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
     snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(ip_address));
     ESP_LOGD(TAG, "Discovering assembly instances for %s", ip_str);
     
+    int cached_count = profile_get_assemblies(ip_address, instances, max_instances);
+    if (cached_count >= 0) {
+        ESP_LOGD(TAG, "Using %d cached assembly instance(s) for %s", cached_count, ip_str);
+        return cached_count;
+    }
+    
+    // One deadline covers the Max Instance query and every probe read
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
+    
     // Create TCP socket
-    int sock = create_tcp_socket(ip_address, timeout_ms);
+    int sock = create_tcp_socket(ip_address, deadline);
     if (sock < 0) {
         ESP_LOGE(TAG, "Failed to connect to device");
         return 0;
@@ -2430,7 +2458,7 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
     
     // Register session
     uint32_t session_handle = 0;
-    esp_err_t ret = register_session(sock, &session_handle);
+    esp_err_t ret = register_session(sock, &session_handle, deadline);
     if (ret != ESP_OK) {
         close(sock);
         ESP_LOGE(TAG, "Failed to register session");
@@ -2439,9 +2467,10 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
     
     // Try to read Max Instance attribute
     uint16_t max_instance = 0;
-    ret = read_max_instance(sock, session_handle, &max_instance, timeout_ms);
+    ret = read_max_instance(sock, session_handle, &max_instance, deadline);
     
     int found_count = 0;
+    bool complete = true;   // Every candidate instance was probed
     
     // Check if Max Instance read succeeded and value is reasonable
     // Some devices may return 0 or very large values, so we need to validate
@@ -2453,16 +2482,22 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
         ESP_LOGD(TAG, "Max Instance: %d, probing instances 1 to %d (will return up to %d)", 
                  max_instance, probe_limit, max_instances);
         for (uint16_t inst = 1; inst <= probe_limit && found_count < max_instances; inst++) {
+            uint32_t remaining_ms = enip_deadline_remaining_ms(deadline);
+            if (remaining_ms == 0) {
+                ESP_LOGW(TAG, "Discovery deadline reached after probing %d instance(s)", inst - 1);
+                complete = false;
+                break;
+            }
             // Try to read the assembly instance to see if it exists
             enip_scanner_assembly_result_t test_result;
-            esp_err_t read_ret = enip_scanner_read_assembly(ip_address, inst, &test_result, timeout_ms);
+            esp_err_t read_ret = enip_scanner_read_assembly(ip_address, inst, &test_result, remaining_ms);
             if (read_ret == ESP_OK && test_result.success) {
                 instances[found_count++] = inst;
                 enip_scanner_free_assembly_result(&test_result);
                 ESP_LOGD(TAG, "Found valid assembly instance: %d", inst);
             } else {
                 ESP_LOGD(TAG, "Instance %d not found or error: %s", inst, 
-                         (read_ret == ESP_OK) ? test_result.error_message : esp_err_to_name(read_ret));
+                         (read_ret == ESP_OK) ? enip_scanner_error_code_name(test_result.error.code) : esp_err_to_name(read_ret));
                 // Ensure result is freed even on error
                 enip_scanner_free_assembly_result(&test_result);
             }
@@ -2476,15 +2511,21 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
         
         ESP_LOGD(TAG, "Max Instance read failed, probing %d common instance numbers", num_common);
         for (int i = 0; i < num_common && found_count < max_instances; i++) {
+            uint32_t remaining_ms = enip_deadline_remaining_ms(deadline);
+            if (remaining_ms == 0) {
+                ESP_LOGW(TAG, "Discovery deadline reached after probing %d common instance(s)", i);
+                complete = false;
+                break;
+            }
             enip_scanner_assembly_result_t test_result;
-            esp_err_t read_ret = enip_scanner_read_assembly(ip_address, common_instances[i], &test_result, timeout_ms);
+            esp_err_t read_ret = enip_scanner_read_assembly(ip_address, common_instances[i], &test_result, remaining_ms);
             if (read_ret == ESP_OK && test_result.success) {
                 instances[found_count++] = common_instances[i];
                 enip_scanner_free_assembly_result(&test_result);
                 ESP_LOGD(TAG, "Found valid assembly instance: %d", common_instances[i]);
             } else {
                 ESP_LOGD(TAG, "Common instance %d not found or error: %s", common_instances[i],
-                         (read_ret == ESP_OK) ? test_result.error_message : esp_err_to_name(read_ret));
+                         (read_ret == ESP_OK) ? enip_scanner_error_code_name(test_result.error.code) : esp_err_to_name(read_ret));
                 // Ensure result is freed even on error
                 enip_scanner_free_assembly_result(&test_result);
             }
@@ -2495,6 +2536,12 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
     unregister_session(sock, session_handle);
     close(sock);
     
+    // Only a full result stands in for the next discovery; a list cut short by
+    // max_instances or the deadline is not cached
+    if (complete && found_count > 0 && found_count < max_instances) {
+        profile_note_assemblies(ip_address, instances, found_count);
+    }
+    
     ESP_LOGD(TAG, "Discovered %d valid assembly instance(s) for %s", found_count, ip_str);
     return found_count;
 }
@@ -2506,53 +2553,28 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
 esp_err_t enip_scanner_register_session(const ip4_addr_t *ip_address,
                                         uint32_t *session_handle,
                                         uint32_t timeout_ms,
-                                        char *error_message)
+                                        enip_scanner_error_t *error)
 {
     if (ip_address == NULL || session_handle == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid parameters");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to acquire mutex");
-        }
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
+    if (!scanner_is_ready()) {
+        enip_error_set(error, ENIP_ERR_NOT_INITIALIZED);
         return ESP_ERR_INVALID_STATE;
     }
     
-    int sock = create_tcp_socket(ip_address, timeout_ms);
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
+    int sock = create_tcp_socket(ip_address, deadline);
     if (sock < 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to create TCP socket");
-        }
+        enip_error_set(error, ENIP_ERR_CONNECT);
         return ESP_FAIL;
     }
     
-    esp_err_t ret = register_session(sock, session_handle);
+    esp_err_t ret = register_session(sock, session_handle, deadline);
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to register session: %s", esp_err_to_name(ret));
-        }
+        enip_error_set(error, ENIP_ERR_REGISTER_SESSION);
         close(sock);
         return ret;
     }
@@ -2573,23 +2595,11 @@ esp_err_t enip_scanner_unregister_session(const ip4_addr_t *ip_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
+    if (!scanner_is_ready()) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    int sock = create_tcp_socket(ip_address, timeout_ms);
+    int sock = create_tcp_socket(ip_address, enip_deadline_from_timeout(timeout_ms));
     if (sock < 0) {
         return ESP_FAIL;
     }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_buffer_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
+
+#define POOL_BLOCKS CONFIG_ENIP_SCANNER_BUFFER_POOL_BLOCKS
+#define POOL_BLOCK_SIZE ((CONFIG_ENIP_SCANNER_BUFFER_POOL_BLOCK_SIZE + 3) & ~3)
+#define POOL_ALL_FREE ((POOL_BLOCKS >= 32) ? 0xFFFFFFFFu : ((1u << POOL_BLOCKS) - 1u))
+
+static uint8_t s_pool[POOL_BLOCKS][POOL_BLOCK_SIZE] __attribute__((aligned(4)));
+static uint32_t s_free_mask = POOL_ALL_FREE;  // Bit n set = block n is free
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static enip_scanner_buffer_pool_stats_t s_stats;
+
+void *enip_buffer_alloc(size_t size)
+{
+    if (size == 0) {
+        size = 1;
+    }
+    
+    if (size <= POOL_BLOCK_SIZE) {
+        int block = -1;
+        taskENTER_CRITICAL(&s_pool_lock);
+        if (s_free_mask != 0) {
+            block = __builtin_ctz(s_free_mask);
+            s_free_mask &= ~(1u << block);
+            s_stats.allocations++;
+            s_stats.in_use++;
+            if (s_stats.in_use > s_stats.peak_in_use) {
+                s_stats.peak_in_use = s_stats.in_use;
+            }
+        } else {
+            s_stats.exhausted++;
+        }
+        taskEXIT_CRITICAL(&s_pool_lock);
+        if (block >= 0) {
+            return s_pool[block];
+        }
+    } else {
+        taskENTER_CRITICAL(&s_pool_lock);
+        s_stats.oversize++;
+        taskEXIT_CRITICAL(&s_pool_lock);
+    }
+    
+    return enip_mem_alloc(ENIP_MEM_HOT, size);
+}
+
+void enip_buffer_free(void *buffer)
+{
+    if (buffer == NULL) {
+        return;
+    }
+    
+    uint8_t *p = (uint8_t *)buffer;
+    if (p < &s_pool[0][0] || p >= &s_pool[POOL_BLOCKS][0]) {
+        enip_mem_free(buffer);
+        return;
+    }
+    
+    size_t block = (size_t)(p - &s_pool[0][0]) / POOL_BLOCK_SIZE;
+    taskENTER_CRITICAL(&s_pool_lock);
+    s_free_mask |= (1u << block);
+    s_stats.in_use--;
+    taskEXIT_CRITICAL(&s_pool_lock);
+}
+
+esp_err_t enip_scanner_get_buffer_pool_stats(enip_scanner_buffer_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_pool_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_pool_lock);
+    stats->blocks = POOL_BLOCKS;
+    stats->block_size = POOL_BLOCK_SIZE;
+    return ESP_OK;
+}
+
+#else
+
+void *enip_buffer_alloc(size_t size)
+{
+    return enip_mem_alloc(ENIP_MEM_HOT, size);
+}
+
+void enip_buffer_free(void *buffer)
+{
+    enip_mem_free(buffer);
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_BUFFER_INTERNAL_H
+#define ENIP_SCANNER_BUFFER_INTERNAL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Packet and scratch buffers for one explicit transaction or implicit
+// connection. Requests up to CONFIG_ENIP_SCANNER_BUFFER_POOL_BLOCK_SIZE bytes
+// are served from a static pool of fixed-size blocks; larger requests, and
+// requests while every block is in use, fall back to the hot (internal RAM)
+// heap tier. Buffers must be released with enip_buffer_free() on every exit
+// path of the operation that took them. Without
+// CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL both map to enip_mem_alloc/_free.
+void *enip_buffer_alloc(size_t size);
+void enip_buffer_free(void *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_BUFFER_INTERNAL_H
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_capture_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
+static const char *TAG = "enip_scanner_capture";
+
+// Frame n (counted from arming) lives in s_frames[n % CONFIG_ENIP_SCANNER_CAPTURE_FRAMES].
+// Recording stops at s_stop_frame, so the frames from the trigger back to
+// pre_frames before it are never overwritten.
+static ENIP_MEM_COLD_BSS enip_scanner_capture_frame_t s_frames[CONFIG_ENIP_SCANNER_CAPTURE_FRAMES];
+static portMUX_TYPE s_capture_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile enip_capture_state_t s_state = ENIP_CAPTURE_IDLE;
+static enip_scanner_capture_config_t s_config;
+static uint32_t s_total;                // Frames recorded since arming
+static uint32_t s_truncated;
+static uint32_t s_trigger_frame;        // First frame at or after the trigger
+static uint32_t s_stop_frame;           // Recording freezes when s_total reaches it
+static int64_t s_trigger_time_us;
+static int64_t s_last_t_to_o_us;        // Time of the last T-to-O frame (gap trigger)
+static bool s_have_previous;            // s_previous holds the watched value of an earlier frame
+static int32_t s_previous;
+
+// Caller holds s_capture_lock
+static void fire_locked(uint32_t trigger_frame, int64_t time_us)
+{
+    s_state = ENIP_CAPTURE_TRIGGERED;
+    s_trigger_frame = trigger_frame;
+    s_trigger_time_us = time_us;
+    s_stop_frame = trigger_frame + s_config.post_frames + (trigger_frame < s_total ? 1 : 0);
+    if (s_total >= s_stop_frame) {
+        s_state = ENIP_CAPTURE_COMPLETE;
+    }
+}
+
+// Extract the watched bit or value; false if the frame does not contain it
+static bool watched_value(const uint8_t *data, uint16_t data_length, int32_t *value)
+{
+    if (s_config.trigger <= ENIP_CAPTURE_TRIGGER_BIT_CHANGE) {
+        if (s_config.offset >= data_length) {
+            return false;
+        }
+        *value = (data[s_config.offset] >> s_config.bit) & 1;
+        return true;
+    }
+    if ((uint32_t)s_config.offset + s_config.width > data_length) {
+        return false;
+    }
+    uint32_t raw = 0;
+    for (uint8_t i = 0; i < s_config.width; i++) {
+        raw |= (uint32_t)data[s_config.offset + i] << (8 * i);
+    }
+    if (s_config.is_signed && s_config.width < 4 && (raw & (1u << (8 * s_config.width - 1)))) {
+        raw |= ~0u << (8 * s_config.width);
+    }
+    *value = (int32_t)raw;
+    return true;
+}
+
+// Caller holds s_capture_lock; returns true if the frame fires the trigger
+static bool evaluate_locked(const uint8_t *data, uint16_t data_length)
+{
+    int32_t value;
+    if (!watched_value(data, data_length, &value)) {
+        return false;
+    }
+    bool had_previous = s_have_previous;
+    int32_t previous = s_previous;
+    s_have_previous = true;
+    s_previous = value;
+    if (!had_previous) {
+        return false;
+    }
+    
+    // Edges and crossings only, so a condition already true at arming does not fire
+    switch (s_config.trigger) {
+        case ENIP_CAPTURE_TRIGGER_BIT_RISING:
+            return previous == 0 && value == 1;
+        case ENIP_CAPTURE_TRIGGER_BIT_FALLING:
+            return previous == 1 && value == 0;
+        case ENIP_CAPTURE_TRIGGER_BIT_CHANGE:
+            return previous != value;
+        case ENIP_CAPTURE_TRIGGER_ABOVE:
+            return s_config.is_signed ? (previous <= s_config.threshold && value > s_config.threshold) :
+                   ((uint32_t)previous <= (uint32_t)s_config.threshold && (uint32_t)value > (uint32_t)s_config.threshold);
+        case ENIP_CAPTURE_TRIGGER_BELOW:
+            return s_config.is_signed ? (previous >= s_config.threshold && value < s_config.threshold) :
+                   ((uint32_t)previous >= (uint32_t)s_config.threshold && (uint32_t)value < (uint32_t)s_config.threshold);
+        default:
+            return false;
+    }
+}
+
+void capture_record_frame(const ip4_addr_t *ip_address, uint8_t direction, const uint8_t *frame,
+                          uint16_t frame_length, uint16_t data_offset, uint16_t data_length)
+{
+    // Unlocked pre-check keeps the cost to two loads while no capture is running
+    enip_capture_state_t state = s_state;
+    if ((state != ENIP_CAPTURE_ARMED && state != ENIP_CAPTURE_TRIGGERED) ||
+        s_config.ip_address.addr != ip_address->addr) {
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+    
+    taskENTER_CRITICAL(&s_capture_lock);
+    if ((s_state == ENIP_CAPTURE_ARMED || s_state == ENIP_CAPTURE_TRIGGERED) &&
+        s_config.ip_address.addr == ip_address->addr) {
+        if (s_state == ENIP_CAPTURE_ARMED && direction == CAPTURE_DIR_T_TO_O &&
+            s_config.trigger == ENIP_CAPTURE_TRIGGER_TIMEOUT && s_last_t_to_o_us != 0 &&
+            now_us - s_last_t_to_o_us > (int64_t)s_config.timeout_ms * 1000) {
+            // The gap check did not run in time; this late frame is the first after the trigger
+            fire_locked(s_total, s_last_t_to_o_us + (int64_t)s_config.timeout_ms * 1000);
+        }
+        if (direction == CAPTURE_DIR_T_TO_O) {
+            s_last_t_to_o_us = now_us;
+        }
+        
+        enip_scanner_capture_frame_t *slot = &s_frames[s_total % CONFIG_ENIP_SCANNER_CAPTURE_FRAMES];
+        uint16_t stored = frame_length < sizeof(slot->data) ? frame_length : sizeof(slot->data);
+        slot->time_us = now_us;
+        slot->direction = direction;
+        slot->trigger = false;
+        slot->length = frame_length;
+        slot->data_offset = data_offset;
+        slot->data_length = data_length;
+        memcpy(slot->data, frame, stored);
+        if (stored < frame_length) {
+            s_truncated++;
+        }
+        
+        // Conditions are evaluated on the full frame, not the stored part
+        if (s_state == ENIP_CAPTURE_ARMED && direction == s_config.direction &&
+            s_config.trigger != ENIP_CAPTURE_TRIGGER_MANUAL && s_config.trigger != ENIP_CAPTURE_TRIGGER_TIMEOUT &&
+            evaluate_locked(frame + data_offset, data_length)) {
+            slot->trigger = true;
+            s_total++;
+            fire_locked(s_total - 1, now_us);
+        } else {
+            s_total++;
+            if (s_state == ENIP_CAPTURE_TRIGGERED && s_total >= s_stop_frame) {
+                s_state = ENIP_CAPTURE_COMPLETE;
+            }
+        }
+    }
+    taskEXIT_CRITICAL(&s_capture_lock);
+}
+
+void capture_check_gap(const ip4_addr_t *ip_address)
+{
+    if (s_state != ENIP_CAPTURE_ARMED || s_config.trigger != ENIP_CAPTURE_TRIGGER_TIMEOUT ||
+        s_config.ip_address.addr != ip_address->addr) {
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+    
+    taskENTER_CRITICAL(&s_capture_lock);
+    if (s_state == ENIP_CAPTURE_ARMED && s_last_t_to_o_us != 0 &&
+        now_us - s_last_t_to_o_us > (int64_t)s_config.timeout_ms * 1000) {
+        fire_locked(s_total, now_us);
+    }
+    taskEXIT_CRITICAL(&s_capture_lock);
+}
+
+void capture_connection_lost(const ip4_addr_t *ip_address)
+{
+    enip_capture_state_t state = s_state;
+    if ((state != ENIP_CAPTURE_ARMED && state != ENIP_CAPTURE_TRIGGERED) ||
+        s_config.ip_address.addr != ip_address->addr) {
+        return;
+    }
+    
+    // No more frames will come: keep what was recorded
+    taskENTER_CRITICAL(&s_capture_lock);
+    if (s_state == ENIP_CAPTURE_ARMED) {
+        if (s_config.trigger == ENIP_CAPTURE_TRIGGER_TIMEOUT) {
+            fire_locked(s_total, esp_timer_get_time());
+        } else {
+            s_trigger_frame = s_total;  // Never triggered; the ring is the capture
+        }
+    }
+    s_stop_frame = s_total;
+    s_state = ENIP_CAPTURE_COMPLETE;
+    taskEXIT_CRITICAL(&s_capture_lock);
+    
+    ESP_LOGW(TAG, "Connection to " IPSTR " lost, capture frozen", IP2STR(ip_address));
+}
+
+esp_err_t enip_scanner_capture_arm(const enip_scanner_capture_config_t *config)
+{
+    if (config == NULL || config->trigger > ENIP_CAPTURE_TRIGGER_TIMEOUT ||
+        config->direction > ENIP_CAPTURE_DIR_O_TO_T || config->bit > 7 ||
+        (uint32_t)config->pre_frames + config->post_frames + 1 > CONFIG_ENIP_SCANNER_CAPTURE_FRAMES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((config->trigger == ENIP_CAPTURE_TRIGGER_ABOVE || config->trigger == ENIP_CAPTURE_TRIGGER_BELOW) &&
+        config->width != 1 && config->width != 2 && config->width != 4) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->trigger == ENIP_CAPTURE_TRIGGER_TIMEOUT && config->timeout_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_capture_lock);
+    s_config = *config;
+    s_total = 0;
+    s_truncated = 0;
+    s_trigger_frame = 0;
+    s_stop_frame = 0;
+    s_trigger_time_us = 0;
+    s_last_t_to_o_us = 0;
+    s_have_previous = false;
+    s_state = ENIP_CAPTURE_ARMED;
+    taskEXIT_CRITICAL(&s_capture_lock);
+    
+    ESP_LOGI(TAG, "Capture armed for " IPSTR " (trigger %d, %u pre / %u post frames)",
+             IP2STR(&config->ip_address), config->trigger, config->pre_frames, config->post_frames);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_capture_trigger(void)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    taskENTER_CRITICAL(&s_capture_lock);
+    if (s_state == ENIP_CAPTURE_ARMED) {
+        fire_locked(s_total, esp_timer_get_time());
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_capture_lock);
+    return ret;
+}
+
+esp_err_t enip_scanner_capture_stop(void)
+{
+    taskENTER_CRITICAL(&s_capture_lock);
+    if (s_state == ENIP_CAPTURE_ARMED || s_state == ENIP_CAPTURE_TRIGGERED) {
+        if (s_state == ENIP_CAPTURE_ARMED) {
+            s_trigger_frame = s_total;
+        }
+        s_stop_frame = s_total;
+        s_state = ENIP_CAPTURE_IDLE;
+    }
+    taskEXIT_CRITICAL(&s_capture_lock);
+    return ESP_OK;
+}
+
+// Caller holds s_capture_lock; absolute number of the oldest readable frame
+static uint32_t window_start_locked(void)
+{
+    uint32_t start = s_total > CONFIG_ENIP_SCANNER_CAPTURE_FRAMES ? s_total - CONFIG_ENIP_SCANNER_CAPTURE_FRAMES : 0;
+    if (s_state != ENIP_CAPTURE_ARMED && s_trigger_frame > s_config.pre_frames &&
+        s_trigger_frame - s_config.pre_frames > start) {
+        start = s_trigger_frame - s_config.pre_frames;
+    }
+    return start;
+}
+
+esp_err_t enip_scanner_capture_get_status(enip_scanner_capture_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&s_capture_lock);
+    uint32_t start = window_start_locked();
+    status->state = s_state;
+    status->config = s_config;
+    status->frames_recorded = s_total;
+    status->frames_truncated = s_truncated;
+    status->frame_count = s_total - start;
+    status->trigger_index = (s_state == ENIP_CAPTURE_ARMED) ? 0 : s_trigger_frame - start;
+    status->trigger_time_us = s_trigger_time_us;
+    taskEXIT_CRITICAL(&s_capture_lock);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_capture_get_frame(uint16_t index, enip_scanner_capture_frame_t *frame)
+{
+    if (frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&s_capture_lock);
+    uint32_t start = window_start_locked();
+    if (start + index < s_total) {
+        *frame = s_frames[(start + index) % CONFIG_ENIP_SCANNER_CAPTURE_FRAMES];
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_capture_lock);
+    return ret;
+}
+
+#else // !CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
+void capture_record_frame(const ip4_addr_t *ip_address, uint8_t direction, const uint8_t *frame,
+                          uint16_t frame_length, uint16_t data_offset, uint16_t data_length)
+{
+}
+
+void capture_check_gap(const ip4_addr_t *ip_address)
+{
+}
+
+void capture_connection_lost(const ip4_addr_t *ip_address)
+{
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_CAPTURE_INTERNAL_H
+#define ENIP_SCANNER_CAPTURE_INTERNAL_H
+
+#include "lwip/ip4_addr.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_DIR_T_TO_O 0
+#define CAPTURE_DIR_O_TO_T 1
+
+// Hooks for the implicit receive, heartbeat and watchdog tasks. They return at
+// once unless a capture is armed for the connection's address, never allocate,
+// and are no-ops unless CONFIG_ENIP_SCANNER_ENABLE_CAPTURE is set.
+
+// Record a frame (CPF items as sent or received) and evaluate the trigger
+void capture_record_frame(const ip4_addr_t *ip_address, uint8_t direction, const uint8_t *frame,
+                          uint16_t frame_length, uint16_t data_offset, uint16_t data_length);
+
+// Fire a timeout trigger if no T-to-O frame arrived for the configured gap
+void capture_check_gap(const ip4_addr_t *ip_address);
+
+// The connection timed out: fire a timeout trigger and freeze the capture
+void capture_connection_lost(const ip4_addr_t *ip_address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_CAPTURE_INTERNAL_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_clock_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdint.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+
+static const char *TAG = "enip_clock";
+
+atomic_int_fast64_t s_virtual_now_us = -1;
+
+void enip_clock_delay_ms(uint32_t delay_ms)
+{
+    int64_t wake_us = enip_clock_now_us() + (int64_t)delay_ms * 1000;
+    
+    // Yield a real tick at a time until the application has advanced the
+    // clock past the wake-up time, or switched back to real time
+    while (true) {
+        int64_t virtual_us = atomic_load_explicit(&s_virtual_now_us, memory_order_relaxed);
+        if (virtual_us < 0) {
+            int64_t left_us = wake_us - esp_timer_get_time();
+            if (left_us > 0) {
+                vTaskDelay(enip_clock_wait_ticks(left_us));
+            }
+            return;
+        }
+        if (virtual_us >= wake_us) {
+            return;
+        }
+        vTaskDelay(1);
+    }
+}
+
+esp_err_t enip_scanner_virtual_clock_enable(void)
+{
+    // Start from real time so timestamps taken before the switch stay valid
+    int_fast64_t expected = -1;
+    if (!atomic_compare_exchange_strong(&s_virtual_now_us, &expected, esp_timer_get_time())) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_LOGI(TAG, "Scanner timers now run on the virtual clock");
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_virtual_clock_disable(void)
+{
+    if (atomic_exchange(&s_virtual_now_us, -1) < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_LOGI(TAG, "Scanner timers back on real time");
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_virtual_clock_advance(int64_t delta_us)
+{
+    if (delta_us < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int_fast64_t now_us = atomic_load(&s_virtual_now_us);
+    do {
+        if (now_us < 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    } while (!atomic_compare_exchange_weak(&s_virtual_now_us, &now_us, now_us + delta_us));
+    return ESP_OK;
+}
+
+int64_t enip_scanner_clock_now_us(void)
+{
+    return enip_clock_now_us();
+}
+
+#else
+
+void enip_clock_delay_ms(uint32_t delay_ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
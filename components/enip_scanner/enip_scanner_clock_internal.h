@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_CLOCK_INTERNAL_H
+#define ENIP_SCANNER_CLOCK_INTERNAL_H
+
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Time source for the scanner's timers: RPI scheduling, the implicit
+// watchdog, reconnect retries and I/O supervision. It is real time unless
+// CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK is set and
+// enip_scanner_virtual_clock_enable() was called; then it only moves when the
+// application advances it. Socket timeouts, explicit-message deadlines and
+// pooled session idle times always run on real time.
+
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+// Virtual time in microseconds, negative while on real time (enip_scanner_clock.c)
+extern atomic_int_fast64_t s_virtual_now_us;
+#endif
+
+static inline int64_t enip_clock_now_us(void)
+{
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+    int64_t virtual_us = atomic_load_explicit(&s_virtual_now_us, memory_order_relaxed);
+    if (virtual_us >= 0) {
+        return virtual_us;
+    }
+#endif
+    return esp_timer_get_time();
+}
+
+// Scanner time in FreeRTOS ticks, for the modules that keep tick timestamps
+static inline TickType_t enip_clock_ticks(void)
+{
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+    int64_t virtual_us = atomic_load_explicit(&s_virtual_now_us, memory_order_relaxed);
+    if (virtual_us >= 0) {
+        return (TickType_t)(virtual_us / ((int64_t)portTICK_PERIOD_MS * 1000));
+    }
+#endif
+    return xTaskGetTickCount();
+}
+
+// Real ticks to block for a wait of wait_us scanner time, at least one. On
+// virtual time it is always one, so the caller re-reads the clock every tick.
+static inline TickType_t enip_clock_wait_ticks(int64_t wait_us)
+{
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+    if (atomic_load_explicit(&s_virtual_now_us, memory_order_relaxed) >= 0) {
+        return 1;
+    }
+#endif
+    if (wait_us <= 0) {
+        return 1;
+    }
+    return (TickType_t)((wait_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+}
+
+// Blocks the calling task for delay_ms of scanner time
+void enip_clock_delay_ms(uint32_t delay_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_CLOCK_INTERNAL_H
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_CONTEXT_INTERNAL_H
+#define ENIP_SCANNER_CONTEXT_INTERNAL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lifecycle of the scanner context
+typedef enum {
+    SCANNER_STATE_DOWN = 0,
+    SCANNER_STATE_STARTING,             // One enip_scanner_init() call owns the start-up
+    SCANNER_STATE_READY,
+} scanner_state_t;
+
+// Scanner-wide state shared by the modules (defined in enip_scanner.c). Every
+// field is atomic, so public calls check readiness and take connection IDs
+// without a lock; pools and caches keep their own locks in their modules.
+typedef struct {
+    atomic_int state;                   // scanner_state_t
+    atomic_uint_fast32_t connection_id_base;  // Random upper half of O-to-T connection IDs; 0 until seeded
+    atomic_uint_fast16_t connection_counter;  // Lower half, advanced by 2 per connection
+    atomic_bool motoman_rs022_instance_direct;
+} scanner_context_t;
+
+extern scanner_context_t s_scanner_ctx;
+
+// Acquire pairs with the release store that ends enip_scanner_init(), so a
+// caller that sees READY also sees everything init set up
+static inline bool scanner_is_ready(void)
+{
+    return atomic_load_explicit(&s_scanner_ctx.state, memory_order_acquire) == SCANNER_STATE_READY;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_CONTEXT_INTERNAL_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_DEADLINE_INTERNAL_H
+#define ENIP_SCANNER_DEADLINE_INTERNAL_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Absolute operation deadline in FreeRTOS ticks.
+// A public call converts its timeout_ms once with enip_deadline_from_timeout()
+// and every connect, send and receive step below it draws from what is left,
+// so the whole call is bounded by timeout_ms rather than each step.
+typedef TickType_t enip_deadline_t;
+
+// Rounds up to whole ticks, at least one: at 100 Hz pdMS_TO_TICKS() would turn
+// anything under 10 ms into a deadline that has already passed
+static inline enip_deadline_t enip_deadline_from_timeout(uint32_t timeout_ms)
+{
+    uint64_t ticks = ((uint64_t)timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    return xTaskGetTickCount() + (TickType_t)(ticks > 0 ? ticks : 1);
+}
+
+// Milliseconds left before the deadline, 0 once it has passed (wrap-safe)
+static inline uint32_t enip_deadline_remaining_ms(enip_deadline_t deadline)
+{
+    int32_t ticks_left = (int32_t)(deadline - xTaskGetTickCount());
+    return ticks_left > 0 ? (uint32_t)ticks_left * portTICK_PERIOD_MS : 0;
+}
+
+static inline bool enip_deadline_expired(enip_deadline_t deadline)
+{
+    return enip_deadline_remaining_ms(deadline) == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_DEADLINE_INTERNAL_H
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_diag_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <stdlib.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
+static const char *TAG = "enip_scanner_diag";
+
+// Heap samples, oldest at s_sample_next once the ring has wrapped
+static enip_scanner_heap_sample_t s_samples[CONFIG_ENIP_SCANNER_DIAG_SAMPLES];
+static size_t s_sample_next = 0;
+static size_t s_sample_count = 0;
+static uint32_t s_samples_taken = 0;
+static portMUX_TYPE s_diag_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_sample_timer = NULL;
+
+static uint8_t fragmentation_pct(size_t free_bytes, size_t largest)
+{
+    if (free_bytes == 0 || largest >= free_bytes) {
+        return 0;
+    }
+    return (uint8_t)(100 - (largest * 100) / free_bytes);
+}
+
+static void read_heap(enip_scanner_heap_sample_t *sample)
+{
+    sample->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    sample->free_bytes = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    sample->largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    sample->fragmentation_pct = fragmentation_pct(sample->free_bytes, sample->largest_free_block);
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+// Upper bounds of the latency buckets in ms; the last one takes everything slower
+static const uint32_t s_latency_bounds_ms[] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, UINT32_MAX
+};
+#define LATENCY_BUCKETS (sizeof(s_latency_bounds_ms) / sizeof(s_latency_bounds_ms[0]))
+
+// The settled heap level is the best of the last few samples, so a request in
+// flight at one sample does not read as a leak
+#define SOAK_SETTLE_SAMPLES 4
+
+typedef struct {
+    uint32_t counts[LATENCY_BUCKETS];
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t max_ms;
+} latency_histogram_t;
+
+static latency_histogram_t s_interval_latency;  // Since the last heap sample
+static latency_histogram_t s_soak_latency;      // Since enip_scanner_soak_start()
+static bool s_soak_running = false;
+static bool s_soak_reported = false;            // A breach was logged already
+static int64_t s_soak_start_us = 0;
+static uint32_t s_soak_first_sample = 0;        // s_samples_taken at the start
+static enip_scanner_heap_sample_t s_soak_baseline;
+static enip_scanner_soak_limits_t s_soak_limits;
+
+static void histogram_add(latency_histogram_t *histogram, uint32_t elapsed_ms, bool ok)
+{
+    size_t bucket = 0;
+    while (elapsed_ms > s_latency_bounds_ms[bucket]) {
+        bucket++;
+    }
+    histogram->counts[bucket]++;
+    histogram->requests++;
+    if (!ok) {
+        histogram->failures++;
+    }
+    if (elapsed_ms > histogram->max_ms) {
+        histogram->max_ms = elapsed_ms;
+    }
+}
+
+// Upper bound of the bucket holding the percentile, capped at the slowest request
+static uint32_t histogram_percentile(const latency_histogram_t *histogram, uint32_t pct)
+{
+    if (histogram->requests == 0) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(((uint64_t)histogram->requests * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            return s_latency_bounds_ms[i] < histogram->max_ms ? s_latency_bounds_ms[i] : histogram->max_ms;
+        }
+    }
+    return histogram->max_ms;
+}
+
+void diag_record_request(int64_t start_us, bool ok)
+{
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us + 999) / 1000);
+    
+    taskENTER_CRITICAL(&s_diag_lock);
+    histogram_add(&s_interval_latency, elapsed_ms, ok);
+    if (s_soak_running) {
+        histogram_add(&s_soak_latency, elapsed_ms, ok);
+    }
+    taskEXIT_CRITICAL(&s_diag_lock);
+}
+
+static void soak_evaluate(enip_scanner_soak_report_t *report)
+{
+    memset(report, 0, sizeof(*report));
+    uint32_t settled_free = 0;
+    uint32_t settled_block = 0;
+    
+    taskENTER_CRITICAL(&s_diag_lock);
+    size_t count = s_samples_taken - s_soak_first_sample;
+    if (count > s_sample_count) {
+        count = s_sample_count;
+    }
+    if (count > SOAK_SETTLE_SAMPLES) {
+        count = SOAK_SETTLE_SAMPLES;
+    }
+    for (size_t i = 1; i <= count; i++) {
+        const enip_scanner_heap_sample_t *sample =
+            &s_samples[(s_sample_next + CONFIG_ENIP_SCANNER_DIAG_SAMPLES - i) % CONFIG_ENIP_SCANNER_DIAG_SAMPLES];
+        if (sample->free_bytes > settled_free) {
+            settled_free = sample->free_bytes;
+        }
+        if (sample->largest_free_block > settled_block) {
+            settled_block = sample->largest_free_block;
+        }
+    }
+    latency_histogram_t latency = s_soak_latency;
+    enip_scanner_heap_sample_t baseline = s_soak_baseline;
+    enip_scanner_soak_limits_t limits = s_soak_limits;
+    int64_t start_us = s_soak_start_us;
+    taskEXIT_CRITICAL(&s_diag_lock);
+    
+    if (count == 0) {
+        // No sample since the start yet
+        enip_scanner_heap_sample_t now;
+        read_heap(&now);
+        settled_free = now.free_bytes;
+        settled_block = now.largest_free_block;
+    }
+    
+    report->elapsed_s = (uint32_t)((esp_timer_get_time() - start_us) / 1000000);
+    report->baseline_free_bytes = baseline.free_bytes;
+    report->settled_free_bytes = settled_free;
+    report->heap_loss_bytes = (int32_t)(baseline.free_bytes - settled_free);
+    report->baseline_largest_free_block = baseline.largest_free_block;
+    report->settled_largest_free_block = settled_block;
+    report->block_loss_bytes = (int32_t)(baseline.largest_free_block - settled_block);
+    report->requests = latency.requests;
+    report->failures = latency.failures;
+    report->latency_p50_ms = histogram_percentile(&latency, 50);
+    report->latency_p95_ms = histogram_percentile(&latency, 95);
+    report->latency_p99_ms = histogram_percentile(&latency, 99);
+    report->latency_max_ms = latency.max_ms;
+    
+    report->heap_exceeded = limits.max_heap_loss_bytes != 0 &&
+                            report->heap_loss_bytes > (int32_t)limits.max_heap_loss_bytes;
+    report->block_exceeded = limits.max_block_loss_bytes != 0 &&
+                             report->block_loss_bytes > (int32_t)limits.max_block_loss_bytes;
+    report->latency_exceeded = limits.max_latency_p99_ms != 0 &&
+                               report->latency_p99_ms > limits.max_latency_p99_ms;
+}
+
+// Checked after every heap sample so a breach shows in the log even if nobody polls
+static void soak_watch(void)
+{
+    if (!s_soak_running || s_soak_reported) {
+        return;
+    }
+    
+    enip_scanner_soak_report_t report;
+    soak_evaluate(&report);
+    if (report.heap_exceeded || report.block_exceeded || report.latency_exceeded) {
+        s_soak_reported = true;
+        ESP_LOGE(TAG, "Soak limits exceeded after %lu s: heap -%ld B, largest block -%ld B, p99 %lu ms",
+                 (unsigned long)report.elapsed_s, (long)report.heap_loss_bytes,
+                 (long)report.block_loss_bytes, (unsigned long)report.latency_p99_ms);
+    }
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+static void diag_take_sample(void *arg)
+{
+    (void)arg;
+    enip_scanner_heap_sample_t sample = {0};
+    read_heap(&sample);
+    
+    taskENTER_CRITICAL(&s_diag_lock);
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+    sample.requests = s_interval_latency.requests;
+    sample.latency_p99_ms = histogram_percentile(&s_interval_latency, 99);
+    memset(&s_interval_latency, 0, sizeof(s_interval_latency));
+#endif
+    s_samples[s_sample_next] = sample;
+    s_sample_next = (s_sample_next + 1) % CONFIG_ENIP_SCANNER_DIAG_SAMPLES;
+    if (s_sample_count < CONFIG_ENIP_SCANNER_DIAG_SAMPLES) {
+        s_sample_count++;
+    }
+    s_samples_taken++;
+    taskEXIT_CRITICAL(&s_diag_lock);
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+    soak_watch();
+#endif
+}
+
+esp_err_t diag_init(void)
+{
+    if (s_sample_timer != NULL) {
+        return ESP_OK;
+    }
+    
+    const esp_timer_create_args_t args = {
+        .callback = diag_take_sample,
+        .name = "enip_diag",
+    };
+    esp_err_t ret = esp_timer_create(&args, &s_sample_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = esp_timer_start_periodic(s_sample_timer, (uint64_t)CONFIG_ENIP_SCANNER_DIAG_SAMPLE_INTERVAL_S * 1000000);
+    if (ret != ESP_OK) {
+        esp_timer_delete(s_sample_timer);
+        s_sample_timer = NULL;
+        return ret;
+    }
+    diag_take_sample(NULL);
+    return ESP_OK;
+}
+
+static void add_subsystem(enip_scanner_memory_report_t *report, const char *name, const diag_footprint_t *footprint)
+{
+    if (report->subsystem_count >= ENIP_SCANNER_DIAG_MAX_SUBSYSTEMS) {
+        return;
+    }
+    enip_scanner_subsystem_memory_t *entry = &report->subsystems[report->subsystem_count++];
+    entry->name = name;
+    entry->bytes = footprint->bytes;
+    entry->items = footprint->items;
+}
+
+static int compare_tasks(const void *a, const void *b)
+{
+    const enip_scanner_task_info_t *ta = a;
+    const enip_scanner_task_info_t *tb = b;
+    return (ta->stack_free_min > tb->stack_free_min) - (ta->stack_free_min < tb->stack_free_min);
+}
+
+static void collect_tasks(enip_scanner_memory_report_t *report)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    // A few spare entries for tasks created between the two calls
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *status = malloc(capacity * sizeof(TaskStatus_t));
+    if (status == NULL) {
+        ESP_LOGW(TAG, "No memory for the task snapshot");
+        return;
+    }
+    UBaseType_t count = uxTaskGetSystemState(status, capacity, NULL);
+    report->tasks_total = count;
+    for (UBaseType_t i = 0; i < count && report->task_count < CONFIG_ENIP_SCANNER_DIAG_MAX_TASKS; i++) {
+        enip_scanner_task_info_t *task = &report->tasks[report->task_count++];
+        strncpy(task->name, status[i].pcTaskName, sizeof(task->name) - 1);
+        task->name[sizeof(task->name) - 1] = '\0';
+        task->stack_free_min = status[i].usStackHighWaterMark;
+        task->priority = status[i].uxCurrentPriority;
+        task->state = status[i].eCurrentState;
+    }
+    free(status);
+    qsort(report->tasks, report->task_count, sizeof(report->tasks[0]), compare_tasks);
+#else
+    (void)report;
+    (void)compare_tasks;
+#endif // CONFIG_FREERTOS_USE_TRACE_FACILITY
+}
+
+esp_err_t enip_scanner_get_memory_report(enip_scanner_memory_report_t *report)
+{
+    if (report == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(report, 0, sizeof(*report));
+    
+    report->heap_total = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    report->heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    report->heap_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    report->heap_largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    report->fragmentation_pct = fragmentation_pct(report->heap_free, report->heap_largest_free_block);
+    
+    diag_footprint_t footprint;
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    implicit_get_footprint(&footprint);
+    add_subsystem(report, "implicit", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+    session_pool_get_footprint(&footprint);
+    add_subsystem(report, "sessions", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+    write_queue_get_footprint(&footprint);
+    add_subsystem(report, "write_queue", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+    io_get_footprint(&footprint);
+    add_subsystem(report, "io_config", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+    translator_get_footprint(&footprint);
+    add_subsystem(report, "translator", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+    profile_cache_get_footprint(&footprint);
+    add_subsystem(report, "profile_cache", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+    footprint.bytes = CONFIG_ENIP_SCANNER_CAPTURE_FRAMES * sizeof(enip_scanner_capture_frame_t);
+    footprint.items = CONFIG_ENIP_SCANNER_CAPTURE_FRAMES;
+    add_subsystem(report, "capture", &footprint);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
+    enip_scanner_buffer_pool_stats_t pool;
+    enip_scanner_get_buffer_pool_stats(&pool);
+    footprint.bytes = (uint32_t)pool.blocks * pool.block_size;
+    footprint.items = pool.in_use;
+    add_subsystem(report, "buffer_pool", &footprint);
+#endif
+    (void)footprint;
+    
+    collect_tasks(report);
+    return ESP_OK;
+}
+
+size_t enip_scanner_get_heap_trend(enip_scanner_heap_sample_t *samples, size_t max_samples)
+{
+    if (samples == NULL || max_samples == 0) {
+        return 0;
+    }
+    
+    taskENTER_CRITICAL(&s_diag_lock);
+    size_t count = s_sample_count < max_samples ? s_sample_count : max_samples;
+    // Newest count samples, oldest first
+    size_t start = (s_sample_next + CONFIG_ENIP_SCANNER_DIAG_SAMPLES - count) % CONFIG_ENIP_SCANNER_DIAG_SAMPLES;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = s_samples[(start + i) % CONFIG_ENIP_SCANNER_DIAG_SAMPLES];
+    }
+    taskEXIT_CRITICAL(&s_diag_lock);
+    return count;
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+esp_err_t enip_scanner_soak_start(const enip_scanner_soak_limits_t *limits)
+{
+    if (limits == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_sample_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    enip_scanner_heap_sample_t baseline = {0};
+    read_heap(&baseline);
+    
+    taskENTER_CRITICAL(&s_diag_lock);
+    s_soak_baseline = baseline;
+    s_soak_limits = *limits;
+    s_soak_first_sample = s_samples_taken;
+    s_soak_start_us = esp_timer_get_time();
+    memset(&s_soak_latency, 0, sizeof(s_soak_latency));
+    s_soak_reported = false;
+    s_soak_running = true;
+    taskEXIT_CRITICAL(&s_diag_lock);
+    
+    ESP_LOGI(TAG, "Soak run started: %lu B free, largest block %lu B",
+             (unsigned long)baseline.free_bytes, (unsigned long)baseline.largest_free_block);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_soak_check(enip_scanner_soak_report_t *report)
+{
+    if (report == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_soak_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    soak_evaluate(report);
+    if (report->heap_exceeded || report->block_exceeded || report->latency_exceeded) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+#else
+
+esp_err_t diag_init(void)
+{
+    return ESP_OK;
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_DIAG_INTERNAL_H
+#define ENIP_SCANNER_DIAG_INTERNAL_H
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory held by one subsystem for the memory report: its heap buffers, the
+// stacks of the tasks it runs and its static tables, plus a count of the items
+// it manages (connections, sessions, entries, ...)
+typedef struct {
+    uint32_t bytes;
+    uint16_t items;
+} diag_footprint_t;
+
+// Each is defined by its module only when the feature is enabled
+void implicit_get_footprint(diag_footprint_t *footprint);
+void session_pool_get_footprint(diag_footprint_t *footprint);
+void write_queue_get_footprint(diag_footprint_t *footprint);
+void io_get_footprint(diag_footprint_t *footprint);
+void translator_get_footprint(diag_footprint_t *footprint);
+void profile_cache_get_footprint(diag_footprint_t *footprint);
+
+// Start the periodic heap sampling (no-op unless CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS is set)
+esp_err_t diag_init(void);
+
+// Adds one explicit request to the soak monitor's latency histogram; start_us
+// is esp_timer_get_time() from before the request
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+void diag_record_request(int64_t start_us, bool ok);
+#else
+static inline void diag_record_request(int64_t start_us, bool ok)
+{
+    (void)start_us;
+    (void)ok;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_DIAG_INTERNAL_H
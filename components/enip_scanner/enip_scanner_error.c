@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner.h"
+#include <stdio.h>
+
+const char *enip_scanner_error_code_name(uint8_t code)
+{
+    switch (code) {
+        case ENIP_ERR_NONE:               return "No error";
+        case ENIP_ERR_INVALID_ARG:        return "Invalid arguments";
+        case ENIP_ERR_NOT_INITIALIZED:    return "Scanner not initialized";
+        case ENIP_ERR_MUTEX:              return "Failed to acquire mutex";
+        case ENIP_ERR_PATH_ENCODE:        return "Failed to encode request path";
+        case ENIP_ERR_REQUEST_TOO_LARGE:  return "Request too large";
+        case ENIP_ERR_SOCKET:             return "Failed to create socket";
+        case ENIP_ERR_CONNECT:            return "Failed to connect to device";
+        case ENIP_ERR_SEND:               return "Failed to send request";
+        case ENIP_ERR_RECV:               return "Failed to receive response";
+        case ENIP_ERR_TIMEOUT:            return "Timeout waiting for response";
+        case ENIP_ERR_PEER_CLOSED:        return "Connection closed by peer";
+        case ENIP_ERR_REGISTER_SESSION:   return "Failed to register session";
+        case ENIP_ERR_SHORT_RESPONSE:     return "Response too short";
+        case ENIP_ERR_UNEXPECTED_COMMAND: return "Unexpected response command";
+        case ENIP_ERR_ENCAP_STATUS:       return "Encapsulation error status";
+        case ENIP_ERR_ITEM_COUNT:         return "Unexpected item count";
+        case ENIP_ERR_ITEM_TYPE:          return "Unexpected data item type";
+        case ENIP_ERR_ITEM_LENGTH:        return "Data item too short";
+        case ENIP_ERR_CIP_STATUS:         return "CIP error status";
+        case ENIP_ERR_CIP_SHORT:          return "CIP response too short";
+        case ENIP_ERR_NO_DATA:            return "No data returned";
+        case ENIP_ERR_NO_MEMORY:          return "Failed to allocate memory";
+        case ENIP_ERR_DATA_TYPE:          return "Unsupported data type";
+        case ENIP_ERR_DATA_SIZE:          return "Invalid data size";
+        default:                          return "Unknown error";
+    }
+}
+
+const char *enip_scanner_cip_status_name(uint8_t cip_status)
+{
+    switch (cip_status) {
+        case 0x00: return "Success";
+        case 0x01: return "Connection failure";
+        case 0x02: return "Resource unavailable";
+        case 0x03: return "Invalid parameter value";
+        case 0x04: return "Path segment error";
+        case 0x05: return "Path destination unknown (Object does not exist)";
+        case 0x06: return "Partial transfer";
+        case 0x07: return "Connection lost";
+        case 0x08: return "Service not supported";
+        case 0x09: return "Invalid attribute value";
+        case 0x0A: return "Attribute list error";
+        case 0x0B: return "Already in requested mode";
+        case 0x0C: return "Object state conflict";
+        case 0x0D: return "Object already exists";
+        case 0x0E: return "Attribute not settable";
+        case 0x0F: return "Privilege violation";
+        case 0x10: return "Device state conflict";
+        case 0x11: return "Reply data too large";
+        case 0x12: return "Fragmentation of a primitive value";
+        case 0x13: return "Not enough data";
+        case 0x14: return "Attribute not supported";
+        case 0x15: return "Too much data";
+        case 0x16: return "Object does not exist";
+        case 0x17: return "Service fragmentation sequence not in progress";
+        case 0x18: return "No stored attribute data";
+        case 0x19: return "Store operation failure";
+        case 0x1A: return "Routing failure - request packet too large";
+        case 0x1B: return "Routing failure - response packet too large";
+        case 0x1C: return "Missing attribute list entry data";
+        case 0x1D: return "Invalid attribute value list";
+        case 0x1E: return "Embedded service error";
+        case 0x1F: return "Vendor specific error";
+        case 0x20: return "Invalid parameter";
+        case 0x21: return "Write-once value or medium already written";
+        case 0x22: return "Invalid reply received";
+        case 0x23: return "Buffer overflow";
+        case 0x24: return "Message format error";
+        case 0x25: return "Key failure in path";
+        case 0x26: return "Path size invalid";
+        case 0x27: return "Unexpected attribute in list";
+        case 0x28: return "Invalid member ID";
+        case 0x29: return "Member not settable";
+        case 0x2A: return "Group 2 only server general failure";
+        case 0x2B: return "Unknown Modbus error";
+        case 0x81: return "Vendor-specific: Invalid instance or attribute (Motoman)";
+        default:   return "Vendor-specific or extended error";
+    }
+}
+
+const char *enip_scanner_format_error(const enip_scanner_error_t *error, char *buffer, size_t buffer_size)
+{
+    if (buffer == NULL || buffer_size == 0) {
+        return "";
+    }
+    buffer[0] = '\0';
+    if (error == NULL || error->code == ENIP_ERR_NONE) {
+        return buffer;
+    }
+
+    const char *name = enip_scanner_error_code_name(error->code);
+    switch (error->code) {
+        case ENIP_ERR_CIP_STATUS:
+            if (error->ext_status_size > 0) {
+                snprintf(buffer, buffer_size, "%s: 0x%02X (%s), extended status 0x%04X",
+                         name, error->cip_status, enip_scanner_cip_status_name(error->cip_status),
+                         error->ext_status);
+            } else {
+                snprintf(buffer, buffer_size, "%s: 0x%02X (%s)",
+                         name, error->cip_status, enip_scanner_cip_status_name(error->cip_status));
+            }
+            break;
+        case ENIP_ERR_ENCAP_STATUS:
+            snprintf(buffer, buffer_size, "%s: 0x%08lX", name, (unsigned long)error->detail);
+            break;
+        case ENIP_ERR_UNEXPECTED_COMMAND:
+        case ENIP_ERR_ITEM_TYPE:
+        case ENIP_ERR_DATA_TYPE:
+            snprintf(buffer, buffer_size, "%s: 0x%04lX", name, (unsigned long)error->detail);
+            break;
+        case ENIP_ERR_SHORT_RESPONSE:
+        case ENIP_ERR_ITEM_LENGTH:
+        case ENIP_ERR_CIP_SHORT:
+        case ENIP_ERR_DATA_SIZE:
+            if (error->detail != 0) {
+                snprintf(buffer, buffer_size, "%s: %lu bytes", name, (unsigned long)error->detail);
+            } else {
+                snprintf(buffer, buffer_size, "%s", name);
+            }
+            break;
+        case ENIP_ERR_ITEM_COUNT:
+            snprintf(buffer, buffer_size, "%s: %lu", name, (unsigned long)error->detail);
+            break;
+        default:
+            if (error->sys_errno != 0) {
+                snprintf(buffer, buffer_size, "%s: errno %d", name, error->sys_errno);
+            } else {
+                snprintf(buffer, buffer_size, "%s", name);
+            }
+            break;
+    }
+    return buffer;
+}
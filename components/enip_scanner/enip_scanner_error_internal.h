@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_ERROR_INTERNAL_H
+#define ENIP_SCANNER_ERROR_INTERNAL_H
+
+#include "enip_scanner.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Error setters shared by all scanner modules. Each one is a handful of
+// stores into an enip_scanner_error_t; no text is produced here, callers that
+// want a message use enip_scanner_format_error() on demand.
+// All setters accept a NULL error pointer.
+
+static inline void enip_error_clear(enip_scanner_error_t *error)
+{
+    if (error != NULL) {
+        *error = (enip_scanner_error_t){0};
+    }
+}
+
+static inline void enip_error_set_detail(enip_scanner_error_t *error, enip_scanner_error_code_t code, uint32_t detail)
+{
+    if (error != NULL) {
+        *error = (enip_scanner_error_t){0};
+        error->layer = (uint8_t)(code >> 4);
+        error->code = (uint8_t)code;
+        error->detail = detail;
+    }
+}
+
+static inline void enip_error_set(enip_scanner_error_t *error, enip_scanner_error_code_t code)
+{
+    enip_error_set_detail(error, code, 0);
+}
+
+static inline void enip_error_set_errno(enip_scanner_error_t *error, enip_scanner_error_code_t code, int err)
+{
+    enip_error_set_detail(error, code, 0);
+    if (error != NULL) {
+        error->sys_errno = (int16_t)err;
+    }
+}
+
+static inline void enip_error_set_cip(enip_scanner_error_t *error, uint8_t cip_status,
+                                      uint8_t ext_status_size, uint16_t ext_status)
+{
+    enip_error_set_detail(error, ENIP_ERR_CIP_STATUS, 0);
+    if (error != NULL) {
+        error->cip_status = cip_status;
+        error->ext_status_size = ext_status_size;
+        error->ext_status = ext_status;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_ERROR_INTERNAL_H
@@ -22,6 +22,14 @@
 
 #include "enip_scanner_implicit_internal.h"
 #include "enip_scanner.h"
+#include "enip_scanner_profile_internal.h"
+#include "enip_scanner_capture_internal.h"
+#include "enip_scanner_log_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner_qos_internal.h"
+#include "enip_scanner_link_internal.h"
+#include "enip_scanner_clock_internal.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_random.h"
@@ -31,6 +39,9 @@
 #include "freertos/FreeRTOSConfig.h"
 #include "lwip/sockets.h"
 #include "lwip/inet.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "esp_netif.h"
 #include "lwip/ip4_addr.h"
 #include "esp_netif_ip_addr.h"
 #include <string.h>
@@ -42,62 +53,128 @@
 
 static const char *TAG = "enip_scanner_implicit";
 
-// Connection ID generation
-static uint32_t connection_id_base = 0;
-static uint16_t connection_counter = 0;
-static SemaphoreHandle_t s_connection_id_mutex = NULL;
+#define IMPLICIT_TASK_STACK_SIZE 4096
+
+#define MAX_IMPLICIT_CONNECTIONS 8
+static enip_implicit_connection_t s_connections[MAX_IMPLICIT_CONNECTIONS];
+static bool s_connections_initialized = false;
 
 // Connection array protection
 static SemaphoreHandle_t s_connections_mutex = NULL;
 
+// Connections dropped by implicit_suspend_all(), reopened by implicit_resume_all();
+// guarded by s_connections_mutex
+typedef struct {
+    bool pending;
+    uint32_t generation;  // Resume tasks of an older link-up give up when this changes
+    ip4_addr_t ip_address;
+    uint16_t assembly_instance_consumed;
+    uint16_t assembly_instance_produced;
+    uint16_t assembly_data_size_consumed;
+    uint16_t assembly_data_size_produced;
+    uint32_t rpi_ms;
+    bool exclusive_owner;
+    bool tag_connection;
+    char tag_name[ENIP_SCANNER_PRODUCED_TAG_NAME_MAX + 1];
+    enip_scanner_route_t route;
+    enip_implicit_data_callback_t callback;
+    void *user_data;
+    uint8_t *o_to_t_data;  // O-to-T image when the link went down, written back after the reopen
+    uint16_t o_to_t_data_length;
+} suspended_connection_t;
+
+static suspended_connection_t s_suspended[MAX_IMPLICIT_CONNECTIONS];
+static uint32_t s_link_generation = 0;
+
+#define RESUME_OPEN_TIMEOUT_MS 5000
+#define RESUME_RETRY_MS 1000
+
+// Same grace enip_scanner_implicit_close() gives the tasks to see valid = false;
+// a slot dropped by implicit_suspend_all() is neither released nor reused sooner
+#define SUSPEND_GRACE_MS 300
+static TickType_t s_suspended_at = 0;  // Guarded by s_connections_mutex
+
+// Sends the O-to-T frames of all connections; created with the first connection
+static TaskHandle_t s_o_to_t_task_handle = NULL;
+
+// Held by the scheduler from staging a batch until its last sendto(), and by
+// whoever closes the UDP socket of a connection that was open, so a staged
+// descriptor is never closed, or reused by another socket, before the send.
+// Taken before s_connections_mutex, never while holding it.
+static SemaphoreHandle_t s_o_to_t_send_mutex = NULL;
+
+// Frame callback and its user data are swapped together while the receive task runs
+static portMUX_TYPE s_frame_callback_lock = portMUX_INITIALIZER_UNLOCKED;
+
 // Forward declarations
-static void heartbeat_task(void *pvParameters);
 static void receive_task(void *pvParameters);
 static void watchdog_task(void *pvParameters);
-static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *conn, uint32_t timeout_ms, bool include_overhead, bool retry_attempted, bool use_fixed_length);
+static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *conn, enip_deadline_t deadline, bool include_overhead, bool retry_attempted, bool use_fixed_length);
 
+// Lock-free: the first caller's random base wins, the counter is a fetch-add
 static uint32_t generate_connection_id(void)
 {
-    // Create mutex on first call if needed
-    if (s_connection_id_mutex == NULL) {
-        s_connection_id_mutex = xSemaphoreCreateMutex();
-        if (s_connection_id_mutex == NULL) {
-            ESP_LOGE(TAG, "Failed to create connection ID mutex");
-            return 0;
+    uint_fast32_t base = atomic_load(&s_scanner_ctx.connection_id_base);
+    if (base == 0) {
+        uint_fast32_t seeded = (uint32_t)(uint16_t)esp_random() << 16;
+        if (seeded == 0) {
+            seeded = 0x087e0000;
         }
-    }
-    
-    if (xSemaphoreTake(s_connection_id_mutex, portMAX_DELAY) != pdTRUE) {
-        return 0;
-    }
-    
-    if (connection_id_base == 0) {
-        uint16_t random_upper = (uint16_t)esp_random();
-        connection_id_base = ((uint32_t)random_upper << 16);
-        connection_counter = 2;
-        if (connection_id_base == 0) {
-            connection_id_base = 0x087e0000;
+        if (atomic_compare_exchange_strong(&s_scanner_ctx.connection_id_base, &base, seeded)) {
+            base = seeded;
         }
     }
     
-    connection_counter += 2;
-    uint32_t o_to_t_connection_id = connection_id_base | (connection_counter & 0xFFFF);
+    uint16_t counter = (uint16_t)(atomic_fetch_add(&s_scanner_ctx.connection_counter, 2) + 2);
+    uint32_t o_to_t_connection_id = (uint32_t)base | counter;
     if (o_to_t_connection_id == 0) {
         o_to_t_connection_id = 0x087e0002;
     }
-    
-    xSemaphoreGive(s_connection_id_mutex);
     return o_to_t_connection_id;
 }
 
 #define read_assembly_data_size enip_scanner_read_assembly_data_size
 
-static esp_err_t forward_open(enip_implicit_connection_t *conn, uint32_t timeout_ms)
+// Route (32) + symbolic segment header (2) + tag name (40) + pad (1)
+#define CONNECTION_PATH_MAX (ENIP_SCANNER_ROUTE_MAX_SIZE + 2 + ENIP_SCANNER_PRODUCED_TAG_NAME_MAX + 1)
+
+// Connection path of Forward Open and Forward Close: the assembly connection
+// points, or the route to the controller followed by the produced tag's
+// symbolic segment. Returns the length in bytes, which is always even.
+static size_t put_connection_path(const enip_implicit_connection_t *conn, uint8_t *path)
+{
+    size_t length = 0;
+    
+    if (conn->tag_connection) {
+        size_t name_length = strlen(conn->tag_name);
+        memcpy(path, conn->route.path, conn->route.size);
+        length = conn->route.size;
+        path[length++] = CIP_PATH_SYMBOLIC;
+        path[length++] = (uint8_t)name_length;
+        memcpy(path + length, conn->tag_name, name_length);
+        length += name_length;
+        if (length % 2 != 0) {
+            path[length++] = 0x00;
+        }
+        return length;
+    }
+    
+    path[length++] = CIP_PATH_CLASS;
+    path[length++] = CIP_CLASS_ASSEMBLY;
+    path[length++] = CIP_PATH_CONNECTION_POINT;
+    path[length++] = (uint8_t)conn->assembly_instance_consumed;
+    path[length++] = CIP_PATH_CONNECTION_POINT;
+    path[length++] = (uint8_t)conn->assembly_instance_produced;
+    return length;
+}
+
+static esp_err_t forward_open(enip_implicit_connection_t *conn, enip_deadline_t deadline)
 {
-    return forward_open_with_size_calculation(conn, timeout_ms, true, false, false);
+    return forward_open_with_size_calculation(conn, deadline, true, false, false);
 }
 
-static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *conn, uint32_t timeout_ms, bool include_overhead, bool retry_attempted, bool use_fixed_length)
+// Retries with other size calculations share the caller's deadline
+static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *conn, enip_deadline_t deadline, bool include_overhead, bool retry_attempted, bool use_fixed_length)
 {
     if (conn == NULL || conn->tcp_socket < 0) {
         return ESP_ERR_INVALID_ARG;
@@ -115,10 +192,12 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     conn->originator_serial_number = esp_random();
     conn->priority_time_tick = 0x2A;
     conn->timeout_ticks = 0x04;
+    conn->priority = qos_implicit_priority();
     
     uint16_t o_to_t_size, t_to_o_size;
     if (include_overhead) {
-        o_to_t_size = conn->assembly_data_size_consumed + 2 + 4;
+        // A tag consumer's O->T frames carry only the CIP sequence count, no Run/Idle header
+        o_to_t_size = conn->tag_connection ? 2 : conn->assembly_data_size_consumed + 2 + 4;
         t_to_o_size = conn->assembly_data_size_produced + 2;
     } else {
         o_to_t_size = conn->assembly_data_size_consumed;
@@ -133,8 +212,8 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
         t_to_o_params = 0x0200;
     }
     
-    o_to_t_params |= (2 << 9);
-    t_to_o_params |= (2 << 9);
+    o_to_t_params |= (uint16_t)(conn->priority << 10);
+    t_to_o_params |= (uint16_t)(conn->priority << 10);
     
     o_to_t_params |= 0x4000;
     if (conn->exclusive_owner) {
@@ -149,7 +228,7 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     t_to_o_params += t_to_o_size;
     
     uint32_t rpi_us = conn->rpi_ms * 1000;
-    uint8_t packet[128];
+    uint8_t packet[96 + CONNECTION_PATH_MAX];
     size_t offset = 0;
     uint16_t cmd = ENIP_SEND_RR_DATA;
     memcpy(packet + offset, &cmd, 2);
@@ -239,14 +318,9 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     memcpy(packet + offset, &t_to_o_params, 2);
     offset += 2;
     packet[offset++] = 0x01;
-    packet[offset++] = 3;
-    
-    packet[offset++] = CIP_PATH_CLASS;
-    packet[offset++] = CIP_CLASS_ASSEMBLY;
-    packet[offset++] = CIP_PATH_CONNECTION_POINT;
-    packet[offset++] = (uint8_t)conn->assembly_instance_consumed;
-    packet[offset++] = CIP_PATH_CONNECTION_POINT;
-    packet[offset++] = (uint8_t)conn->assembly_instance_produced;
+    size_t conn_path_length = put_connection_path(conn, packet + offset + 1);
+    packet[offset++] = (uint8_t)(conn_path_length / 2);
+    offset += conn_path_length;
     
     size_t cip_length = offset - cip_start;
     uint16_t data_item_length = (uint16_t)cip_length;
@@ -254,7 +328,7 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     uint16_t enip_data_length = (uint16_t)(offset - 24);
     memcpy(packet + length_offset, &enip_data_length, 2);
     
-    esp_err_t ret = send_data(conn->tcp_socket, packet, offset);
+    esp_err_t ret = send_data(conn->tcp_socket, packet, offset, deadline);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to send Forward Open request");
         return ret;
@@ -262,7 +336,7 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     
     uint8_t response[512];
     size_t bytes_received = 0;
-    ret = recv_data(conn->tcp_socket, response, 28, timeout_ms, &bytes_received);
+    ret = recv_data(conn->tcp_socket, response, 28, deadline, &bytes_received);
     if (ret != ESP_OK || bytes_received < 24) {
         ESP_LOGE(TAG, "Failed to receive Forward Open ENIP header: got %zu bytes", bytes_received);
         return ESP_FAIL;
@@ -304,7 +378,7 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
         }
         if (remaining > 0) {
             size_t additional_received = 0;
-            ret = recv_data(conn->tcp_socket, response + bytes_received + response_offset, remaining, timeout_ms, &additional_received);
+            ret = recv_data(conn->tcp_socket, response + bytes_received + response_offset, remaining, deadline, &additional_received);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to receive Forward Open response data: got %zu bytes", additional_received);
                 return ESP_FAIL;
@@ -411,11 +485,11 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
             } else if (extended_status == 0x0315) {
                 ESP_LOGE(TAG, "Invalid Connection Parameters (0x0315)");
                 if (include_overhead && !retry_attempted) {
-                    esp_err_t retry_result = forward_open_with_size_calculation(conn, timeout_ms, false, true, false);
+                    esp_err_t retry_result = forward_open_with_size_calculation(conn, deadline, false, true, false);
                     if (retry_result == ESP_OK) {
                         return ESP_OK;
                     }
-                    retry_result = forward_open_with_size_calculation(conn, timeout_ms, false, true, true);
+                    retry_result = forward_open_with_size_calculation(conn, deadline, false, true, true);
                     if (retry_result == ESP_OK) {
                         return ESP_OK;
                     }
@@ -447,13 +521,13 @@ static esp_err_t forward_open_with_size_calculation(enip_implicit_connection_t *
     return ESP_OK;
 }
 
-static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeout_ms)
+static esp_err_t forward_close(enip_implicit_connection_t *conn, enip_deadline_t deadline)
 {
     if (conn == NULL || conn->tcp_socket < 0) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    uint8_t packet[128];
+    uint8_t packet[64 + CONNECTION_PATH_MAX];
     size_t offset = 0;
     uint16_t cmd = ENIP_SEND_RR_DATA;
     memcpy(packet + offset, &cmd, 2);
@@ -527,16 +601,10 @@ static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeou
     memcpy(packet + offset, &conn->originator_serial_number, 4);
     offset += 4;
     
-    uint8_t conn_path_size = 3;
-    packet[offset++] = conn_path_size;
+    size_t conn_path_length = put_connection_path(conn, packet + offset + 2);
+    packet[offset++] = (uint8_t)(conn_path_length / 2);
     packet[offset++] = 0x00;
-    
-    packet[offset++] = CIP_PATH_CLASS;
-    packet[offset++] = CIP_CLASS_ASSEMBLY;
-    packet[offset++] = CIP_PATH_CONNECTION_POINT;
-    packet[offset++] = (uint8_t)conn->assembly_instance_consumed;
-    packet[offset++] = CIP_PATH_CONNECTION_POINT;
-    packet[offset++] = (uint8_t)conn->assembly_instance_produced;
+    offset += conn_path_length;
     
     size_t cip_length = offset - cip_start;
     uint16_t data_item_length = (uint16_t)cip_length;
@@ -545,7 +613,7 @@ static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeou
     uint16_t enip_data_length = (uint16_t)(offset - 24);
     memcpy(packet + length_offset, &enip_data_length, 2);
     
-    esp_err_t ret = send_data(conn->tcp_socket, packet, offset);
+    esp_err_t ret = send_data(conn->tcp_socket, packet, offset, deadline);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to send Forward Close request");
         return ret;
@@ -562,8 +630,8 @@ static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeou
     FD_ZERO(&error_fds);
     FD_SET(conn->tcp_socket, &read_fds);
     FD_SET(conn->tcp_socket, &error_fds);
-    // Add extra time for device processing (minimum 2 seconds)
-    uint32_t select_timeout_ms = timeout_ms > 2000 ? timeout_ms : 2000;
+    // Wait for the device's reply with whatever is left of the deadline
+    uint32_t select_timeout_ms = enip_deadline_remaining_ms(deadline);
     tv.tv_sec = select_timeout_ms / 1000;
     tv.tv_usec = (select_timeout_ms % 1000) * 1000;
     
@@ -586,17 +654,17 @@ static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeou
         ESP_LOGW(TAG, "Forward Close: Socket not readable (select returned %d, errno=%d)", select_result, errno);
         
         // Try to read anyway - sometimes data is available even if select says it's not
-        ret = recv_data(conn->tcp_socket, response, 24, 100, &bytes_received);
+        ret = recv_data(conn->tcp_socket, response, 24, enip_deadline_from_timeout(100), &bytes_received);
         if (ret != ESP_OK || bytes_received == 0) {
             ESP_LOGW(TAG, "Forward Close: No data available");
             return ESP_ERR_TIMEOUT;
         }
     } else {
-        ret = recv_data(conn->tcp_socket, response, 24, timeout_ms, &bytes_received);
+        ret = recv_data(conn->tcp_socket, response, 24, deadline, &bytes_received);
     }
     
     if (bytes_received == 0 && ret != ESP_OK) {
-        ret = recv_data(conn->tcp_socket, response, 24, timeout_ms, &bytes_received);
+        ret = recv_data(conn->tcp_socket, response, 24, deadline, &bytes_received);
     }
     
     // Check if socket was closed by peer (some devices close connection as acknowledgment)
@@ -629,7 +697,7 @@ static esp_err_t forward_close(enip_implicit_connection_t *conn, uint32_t timeou
             if (response_length > 0 && response_length <= sizeof(response) - 24) {
                 size_t remaining = response_length;
                 size_t additional_received = 0;
-                recv_data(conn->tcp_socket, response + 24, remaining, timeout_ms, &additional_received);
+                recv_data(conn->tcp_socket, response + 24, remaining, deadline, &additional_received);
                 bytes_received += additional_received;
                 
                 ESP_LOG_BUFFER_HEXDUMP(TAG, response, bytes_received, ESP_LOG_DEBUG);
@@ -784,181 +852,389 @@ static int create_udp_socket(void)
 }
 
 
-static void heartbeat_task(void *pvParameters)
+// O-to-T frame: Item Count (2) + Sequenced Address Item (12) + Data Item Header (4) +
+//               CIP Seq (2) + Run/Idle (4) + Assembly Data
+// A produced tag consumer sends heartbeats that end after the CIP sequence count.
+#define O_TO_T_EIP_SEQ_OFFSET 10
+#define O_TO_T_CIP_SEQ_OFFSET 18
+#define O_TO_T_RUN_IDLE_OFFSET 20
+#define O_TO_T_HEADER_SIZE 24
+
+// Everything but the sequence counters and the assembly data is fixed for the
+// life of the connection, so the frame is built once and patched in place
+static void build_o_to_t_template(enip_implicit_connection_t *conn)
 {
-    enip_implicit_connection_t *conn = (enip_implicit_connection_t *)pvParameters;
-    if (conn == NULL) {
-        vTaskDelete(NULL);
-        return;
-    }
-    
-    uint32_t eip_sequence = 0;
-    uint16_t cip_sequence = 0;
+    uint8_t *frame = conn->o_to_t_frame;
+    uint16_t item_count = 2;
+    uint16_t addr_item_type = CPF_ITEM_SEQUENCED_ADDRESS;
+    uint16_t addr_item_length = 8;
+    uint16_t data_item_type = CPF_ITEM_CONNECTED_DATA;
+    uint16_t data_item_length = 2 + 4 + conn->assembly_data_size_consumed;  // CIP seq + Run/Idle + assembly data
+    uint32_t run_idle = 0x00000001;  // Run state
+    if (conn->tag_connection) {
+        data_item_length = 2;
+    }
+    
+    memcpy(frame + 0, &item_count, 2);
+    memcpy(frame + 2, &addr_item_type, 2);
+    memcpy(frame + 4, &addr_item_length, 2);
+    memcpy(frame + 6, &conn->o_to_t_connection_id, 4);
+    memset(frame + O_TO_T_EIP_SEQ_OFFSET, 0, 4);
+    memcpy(frame + 14, &data_item_type, 2);
+    memcpy(frame + 16, &data_item_length, 2);
+    memset(frame + O_TO_T_CIP_SEQ_OFFSET, 0, 2);
+    memcpy(frame + O_TO_T_RUN_IDLE_OFFSET, &run_idle, 4);
+    memset(frame + O_TO_T_HEADER_SIZE, 0, conn->assembly_data_size_consumed);
+    
+    memset(&conn->o_to_t_addr, 0, sizeof(conn->o_to_t_addr));
+    conn->o_to_t_addr.sin_family = AF_INET;
+    conn->o_to_t_addr.sin_addr.s_addr = conn->ip_address.addr;
+    conn->o_to_t_addr.sin_port = htons(ENIP_IMPLICIT_PORT);
+    
+    conn->o_to_t_frame_size = conn->tag_connection ? O_TO_T_RUN_IDLE_OFFSET :
+                              O_TO_T_HEADER_SIZE + conn->assembly_data_size_consumed;
+    conn->eip_sequence = 0;
+    conn->cip_sequence = 0;
+}
+
+// Stamps the next sequence numbers and the current O-to-T data into the
+// connection's template and copies the frame to out. Called with
+// s_connections_mutex held; the frame is sent after the mutex is released.
+static void stage_o_to_t_frame(enip_implicit_connection_t *conn, uint8_t *out)
+{
+    typedef struct {
+        enip_implicit_data_callback_t callback;
+        void *user_data;
+        uint8_t *o_to_t_data;  // Dynamic size
+        uint16_t o_to_t_data_length;
+        SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
+    } callback_wrapper_t;
     
-    // Wait 50ms after Forward Open before sending first heartbeat
-    vTaskDelay(pdMS_TO_TICKS(50));
+    uint8_t *frame = conn->o_to_t_frame;
+    uint16_t assembly_data_size = conn->assembly_data_size_consumed;
+    callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
     
-    // Calculate packet size: Item Count (2) + Address Item (12) + Data Item Header (4) + 
-    //                        CIP Seq (2) + Run/Idle (4) + Assembly Data
-    size_t packet_size = 2 + 12 + 4 + 2 + 4 + conn->assembly_data_size_consumed;
-    uint8_t *packet = malloc(packet_size);
-    if (packet == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate packet buffer");
-        vTaskDelete(NULL);
-        return;
+    memcpy(frame + O_TO_T_EIP_SEQ_OFFSET, &conn->eip_sequence, 4);
+    memcpy(frame + O_TO_T_CIP_SEQ_OFFSET, &conn->cip_sequence, 2);
+    conn->eip_sequence++;
+    conn->cip_sequence++;
+    
+    // The wrapper buffer is always assembly_data_size_consumed bytes, zero-padded
+    // if the user wrote less. A writer holding the mutex only delays this frame's
+    // update: the payload of the previous frame is still in the template.
+    if (conn->tag_connection) {
+        // Heartbeat only
+    } else if (wrapper != NULL && wrapper->data_mutex != NULL) {
+        if (xSemaphoreTake(wrapper->data_mutex, 0) == pdTRUE) {
+            if (wrapper->o_to_t_data && wrapper->o_to_t_data_length > 0) {
+                memcpy(frame + O_TO_T_HEADER_SIZE, wrapper->o_to_t_data, assembly_data_size);
+            } else if (wrapper->o_to_t_data == NULL) {
+                ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Heartbeat: No O-to-T data buffer allocated, sending zeros");
+            } else {
+                ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Heartbeat: O-to-T data length is 0, sending zeros");
+            }
+            xSemaphoreGive(wrapper->data_mutex);
+        }
+    } else {
+        ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Heartbeat: No wrapper found, sending zeros");
     }
     
-    while (conn->state == ENIP_CONN_STATE_OPEN && conn->valid) {
-        size_t offset = 0;
-        
-        // Item Count
-        uint16_t item_count = 2;
-        memcpy(packet + offset, &item_count, 2);
-        offset += 2;
-        
-        // Sequenced Address Item (0x8002, 8 bytes)
-        uint16_t addr_item_type = CPF_ITEM_SEQUENCED_ADDRESS;
-        uint16_t addr_item_length = 8;
-        memcpy(packet + offset, &addr_item_type, 2);
-        offset += 2;
-        memcpy(packet + offset, &addr_item_length, 2);
-        offset += 2;
-        memcpy(packet + offset, &conn->o_to_t_connection_id, 4);
-        offset += 4;
-        memcpy(packet + offset, &eip_sequence, 4);
-        offset += 4;
-        eip_sequence++;
-        
-        // Connected Data Item - size = CIP seq (2) + Run/Idle (4) + Assembly data
-        uint16_t data_item_length = 2 + 4 + conn->assembly_data_size_consumed;  // CIP seq + Run/Idle + assembly data
-        uint16_t data_item_type = CPF_ITEM_CONNECTED_DATA;
-        memcpy(packet + offset, &data_item_type, 2);
-        offset += 2;
-        memcpy(packet + offset, &data_item_length, 2);
-        offset += 2;
-        memcpy(packet + offset, &cip_sequence, 2);
-        offset += 2;
-        cip_sequence++;
-        
-        // Run/Idle Header (4 bytes) - 0x00000001 = Run state
-        uint32_t run_idle = 0x00000001;
-        memcpy(packet + offset, &run_idle, 4);
-        offset += 4;
-        
-        // Assembly data (O-to-T, consumed) - use actual size
-        uint16_t assembly_data_size = conn->assembly_data_size_consumed;
-        typedef struct {
-            enip_implicit_data_callback_t callback;
-            void *user_data;
-            uint8_t *o_to_t_data;  // Dynamic size
-            uint16_t o_to_t_data_length;
-            SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
-        } callback_wrapper_t;
-        
-        // Safely access user_data (may be NULL during shutdown)
-        // Check valid flag first (atomic read)
-        bool conn_valid = conn->valid;
-        callback_wrapper_t *wrapper = NULL;
-        if (conn->user_data != NULL && conn_valid) {
-            wrapper = (callback_wrapper_t *)conn->user_data;
+    memcpy(out, frame, conn->o_to_t_frame_size);
+    
+    // Explicit write to assembly instance (DISABLED - can be re-enabled by changing #if 0 to #if 1)
+    // Some devices require the assembly instance to be updated explicitly, not just via implicit messaging packets
+    // Note: WAGO devices typically reject explicit writes with privilege violation (0x0F) when using implicit messaging
+    // Set to #if 1 to re-enable this feature
+#if 0
+    if (wrapper && wrapper->o_to_t_data && wrapper->o_to_t_data_length > 0) {
+        enip_scanner_error_t write_error = {0};
+        esp_err_t write_ret = enip_scanner_write_assembly(&conn->ip_address,
+                                                          conn->assembly_instance_consumed,
+                                                          wrapper->o_to_t_data,
+                                                          conn->assembly_data_size_consumed,
+                                                          conn->rpi_ms + 100,  // Timeout slightly longer than RPI
+                                                          &write_error);
+        if (write_ret != ESP_OK) {
+            char error_msg[128];
+            ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Explicit write to assembly %u failed: %s (error: %s)",
+                         conn->assembly_instance_consumed,
+                         enip_scanner_format_error(&write_error, error_msg, sizeof(error_msg)),
+                         esp_err_to_name(write_ret));
         }
+    }
+#endif
+}
+
+// A frame staged under s_connections_mutex and sent once it is released.
+// sendto() needs the lwIP core lock, and with CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+// the lwIP thread holds that lock while it runs the receive callbacks. The
+// socket stays open until the send because s_o_to_t_send_mutex is held.
+typedef struct {
+    int slot;
+    int sock;
+    struct sockaddr_in addr;
+    ip4_addr_t ip_address;
+    size_t offset;                      // Into s_o_to_t_staging
+    uint16_t frame_size;
+    uint16_t data_size;
+} o_to_t_pending_t;
+
+// Only the scheduler task touches these
+static uint8_t *s_o_to_t_staging = NULL;
+static size_t s_o_to_t_staging_size = 0;
+
+// One task sends the O-to-T frames of every open connection. Each pass stages
+// all frames that are due, sends them back to back without holding
+// s_connections_mutex (but with s_o_to_t_send_mutex), then sleeps until the earliest next due time;
+// enip_scanner_implicit_open() wakes it for a new connection.
+static void o_to_t_scheduler_task(void *pvParameters)
+{
+    (void)pvParameters;
+    o_to_t_pending_t pending[MAX_IMPLICIT_CONNECTIONS];
+    
+    while (true) {
+        int64_t next_due_us = enip_clock_now_us() + 1000000;
+        int pending_count = 0;
         
-        // Access O-to-T data with mutex protection
-        if (wrapper && wrapper->data_mutex != NULL) {
-            if (xSemaphoreTake(wrapper->data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                if (wrapper->o_to_t_data && wrapper->o_to_t_data_length > 0) {
-                    // The wrapper buffer is always allocated to exactly assembly_data_size_consumed bytes
-                    // and is zero-padded if the user wrote less data
-                    // Always copy the full assembly_data_size bytes from the buffer
-                    memcpy(packet + offset, wrapper->o_to_t_data, assembly_data_size);
-                } else {
-                    // Default: zeros
-                    memset(packet + offset, 0, assembly_data_size);
-                    // Log if we expected data but didn't find it (only occasionally)
-                    static uint32_t no_data_count = 0;
-                    if ((no_data_count++ % 100) == 0) {
-                        if (wrapper->o_to_t_data == NULL) {
-                            ESP_LOGW(TAG, "Heartbeat: No O-to-T data buffer allocated, sending zeros");
-                        } else if (wrapper->o_to_t_data_length == 0) {
-                            ESP_LOGW(TAG, "Heartbeat: O-to-T data length is 0, sending zeros");
+        xSemaphoreTake(s_o_to_t_send_mutex, portMAX_DELAY);
+        if (xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            int64_t now_us = enip_clock_now_us();
+            size_t staged = 0;
+            for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+                enip_implicit_connection_t *conn = &s_connections[i];
+                if (!conn->valid || conn->state != ENIP_CONN_STATE_OPEN || conn->o_to_t_frame == NULL) {
+                    continue;
+                }
+                
+                if (now_us >= conn->o_to_t_next_us) {
+                    if (staged + conn->o_to_t_frame_size > s_o_to_t_staging_size) {
+                        // Grows to the largest set of due frames seen, then stays
+                        uint8_t *grown = enip_mem_realloc(ENIP_MEM_HOT, s_o_to_t_staging,
+                                                          staged + conn->o_to_t_frame_size);
+                        if (grown != NULL) {
+                            s_o_to_t_staging = grown;
+                            s_o_to_t_staging_size = staged + conn->o_to_t_frame_size;
                         }
                     }
+                    if (staged + conn->o_to_t_frame_size <= s_o_to_t_staging_size) {
+                        o_to_t_pending_t *entry = &pending[pending_count++];
+                        entry->slot = i;
+                        entry->sock = conn->udp_socket;
+                        entry->addr = conn->o_to_t_addr;
+                        entry->ip_address = conn->ip_address;
+                        entry->offset = staged;
+                        entry->frame_size = conn->o_to_t_frame_size;
+                        entry->data_size = conn->tag_connection ? 0 : conn->assembly_data_size_consumed;
+                        stage_o_to_t_frame(conn, s_o_to_t_staging + staged);
+                        staged += conn->o_to_t_frame_size;
+                    } else {
+                        ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "No memory to stage the O-to-T frame for " IPSTR,
+                                     IP2STR(&conn->ip_address));
+                    }
+                    
+                    // Send at least every 1000ms even if the RPI is larger
+                    uint32_t period_ms = conn->rpi_ms > 1000 ? 1000 : conn->rpi_ms;
+                    conn->o_to_t_next_us += (int64_t)period_ms * 1000;
+                    if (conn->o_to_t_next_us <= now_us) {
+                        // Fell more than a period behind: restart the schedule rather than bursting
+                        conn->o_to_t_next_us = now_us + (int64_t)period_ms * 1000;
+                    }
                 }
-                xSemaphoreGive(wrapper->data_mutex);
-            } else {
-                // Mutex timeout - use zeros
-                memset(packet + offset, 0, assembly_data_size);
-            }
-        } else {
-            // Default: zeros
-            memset(packet + offset, 0, assembly_data_size);
-            static uint32_t no_wrapper_count = 0;
-            if ((no_wrapper_count++ % 100) == 0) {
-                if (wrapper == NULL) {
-                    ESP_LOGW(TAG, "Heartbeat: No wrapper found, sending zeros");
+                if (conn->o_to_t_next_us < next_due_us) {
+                    next_due_us = conn->o_to_t_next_us;
                 }
             }
+            xSemaphoreGive(s_connections_mutex);
         }
-        offset += assembly_data_size;
-        
-        // Send packet (packet_size bytes total)
-        struct sockaddr_in target_addr;
-        memset(&target_addr, 0, sizeof(target_addr));
-        target_addr.sin_family = AF_INET;
-        target_addr.sin_addr.s_addr = conn->ip_address.addr;
-        target_addr.sin_port = htons(ENIP_IMPLICIT_PORT);
         
-        ssize_t sent = sendto(conn->udp_socket, packet, packet_size, 0,
-                             (struct sockaddr *)&target_addr, sizeof(target_addr));
-        if (sent >= 0) {
-            // Update last heartbeat time when we successfully send O->T
-            conn->last_heartbeat_time = xTaskGetTickCount();
-        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            // Log errors at reduced frequency
-            static uint32_t error_count = 0;
-            if ((error_count++ % 100) == 0) {
-                ESP_LOGW(TAG, "Heartbeat send error: %d", errno);
+        uint32_t sent_mask = 0;
+        for (int i = 0; i < pending_count; i++) {
+            const o_to_t_pending_t *entry = &pending[i];
+            const uint8_t *frame = s_o_to_t_staging + entry->offset;
+            ssize_t sent = sendto(entry->sock, frame, entry->frame_size, 0,
+                                  (const struct sockaddr *)&entry->addr, sizeof(entry->addr));
+            if (sent >= 0) {
+                sent_mask |= 1u << entry->slot;
+                capture_record_frame(&entry->ip_address, CAPTURE_DIR_O_TO_T, frame, entry->frame_size,
+                                     entry->frame_size - entry->data_size, entry->data_size);
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Heartbeat send error: %d", errno);
             }
         }
+        xSemaphoreGive(s_o_to_t_send_mutex);
         
-        // Explicit write to assembly instance (DISABLED - can be re-enabled by changing #if 0 to #if 1)
-        // Some devices require the assembly instance to be updated explicitly, not just via implicit messaging packets
-        // Note: WAGO devices typically reject explicit writes with privilege violation (0x0F) when using implicit messaging
-        // Set to #if 1 to re-enable this feature
-#if 0
-        if (wrapper && wrapper->o_to_t_data && wrapper->o_to_t_data_length > 0) {
-            char error_msg[128] = {0};
-            esp_err_t write_ret = enip_scanner_write_assembly(&conn->ip_address,
-                                                              conn->assembly_instance_consumed,
-                                                              wrapper->o_to_t_data,
-                                                              conn->assembly_data_size_consumed,
-                                                              conn->rpi_ms + 100,  // Timeout slightly longer than RPI
-                                                              error_msg);
-            if (write_ret != ESP_OK) {
-                // Log errors at reduced frequency to avoid spam
-                static uint32_t write_error_count = 0;
-                if ((write_error_count++ % 50) == 0) {
-                    ESP_LOGW(TAG, "Explicit write to assembly %u failed: %s (error: %s)", 
-                             conn->assembly_instance_consumed, error_msg, esp_err_to_name(write_ret));
+        // The watchdog only trusts heartbeats that actually left
+        if (sent_mask != 0 && xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            TickType_t now = enip_clock_ticks();
+            for (int i = 0; i < pending_count; i++) {
+                enip_implicit_connection_t *conn = &s_connections[pending[i].slot];
+                if ((sent_mask & (1u << pending[i].slot)) && conn->valid && conn->udp_socket == pending[i].sock) {
+                    conn->last_heartbeat_time = now;
                 }
             }
+            xSemaphoreGive(s_connections_mutex);
         }
-#endif
         
-        // Delay by RPI, but cap at 1000ms maximum
-        // This ensures we send O->T packets at least every 1000ms even if RPI is larger
-        uint32_t delay_ms = conn->rpi_ms;
-        if (delay_ms > 1000) {
-            delay_ms = 1000;
+        ulTaskNotifyTake(pdTRUE, enip_clock_wait_ticks(next_due_us - enip_clock_now_us()));
+    }
+}
+
+// Parses one T-to-O frame and hands its assembly data to the callbacks. The
+// frame is only valid for the duration of the call: it points into the receive
+// task's buffer, or into the pbuf in raw receive mode.
+static void dispatch_t_to_o(enip_implicit_connection_t *conn, const uint8_t *recv_buffer,
+                            size_t received, int64_t rx_time_us)
+{
+    // Minimum packet size check
+    if (received < 2) {
+        return;
+    }
+    
+    // Parse Item Count
+    uint16_t item_count;
+    memcpy(&item_count, recv_buffer, 2);
+    
+    if (item_count < 2 || received < 14) {
+        return;
+    }
+    
+    // Parse Address Item
+    uint16_t addr_item_type;
+    uint16_t addr_item_length;
+    memcpy(&addr_item_type, recv_buffer + 2, 2);
+    memcpy(&addr_item_length, recv_buffer + 4, 2);
+    
+    uint32_t connection_id = 0;
+    uint32_t encap_sequence = 0;
+    bool has_encap_sequence = false;
+    size_t data_item_offset = 6;
+    
+    if (addr_item_type == CPF_ITEM_SEQUENCED_ADDRESS) {
+        // Sequenced Address Item (8 bytes)
+        if (addr_item_length != 8 || received < 14) {
+            return;
+        }
+        memcpy(&connection_id, recv_buffer + 6, 4);
+        memcpy(&encap_sequence, recv_buffer + 10, 4);
+        has_encap_sequence = true;
+        data_item_offset = 14;  // Skip sequence number
+    } else if (addr_item_type == CPF_ITEM_CONNECTION_ADDRESS) {
+        // Connection Address Item (4 bytes)
+        if (addr_item_length != 4 || received < 10) {
+            return;
         }
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        memcpy(&connection_id, recv_buffer + 6, 4);
+        data_item_offset = 10;
+    } else {
+        ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Received packet with unknown address item type: 0x%04X", addr_item_type);
+        return;
     }
     
-    free(packet);
-    vTaskDelete(NULL);
+    // Verify Connection ID matches T-to-O Connection ID
+    if (connection_id != conn->t_to_o_connection_id) {
+        ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Received packet with wrong connection ID: 0x%08lX (expected 0x%08lX, "
+                     "T->O instance %u) - check the Forward Open response for the IDs the device assigned",
+                     (unsigned long)connection_id, (unsigned long)conn->t_to_o_connection_id,
+                     conn->assembly_instance_produced);
+        return;  // Different connection, ignore
+    }
+    
+    // Parse Data Item
+    if (received < data_item_offset + 4) {
+        return;
+    }
+    
+    uint16_t data_item_type;
+    uint16_t data_item_length;
+    memcpy(&data_item_type, recv_buffer + data_item_offset, 2);
+    memcpy(&data_item_length, recv_buffer + data_item_offset + 2, 2);
+    
+    if (data_item_type != CPF_ITEM_CONNECTED_DATA) {
+        return;
+    }
+    
+    // For Class 1, skip 2-byte CIP sequence count
+    // Expected data_item_length = CIP seq (2) + Assembly data size
+    size_t assembly_data_offset = data_item_offset + 4;  // Skip data item header
+    uint16_t expected_data_length = 2 + conn->assembly_data_size_produced;  // CIP seq + assembly data
+    
+    uint16_t cip_sequence = 0;
+    bool has_cip_sequence = false;
+    if (data_item_length == expected_data_length) {
+        // Class 1: Skip CIP sequence count (2 bytes)
+        memcpy(&cip_sequence, recv_buffer + assembly_data_offset, 2);
+        has_cip_sequence = true;
+        assembly_data_offset += 2;
+    } else if (data_item_length == conn->assembly_data_size_produced) {
+        // Class 0: No sequence count (unlikely for implicit messaging)
+        // assembly_data_offset stays the same
+    } else {
+        ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Unexpected data item length: %u (expected %u or %u)",
+                     data_item_length, expected_data_length, conn->assembly_data_size_produced);
+        return;
+    }
+    
+    uint16_t assembly_data_length = conn->assembly_data_size_produced;
+    
+    // Extract Assembly data
+    if (received < assembly_data_offset + assembly_data_length) {
+        return;
+    }
+    
+    // Update last packet time for watchdog
+    conn->last_packet_time = enip_clock_ticks();
+    capture_record_frame(&conn->ip_address, CAPTURE_DIR_T_TO_O, recv_buffer, received,
+                         assembly_data_offset, assembly_data_length);
+    
+    
+    // Call user callback if provided (safely check conn->valid first)
+    // Check valid flag first (atomic read)
+    bool conn_valid = conn->valid;
+    if (conn->user_data != NULL && conn_valid) {
+        // Use the same structure definition as in enip_scanner_implicit_open
+        typedef struct {
+            enip_implicit_data_callback_t callback;
+            void *user_data;
+            uint8_t *o_to_t_data;  // Dynamic allocation for O-to-T data
+            uint16_t o_to_t_data_length;
+            SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
+        } callback_wrapper_t;
+        
+        callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
+        if (wrapper && wrapper->callback) {
+            // Hand the assembly data to the callback in place; the callback runs
+            // before recv_buffer is reused and gets a const pointer
+            wrapper->callback(&conn->ip_address, conn->assembly_instance_produced,
+                            recv_buffer + assembly_data_offset, assembly_data_length, wrapper->user_data);
+        } else {
+            ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "No callback available for received data (wrapper=%p, callback=%p)",
+                         wrapper, wrapper ? wrapper->callback : NULL);
+        }
+    }
+    
+    taskENTER_CRITICAL(&s_frame_callback_lock);
+    enip_implicit_frame_callback_t frame_callback = conn->frame_callback;
+    void *frame_user_data = conn->frame_user_data;
+    taskEXIT_CRITICAL(&s_frame_callback_lock);
+    if (frame_callback != NULL && conn->valid) {
+        enip_implicit_frame_t frame = {
+            .ip_address = &conn->ip_address,
+            .assembly_instance = conn->assembly_instance_produced,
+            .data = recv_buffer + assembly_data_offset,
+            .data_length = assembly_data_length,
+            .rx_time_us = rx_time_us,
+            .encap_sequence = encap_sequence,
+            .cip_sequence = cip_sequence,
+            .has_encap_sequence = has_encap_sequence,
+            .has_cip_sequence = has_cip_sequence,
+            .t_to_o_connection_id = connection_id,
+            .o_to_t_connection_id = conn->o_to_t_connection_id,
+            .connection_serial_number = conn->connection_serial_number,
+        };
+        frame_callback(&frame, frame_user_data);
+    }
 }
 
-
 static void receive_task(void *pvParameters)
 {
     enip_implicit_connection_t *conn = (enip_implicit_connection_t *)pvParameters;
@@ -979,6 +1255,7 @@ static void receive_task(void *pvParameters)
         
         ssize_t received = recvfrom(conn->udp_socket, recv_buffer, sizeof(recv_buffer), 0,
                                    (struct sockaddr *)&from_addr, &from_len);
+        int64_t rx_time_us = enip_clock_now_us();
         
         if (received < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -991,10 +1268,11 @@ static void receive_task(void *pvParameters)
                              (unsigned long)conn->t_to_o_connection_id, (unsigned long)conn->rpi_ms);
                     no_packet_count = 0;  // Reset counter
                 }
+                capture_check_gap(&conn->ip_address);
                 vTaskDelay(pdMS_TO_TICKS(10));
                 continue;
             }
-            ESP_LOGW(TAG, "Receive error: %d", errno);
+            ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Receive error: %d", errno);
             vTaskDelay(pdMS_TO_TICKS(10));
             continue;
         }
@@ -1004,153 +1282,87 @@ static void receive_task(void *pvParameters)
         
         // Check source IP matches target device
         if (from_addr.sin_addr.s_addr != conn->ip_address.addr) {
-            static uint32_t wrong_ip_count = 0;
-            if ((wrong_ip_count++ % 100) == 0) {
-                ESP_LOGW(TAG, "Received UDP packet from wrong IP (expected " IPSTR ", got " IPSTR ") - ignoring",
+            ENIP_LOG_HOT(ESP_LOG_WARN, TAG, "Received UDP packet from wrong IP (expected " IPSTR ", got " IPSTR ") - ignoring",
                          IP2STR(&conn->ip_address), IP2STR((ip4_addr_t *)&from_addr.sin_addr));
-            }
             continue;  // Ignore packets from other devices
         }
         
-        // Minimum packet size check
-        if (received < 2) {
-            continue;
-        }
-        
-        // Parse Item Count
-        uint16_t item_count;
-        memcpy(&item_count, recv_buffer, 2);
-        
-        if (item_count < 2 || received < 14) {
-            continue;
-        }
-        
-        // Parse Address Item
-        uint16_t addr_item_type;
-        uint16_t addr_item_length;
-        memcpy(&addr_item_type, recv_buffer + 2, 2);
-        memcpy(&addr_item_length, recv_buffer + 4, 2);
-        
-        uint32_t connection_id = 0;
-        size_t data_item_offset = 6;
-        
-        if (addr_item_type == CPF_ITEM_SEQUENCED_ADDRESS) {
-            // Sequenced Address Item (8 bytes)
-            if (addr_item_length != 8 || received < 14) {
-                continue;
-            }
-            memcpy(&connection_id, recv_buffer + 6, 4);
-            data_item_offset = 14;  // Skip sequence number
-        } else if (addr_item_type == CPF_ITEM_CONNECTION_ADDRESS) {
-            // Connection Address Item (4 bytes)
-            if (addr_item_length != 4 || received < 10) {
-                continue;
-            }
-            memcpy(&connection_id, recv_buffer + 6, 4);
-            data_item_offset = 10;
-        } else {
-            static uint32_t unknown_addr_count = 0;
-            if ((unknown_addr_count++ % 100) == 0) {
-                ESP_LOGW(TAG, "Received packet with unknown address item type: 0x%04X", addr_item_type);
-            }
-            continue;
-        }
-        
-        // Verify Connection ID matches T-to-O Connection ID
-        if (connection_id != conn->t_to_o_connection_id) {
-            static uint32_t wrong_conn_id_count = 0;
-            if ((wrong_conn_id_count++ % 100) == 0) {
-                ESP_LOGW(TAG, "Received packet with wrong connection ID: 0x%08lX (expected 0x%08lX) - ignoring",
-                         (unsigned long)connection_id, (unsigned long)conn->t_to_o_connection_id);
-                ESP_LOGW(TAG, "  T->O Instance: %u, Expected data size: %u bytes", 
-                         conn->assembly_instance_produced, conn->assembly_data_size_produced);
-                ESP_LOGW(TAG, "  This may indicate the adapter is using a different connection ID than expected");
-                ESP_LOGW(TAG, "  Check Forward Open response - device may have assigned different IDs");
-            }
-            continue;  // Different connection, ignore
-        }
-        
-        // Parse Data Item
-        if (received < data_item_offset + 4) {
-            continue;
-        }
-        
-        uint16_t data_item_type;
-        uint16_t data_item_length;
-        memcpy(&data_item_type, recv_buffer + data_item_offset, 2);
-        memcpy(&data_item_length, recv_buffer + data_item_offset + 2, 2);
-        
-        if (data_item_type != CPF_ITEM_CONNECTED_DATA) {
-            continue;
-        }
-        
-        // For Class 1, skip 2-byte CIP sequence count
-        // Expected data_item_length = CIP seq (2) + Assembly data size
-        size_t assembly_data_offset = data_item_offset + 4;  // Skip data item header
-        uint16_t expected_data_length = 2 + conn->assembly_data_size_produced;  // CIP seq + assembly data
-        
-        if (data_item_length == expected_data_length) {
-            // Class 1: Skip CIP sequence count (2 bytes)
-            assembly_data_offset += 2;
-        } else if (data_item_length == conn->assembly_data_size_produced) {
-            // Class 0: No sequence count (unlikely for implicit messaging)
-            // assembly_data_offset stays the same
+        dispatch_t_to_o(conn, recv_buffer, received, rx_time_us);
+    }
+    
+    vTaskDelete(NULL);
+}
+
+
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+
+// Frames split over a pbuf chain are linearized here; only the lwIP thread uses it
+static uint8_t s_raw_rx_frame[512];
+
+// Runs in the lwIP thread for every T-to-O datagram of the connection
+static void raw_t_to_o_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    enip_implicit_connection_t *conn = (enip_implicit_connection_t *)arg;
+    int64_t rx_time_us = enip_clock_now_us();
+    
+    if (conn->valid) {
+        if (p->next == NULL) {
+            // Parse the frame where the Ethernet driver left it
+            dispatch_t_to_o(conn, (const uint8_t *)p->payload, p->len, rx_time_us);
         } else {
-            ESP_LOGW(TAG, "Unexpected data item length: %u (expected %u or %u)", 
-                     data_item_length, expected_data_length, conn->assembly_data_size_produced);
-            continue;
-        }
-        
-        uint16_t assembly_data_length = conn->assembly_data_size_produced;
-        
-        // Extract Assembly data
-        if (received < assembly_data_offset + assembly_data_length) {
-            continue;
-        }
-        
-        // Update last packet time for watchdog
-        conn->last_packet_time = xTaskGetTickCount();
-        
-        
-        // Call user callback if provided (safely check conn->valid first)
-        // Check valid flag first (atomic read)
-        bool conn_valid = conn->valid;
-        if (conn->user_data != NULL && conn_valid) {
-            // Use the same structure definition as in enip_scanner_implicit_open
-            typedef struct {
-                enip_implicit_data_callback_t callback;
-                void *user_data;
-                uint8_t *o_to_t_data;  // Dynamic allocation for O-to-T data
-                uint16_t o_to_t_data_length;
-                SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
-            } callback_wrapper_t;
-            
-            callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
-            if (wrapper && wrapper->callback) {
-                // Extract assembly data
-                // Allocate buffer for assembly data (use actual size)
-                uint8_t *assembly_data = malloc(assembly_data_length);
-                if (assembly_data != NULL) {
-                    memcpy(assembly_data, recv_buffer + assembly_data_offset, assembly_data_length);
-                    wrapper->callback(&conn->ip_address, conn->assembly_instance_produced,
-                                    assembly_data, assembly_data_length, wrapper->user_data);
-                    free(assembly_data);
-                } else {
-                    ESP_LOGW(TAG, "Failed to allocate memory for assembly data callback");
-                }
-            } else {
-                static uint32_t no_callback_count = 0;
-                if ((no_callback_count++ % 100) == 0) {
-                    ESP_LOGW(TAG, "No callback available for received data (wrapper=%p, callback=%p)",
-                             wrapper, wrapper ? wrapper->callback : NULL);
-                }
-            }
+            u16_t len = pbuf_copy_partial(p, s_raw_rx_frame, sizeof(s_raw_rx_frame), 0);
+            dispatch_t_to_o(conn, s_raw_rx_frame, len, rx_time_us);
         }
     }
+    pbuf_free(p);
+}
+
+static esp_err_t raw_rx_attach_in_lwip(void *ctx)
+{
+    enip_implicit_connection_t *conn = (enip_implicit_connection_t *)ctx;
+    struct udp_pcb *pcb = udp_new();
+    if (pcb == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
     
-    vTaskDelete(NULL);
+    // Shares port 2222 with the connection's socket, which keeps sending O-to-T.
+    // lwIP delivers a datagram to a PCB connected to its source ahead of any
+    // unconnected one, so the device's frames bypass the socket mailbox.
+    ip_set_option(pcb, SOF_REUSEADDR);
+    ip_addr_t remote = IPADDR4_INIT(conn->ip_address.addr);
+    if (udp_bind(pcb, IP4_ADDR_ANY, ENIP_IMPLICIT_PORT) != ERR_OK ||
+        udp_connect(pcb, &remote, ENIP_IMPLICIT_PORT) != ERR_OK) {
+        udp_remove(pcb);
+        return ESP_FAIL;
+    }
+    udp_recv(pcb, raw_t_to_o_recv, conn);
+    conn->raw_pcb = pcb;
+    return ESP_OK;
 }
 
+static esp_err_t raw_rx_detach_in_lwip(void *ctx)
+{
+    enip_implicit_connection_t *conn = (enip_implicit_connection_t *)ctx;
+    if (conn->raw_pcb != NULL) {
+        udp_remove(conn->raw_pcb);
+        conn->raw_pcb = NULL;
+    }
+    return ESP_OK;
+}
+
+// Once this returns no receive callback for conn is running or will run.
+// Must not be called with s_connections_mutex held: the callbacks it waits
+// for may call enip_scanner_implicit_write_data(). Nothing in this file holds
+// the mutex while it needs the lwIP core lock, so such a call never deadlocks.
+static void raw_rx_detach(enip_implicit_connection_t *conn)
+{
+    esp_netif_tcpip_exec(raw_rx_detach_in_lwip, conn);
+}
+
+#endif // CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
 
 static void watchdog_task(void *pvParameters)
 {
@@ -1161,12 +1373,17 @@ static void watchdog_task(void *pvParameters)
     }
     
     while (conn->state == ENIP_CONN_STATE_OPEN && conn->valid) {
-        vTaskDelay(pdMS_TO_TICKS(100));  // Check every 100ms
+        enip_clock_delay_ms(100);  // Check every 100ms
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+        if (conn->raw_pcb != NULL) {
+            capture_check_gap(&conn->ip_address);  // No receive task polls in raw mode
+        }
+#endif
         
         // Check if we're still sending O->T heartbeats
         uint32_t time_since_last_heartbeat = 0;
         if (conn->last_heartbeat_time != 0) {
-            time_since_last_heartbeat = xTaskGetTickCount() - conn->last_heartbeat_time;
+            time_since_last_heartbeat = enip_clock_ticks() - conn->last_heartbeat_time;
         }
         
         uint32_t heartbeat_timeout_ticks = (conn->rpi_ms * 2) / portTICK_PERIOD_MS;
@@ -1184,7 +1401,7 @@ static void watchdog_task(void *pvParameters)
                 watchdog_timeout_ms = 10000;
             }
             uint32_t timeout_ticks = watchdog_timeout_ms / portTICK_PERIOD_MS;
-            uint32_t time_since_last_packet = xTaskGetTickCount() - conn->last_packet_time;
+            uint32_t time_since_last_packet = enip_clock_ticks() - conn->last_packet_time;
             
             if (time_since_last_packet > timeout_ticks) {
                 uint32_t elapsed_ms = (unsigned long)(time_since_last_packet * portTICK_PERIOD_MS);
@@ -1194,8 +1411,12 @@ static void watchdog_task(void *pvParameters)
                          (unsigned long)conn->rpi_ms, (unsigned long)watchdog_timeout_ms);
                 ESP_LOGW(TAG, "  We ARE sending O->T heartbeats, but adapter is NOT sending T->O data packets");
                 ESP_LOGW(TAG, "  Possible causes: Adapter not configured for T->O, wrong connection ID, or network issue");
+                capture_connection_lost(&conn->ip_address);
                 conn->state = ENIP_CONN_STATE_CLOSING;
                 conn->valid = false;
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+                raw_rx_detach(conn);
+#endif
                 break;
             }
         }
@@ -1204,12 +1425,62 @@ static void watchdog_task(void *pvParameters)
     vTaskDelete(NULL);
 }
 
-#define MAX_IMPLICIT_CONNECTIONS 8
-static enip_implicit_connection_t s_connections[MAX_IMPLICIT_CONNECTIONS];
-static bool s_connections_initialized = false;
+// Frees the callback wrapper of conn and its O-to-T data
+static void free_callback_wrapper(enip_implicit_connection_t *conn)
+{
+    typedef struct {
+        enip_implicit_data_callback_t callback;
+        void *user_data;
+        uint8_t *o_to_t_data;
+        uint16_t o_to_t_data_length;
+        SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
+    } callback_wrapper_t;
+    
+    callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
+    if (wrapper != NULL) {
+        if (wrapper->data_mutex != NULL) {
+            vSemaphoreDelete(wrapper->data_mutex);
+        }
+        enip_mem_free(wrapper->o_to_t_data);
+        enip_mem_free(wrapper);
+    }
+    conn->user_data = NULL;
+}
+
+// Closes the UDP socket of a connection the scheduler may have staged a frame for
+static void close_udp_socket(int sock)
+{
+    xSemaphoreTake(s_o_to_t_send_mutex, portMAX_DELAY);
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+    xSemaphoreGive(s_o_to_t_send_mutex);
+}
 
-static enip_implicit_connection_t *find_or_create_connection(const ip4_addr_t *ip_address)
+// Frees what an invalidated connection still holds. Its sockets are closed
+// without a Forward Close; the device drops the connection on its own timeout.
+// The caller copies the slot out and clears it under s_connections_mutex, then
+// calls this with the copy after releasing the mutex: closing sockets needs the
+// lwIP core lock, which a raw receive callback holds while it may be waiting in
+// enip_scanner_implicit_write_data().
+static void release_connection(enip_implicit_connection_t *conn)
 {
+    if (conn->udp_socket >= 0) {
+        close_udp_socket(conn->udp_socket);
+    }
+    if (conn->tcp_socket >= 0) {
+        unregister_session(conn->tcp_socket, conn->session_handle);
+        close(conn->tcp_socket);
+    }
+    free_callback_wrapper(conn);
+    enip_mem_free(conn->o_to_t_frame);
+}
+
+// Returns the slot for ip_address; *created is true when a free slot was
+// reserved for it (state OPENING), so concurrent opens never share a slot
+static enip_implicit_connection_t *find_or_create_connection(const ip4_addr_t *ip_address, bool *created)
+{
+    *created = false;
+    
     // Create mutex on first call if needed
     if (s_connections_mutex == NULL) {
         s_connections_mutex = xSemaphoreCreateMutex();
@@ -1218,6 +1489,13 @@ static enip_implicit_connection_t *find_or_create_connection(const ip4_addr_t *i
             return NULL;
         }
     }
+    if (s_o_to_t_send_mutex == NULL) {
+        s_o_to_t_send_mutex = xSemaphoreCreateMutex();
+        if (s_o_to_t_send_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create O-to-T send mutex");
+            return NULL;
+        }
+    }
     
     if (xSemaphoreTake(s_connections_mutex, portMAX_DELAY) != pdTRUE) {
         return NULL;
@@ -1229,10 +1507,12 @@ static enip_implicit_connection_t *find_or_create_connection(const ip4_addr_t *i
     }
     
     enip_implicit_connection_t *found_conn = NULL;
+    enip_implicit_connection_t stale;
+    bool release_stale = false;
     
     for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
-        if (s_connections[i].valid && 
-            s_connections[i].ip_address.addr == ip_address->addr) {
+        bool in_use = s_connections[i].valid || s_connections[i].state == ENIP_CONN_STATE_OPENING;
+        if (in_use && s_connections[i].ip_address.addr == ip_address->addr) {
             found_conn = &s_connections[i];
             break;
         }
@@ -1240,31 +1520,44 @@ static enip_implicit_connection_t *find_or_create_connection(const ip4_addr_t *i
     
     if (found_conn == NULL) {
         for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
-            if (!s_connections[i].valid) {
+            if (!s_connections[i].valid && s_connections[i].state != ENIP_CONN_STATE_OPENING) {
+                // Left over by a connection the watchdog invalidated, or by a failed open
+                if (s_connections[i].state == ENIP_CONN_STATE_CLOSING) {
+                    stale = s_connections[i];
+                    release_stale = true;
+                }
                 memset(&s_connections[i], 0, sizeof(enip_implicit_connection_t));
                 s_connections[i].ip_address = *ip_address;
-                s_connections[i].state = ENIP_CONN_STATE_IDLE;
+                s_connections[i].state = ENIP_CONN_STATE_OPENING;
                 found_conn = &s_connections[i];
+                *created = true;
                 break;
             }
         }
     }
     
     xSemaphoreGive(s_connections_mutex);
+    
+    if (release_stale) {
+        release_connection(&stale);
+    }
     return found_conn;  // NULL if no free slots
 }
 
 
-esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
-                                     uint16_t assembly_instance_consumed,
-                                     uint16_t assembly_instance_produced,
-                                     uint16_t assembly_data_size_consumed,
-                                     uint16_t assembly_data_size_produced,
-                                     uint32_t rpi_ms,
-                                     enip_implicit_data_callback_t callback,
-                                     void *user_data,
-                                     uint32_t timeout_ms,
-                                     bool exclusive_owner)
+// tag_name is NULL for an assembly connection
+static esp_err_t implicit_open(const ip4_addr_t *ip_address,
+                               uint16_t assembly_instance_consumed,
+                               uint16_t assembly_instance_produced,
+                               uint16_t assembly_data_size_consumed,
+                               uint16_t assembly_data_size_produced,
+                               uint32_t rpi_ms,
+                               enip_implicit_data_callback_t callback,
+                               void *user_data,
+                               uint32_t timeout_ms,
+                               bool exclusive_owner,
+                               const char *tag_name,
+                               const enip_scanner_route_t *route)
 {
     if (ip_address == NULL || callback == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -1275,53 +1568,48 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (s_scanner_mutex == NULL) {
+    if (!scanner_is_ready()) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    enip_implicit_connection_t *conn = find_or_create_connection(ip_address);
+    bool created = false;
+    enip_implicit_connection_t *conn = find_or_create_connection(ip_address, &created);
     if (conn == NULL) {
         ESP_LOGE(TAG, "No free connection slots available");
         return ESP_ERR_NO_MEM;
     }
     
-    // Check if connection is already open (need to take mutex again)
-    if (s_connections_mutex != NULL && xSemaphoreTake(s_connections_mutex, portMAX_DELAY) == pdTRUE) {
-        if (conn->valid && conn->state == ENIP_CONN_STATE_OPEN) {
-            xSemaphoreGive(s_connections_mutex);
-            ESP_LOGW(TAG, "Connection already open for this IP");
-            return ESP_ERR_INVALID_STATE;
-        }
-        xSemaphoreGive(s_connections_mutex);
+    // An existing slot is either open or being opened by another task
+    if (!created) {
+        ESP_LOGW(TAG, "Connection already open for this IP");
+        return ESP_ERR_INVALID_STATE;
     }
     conn->assembly_instance_consumed = assembly_instance_consumed;
     conn->assembly_instance_produced = assembly_instance_produced;
     conn->rpi_ms = rpi_ms;
     conn->exclusive_owner = exclusive_owner;
+    if (tag_name != NULL) {
+        conn->tag_connection = true;
+        strlcpy(conn->tag_name, tag_name, sizeof(conn->tag_name));
+        conn->route = *route;
+    }
     conn->state = ENIP_CONN_STATE_OPENING;
     conn->user_data = user_data;
     conn->last_packet_time = 0;
     conn->last_heartbeat_time = 0;
     
-    conn->tcp_socket = create_tcp_socket(ip_address, timeout_ms);
+    // One deadline covers connect, session registration, size autodetection,
+    // Forward Open (including its retries) and the initial O->T read
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
+    
+    conn->tcp_socket = create_tcp_socket(ip_address, deadline);
     if (conn->tcp_socket < 0) {
         ESP_LOGE(TAG, "Failed to create TCP socket");
         conn->state = ENIP_CONN_STATE_IDLE;
         return ESP_FAIL;
     }
     
-    esp_err_t ret = register_session(conn->tcp_socket, &conn->session_handle);
+    esp_err_t ret = register_session(conn->tcp_socket, &conn->session_handle, deadline);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register session: %s", esp_err_to_name(ret));
         close(conn->tcp_socket);
@@ -1330,12 +1618,17 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
         return ret;
     }
     
-    if (assembly_data_size_consumed == 0) {
+    bool consumed_size_cached = false;
+    if (assembly_data_size_consumed == 0 && !conn->tag_connection &&
+        profile_get_assembly_size(ip_address, assembly_instance_consumed, &conn->assembly_data_size_consumed)) {
+        consumed_size_cached = true;
+        ESP_LOGD(TAG, "Using cached consumed assembly data size for instance %u", assembly_instance_consumed);
+    } else if (assembly_data_size_consumed == 0 && !conn->tag_connection) {
         ESP_LOGD(TAG, "Autodetecting consumed assembly data size for instance %u", assembly_instance_consumed);
         ret = read_assembly_data_size(conn->tcp_socket, conn->session_handle, 
                                       assembly_instance_consumed, 
                                       &conn->assembly_data_size_consumed, 
-                                      timeout_ms);
+                                      deadline);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to autodetect consumed assembly data size: %s", esp_err_to_name(ret));
             ESP_LOGW(TAG, "You may need to specify assembly_data_size_consumed manually");
@@ -1345,16 +1638,22 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
             conn->state = ENIP_CONN_STATE_IDLE;
             return ESP_ERR_NOT_FOUND;
         }
+        profile_note_assembly_size(ip_address, assembly_instance_consumed, conn->assembly_data_size_consumed);
     } else {
         conn->assembly_data_size_consumed = assembly_data_size_consumed;
     }
     
-    if (assembly_data_size_produced == 0) {
+    bool produced_size_cached = false;
+    if (assembly_data_size_produced == 0 &&
+        profile_get_assembly_size(ip_address, assembly_instance_produced, &conn->assembly_data_size_produced)) {
+        produced_size_cached = true;
+        ESP_LOGD(TAG, "Using cached produced assembly data size for instance %u", assembly_instance_produced);
+    } else if (assembly_data_size_produced == 0) {
         ESP_LOGD(TAG, "Autodetecting produced assembly data size for instance %u", assembly_instance_produced);
         ret = read_assembly_data_size(conn->tcp_socket, conn->session_handle, 
                                       assembly_instance_produced, 
                                       &conn->assembly_data_size_produced, 
-                                      timeout_ms);
+                                      deadline);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to autodetect produced assembly data size: %s", esp_err_to_name(ret));
             ESP_LOGW(TAG, "You may need to specify assembly_data_size_produced manually");
@@ -1364,6 +1663,7 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
             conn->state = ENIP_CONN_STATE_IDLE;
             return ESP_ERR_NOT_FOUND;
         }
+        profile_note_assembly_size(ip_address, assembly_instance_produced, conn->assembly_data_size_produced);
     } else {
         conn->assembly_data_size_produced = assembly_data_size_produced;
     }
@@ -1371,8 +1671,15 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
     ESP_LOGD(TAG, "Assembly sizes: Consumed=%u bytes, Produced=%u bytes", 
              conn->assembly_data_size_consumed, conn->assembly_data_size_produced);
     
-    ret = forward_open(conn, timeout_ms);
+    ret = forward_open(conn, deadline);
     if (ret != ESP_OK) {
+        // A refused open may be a stale cached size; probe again next time
+        if (consumed_size_cached && ret != ESP_ERR_TIMEOUT) {
+            profile_forget_assembly(ip_address, assembly_instance_consumed);
+        }
+        if (produced_size_cached && ret != ESP_ERR_TIMEOUT) {
+            profile_forget_assembly(ip_address, assembly_instance_produced);
+        }
         unregister_session(conn->tcp_socket, conn->session_handle);
         close(conn->tcp_socket);
         conn->tcp_socket = -1;
@@ -1383,13 +1690,14 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
     // Create UDP socket
     conn->udp_socket = create_udp_socket();
     if (conn->udp_socket < 0) {
-        forward_close(conn, timeout_ms);
+        forward_close(conn, deadline);
         unregister_session(conn->tcp_socket, conn->session_handle);
         close(conn->tcp_socket);
         conn->tcp_socket = -1;
         conn->state = ENIP_CONN_STATE_IDLE;
         return ESP_FAIL;
     }
+    qos_mark_implicit_socket(conn->udp_socket, conn->priority);
     
     // Store callback (we'll need to wrap it)
     // For now, store callback pointer in user_data field
@@ -1402,10 +1710,10 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
         SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
     } callback_wrapper_t;
     
-    callback_wrapper_t *wrapper = malloc(sizeof(callback_wrapper_t));
+    callback_wrapper_t *wrapper = enip_mem_alloc(ENIP_MEM_HOT, sizeof(callback_wrapper_t));
     if (wrapper == NULL) {
         close(conn->udp_socket);
-        forward_close(conn, timeout_ms);
+        forward_close(conn, deadline);
         unregister_session(conn->tcp_socket, conn->session_handle);
         close(conn->tcp_socket);
         conn->tcp_socket = -1;
@@ -1418,9 +1726,9 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
     wrapper->o_to_t_data_length = 0;
     wrapper->data_mutex = xSemaphoreCreateMutex();
     if (wrapper->data_mutex == NULL) {
-        free(wrapper);
+        enip_mem_free(wrapper);
         close(conn->udp_socket);
-        forward_close(conn, timeout_ms);
+        forward_close(conn, deadline);
         unregister_session(conn->tcp_socket, conn->session_handle);
         close(conn->tcp_socket);
         conn->tcp_socket = -1;
@@ -1428,55 +1736,92 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
         return ESP_ERR_NO_MEM;
     }
     
-    // Read initial O->T assembly data from the device
-    // This ensures we start with the current state, not zeros
-    enip_scanner_assembly_result_t assembly_result = {0};
-    ret = enip_scanner_read_assembly(ip_address, assembly_instance_consumed, &assembly_result, timeout_ms);
-    
-    // Protect initial data write with mutex
-    if (xSemaphoreTake(wrapper->data_mutex, portMAX_DELAY) == pdTRUE) {
-        if (ret == ESP_OK && assembly_result.data_length > 0) {
-            // Allocate buffer for O-to-T data
-            wrapper->o_to_t_data = malloc(conn->assembly_data_size_consumed);
-            if (wrapper->o_to_t_data != NULL) {
-                // Copy the read data
-                uint16_t copy_size = (assembly_result.data_length < conn->assembly_data_size_consumed) ?
-                                     assembly_result.data_length : conn->assembly_data_size_consumed;
-                memcpy(wrapper->o_to_t_data, assembly_result.data, copy_size);
-                
-                // Zero-pad if the read data is shorter than expected
-                if (copy_size < conn->assembly_data_size_consumed) {
-                    memset(wrapper->o_to_t_data + copy_size, 0, conn->assembly_data_size_consumed - copy_size);
+    // Held for the life of the connection, so it comes from the heap rather
+    // than the packet buffer pool, which explicit requests need
+    conn->o_to_t_frame = enip_mem_alloc(ENIP_MEM_HOT, O_TO_T_HEADER_SIZE + conn->assembly_data_size_consumed);
+    if (conn->o_to_t_frame == NULL) {
+        vSemaphoreDelete(wrapper->data_mutex);
+        enip_mem_free(wrapper);
+        close(conn->udp_socket);
+        forward_close(conn, deadline);
+        unregister_session(conn->tcp_socket, conn->session_handle);
+        close(conn->tcp_socket);
+        conn->tcp_socket = -1;
+        conn->state = ENIP_CONN_STATE_IDLE;
+        return ESP_ERR_NO_MEM;
+    }
+    build_o_to_t_template(conn);
+    
+    // A produced tag consumer has no O->T data
+    if (!conn->tag_connection) {
+        // Read initial O->T assembly data from the device
+        // This ensures we start with the current state, not zeros
+        enip_scanner_assembly_result_t assembly_result = {0};
+        ret = enip_scanner_read_assembly(ip_address, assembly_instance_consumed, &assembly_result,
+                                         enip_deadline_remaining_ms(deadline));
+        
+        // Protect initial data write with mutex
+        if (xSemaphoreTake(wrapper->data_mutex, portMAX_DELAY) == pdTRUE) {
+            if (ret == ESP_OK && assembly_result.data_length > 0) {
+                // Allocate buffer for O-to-T data
+                wrapper->o_to_t_data = enip_mem_alloc(ENIP_MEM_HOT, conn->assembly_data_size_consumed);
+                if (wrapper->o_to_t_data != NULL) {
+                    // Copy the read data
+                    uint16_t copy_size = (assembly_result.data_length < conn->assembly_data_size_consumed) ?
+                                         assembly_result.data_length : conn->assembly_data_size_consumed;
+                    memcpy(wrapper->o_to_t_data, assembly_result.data, copy_size);
+                    
+                    // Zero-pad if the read data is shorter than expected
+                    if (copy_size < conn->assembly_data_size_consumed) {
+                        memset(wrapper->o_to_t_data + copy_size, 0, conn->assembly_data_size_consumed - copy_size);
+                    }
+                    
+                    wrapper->o_to_t_data_length = conn->assembly_data_size_consumed;
+                } else {
+                    ESP_LOGW(TAG, "Failed to allocate buffer for initial O->T data");
                 }
-                
-                wrapper->o_to_t_data_length = conn->assembly_data_size_consumed;
             } else {
-                ESP_LOGW(TAG, "Failed to allocate buffer for initial O->T data");
-            }
-        } else {
-            ESP_LOGW(TAG, "Failed to read initial O->T assembly data: %s (will start with zeros)", 
-                     ret == ESP_OK ? "empty data" : esp_err_to_name(ret));
-            // Allocate zero-filled buffer
-            wrapper->o_to_t_data = malloc(conn->assembly_data_size_consumed);
-            if (wrapper->o_to_t_data != NULL) {
-                memset(wrapper->o_to_t_data, 0, conn->assembly_data_size_consumed);
-                wrapper->o_to_t_data_length = conn->assembly_data_size_consumed;  // Always set to full buffer size
+                ESP_LOGW(TAG, "Failed to read initial O->T assembly data: %s (will start with zeros)", 
+                         ret == ESP_OK ? "empty data" : esp_err_to_name(ret));
+                // Allocate zero-filled buffer
+                wrapper->o_to_t_data = enip_mem_alloc(ENIP_MEM_HOT, conn->assembly_data_size_consumed);
+                if (wrapper->o_to_t_data != NULL) {
+                    memset(wrapper->o_to_t_data, 0, conn->assembly_data_size_consumed);
+                    wrapper->o_to_t_data_length = conn->assembly_data_size_consumed;  // Always set to full buffer size
+                }
             }
+            xSemaphoreGive(wrapper->data_mutex);
         }
-        xSemaphoreGive(wrapper->data_mutex);
+        
+        // Free assembly result
+        enip_scanner_free_assembly_result(&assembly_result);
     }
     
-    // Free assembly result
-    enip_scanner_free_assembly_result(&assembly_result);
-    
+    // First O->T frame 50ms after Forward Open
+    conn->o_to_t_next_us = enip_clock_now_us() + 50000;
     conn->user_data = wrapper;
     conn->state = ENIP_CONN_STATE_OPEN;
     conn->valid = true;
-    conn->last_packet_time = xTaskGetTickCount();
+    conn->last_packet_time = enip_clock_ticks();
     
-    xTaskCreate(heartbeat_task, "enip_hb", 4096, conn, 4, &conn->heartbeat_task_handle);
-    xTaskCreate(receive_task, "enip_recv", 4096, conn, 5, &conn->receive_task_handle);
-    xTaskCreate(watchdog_task, "enip_wdog", 4096, conn, 1, &conn->watchdog_task_handle);
+    // Under the mutex so concurrent opens start a single scheduler
+    xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+    if (s_o_to_t_task_handle == NULL) {
+        xTaskCreate(o_to_t_scheduler_task, "enip_o2t", IMPLICIT_TASK_STACK_SIZE, NULL, 4, &s_o_to_t_task_handle);
+    } else {
+        xTaskNotifyGive(s_o_to_t_task_handle);
+    }
+    xSemaphoreGive(s_connections_mutex);
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+    esp_err_t raw_ret = esp_netif_tcpip_exec(raw_rx_attach_in_lwip, conn);
+    if (raw_ret != ESP_OK) {
+        ESP_LOGW(TAG, "Raw T->O receive unavailable (%s), using the socket", esp_err_to_name(raw_ret));
+        xTaskCreate(receive_task, "enip_recv", IMPLICIT_TASK_STACK_SIZE, conn, 5, &conn->receive_task_handle);
+    }
+#else
+    xTaskCreate(receive_task, "enip_recv", IMPLICIT_TASK_STACK_SIZE, conn, 5, &conn->receive_task_handle);
+#endif
+    xTaskCreate(watchdog_task, "enip_wdog", IMPLICIT_TASK_STACK_SIZE, conn, 1, &conn->watchdog_task_handle);
     
     ESP_LOGI(TAG, "Implicit connection opened: O-to-T=0x%08lX, T-to-O=0x%08lX",
              (unsigned long)conn->o_to_t_connection_id, (unsigned long)conn->t_to_o_connection_id);
@@ -1484,6 +1829,53 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
     return ESP_OK;
 }
 
+esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
+                                     uint16_t assembly_instance_consumed,
+                                     uint16_t assembly_instance_produced,
+                                     uint16_t assembly_data_size_consumed,
+                                     uint16_t assembly_data_size_produced,
+                                     uint32_t rpi_ms,
+                                     enip_implicit_data_callback_t callback,
+                                     void *user_data,
+                                     uint32_t timeout_ms,
+                                     bool exclusive_owner)
+{
+    return implicit_open(ip_address, assembly_instance_consumed, assembly_instance_produced,
+                         assembly_data_size_consumed, assembly_data_size_produced, rpi_ms,
+                         callback, user_data, timeout_ms, exclusive_owner, NULL, NULL);
+}
+
+esp_err_t enip_scanner_implicit_open_produced_tag(const ip4_addr_t *ip_address,
+                                                  const char *tag_name,
+                                                  const enip_scanner_route_t *route,
+                                                  uint16_t tag_data_size,
+                                                  uint32_t rpi_ms,
+                                                  enip_implicit_data_callback_t callback,
+                                                  void *user_data,
+                                                  uint32_t timeout_ms)
+{
+    if (tag_name == NULL || tag_data_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Produced tags are controller-scoped base tags: no program scope, members or elements
+    size_t name_length = strlen(tag_name);
+    if (name_length == 0 || name_length > ENIP_SCANNER_PRODUCED_TAG_NAME_MAX ||
+        strpbrk(tag_name, ".[]:") != NULL) {
+        ESP_LOGE(TAG, "Invalid produced tag name '%s'", tag_name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    enip_scanner_route_t controller_route = { .size = 2, .path = { 0x01, 0x00 } };  // Backplane, slot 0
+    if (route != NULL && route->size > 0) {
+        controller_route = *route;
+    }
+    
+    // The consumer's O->T frames are heartbeats; the tag arrives point-to-point T->O
+    return implicit_open(ip_address, 0, 0, 0, tag_data_size, rpi_ms, callback, user_data,
+                         timeout_ms, true, tag_name, &controller_route);
+}
+
 esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t timeout_ms)
 {
     if (ip_address == NULL) {
@@ -1508,8 +1900,32 @@ esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t tim
     }
     
     if (conn == NULL || !conn->valid) {
+        // Dropped by the watchdog or a link down: nothing to send, just let go of it
+        // Any further leftover for this device is released when its slot is reused
+        esp_err_t ret = ESP_ERR_NOT_FOUND;
+        enip_implicit_connection_t stale;
+        bool release_stale = false;
+        for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+            if (!release_stale && s_connections[i].state == ENIP_CONN_STATE_CLOSING && !s_connections[i].valid &&
+                s_connections[i].ip_address.addr == ip_address->addr) {
+                stale = s_connections[i];
+                release_stale = true;
+                memset(&s_connections[i], 0, sizeof(enip_implicit_connection_t));
+                ret = ESP_OK;
+            }
+            if (s_suspended[i].pending && s_suspended[i].ip_address.addr == ip_address->addr) {
+                s_suspended[i].pending = false;
+                enip_mem_free(s_suspended[i].o_to_t_data);
+                s_suspended[i].o_to_t_data = NULL;
+                ret = ESP_OK;
+            }
+        }
         xSemaphoreGive(s_connections_mutex);
-        return ESP_ERR_NOT_FOUND;
+        
+        if (release_stale) {
+            release_connection(&stale);
+        }
+        return ret;
     }
     
     // Save state and socket before releasing mutex
@@ -1528,7 +1944,7 @@ esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t tim
         // This ensures device receives it on an active connection and responds quickly
         
         uint32_t fc_timeout = timeout_ms > 5000 ? 5000 : timeout_ms;
-        esp_err_t send_ret = forward_close(conn, fc_timeout);
+        esp_err_t send_ret = forward_close(conn, enip_deadline_from_timeout(fc_timeout));
         
         if (send_ret == ESP_OK) {
             forward_close_success = true;
@@ -1547,11 +1963,13 @@ esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t tim
     if (xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
         conn->valid = false;
         // Clear task handles immediately - tasks will delete themselves
-        conn->heartbeat_task_handle = NULL;
         conn->receive_task_handle = NULL;
         conn->watchdog_task_handle = NULL;
         xSemaphoreGive(s_connections_mutex);
     }
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+    raw_rx_detach(conn);
+#endif
     
     // Give tasks a short time to see conn->valid = false and exit gracefully
     // Tasks check conn->valid in their loops and will exit, then call vTaskDelete(NULL)
@@ -1582,8 +2000,7 @@ esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t tim
                      (unsigned long)watchdog_timeout_ms);
             vTaskDelay(pdMS_TO_TICKS(watchdog_timeout_ms));
         }
-        shutdown(udp_socket, SHUT_RDWR);
-        close(udp_socket);
+        close_udp_socket(udp_socket);
         
         if (xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
             conn->udp_socket = -1;
@@ -1606,29 +2023,8 @@ esp_err_t enip_scanner_implicit_close(const ip4_addr_t *ip_address, uint32_t tim
     
     // Free callback wrapper (must be done after tasks exit to avoid use-after-free)
     if (xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        if (conn->user_data != NULL) {
-            // Free callback wrapper and its data buffer
-            typedef struct {
-                enip_implicit_data_callback_t callback;
-                void *user_data;
-                uint8_t *o_to_t_data;
-                uint16_t o_to_t_data_length;
-                SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
-            } callback_wrapper_t;
-            callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
-            if (wrapper) {
-                // Delete mutex if it exists
-                if (wrapper->data_mutex != NULL) {
-                    vSemaphoreDelete(wrapper->data_mutex);
-                    wrapper->data_mutex = NULL;
-                }
-                if (wrapper->o_to_t_data) {
-                    free(wrapper->o_to_t_data);
-                }
-                free(wrapper);
-            }
-            conn->user_data = NULL;
-        }
+        free_callback_wrapper(conn);
+        enip_mem_free(conn->o_to_t_frame);
         
         memset(conn, 0, sizeof(enip_implicit_connection_t));
         xSemaphoreGive(s_connections_mutex);
@@ -1697,9 +2093,9 @@ esp_err_t enip_scanner_implicit_write_data(const ip4_addr_t *ip_address,
     // Allocate/reallocate buffer if needed
     if (wrapper->o_to_t_data == NULL || wrapper->o_to_t_data_length < conn->assembly_data_size_consumed) {
         if (wrapper->o_to_t_data != NULL) {
-            free(wrapper->o_to_t_data);
+            enip_mem_free(wrapper->o_to_t_data);
         }
-        wrapper->o_to_t_data = malloc(conn->assembly_data_size_consumed);
+        wrapper->o_to_t_data = enip_mem_alloc(ENIP_MEM_HOT, conn->assembly_data_size_consumed);
         if (wrapper->o_to_t_data == NULL) {
             xSemaphoreGive(wrapper->data_mutex);
             return ESP_ERR_NO_MEM;
@@ -1808,5 +2204,283 @@ esp_err_t enip_scanner_implicit_read_o_to_t_data(const ip4_addr_t *ip_address,
     return ESP_OK;
 }
 
+esp_err_t enip_scanner_implicit_set_frame_callback(const ip4_addr_t *ip_address,
+                                                   enip_implicit_frame_callback_t callback,
+                                                   void *user_data)
+{
+    if (ip_address == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_connections_mutex == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    if (xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_FAIL;
+    }
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        enip_implicit_connection_t *conn = &s_connections[i];
+        if (conn->valid && conn->ip_address.addr == ip_address->addr) {
+            taskENTER_CRITICAL(&s_frame_callback_lock);
+            conn->frame_callback = callback;
+            conn->frame_user_data = user_data;
+            taskEXIT_CRITICAL(&s_frame_callback_lock);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(s_connections_mutex);
+    return ret;
+}
+
+// Releases the slots implicit_suspend_all() dropped (bit i for slot i) once
+// their tasks have had time to exit
+static void reap_task(void *pvParameters)
+{
+    uint32_t dropped = (uint32_t)(uintptr_t)pvParameters;
+    
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        if (dropped & (1u << i)) {
+            raw_rx_detach(&s_connections[i]);
+        }
+    }
+#endif
+    
+    vTaskDelay(pdMS_TO_TICKS(SUSPEND_GRACE_MS));
+    
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        if (!(dropped & (1u << i))) {
+            continue;
+        }
+        enip_implicit_connection_t stale;
+        bool release_stale = false;
+        xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+        enip_implicit_connection_t *conn = &s_connections[i];
+        // A close or an open may have taken the slot over in the meantime
+        if (!conn->valid && conn->state == ENIP_CONN_STATE_CLOSING) {
+            stale = *conn;
+            release_stale = true;
+            memset(conn, 0, sizeof(enip_implicit_connection_t));
+        }
+        xSemaphoreGive(s_connections_mutex);
+        if (release_stale) {
+            release_connection(&stale);
+        }
+    }
+    
+    vTaskDelete(NULL);
+}
+
+void implicit_suspend_all(void)
+{
+    typedef struct {
+        enip_implicit_data_callback_t callback;
+        void *user_data;
+        uint8_t *o_to_t_data;
+        uint16_t o_to_t_data_length;
+        SemaphoreHandle_t data_mutex;  // Mutex to protect o_to_t_data access
+    } callback_wrapper_t;
+    
+    if (s_connections_mutex == NULL) {
+        return;
+    }
+    
+    uint32_t dropped = 0;
+    int count = 0;
+    xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+    s_link_generation++;
+    s_suspended_at = xTaskGetTickCount();
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        enip_implicit_connection_t *conn = &s_connections[i];
+        suspended_connection_t *entry = &s_suspended[i];
+        if (entry->pending) {
+            // Still waiting from an earlier link down; the next link-up retries it
+            entry->generation = s_link_generation;
+        }
+        if (!conn->valid || conn->state != ENIP_CONN_STATE_OPEN) {
+            continue;
+        }
+        
+        callback_wrapper_t *wrapper = (callback_wrapper_t *)conn->user_data;
+        if (entry->pending) {
+            // The slot was reused by a connection to another device; keep the older entry
+            // and find this one a free place
+            entry = NULL;
+            for (int j = 0; j < MAX_IMPLICIT_CONNECTIONS; j++) {
+                if (!s_suspended[j].pending) {
+                    entry = &s_suspended[j];
+                    break;
+                }
+            }
+        }
+        if (entry != NULL && wrapper != NULL) {
+            enip_mem_free(entry->o_to_t_data);
+            memset(entry, 0, sizeof(*entry));
+            entry->pending = true;
+            entry->generation = s_link_generation;
+            entry->ip_address = conn->ip_address;
+            entry->assembly_instance_consumed = conn->assembly_instance_consumed;
+            entry->assembly_instance_produced = conn->assembly_instance_produced;
+            entry->assembly_data_size_consumed = conn->assembly_data_size_consumed;
+            entry->assembly_data_size_produced = conn->assembly_data_size_produced;
+            entry->rpi_ms = conn->rpi_ms;
+            entry->exclusive_owner = conn->exclusive_owner;
+            entry->tag_connection = conn->tag_connection;
+            memcpy(entry->tag_name, conn->tag_name, sizeof(entry->tag_name));
+            entry->route = conn->route;
+            entry->callback = wrapper->callback;
+            entry->user_data = wrapper->user_data;
+            if (xSemaphoreTake(wrapper->data_mutex, portMAX_DELAY) == pdTRUE) {
+                if (wrapper->o_to_t_data != NULL && wrapper->o_to_t_data_length > 0) {
+                    entry->o_to_t_data = enip_mem_alloc(ENIP_MEM_COLD, wrapper->o_to_t_data_length);
+                    if (entry->o_to_t_data != NULL) {
+                        memcpy(entry->o_to_t_data, wrapper->o_to_t_data, wrapper->o_to_t_data_length);
+                        entry->o_to_t_data_length = wrapper->o_to_t_data_length;
+                    }
+                }
+                xSemaphoreGive(wrapper->data_mutex);
+            }
+        }
+        
+        // Stops the O-to-T scheduler, the receive task and the watchdog for this connection
+        capture_connection_lost(&conn->ip_address);
+        conn->state = ENIP_CONN_STATE_CLOSING;
+        conn->valid = false;
+        conn->receive_task_handle = NULL;
+        conn->watchdog_task_handle = NULL;
+        dropped |= 1u << i;
+        count++;
+    }
+    xSemaphoreGive(s_connections_mutex);
+    
+    if (count == 0) {
+        return;
+    }
+    ESP_LOGW(TAG, "Link lost: suspended %d implicit connection(s)", count);
+    
+    // Called from the network event handler, so the grace is waited out elsewhere;
+    // if the task cannot start, the slots are released when reused or closed
+    if (xTaskCreate(reap_task, "enip_reap", IMPLICIT_TASK_STACK_SIZE, (void *)(uintptr_t)dropped, 3, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to start the task releasing suspended connections");
+    }
+}
+
+// Reopens one suspended connection, retrying until it is open, closed by the
+// application, or the link goes down again
+static void resume_task(void *pvParameters)
+{
+    int index = (int)(intptr_t)pvParameters;
+    
+    // o_to_t_data stays owned by s_suspended[index]
+    xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+    suspended_connection_t entry = s_suspended[index];
+    TickType_t suspended_for = xTaskGetTickCount() - s_suspended_at;
+    xSemaphoreGive(s_connections_mutex);
+    
+    // An open must not reuse a dropped slot before its tasks have exited
+    if (suspended_for < pdMS_TO_TICKS(SUSPEND_GRACE_MS)) {
+        vTaskDelay(pdMS_TO_TICKS(SUSPEND_GRACE_MS) - suspended_for);
+    }
+    
+    while (true) {
+        esp_err_t ret;
+        if (entry.tag_connection) {
+            ret = implicit_open(&entry.ip_address, 0, 0, 0, entry.assembly_data_size_produced, entry.rpi_ms,
+                                entry.callback, entry.user_data, RESUME_OPEN_TIMEOUT_MS, true,
+                                entry.tag_name, &entry.route);
+        } else {
+            ret = implicit_open(&entry.ip_address, entry.assembly_instance_consumed,
+                                entry.assembly_instance_produced, entry.assembly_data_size_consumed,
+                                entry.assembly_data_size_produced, entry.rpi_ms, entry.callback, entry.user_data,
+                                RESUME_OPEN_TIMEOUT_MS, entry.exclusive_owner, NULL, NULL);
+        }
+        
+        uint8_t *restore = NULL;
+        uint16_t restore_length = 0;
+        xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+        suspended_connection_t *current = &s_suspended[index];
+        bool wanted = current->pending && current->generation == entry.generation;
+        bool done = !wanted || ret == ESP_OK || ret == ESP_ERR_INVALID_STATE;
+        if (wanted && done) {
+            // Opened, or the application opened this device again itself
+            current->pending = false;
+            restore = current->o_to_t_data;
+            restore_length = current->o_to_t_data_length;
+            current->o_to_t_data = NULL;
+        }
+        xSemaphoreGive(s_connections_mutex);
+        
+        if (ret == ESP_OK && !wanted) {
+            // Closed by the application, or the link dropped again, while this was opening
+            enip_scanner_implicit_close(&entry.ip_address, RESUME_OPEN_TIMEOUT_MS);
+        } else if (ret == ESP_OK) {
+            if (restore != NULL) {
+                enip_scanner_implicit_write_data(&entry.ip_address, restore, restore_length);
+            }
+            ESP_LOGI(TAG, "Resumed implicit connection to " IPSTR, IP2STR(&entry.ip_address));
+        }
+        enip_mem_free(restore);
+        if (done) {
+            break;
+        }
+        enip_clock_delay_ms(RESUME_RETRY_MS);
+    }
+    
+    vTaskDelete(NULL);
+}
+
+void implicit_resume_all(void)
+{
+    if (s_connections_mutex == NULL) {
+        return;
+    }
+    
+    // Every connection gets its own task so they come back in parallel
+    int started = 0;
+    xSemaphoreTake(s_connections_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        if (!s_suspended[i].pending) {
+            continue;
+        }
+        s_suspended[i].generation = ++s_link_generation;
+        if (xTaskCreate(resume_task, "enip_resume", IMPLICIT_TASK_STACK_SIZE, (void *)(intptr_t)i, 3, NULL) == pdPASS) {
+            started++;
+        }
+    }
+    xSemaphoreGive(s_connections_mutex);
+    
+    if (started > 0) {
+        ESP_LOGI(TAG, "Link up: reopening %d implicit connection(s)", started);
+    }
+}
+
+void implicit_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = sizeof(s_connections);
+    footprint->items = 0;
+    if (s_connections_mutex == NULL ||
+        xSemaphoreTake(s_connections_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    
+    for (int i = 0; i < MAX_IMPLICIT_CONNECTIONS; i++) {
+        const enip_implicit_connection_t *conn = &s_connections[i];
+        if (!conn->valid) {
+            continue;
+        }
+        // Receive and watchdog stacks, the O-to-T buffer of the callback
+        // wrapper and the O-to-T frame template
+        uint32_t stacks = (conn->receive_task_handle != NULL) ? 2 : 1;
+        footprint->items++;
+        footprint->bytes += stacks * IMPLICIT_TASK_STACK_SIZE + 2 * conn->assembly_data_size_consumed + 64;
+    }
+    if (s_o_to_t_task_handle != NULL) {
+        footprint->bytes += IMPLICIT_TASK_STACK_SIZE + s_o_to_t_staging_size;
+    }
+    xSemaphoreGive(s_connections_mutex);
+}
+
 #endif // CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
 
@@ -23,9 +23,14 @@
 #ifndef ENIP_SCANNER_IMPLICIT_INTERNAL_H
 #define ENIP_SCANNER_IMPLICIT_INTERNAL_H
 
+#include "enip_scanner.h"
+#include "enip_scanner_deadline_internal.h"
+#include "enip_scanner_context_internal.h"
 #include "lwip/ip4_addr.h"
+#include "lwip/sockets.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/types.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -33,14 +38,14 @@ extern "C" {
 #endif
 
 // Forward declarations for shared functions from enip_scanner.c
-int create_tcp_socket(const ip4_addr_t *ip_addr, uint32_t timeout_ms);
-esp_err_t register_session(int sock, uint32_t *session_handle);
+int create_tcp_socket(const ip4_addr_t *ip_addr, enip_deadline_t deadline);
+esp_err_t register_session(int sock, uint32_t *session_handle, enip_deadline_t deadline);
 void unregister_session(int sock, uint32_t session_handle);
-esp_err_t send_data(int sock, const void *data, size_t len);
-esp_err_t recv_data(int sock, void *data, size_t len, uint32_t timeout_ms, size_t *bytes_received);
-esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle, uint16_t assembly_instance, uint16_t *data_size, uint32_t timeout_ms);
-extern SemaphoreHandle_t s_scanner_mutex;
-extern bool s_scanner_initialized;
+esp_err_t send_data(int sock, const void *data, size_t len, enip_deadline_t deadline);
+esp_err_t recv_data(int sock, void *data, size_t len, enip_deadline_t deadline, size_t *bytes_received);
+esp_err_t set_socket_deadline(int sock, enip_deadline_t deadline);
+ssize_t recv_available(int sock, void *data, size_t len, enip_deadline_t deadline);
+esp_err_t enip_scanner_read_assembly_data_size(int sock, uint32_t session_handle, uint16_t assembly_instance, uint16_t *data_size, enip_deadline_t deadline);
 
 // EtherNet/IP constants
 #define ENIP_PORT 44818
@@ -62,7 +67,7 @@ extern bool s_scanner_initialized;
 #define CIP_PATH_INSTANCE 0x24
 #define CIP_PATH_ATTRIBUTE 0x30
 #define CIP_PATH_CONNECTION_POINT 0x2C
-#define CIP_PATH_ATTRIBUTE 0x30
+#define CIP_PATH_SYMBOLIC 0x91
 
 // CPF Item Types
 #define CPF_ITEM_NULL_ADDRESS 0x0000
@@ -106,13 +111,27 @@ typedef struct {
     uint32_t originator_serial_number;
     uint8_t priority_time_tick;  // Priority/Time Tick byte from Forward Open (must match in Forward Close)
     uint8_t timeout_ticks;  // Timeout Ticks from Forward Open (must match in Forward Close)
+    uint8_t priority;  // Connection priority from Forward Open (ENIP_SCANNER_PRIORITY_* values), selects the DSCP
     bool exclusive_owner;  // true = PTP (Point-to-Point), false = non-PTP (Multicast T-to-O)
+    bool tag_connection;  // Consumer of a Logix produced tag: symbolic connection path, heartbeat-only O->T
+    char tag_name[ENIP_SCANNER_PRODUCED_TAG_NAME_MAX + 1];
+    enip_scanner_route_t route;  // Route to the controller, prefixed to the tag's connection path
     enip_connection_state_t state;
     void *user_data;
+    enip_implicit_frame_callback_t frame_callback;  // Guarded by s_frame_callback_lock
+    void *frame_user_data;
     uint32_t last_packet_time;  // Time of last T->O packet received
     uint32_t last_heartbeat_time;  // Time of last O->T heartbeat sent
+    uint8_t *o_to_t_frame;  // Prebuilt O->T frame; sequences and assembly data are patched per send
+    uint16_t o_to_t_frame_size;
+    struct sockaddr_in o_to_t_addr;
+    uint32_t eip_sequence;
+    uint16_t cip_sequence;
+    int64_t o_to_t_next_us;  // esp_timer time the next O->T frame is due
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+    struct udp_pcb *raw_pcb;  // T->O receive PCB; set and cleared only in the lwIP thread
+#endif
     bool valid;
-    TaskHandle_t heartbeat_task_handle;
     TaskHandle_t receive_task_handle;
     TaskHandle_t watchdog_task_handle;
 } enip_implicit_connection_t;
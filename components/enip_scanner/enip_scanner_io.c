@@ -0,0 +1,556 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "enip_scanner_link_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner_clock_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+
+static const char *TAG = "enip_scanner_io";
+
+#define IO_TASK_PERIOD_MS 20
+#define IO_TASK_STACK_SIZE 6144
+
+// Input image for an implicit entry whose T-to-O size is autodetected: the
+// largest frame the implicit layer receives
+#define IO_INPUT_AUTODETECT_SIZE 512
+
+// The implicit data callback runs in the lwIP thread in raw receive mode
+#if CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX
+#define IO_CALLBACK_WAIT 0
+#else
+#define IO_CALLBACK_WAIT portMAX_DELAY
+#endif
+
+typedef struct {
+    enip_scanner_io_entry_t entry;
+    enip_scanner_route_t route;
+    enip_scanner_io_status_t status;
+    TickType_t next_due;                        // Next poll, or next reopen attempt
+    uint8_t last_value[ENIP_SCANNER_IO_VALUE_MAX];
+    uint16_t last_length;
+    uint32_t last_hash;                         // Of the whole value, which may be longer than last_value
+    uint8_t *input;                             // Implicit: latest T-to-O data
+    uint16_t input_length;
+    uint16_t input_capacity;
+} io_slot_t;
+
+static io_slot_t *s_slots = NULL;
+static size_t s_slot_count = 0;
+static SemaphoreHandle_t s_io_mutex = NULL;
+static SemaphoreHandle_t s_bringup_done = NULL;
+static TaskHandle_t s_io_task_handle = NULL;
+static volatile bool s_io_running = false;
+static volatile bool s_link_down = false;     // Polls and silence checks wait for the link
+static size_t s_bringup_next = 0;
+static TickType_t s_start_tick = 0;
+static enip_scanner_io_data_callback_t s_callback = NULL;
+static void *s_callback_user_data = NULL;
+
+static uint32_t ticks_to_ms(TickType_t ticks)
+{
+    return (uint32_t)(ticks * portTICK_PERIOD_MS);
+}
+
+static void io_notify(size_t index, const uint8_t *data, uint16_t data_length)
+{
+    enip_scanner_io_data_callback_t callback = s_callback;
+    if (callback != NULL) {
+        callback(index, &s_slots[index].entry, data, data_length, s_callback_user_data);
+    }
+}
+
+static void io_set_state(io_slot_t *slot, enip_scanner_io_state_t state, esp_err_t result)
+{
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    if (state == ENIP_IO_STATE_RUNNING && slot->status.up_time_ms == 0) {
+        slot->status.up_time_ms = ticks_to_ms(enip_clock_ticks() - s_start_tick);
+    }
+    if (state == ENIP_IO_STATE_FAILED) {
+        slot->status.failures++;
+    }
+    slot->status.state = state;
+    slot->status.last_result = result;
+    xSemaphoreGive(s_io_mutex);
+}
+
+// Deliver a polled value when it differs from the previous one
+// FNV-1a, so a change past the stored prefix of a long value is still seen
+static uint32_t io_value_hash(const uint8_t *data, uint16_t data_length)
+{
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < data_length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void io_publish_value(io_slot_t *slot, const uint8_t *data, uint16_t data_length)
+{
+    size_t index = slot - s_slots;
+    uint16_t stored = data_length < sizeof(slot->last_value) ? data_length : sizeof(slot->last_value);
+    uint32_t hash = io_value_hash(data, data_length);
+    bool changed = data_length != slot->last_length || hash != slot->last_hash ||
+                   memcmp(slot->last_value, data, stored) != 0;
+    
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    slot->status.updates++;
+    slot->status.last_update_ms = ticks_to_ms(enip_clock_ticks());
+    if (changed) {
+        slot->last_length = data_length;
+        slot->last_hash = hash;
+        memcpy(slot->last_value, data, stored);
+    }
+    xSemaphoreGive(s_io_mutex);
+    
+    if (changed) {
+        io_notify(index, data, data_length);
+    }
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+static void io_implicit_callback(const ip4_addr_t *ip_address, uint16_t assembly_instance,
+                                 const uint8_t *data, uint16_t data_length, void *user_data)
+{
+    (void)ip_address;
+    (void)assembly_instance;
+    io_slot_t *slot = (io_slot_t *)user_data;
+    
+    // With CONFIG_ENIP_SCANNER_IMPLICIT_RAW_RX this runs in the lwIP thread and
+    // must not wait: if the slot is busy this frame's bookkeeping is skipped,
+    // the next frame is one RPI away
+    if (xSemaphoreTake(s_io_mutex, IO_CALLBACK_WAIT) == pdTRUE) {
+        slot->status.updates++;
+        slot->status.last_update_ms = ticks_to_ms(enip_clock_ticks());
+        // Keep the input image for enip_scanner_io_read_input(); io_bring_up()
+        // sized it, so nothing is allocated here
+        uint16_t length = data_length < slot->input_capacity ? data_length : slot->input_capacity;
+        memcpy(slot->input, data, length);
+        slot->input_length = length;
+        xSemaphoreGive(s_io_mutex);
+    }
+    
+    io_notify(slot - s_slots, data, data_length);
+}
+
+// Same limit the implicit watchdog uses before it drops a silent connection
+static uint32_t io_implicit_silence_limit_ms(const enip_scanner_io_entry_t *entry)
+{
+    uint32_t limit = entry->period_ms * 20;
+    return limit < 10000 ? 10000 : limit;
+}
+#endif
+
+// Open the connection or take the first sample of one entry
+static void io_bring_up(io_slot_t *slot)
+{
+    const enip_scanner_io_entry_t *entry = &slot->entry;
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+    
+    io_set_state(slot, ENIP_IO_STATE_STARTING, ESP_OK);
+    
+    switch (entry->type) {
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    case ENIP_IO_ENTRY_IMPLICIT: {
+        // Sized before the callback can run: in raw receive mode it runs in the
+        // lwIP thread and must not allocate
+        uint16_t input_size = entry->size_produced != 0 ? entry->size_produced : IO_INPUT_AUTODETECT_SIZE;
+        xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+        if (slot->input_capacity < input_size) {
+            uint8_t *grown = enip_mem_realloc(ENIP_MEM_HOT, slot->input, input_size);
+            if (grown != NULL) {
+                slot->input = grown;
+                slot->input_capacity = input_size;
+            }
+        }
+        bool sized = slot->input_capacity >= input_size;
+        xSemaphoreGive(s_io_mutex);
+        if (!sized) {
+            ret = ESP_ERR_NO_MEM;
+            break;
+        }
+        
+        ret = enip_scanner_implicit_open(&entry->ip_address, entry->assembly_consumed, entry->assembly_produced,
+                                         entry->size_consumed, entry->size_produced, entry->period_ms,
+                                         io_implicit_callback, slot, CONFIG_ENIP_SCANNER_IO_OPEN_TIMEOUT_MS,
+                                         entry->exclusive_owner);
+        if (ret == ESP_OK) {
+            // Count the silence watchdog from the moment the connection opened
+            xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+            slot->status.last_update_ms = ticks_to_ms(enip_clock_ticks());
+            xSemaphoreGive(s_io_mutex);
+        }
+        break;
+    }
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+    case ENIP_IO_ENTRY_TAG: {
+        enip_scanner_tag_result_t result;
+        ret = enip_scanner_read_tag_routed(&entry->ip_address, &slot->route, entry->tag_path, &result,
+                                           CONFIG_ENIP_SCANNER_IO_OPEN_TIMEOUT_MS);
+        xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+        slot->status.error = result.error;
+        xSemaphoreGive(s_io_mutex);
+        if (ret == ESP_OK && result.success) {
+            io_publish_value(slot, result.data, result.data_length);
+        } else if (ret == ESP_OK) {
+            ret = ESP_FAIL;
+        }
+        enip_scanner_free_tag_result(&result);
+        break;
+    }
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
+    case ENIP_IO_ENTRY_MOTOMAN_STATUS: {
+        enip_scanner_motoman_status_t status;
+        ret = enip_scanner_motoman_read_status(&entry->ip_address, &status, CONFIG_ENIP_SCANNER_IO_OPEN_TIMEOUT_MS);
+        xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+        slot->status.error = status.error;
+        xSemaphoreGive(s_io_mutex);
+        if (ret == ESP_OK && status.success) {
+            uint8_t value[8];
+            memcpy(value, &status.data1, 4);
+            memcpy(value + 4, &status.data2, 4);
+            io_publish_value(slot, value, sizeof(value));
+        } else if (ret == ESP_OK) {
+            ret = ESP_FAIL;
+        }
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+    
+    TickType_t now = enip_clock_ticks();
+    if (ret == ESP_OK) {
+        io_set_state(slot, ENIP_IO_STATE_RUNNING, ESP_OK);
+        slot->next_due = now + pdMS_TO_TICKS(entry->period_ms);
+    } else {
+        ESP_LOGW(TAG, "Entry %u (" IPSTR ") failed to start: %s", (unsigned)(slot - s_slots),
+                 IP2STR(&entry->ip_address), esp_err_to_name(ret));
+        io_set_state(slot, ENIP_IO_STATE_FAILED, ret);
+        slot->next_due = now + pdMS_TO_TICKS(CONFIG_ENIP_SCANNER_IO_RETRY_MS);
+    }
+}
+
+// Bring-up worker: claims entries one at a time until none are left
+static void io_bringup_task(void *arg)
+{
+    (void)arg;
+    while (s_io_running) {
+        xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+        size_t index = s_bringup_next;
+        while (index < s_slot_count && !s_slots[index].entry.enabled) {
+            index++;
+        }
+        s_bringup_next = index + 1;
+        xSemaphoreGive(s_io_mutex);
+        
+        if (index >= s_slot_count) {
+            break;
+        }
+        io_bring_up(&s_slots[index]);
+    }
+    xSemaphoreGive(s_bringup_done);
+    vTaskDelete(NULL);
+}
+
+// Supervisor: keeps polled entries sampled and failed or silent connections reopened
+static void io_task(void *arg)
+{
+    int workers = (int)(intptr_t)arg;
+    
+    for (int i = 0; i < workers; i++) {
+        xSemaphoreTake(s_bringup_done, portMAX_DELAY);
+    }
+    
+    int running = 0;
+    int enabled = 0;
+    for (size_t i = 0; i < s_slot_count; i++) {
+        enabled += s_slots[i].entry.enabled ? 1 : 0;
+        running += s_slots[i].status.state == ENIP_IO_STATE_RUNNING ? 1 : 0;
+    }
+    ESP_LOGI(TAG, "I/O configuration up: %d of %d entries running after %lu ms", running, enabled,
+             (unsigned long)ticks_to_ms(enip_clock_ticks() - s_start_tick));
+    
+    while (s_io_running) {
+        TickType_t now = enip_clock_ticks();
+        
+        // Without a link every poll fails and every connection looks silent; the
+        // implicit layer reopens its connections itself once the link is back
+        if (s_link_down) {
+            enip_clock_delay_ms(IO_TASK_PERIOD_MS);
+            continue;
+        }
+        
+        for (size_t i = 0; i < s_slot_count && s_io_running; i++) {
+            io_slot_t *slot = &s_slots[i];
+            if (!slot->entry.enabled) {
+                continue;
+            }
+            
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+            if (slot->entry.type == ENIP_IO_ENTRY_IMPLICIT) {
+                if (slot->status.state == ENIP_IO_STATE_RUNNING) {
+                    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+                    uint32_t silent_ms = ticks_to_ms(now) - slot->status.last_update_ms;
+                    xSemaphoreGive(s_io_mutex);
+                    if (silent_ms > io_implicit_silence_limit_ms(&slot->entry)) {
+                        ESP_LOGW(TAG, "Entry %u: no T->O data for %lu ms, reopening", (unsigned)i,
+                                 (unsigned long)silent_ms);
+                        enip_scanner_implicit_close(&slot->entry.ip_address, CONFIG_ENIP_SCANNER_IO_OPEN_TIMEOUT_MS);
+                        io_set_state(slot, ENIP_IO_STATE_FAILED, ESP_ERR_TIMEOUT);
+                        slot->next_due = now;
+                    }
+                    continue;
+                }
+                if ((int32_t)(now - slot->next_due) >= 0) {
+                    io_bring_up(slot);
+                }
+                continue;
+            }
+#endif
+            // Polled entries: a failed entry retries on its own schedule in io_bring_up()
+            if ((int32_t)(now - slot->next_due) >= 0) {
+                io_bring_up(slot);
+            }
+        }
+        
+        enip_clock_delay_ms(IO_TASK_PERIOD_MS);
+    }
+    
+    s_io_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t enip_scanner_io_start(const enip_scanner_io_entry_t *entries, size_t count)
+{
+    if (count > 0 && entries == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (count > CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (s_io_mutex == NULL) {
+        s_io_mutex = xSemaphoreCreateMutex();
+        s_bringup_done = xSemaphoreCreateCounting(CONFIG_ENIP_SCANNER_IO_BRINGUP_WORKERS, 0);
+        if (s_io_mutex == NULL || s_bringup_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_io_running || s_io_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count == 0) {
+        return ESP_OK;
+    }
+    
+    io_slot_t *slots = enip_mem_calloc(ENIP_MEM_HOT, count, sizeof(io_slot_t));
+    if (slots == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < count; i++) {
+        slots[i].entry = entries[i];
+        slots[i].entry.tag_path[sizeof(slots[i].entry.tag_path) - 1] = '\0';
+        slots[i].entry.route[sizeof(slots[i].entry.route) - 1] = '\0';
+        if (slots[i].entry.period_ms == 0) {
+            slots[i].entry.period_ms = 100;
+        }
+        if (slots[i].entry.route[0] != '\0' &&
+            enip_scanner_route_parse(slots[i].entry.route, &slots[i].route) != ESP_OK) {
+            ESP_LOGW(TAG, "Entry %u: invalid route '%s', entry disabled", (unsigned)i, slots[i].entry.route);
+            slots[i].entry.enabled = false;
+        }
+        slots[i].status.state = slots[i].entry.enabled ? ENIP_IO_STATE_STARTING : ENIP_IO_STATE_DISABLED;
+    }
+    
+    for (size_t i = 0; i < s_slot_count; i++) {
+        enip_mem_free(s_slots[i].input);
+    }
+    enip_mem_free(s_slots);
+    s_slots = slots;
+    s_slot_count = count;
+    s_bringup_next = 0;
+    s_start_tick = enip_clock_ticks();
+    s_io_running = true;
+    
+    // All entries come up in parallel, limited by the number of bring-up workers
+    int workers = CONFIG_ENIP_SCANNER_IO_BRINGUP_WORKERS;
+    if ((size_t)workers > count) {
+        workers = (int)count;
+    }
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        if (xTaskCreate(io_bringup_task, "enip_io_up", IO_TASK_STACK_SIZE, NULL, 4, NULL) == pdPASS) {
+            started++;
+        }
+    }
+    if (started == 0 ||
+        xTaskCreate(io_task, "enip_io", IO_TASK_STACK_SIZE, (void *)(intptr_t)started, 3, &s_io_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create I/O configuration tasks");
+        s_io_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "Bringing up %u I/O entries with %d workers", (unsigned)count, started);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_io_stop(uint32_t timeout_ms)
+{
+    if (s_io_mutex == NULL || (!s_io_running && s_io_task_handle == NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_io_running = false;
+    
+    // Bring-up workers and the supervisor finish their current step and exit
+    while (s_io_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(IO_TASK_PERIOD_MS));
+    }
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    for (size_t i = 0; i < s_slot_count; i++) {
+        io_slot_t *slot = &s_slots[i];
+        if (slot->entry.type == ENIP_IO_ENTRY_IMPLICIT && slot->status.state == ENIP_IO_STATE_RUNNING) {
+            enip_scanner_implicit_close(&slot->entry.ip_address, timeout_ms);
+        }
+    }
+#else
+    (void)timeout_ms;
+#endif
+    
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_slot_count; i++) {
+        s_slots[i].status.state = ENIP_IO_STATE_DISABLED;
+    }
+    xSemaphoreGive(s_io_mutex);
+    return ESP_OK;
+}
+
+void io_link_changed(bool up)
+{
+    s_link_down = !up;
+    if (!up || s_io_mutex == NULL) {
+        return;
+    }
+    
+    TickType_t now = enip_clock_ticks();
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_slot_count; i++) {
+        io_slot_t *slot = &s_slots[i];
+        if (slot->entry.type == ENIP_IO_ENTRY_IMPLICIT && slot->status.state == ENIP_IO_STATE_RUNNING) {
+            // Give the resumed connection a full silence period to deliver data
+            slot->status.last_update_ms = ticks_to_ms(now);
+        } else {
+            // Polls and failed entries go again right away instead of at their next retry
+            slot->next_due = now;
+        }
+    }
+    xSemaphoreGive(s_io_mutex);
+}
+
+size_t enip_scanner_io_get_count(void)
+{
+    return s_slot_count;
+}
+
+void io_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = 0;
+    footprint->items = 0;
+    if (s_io_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    footprint->items = s_slot_count;
+    footprint->bytes = s_slot_count * sizeof(io_slot_t) + (s_io_task_handle != NULL ? IO_TASK_STACK_SIZE : 0);
+    for (size_t i = 0; i < s_slot_count; i++) {
+        footprint->bytes += s_slots[i].input_capacity;
+    }
+    xSemaphoreGive(s_io_mutex);
+}
+
+esp_err_t enip_scanner_io_get_status(size_t index, enip_scanner_io_entry_t *entry, enip_scanner_io_status_t *status)
+{
+    if (s_io_mutex == NULL || index >= s_slot_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    if (entry != NULL) {
+        *entry = s_slots[index].entry;
+    }
+    if (status != NULL) {
+        *status = s_slots[index].status;
+    }
+    xSemaphoreGive(s_io_mutex);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_io_read_input(size_t index, uint8_t *data, uint16_t max_length, uint16_t *data_length)
+{
+    if (data == NULL || data_length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_io_mutex == NULL || index >= s_slot_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    xSemaphoreTake(s_io_mutex, portMAX_DELAY);
+    io_slot_t *slot = &s_slots[index];
+    const uint8_t *input = slot->entry.type == ENIP_IO_ENTRY_IMPLICIT ? slot->input : slot->last_value;
+    uint16_t length = slot->entry.type == ENIP_IO_ENTRY_IMPLICIT ? slot->input_length : slot->last_length;
+    if (length > ENIP_SCANNER_IO_VALUE_MAX && slot->entry.type != ENIP_IO_ENTRY_IMPLICIT) {
+        length = ENIP_SCANNER_IO_VALUE_MAX;
+    }
+    esp_err_t ret = ESP_OK;
+    if (slot->status.updates == 0 || length == 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        *data_length = length < max_length ? length : max_length;
+        memcpy(data, input, *data_length);
+    }
+    xSemaphoreGive(s_io_mutex);
+    return ret;
+}
+
+void enip_scanner_io_set_callback(enip_scanner_io_data_callback_t callback, void *user_data)
+{
+    s_callback_user_data = user_data;
+    s_callback = callback;
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_LINK_INTERNAL_H
+#define ENIP_SCANNER_LINK_INTERNAL_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Link-state handling, driven by enip_scanner_notify_link_down()/_up() (enip_scanner.c).
+// implicit_suspend_all() drops every open implicit connection without a Forward
+// Close and keeps its parameters and O-to-T image; implicit_resume_all() reopens
+// the suspended ones, one task per connection. Neither waits, so both are safe to
+// call from an event handler; a short-lived task releases the dropped slots once
+// their tasks have exited. io_link_changed() holds the I/O
+// supervisor's polls and silence checks while the link is down.
+void implicit_suspend_all(void);
+void implicit_resume_all(void);
+void io_link_changed(bool up);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_LINK_INTERNAL_H
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_log_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static portMUX_TYPE s_log_lock = portMUX_INITIALIZER_UNLOCKED;
+static enip_scanner_log_stats_t s_log_stats;
+
+bool enip_log_allow(enip_log_site_t *site, uint32_t *suppressed)
+{
+    const TickType_t interval = pdMS_TO_TICKS(CONFIG_ENIP_SCANNER_LOG_INTERVAL_MS) > 0 ?
+                                pdMS_TO_TICKS(CONFIG_ENIP_SCANNER_LOG_INTERVAL_MS) : 1;
+    TickType_t now = xTaskGetTickCount();
+    bool allow = false;
+    
+    taskENTER_CRITICAL(&s_log_lock);
+    if (site->spent > 0) {
+        TickType_t refill = (now - site->last_refill) / interval;
+        if (refill >= site->spent) {
+            site->spent = 0;
+        } else {
+            site->spent -= refill;
+            site->last_refill += refill * interval;
+        }
+    }
+    if (site->spent < CONFIG_ENIP_SCANNER_LOG_BURST) {
+        if (site->spent == 0) {
+            site->last_refill = now;
+        }
+        site->spent++;
+        *suppressed = site->suppressed;
+        site->suppressed = 0;
+        s_log_stats.emitted++;
+        allow = true;
+    } else {
+        site->suppressed++;
+        s_log_stats.suppressed++;
+    }
+    taskEXIT_CRITICAL(&s_log_lock);
+    
+    return allow;
+}
+
+esp_err_t enip_scanner_get_log_stats(enip_scanner_log_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_log_lock);
+    *stats = s_log_stats;
+    taskEXIT_CRITICAL(&s_log_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_LOG_INTERNAL_H
+#define ENIP_SCANNER_LOG_INTERNAL_H
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Token bucket of one call site. Zero-initialised means a full bucket.
+typedef struct {
+    TickType_t last_refill;
+    uint16_t spent;                     // Tokens used out of CONFIG_ENIP_SCANNER_LOG_BURST
+    uint32_t suppressed;                // Messages dropped since the last one emitted
+} enip_log_site_t;
+
+// Take a token for the call site. Returns false if the message must be dropped;
+// otherwise *suppressed gets the number dropped since the site last logged.
+bool enip_log_allow(enip_log_site_t *site, uint32_t *suppressed);
+
+// Log at most CONFIG_ENIP_SCANNER_LOG_BURST messages from this call site, then
+// one per CONFIG_ENIP_SCANNER_LOG_INTERVAL_MS. The next message after a
+// suppressed run reports how many were dropped.
+#define ENIP_LOG_LIMITED(level, tag, format, ...) do {                                      \
+        static enip_log_site_t _enip_log_site;                                              \
+        uint32_t _enip_log_dropped;                                                         \
+        if (enip_log_allow(&_enip_log_site, &_enip_log_dropped)) {                          \
+            ESP_LOG_LEVEL_LOCAL(level, tag, format, ##__VA_ARGS__);                         \
+            if (_enip_log_dropped > 0) {                                                    \
+                ESP_LOG_LEVEL_LOCAL(level, tag, "  (%lu similar messages suppressed)",      \
+                                    (unsigned long)_enip_log_dropped);                      \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+// Rate-limited log for per-packet paths (implicit receive and heartbeat loops).
+// Levels above CONFIG_ENIP_SCANNER_HOT_LOG_LEVEL are removed at compile time.
+#define ENIP_LOG_HOT(level, tag, format, ...) do {                                          \
+        if ((level) <= CONFIG_ENIP_SCANNER_HOT_LOG_LEVEL) {                                 \
+            ENIP_LOG_LIMITED(level, tag, format, ##__VA_ARGS__);                            \
+        }                                                                                   \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_LOG_INTERNAL_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+
+#define HOT_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define COLD_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+static portMUX_TYPE s_mem_lock = portMUX_INITIALIZER_UNLOCKED;
+static enip_scanner_memory_tier_stats_t s_stats;
+
+// Adds or removes one block from the usage of the tier it landed in
+static void mem_account(void *ptr, bool add)
+{
+    uint32_t size = heap_caps_get_allocated_size(ptr);
+    bool external = esp_ptr_external_ram(ptr);
+    
+    taskENTER_CRITICAL(&s_mem_lock);
+    uint32_t *bytes = external ? &s_stats.psram_bytes : &s_stats.internal_bytes;
+    uint32_t *peak = external ? &s_stats.psram_peak : &s_stats.internal_peak;
+    if (add) {
+        *bytes += size;
+        if (*bytes > *peak) {
+            *peak = *bytes;
+        }
+    } else {
+        *bytes -= size < *bytes ? size : *bytes;
+    }
+    taskEXIT_CRITICAL(&s_mem_lock);
+}
+
+static void mem_count(uint32_t *counter)
+{
+    taskENTER_CRITICAL(&s_mem_lock);
+    (*counter)++;
+    taskEXIT_CRITICAL(&s_mem_lock);
+}
+
+void *enip_mem_alloc(enip_mem_tier_t tier, size_t size)
+{
+    void *ptr = NULL;
+    if (tier == ENIP_MEM_COLD) {
+        ptr = heap_caps_malloc(size, COLD_CAPS);
+        if (ptr == NULL) {
+            mem_count(&s_stats.psram_fallbacks);
+        }
+    }
+    if (ptr == NULL) {
+        ptr = heap_caps_malloc(size, HOT_CAPS);
+    }
+    
+    if (ptr != NULL) {
+        mem_account(ptr, true);
+    } else if (size > 0) {
+        mem_count(&s_stats.failures);
+    }
+    return ptr;
+}
+
+void *enip_mem_calloc(enip_mem_tier_t tier, size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *ptr = enip_mem_alloc(tier, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void *enip_mem_realloc(enip_mem_tier_t tier, void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return enip_mem_alloc(tier, size);
+    }
+    if (size == 0) {
+        enip_mem_free(ptr);
+        return NULL;
+    }
+    
+    // The block may move between tiers, so take it out and put the result back
+    mem_account(ptr, false);
+    void *grown = NULL;
+    if (tier == ENIP_MEM_COLD) {
+        grown = heap_caps_realloc(ptr, size, COLD_CAPS);
+        if (grown == NULL) {
+            mem_count(&s_stats.psram_fallbacks);
+        }
+    }
+    if (grown == NULL) {
+        grown = heap_caps_realloc(ptr, size, HOT_CAPS);
+    }
+    
+    if (grown == NULL) {
+        // The original block is untouched
+        mem_account(ptr, true);
+        mem_count(&s_stats.failures);
+        return NULL;
+    }
+    mem_account(grown, true);
+    return grown;
+}
+
+void enip_mem_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    mem_account(ptr, false);
+    heap_caps_free(ptr);
+}
+
+esp_err_t enip_scanner_get_memory_tier_stats(enip_scanner_memory_tier_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_mem_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_mem_lock);
+    stats->psram_total = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    stats->psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    return ESP_OK;
+}
+
+#else
+
+void *enip_mem_alloc(enip_mem_tier_t tier, size_t size)
+{
+    (void)tier;
+    return malloc(size);
+}
+
+void *enip_mem_calloc(enip_mem_tier_t tier, size_t count, size_t size)
+{
+    (void)tier;
+    return calloc(count, size);
+}
+
+void *enip_mem_realloc(enip_mem_tier_t tier, void *ptr, size_t size)
+{
+    (void)tier;
+    return realloc(ptr, size);
+}
+
+void enip_mem_free(void *ptr)
+{
+    free(ptr);
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
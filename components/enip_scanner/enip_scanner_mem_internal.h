@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_MEM_INTERNAL_H
+#define ENIP_SCANNER_MEM_INTERNAL_H
+
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory tiers for scanner allocations. HOT is for data touched on every
+// packet or cycle (callback buffers, input images, queued writes) and always
+// comes from internal RAM. COLD is for large, rarely touched data (caches,
+// trace rings) and comes from PSRAM when CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+// is set, falling back to internal RAM when PSRAM is full. Memory taken with
+// enip_mem_alloc()/_calloc()/_realloc() must be released with enip_mem_free()
+// so the per-tier usage stays right. Without the option all map to the C heap.
+typedef enum {
+    ENIP_MEM_HOT = 0,
+    ENIP_MEM_COLD,
+} enip_mem_tier_t;
+
+void *enip_mem_alloc(enip_mem_tier_t tier, size_t size);
+void *enip_mem_calloc(enip_mem_tier_t tier, size_t count, size_t size);
+void *enip_mem_realloc(enip_mem_tier_t tier, void *ptr, size_t size);
+void enip_mem_free(void *ptr);
+
+// Static tables that belong in the cold tier; needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+#define ENIP_MEM_COLD_BSS EXT_RAM_BSS_ATTR
+#else
+#define ENIP_MEM_COLD_BSS
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_MEM_INTERNAL_H
@@ -22,6 +22,9 @@
 
 #include "enip_scanner_motoman_internal.h"
 #include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_session_internal.h"
+#include "enip_scanner_buffer_internal.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "freertos/task.h"
@@ -35,16 +38,14 @@
 
 static const char *TAG = "enip_scanner_motoman";
 
-static bool s_motoman_rs022_instance_direct = false;
-
 void enip_scanner_motoman_set_rs022_instance_direct(bool instance_direct)
 {
-    s_motoman_rs022_instance_direct = instance_direct;
+    atomic_store(&s_scanner_ctx.motoman_rs022_instance_direct, instance_direct);
 }
 
 bool enip_scanner_motoman_get_rs022_instance_direct(void)
 {
-    return s_motoman_rs022_instance_direct;
+    return atomic_load(&s_scanner_ctx.motoman_rs022_instance_direct);
 }
 
 // ============================================================================
@@ -138,12 +139,12 @@ static esp_err_t build_motoman_cip_path(uint16_t cip_class, uint16_t instance, u
 
 static uint16_t motoman_variable_instance(uint16_t variable_number)
 {
-    return variable_number + (s_motoman_rs022_instance_direct ? 0 : 1);
+    return variable_number + (enip_scanner_motoman_get_rs022_instance_direct() ? 0 : 1);
 }
 
 static uint16_t motoman_register_instance(uint16_t register_number)
 {
-    return register_number + (s_motoman_rs022_instance_direct ? 0 : 1);
+    return register_number + (enip_scanner_motoman_get_rs022_instance_direct() ? 0 : 1);
 }
 
 /**
@@ -154,56 +155,25 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
                                           const uint8_t *data, uint16_t data_length,
                                           uint8_t *response_buffer, size_t response_buffer_size,
                                           size_t *response_length, uint32_t timeout_ms,
-                                          char *error_message) {
+                                          enip_scanner_error_t *error) {
     if (ip_address == NULL || response_buffer == NULL || response_length == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to acquire mutex");
-        }
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
+    if (!scanner_is_ready()) {
+        enip_error_set(error, ENIP_ERR_NOT_INITIALIZED);
         return ESP_ERR_INVALID_STATE;
     }
     
-    // Create TCP socket
-    int sock = create_tcp_socket(ip_address, timeout_ms);
-    if (sock < 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to connect to device");
-        }
-        return ESP_FAIL;
-    }
+    // Every Motoman call is a single request, so its deadline lives here
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
     
-    // Register session
+    // Connect and register a session, or reuse a pooled one
+    int sock = -1;
     uint32_t session_handle = 0;
-    esp_err_t ret = register_session(sock, &session_handle);
+    esp_err_t ret = session_acquire(ip_address, deadline, &sock, &session_handle, error);
     if (ret != ESP_OK) {
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to register session: %s", esp_err_to_name(ret));
-        }
         return ret;
     }
     
@@ -215,11 +185,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     ret = build_motoman_cip_path(cip_class, instance, attribute, include_attribute,
                                  cip_path, sizeof(cip_path), &path_size_words);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to build CIP path");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_PATH_ENCODE);
         return ret;
     }
     
@@ -233,13 +200,10 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     
     // Build packet
     size_t total_packet_size = 24 + enip_data_length;  // ENIP header + data
-    uint8_t *packet = malloc(total_packet_size);
+    uint8_t *packet = enip_buffer_alloc(total_packet_size);
     if (packet == NULL) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to allocate memory");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_NO_MEMORY);
         return ESP_ERR_NO_MEM;
     }
     
@@ -274,7 +238,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     offset += 4;
     
     // Timeout
-    uint8_t cip_timeout = (timeout_ms / 1000) > 255 ? 255 : (timeout_ms / 1000);
+    uint32_t remaining_ms = enip_deadline_remaining_ms(deadline);
+    uint8_t cip_timeout = (remaining_ms / 1000) > 255 ? 255 : (remaining_ms / 1000);
     if (cip_timeout == 0) cip_timeout = 1;
     memcpy(packet + offset, &cip_timeout, 1);
     offset += 1;
@@ -314,27 +279,21 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     }
     
     // Send packet
-    ret = send_data(sock, packet, offset);
-    free(packet);
+    ret = send_data(sock, packet, offset, deadline);
+    enip_buffer_free(packet);
     
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to send CIP message");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SEND);
         return ret;
     }
     
     // Receive response
     uint8_t response[512];
-    ssize_t recv_ret = recv(sock, response, sizeof(response), 0);
+    ssize_t recv_ret = recv_available(sock, response, sizeof(response), deadline);
     if (recv_ret < 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to receive response: %d", errno);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_errno(error, ENIP_ERR_RECV, errno);
         return ESP_FAIL;
     }
     
@@ -343,15 +302,17 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     // Try to read more if we got very little data (TCP may deliver in multiple packets)
     // But only try once with a short timeout to avoid hanging
     if (bytes_received < 40 && bytes_received < sizeof(response)) {
-        // Set a short timeout for the second read attempt (100ms)
-        struct timeval short_timeout = { .tv_sec = 0, .tv_usec = 100000 };
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &short_timeout, sizeof(short_timeout));
+        // Set a short timeout for the second read attempt (100ms, never past the deadline)
+        enip_deadline_t short_deadline = enip_deadline_from_timeout(100);
+        if ((int32_t)(short_deadline - deadline) > 0) {
+            short_deadline = deadline;
+        }
         
-        recv_ret = recv(sock, response + bytes_received, sizeof(response) - bytes_received, 0);
+        recv_ret = recv_available(sock, response + bytes_received, sizeof(response) - bytes_received, short_deadline);
         if (recv_ret > 0) {
             bytes_received += (size_t)recv_ret;
         }
-        // Note: We're closing the socket soon anyway, so no need to restore timeout
+        // Note: every later socket call re-applies the deadline, so no need to restore a timeout
     }
     
     // Find SendRRData command in response
@@ -365,11 +326,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     }
     
     if (header_offset + 24 > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -378,11 +336,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     memcpy(&response_header, response + header_offset, sizeof(response_header));
     
     if (response_header.status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "ENIP error status: 0x%08lX", (unsigned long)response_header.status);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_ENCAP_STATUS, response_header.status);
         return ESP_FAIL;
     }
     
@@ -397,11 +352,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     
     size_t enip_data_offset = header_offset + 24;
     if (enip_data_offset + 16 > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "ENIP data too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -413,11 +365,8 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     
     // Read Item 2: Unconnected Data Item
     if (item_offset + 4 > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Data item header too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_ITEM_LENGTH);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -426,77 +375,29 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     item_offset += 4;
     
     if (response_data_item_type != 0x00B2) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Unexpected data item type: 0x%04X", response_data_item_type);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_ITEM_TYPE, response_data_item_type);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     // CIP response: [service|0x80][reserved][general status][additional status size][additional status...][data]
     if (item_offset + 4 > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "CIP response too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_CIP_SHORT);
         return ESP_ERR_INVALID_RESPONSE;
     }
 
     uint8_t cip_general_status = response[item_offset + 2];
     uint8_t cip_additional_status_size = response[item_offset + 3]; // size in 16-bit words
     if (cip_general_status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            const char* status_msg = (cip_general_status == 0x01) ? "Connection failure" :
-                                     (cip_general_status == 0x02) ? "Resource unavailable" :
-                                     (cip_general_status == 0x03) ? "Invalid parameter value" :
-                                     (cip_general_status == 0x04) ? "Path segment error" :
-                                     (cip_general_status == 0x05) ? "Path destination unknown (Object does not exist)" :
-                                     (cip_general_status == 0x06) ? "Partial transfer" :
-                                     (cip_general_status == 0x07) ? "Connection lost" :
-                                     (cip_general_status == 0x08) ? "Service not supported" :
-                                     (cip_general_status == 0x09) ? "Invalid attribute value" :
-                                     (cip_general_status == 0x0A) ? "Attribute list error" :
-                                     (cip_general_status == 0x0B) ? "Already in requested mode" :
-                                     (cip_general_status == 0x0C) ? "Object state conflict" :
-                                     (cip_general_status == 0x0D) ? "Object already exists" :
-                                     (cip_general_status == 0x0E) ? "Attribute not settable" :
-                                     (cip_general_status == 0x0F) ? "Privilege violation" :
-                                     (cip_general_status == 0x10) ? "Device state conflict" :
-                                     (cip_general_status == 0x11) ? "Reply data too large" :
-                                     (cip_general_status == 0x12) ? "Fragmentation of a primitive value" :
-                                     (cip_general_status == 0x13) ? "Not enough data" :
-                                     (cip_general_status == 0x14) ? "Attribute not supported" :
-                                     (cip_general_status == 0x15) ? "Too much data" :
-                                     (cip_general_status == 0x16) ? "Object does not exist" :
-                                     (cip_general_status == 0x17) ? "Service fragmentation sequence not in progress" :
-                                     (cip_general_status == 0x18) ? "No stored attribute data" :
-                                     (cip_general_status == 0x19) ? "Store operation failure" :
-                                     (cip_general_status == 0x1A) ? "Routing failure - request packet too large" :
-                                     (cip_general_status == 0x1B) ? "Routing failure - response packet too large" :
-                                     (cip_general_status == 0x1C) ? "Missing attribute list entry data" :
-                                     (cip_general_status == 0x1D) ? "Invalid attribute value list" :
-                                     (cip_general_status == 0x1E) ? "Embedded service error" :
-                                     (cip_general_status == 0x1F) ? "Vendor specific error" :
-                                     (cip_general_status == 0x20) ? "Invalid parameter" :
-                                     (cip_general_status == 0x21) ? "Write-once value or medium already written" :
-                                     (cip_general_status == 0x22) ? "Invalid reply received" :
-                                     (cip_general_status == 0x23) ? "Buffer overflow" :
-                                     (cip_general_status == 0x24) ? "Message format error" :
-                                     (cip_general_status == 0x25) ? "Key failure in path" :
-                                     (cip_general_status == 0x26) ? "Path size invalid" :
-                                     (cip_general_status == 0x27) ? "Unexpected attribute in list" :
-                                     (cip_general_status == 0x28) ? "Invalid member ID" :
-                                     (cip_general_status == 0x29) ? "Member not settable" :
-                                     (cip_general_status == 0x2A) ? "Group 2 only server general failure" :
-                                     (cip_general_status == 0x2B) ? "Unknown Modbus error" :
-                                     (cip_general_status == 0x81) ? "Vendor-specific: Invalid instance or attribute (Motoman)" :
-                                     "Vendor-specific or extended error";
-            snprintf(error_message, 128, "CIP error status: 0x%02X (%s)", cip_general_status, status_msg);
-        }
+        session_release(sock, session_handle, false);
+        uint16_t ext_status = 0;
+        uint8_t ext_words = 0;
+        if (cip_additional_status_size > 0 && item_offset + 6 <= bytes_received) {
+            ext_status = response[item_offset + 4] | (response[item_offset + 5] << 8);
+            ext_words = cip_additional_status_size;
+        }
+        enip_error_set_cip(error, cip_general_status, ext_words, ext_status);
         return ESP_FAIL;
     }
     
@@ -574,8 +475,9 @@ static esp_err_t send_motoman_cip_message(const ip4_addr_t *ip_address, uint16_t
     }
     *response_length = copy_length;
     
-    unregister_session(sock, session_handle);
-    close(sock);
+    // Only a session whose whole reply was consumed can serve the next request
+    bool complete = bytes_received == (size_t)header_offset + sizeof(enip_header_t) + response_header.length;
+    session_release(sock, session_handle, complete);
     
     return ESP_OK;
 }
@@ -591,26 +493,26 @@ esp_err_t enip_scanner_motoman_read_status(const ip4_addr_t *ip_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(status, 0, sizeof(enip_scanner_motoman_status_t));
+    // Only the status fields are reset; data fields are valid when success is true
     status->ip_address = *ip_address;
+    status->success = false;
+    enip_error_clear(&status->error);
     
     // Read Class 0x72, Instance 1, Get_Attribute_All (reads both Data 1 and Data 2)
     uint8_t response[16];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_STATUS, 1, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &status->error);
     
     if (ret != ESP_OK) {
-        snprintf(status->error_message, sizeof(status->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 8) {
-        snprintf(status->error_message, sizeof(status->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&status->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -625,11 +527,9 @@ esp_err_t enip_scanner_motoman_read_status(const ip4_addr_t *ip_address,
 }
 
 esp_err_t enip_scanner_motoman_read_io(const ip4_addr_t *ip_address, uint16_t signal_number,
-                                       uint8_t *value, uint32_t timeout_ms, char *error_message) {
+                                       uint8_t *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -638,24 +538,18 @@ esp_err_t enip_scanner_motoman_read_io(const ip4_addr_t *ip_address, uint16_t si
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_IO_DATA, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 1) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -664,11 +558,9 @@ esp_err_t enip_scanner_motoman_read_io(const ip4_addr_t *ip_address, uint16_t si
 }
 
 esp_err_t enip_scanner_motoman_write_io(const ip4_addr_t *ip_address, uint16_t signal_number,
-                                        uint8_t value, uint32_t timeout_ms, char *error_message) {
+                                        uint8_t value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -678,17 +570,13 @@ esp_err_t enip_scanner_motoman_write_io(const ip4_addr_t *ip_address, uint16_t s
     uint8_t data[1] = {value};
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_IO_DATA, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 1,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -696,11 +584,9 @@ esp_err_t enip_scanner_motoman_write_io(const ip4_addr_t *ip_address, uint16_t s
 }
 
 esp_err_t enip_scanner_motoman_read_variable_b(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               uint8_t *value, uint32_t timeout_ms, char *error_message) {
+                                               uint8_t *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -709,24 +595,18 @@ esp_err_t enip_scanner_motoman_read_variable_b(const ip4_addr_t *ip_address, uin
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_B, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 1) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -735,11 +615,9 @@ esp_err_t enip_scanner_motoman_read_variable_b(const ip4_addr_t *ip_address, uin
 }
 
 esp_err_t enip_scanner_motoman_write_variable_b(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 uint8_t value, uint32_t timeout_ms, char *error_message) {
+                                                 uint8_t value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -747,17 +625,13 @@ esp_err_t enip_scanner_motoman_write_variable_b(const ip4_addr_t *ip_address, ui
     uint8_t data[1] = {value};
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_B, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 1,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -765,11 +639,9 @@ esp_err_t enip_scanner_motoman_write_variable_b(const ip4_addr_t *ip_address, ui
 }
 
 esp_err_t enip_scanner_motoman_read_variable_i(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               int16_t *value, uint32_t timeout_ms, char *error_message) {
+                                               int16_t *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -777,24 +649,18 @@ esp_err_t enip_scanner_motoman_read_variable_i(const ip4_addr_t *ip_address, uin
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_I, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 2) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -803,11 +669,9 @@ esp_err_t enip_scanner_motoman_read_variable_i(const ip4_addr_t *ip_address, uin
 }
 
 esp_err_t enip_scanner_motoman_write_variable_i(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 int16_t value, uint32_t timeout_ms, char *error_message) {
+                                                 int16_t value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -817,17 +681,13 @@ esp_err_t enip_scanner_motoman_write_variable_i(const ip4_addr_t *ip_address, ui
     data[1] = (value >> 8) & 0xFF;
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_I, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 2,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -835,11 +695,9 @@ esp_err_t enip_scanner_motoman_write_variable_i(const ip4_addr_t *ip_address, ui
 }
 
 esp_err_t enip_scanner_motoman_read_variable_d(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               int32_t *value, uint32_t timeout_ms, char *error_message) {
+                                               int32_t *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -847,24 +705,18 @@ esp_err_t enip_scanner_motoman_read_variable_d(const ip4_addr_t *ip_address, uin
     
     uint8_t response[8];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_D, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 4) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -873,11 +725,9 @@ esp_err_t enip_scanner_motoman_read_variable_d(const ip4_addr_t *ip_address, uin
 }
 
 esp_err_t enip_scanner_motoman_write_variable_d(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 int32_t value, uint32_t timeout_ms, char *error_message) {
+                                                 int32_t value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -889,17 +739,13 @@ esp_err_t enip_scanner_motoman_write_variable_d(const ip4_addr_t *ip_address, ui
     data[3] = (value >> 24) & 0xFF;
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_D, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 4,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -907,11 +753,9 @@ esp_err_t enip_scanner_motoman_write_variable_d(const ip4_addr_t *ip_address, ui
 }
 
 esp_err_t enip_scanner_motoman_read_variable_r(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               float *value, uint32_t timeout_ms, char *error_message) {
+                                               float *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -919,24 +763,18 @@ esp_err_t enip_scanner_motoman_read_variable_r(const ip4_addr_t *ip_address, uin
     
     uint8_t response[8];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_R, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 4) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -947,11 +785,9 @@ esp_err_t enip_scanner_motoman_read_variable_r(const ip4_addr_t *ip_address, uin
 }
 
 esp_err_t enip_scanner_motoman_write_variable_r(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 float value, uint32_t timeout_ms, char *error_message) {
+                                                 float value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -965,17 +801,13 @@ esp_err_t enip_scanner_motoman_write_variable_r(const ip4_addr_t *ip_address, ui
     data[3] = (converter.u32 >> 24) & 0xFF;
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_R, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 4,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -983,11 +815,9 @@ esp_err_t enip_scanner_motoman_write_variable_r(const ip4_addr_t *ip_address, ui
 }
 
 esp_err_t enip_scanner_motoman_read_register(const ip4_addr_t *ip_address, uint16_t register_number,
-                                             uint16_t *value, uint32_t timeout_ms, char *error_message) {
+                                             uint16_t *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -996,24 +826,18 @@ esp_err_t enip_scanner_motoman_read_register(const ip4_addr_t *ip_address, uint1
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_REGISTER, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 2) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1022,11 +846,9 @@ esp_err_t enip_scanner_motoman_read_register(const ip4_addr_t *ip_address, uint1
 }
 
 esp_err_t enip_scanner_motoman_write_register(const ip4_addr_t *ip_address, uint16_t register_number,
-                                              uint16_t value, uint32_t timeout_ms, char *error_message) {
+                                              uint16_t value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1036,17 +858,13 @@ esp_err_t enip_scanner_motoman_write_register(const ip4_addr_t *ip_address, uint
     data[1] = (value >> 8) & 0xFF;
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_REGISTER, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 2,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -1064,16 +882,14 @@ static esp_err_t read_motoman_alarm_attributes(const ip4_addr_t *ip_address, uin
     // Response format: Alarm code (4) + Alarm data (4) + Alarm data type (4) + Date/time (16) + Alarm string (32) = 60 bytes
     uint8_t response[128];  // Large enough for 60 bytes + CIP headers
     size_t response_length = 0;
-    char error_msg[128];
     
     // Use Get_Attribute_All (0x01) with attribute 0 (omitted for Get_Attribute_All)
     // This reads all 5 attributes in one request: 60 bytes total
     esp_err_t ret = send_motoman_cip_message(ip_address, cip_class, instance, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &alarm->error);
     if (ret != ESP_OK) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "%s", error_msg);
         return ret;
     }
     
@@ -1081,8 +897,7 @@ static esp_err_t read_motoman_alarm_attributes(const ip4_addr_t *ip_address, uin
     // The actual alarm data is 60 bytes, but the response might have 8 bytes of path info before it
     // Check if we have enough data - need at least 52 bytes (60 - 8 for path), ideally 60
     if (response_length < 52) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), 
-                 "Alarm response too short: expected at least 52 bytes, got %zu bytes", response_length);
+        enip_error_set_detail(&alarm->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         ESP_LOGE(TAG, "Expected at least 52 bytes, got %zu bytes", response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
@@ -1118,7 +933,7 @@ static esp_err_t read_motoman_alarm_attributes(const ip4_addr_t *ip_address, uin
     
     // Attribute 1: Alarm code (4 bytes)
     if (available < 4) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "Not enough data for alarm code");
+        enip_error_set_detail(&alarm->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     alarm->alarm_code = (uint32_t)(response[offset] | (response[offset+1] << 8) | 
@@ -1128,7 +943,7 @@ static esp_err_t read_motoman_alarm_attributes(const ip4_addr_t *ip_address, uin
     
     // Attribute 2: Alarm data (4 bytes)
     if (available < 4) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "Not enough data for alarm data");
+        enip_error_set_detail(&alarm->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     alarm->alarm_data = (uint32_t)(response[offset] | (response[offset+1] << 8) | 
@@ -1138,7 +953,7 @@ static esp_err_t read_motoman_alarm_attributes(const ip4_addr_t *ip_address, uin
     
     // Attribute 3: Alarm data type (4 bytes)
     if (available < 4) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "Not enough data for alarm data type");
+        enip_error_set_detail(&alarm->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     alarm->alarm_data_type = (uint32_t)(response[offset] | (response[offset+1] << 8) | 
@@ -1198,12 +1013,14 @@ esp_err_t enip_scanner_motoman_read_alarm(const ip4_addr_t *ip_address, uint8_t
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(alarm, 0, sizeof(enip_scanner_motoman_alarm_t));
+    // Only the status fields are reset; data fields are valid when success is true
     alarm->ip_address = *ip_address;
+    alarm->success = false;
+    enip_error_clear(&alarm->error);
     
     // Instance: 1=Latest alarm, 2=Alarm immediately before 1, 3=Alarm immediately before 2, 4=Alarm immediately before 3
     if (alarm_instance < 1 || alarm_instance > 4) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "Invalid alarm instance (must be 1-4)");
+        enip_error_set(&alarm->error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1216,8 +1033,10 @@ esp_err_t enip_scanner_motoman_read_alarm_history(const ip4_addr_t *ip_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(alarm, 0, sizeof(enip_scanner_motoman_alarm_t));
+    // Only the status fields are reset; data fields are valid when success is true
     alarm->ip_address = *ip_address;
+    alarm->success = false;
+    enip_error_clear(&alarm->error);
     
     // Instance ranges:
     // 1-100: Major failure
@@ -1230,7 +1049,7 @@ esp_err_t enip_scanner_motoman_read_alarm_history(const ip4_addr_t *ip_address,
         (alarm_instance < 2001 || alarm_instance > 2100) &&
         (alarm_instance < 3001 || alarm_instance > 3100) &&
         (alarm_instance < 4001 || alarm_instance > 4100)) {
-        snprintf(alarm->error_message, sizeof(alarm->error_message), "Invalid alarm history instance");
+        enip_error_set(&alarm->error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1248,26 +1067,26 @@ esp_err_t enip_scanner_motoman_read_job_info(const ip4_addr_t *ip_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(job_info, 0, sizeof(enip_scanner_motoman_job_info_t));
+    // Only the status fields are reset; data fields are valid when success is true
     job_info->ip_address = *ip_address;
+    job_info->success = false;
+    enip_error_clear(&job_info->error);
     
     // Instance 1, Get_Attribute_All
     uint8_t response[44];  // Job name (32) + Line number (4) + Step number (4) + Speed override (4) = 44 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_JOB_INFO, 1, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &job_info->error);
     
     if (ret != ESP_OK) {
-        snprintf(job_info->error_message, sizeof(job_info->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 44) {
-        snprintf(job_info->error_message, sizeof(job_info->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&job_info->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1299,26 +1118,26 @@ esp_err_t enip_scanner_motoman_read_axis_config(const ip4_addr_t *ip_address, ui
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(config, 0, sizeof(enip_scanner_motoman_axis_config_t));
+    // Only the status fields are reset; data fields are valid when success is true
     config->ip_address = *ip_address;
+    config->success = false;
+    enip_error_clear(&config->error);
     
     // Instance ranges: 1-8 (Robot pulse), 11-18 (Base pulse), 21-44 (Station pulse), 101-108 (Robot coordinate), 111-118 (Base linear)
     uint8_t response[32];  // 8 axis coordinate names (4 bytes each) = 32 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_AXIS_CONFIG, control_group, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &config->error);
     
     if (ret != ESP_OK) {
-        snprintf(config->error_message, sizeof(config->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 32) {
-        snprintf(config->error_message, sizeof(config->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&config->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1342,26 +1161,26 @@ esp_err_t enip_scanner_motoman_read_position(const ip4_addr_t *ip_address, uint1
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(position, 0, sizeof(enip_scanner_motoman_position_t));
+    // Only the status fields are reset; data fields are valid when success is true
     position->ip_address = *ip_address;
+    position->success = false;
+    enip_error_clear(&position->error);
     
     // Instance ranges: 1-8 (Robot Pulse), 11-18 (Base Pulse), 21-44 (Station Pulse), 101-108 (Robot Base)
     uint8_t response[52];  // Data type (4) + Configuration (4) + Tool number (4) + Reservation (4) + Extended config (4) + 8 axis (32) = 52 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_POSITION, control_group, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &position->error);
     
     if (ret != ESP_OK) {
-        snprintf(position->error_message, sizeof(position->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 44) {
-        snprintf(position->error_message, sizeof(position->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&position->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1403,26 +1222,26 @@ esp_err_t enip_scanner_motoman_read_position_deviation(const ip4_addr_t *ip_addr
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(deviation, 0, sizeof(enip_scanner_motoman_position_deviation_t));
+    // Only the status fields are reset; data fields are valid when success is true
     deviation->ip_address = *ip_address;
+    deviation->success = false;
+    enip_error_clear(&deviation->error);
     
     // Instance ranges: 1-8 (Robot), 11-18 (Base), 21-44 (Station)
     uint8_t response[32];  // 8 axis data (4 bytes each) = 32 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_POSITION_DEVIATION, control_group, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &deviation->error);
     
     if (ret != ESP_OK) {
-        snprintf(deviation->error_message, sizeof(deviation->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 4) {
-        snprintf(deviation->error_message, sizeof(deviation->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&deviation->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1458,26 +1277,26 @@ esp_err_t enip_scanner_motoman_read_torque(const ip4_addr_t *ip_address, uint16_
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(torque, 0, sizeof(enip_scanner_motoman_torque_t));
+    // Only the status fields are reset; data fields are valid when success is true
     torque->ip_address = *ip_address;
+    torque->success = false;
+    enip_error_clear(&torque->error);
     
     // Instance ranges: 1-8 (Robot), 11-18 (Base), 21-44 (Station)
     uint8_t response[32];  // 8 axis data (4 bytes each) = 32 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_TORQUE, control_group, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &torque->error);
     
     if (ret != ESP_OK) {
-        snprintf(torque->error_message, sizeof(torque->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 4) {
-        snprintf(torque->error_message, sizeof(torque->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&torque->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1508,11 +1327,9 @@ esp_err_t enip_scanner_motoman_read_torque(const ip4_addr_t *ip_address, uint16_
 // ============================================================================
 
 esp_err_t enip_scanner_motoman_read_variable_s(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               char *value, size_t value_size, uint32_t timeout_ms, char *error_message) {
+                                               char *value, size_t value_size, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL || value_size == 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1520,24 +1337,18 @@ esp_err_t enip_scanner_motoman_read_variable_s(const ip4_addr_t *ip_address, uin
     
     uint8_t response[32];  // String variable is 32 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_S, instance, 1,
                                              CIP_SERVICE_GET_ATTRIBUTE_SINGLE, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
     if (response_length < 1) {
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", response_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1551,11 +1362,9 @@ esp_err_t enip_scanner_motoman_read_variable_s(const ip4_addr_t *ip_address, uin
 }
 
 esp_err_t enip_scanner_motoman_write_variable_s(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 const char *value, uint32_t timeout_ms, char *error_message) {
+                                                 const char *value, uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || value == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1570,17 +1379,13 @@ esp_err_t enip_scanner_motoman_write_variable_s(const ip4_addr_t *ip_address, ui
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_S, instance, 1,
                                              CIP_SERVICE_SET_ATTRIBUTE_SINGLE, data, 32,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -1597,15 +1402,16 @@ esp_err_t enip_scanner_motoman_read_variable_p(const ip4_addr_t *ip_address, uin
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(position, 0, sizeof(enip_scanner_motoman_position_t));
+    // Only the status fields are reset; data fields are valid when success is true
     position->ip_address = *ip_address;
+    position->success = false;
+    enip_error_clear(&position->error);
     
     // Instance = variable_number (+1 when RS022=0)
     uint16_t instance = motoman_variable_instance(variable_number);
     
     uint8_t response[52];  // Data type (4) + Configuration (4) + Tool number (4) + User coord (4) + Extended config (4) + 8 axis (32) = 52 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     // Use Get_Attribute_All (Service 0x01) - this should read all attributes at once
     // Note: PLC config shows Service 14 (0x0E = Get_Attribute_Single), but that requires
@@ -1613,17 +1419,14 @@ esp_err_t enip_scanner_motoman_read_variable_p(const ip4_addr_t *ip_address, uin
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_P, instance, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &position->error);
     
     if (ret != ESP_OK) {
-        // Copy error message, truncating if necessary
-        strncpy(position->error_message, error_msg, sizeof(position->error_message) - 1);
-        position->error_message[sizeof(position->error_message) - 1] = '\0';
         return ret;
     }
     
     if (response_length < 52) {
-        snprintf(position->error_message, sizeof(position->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&position->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1647,11 +1450,9 @@ esp_err_t enip_scanner_motoman_read_variable_p(const ip4_addr_t *ip_address, uin
 
 esp_err_t enip_scanner_motoman_write_variable_p(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                  const enip_scanner_motoman_position_t *position,
-                                                 uint32_t timeout_ms, char *error_message) {
+                                                 uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || position == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1693,17 +1494,13 @@ esp_err_t enip_scanner_motoman_write_variable_p(const ip4_addr_t *ip_address, ui
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_P, instance, 0,
                                              CIP_SERVICE_SET_ATTRIBUTE_ALL, data, sizeof(data),
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -1720,27 +1517,27 @@ esp_err_t enip_scanner_motoman_read_variable_bp(const ip4_addr_t *ip_address, ui
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(position, 0, sizeof(enip_scanner_motoman_base_position_t));
+    // Only the status fields are reset; data fields are valid when success is true
     position->ip_address = *ip_address;
+    position->success = false;
+    enip_error_clear(&position->error);
     
     uint16_t instance = motoman_variable_instance(variable_number);
     
     uint8_t response[36];  // Data type (4) + 8 axis (32) = 36 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_BP, instance, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &position->error);
     
     if (ret != ESP_OK) {
-        snprintf(position->error_message, sizeof(position->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 36) {
-        snprintf(position->error_message, sizeof(position->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&position->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1761,11 +1558,9 @@ esp_err_t enip_scanner_motoman_read_variable_bp(const ip4_addr_t *ip_address, ui
 
 esp_err_t enip_scanner_motoman_write_variable_bp(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                   const enip_scanner_motoman_base_position_t *position,
-                                                  uint32_t timeout_ms, char *error_message) {
+                                                  uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || position == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1787,17 +1582,13 @@ esp_err_t enip_scanner_motoman_write_variable_bp(const ip4_addr_t *ip_address, u
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_BP, instance, 0,
                                              CIP_SERVICE_SET_ATTRIBUTE_ALL, data, sizeof(data),
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
@@ -1814,27 +1605,27 @@ esp_err_t enip_scanner_motoman_read_variable_ex(const ip4_addr_t *ip_address, ui
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(position, 0, sizeof(enip_scanner_motoman_external_position_t));
+    // Only the status fields are reset; data fields are valid when success is true
     position->ip_address = *ip_address;
+    position->success = false;
+    enip_error_clear(&position->error);
     
     uint16_t instance = motoman_variable_instance(variable_number);
     
     uint8_t response[36];  // Data type (4) + 8 axis (32) = 36 bytes
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_EX, instance, 0,
                                              CIP_SERVICE_GET_ATTRIBUTE_ALL, NULL, 0,
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, &position->error);
     
     if (ret != ESP_OK) {
-        snprintf(position->error_message, sizeof(position->error_message), "%s", error_msg);
         return ret;
     }
     
     if (response_length < 36) {
-        snprintf(position->error_message, sizeof(position->error_message), "Response too short: %zu bytes", response_length);
+        enip_error_set_detail(&position->error, ENIP_ERR_SHORT_RESPONSE, response_length);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -1855,11 +1646,9 @@ esp_err_t enip_scanner_motoman_read_variable_ex(const ip4_addr_t *ip_address, ui
 
 esp_err_t enip_scanner_motoman_write_variable_ex(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                   const enip_scanner_motoman_external_position_t *position,
-                                                  uint32_t timeout_ms, char *error_message) {
+                                                  uint32_t timeout_ms, enip_scanner_error_t *error) {
     if (ip_address == NULL || position == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid arguments");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -1881,17 +1670,13 @@ esp_err_t enip_scanner_motoman_write_variable_ex(const ip4_addr_t *ip_address, u
     
     uint8_t response[4];
     size_t response_length = 0;
-    char error_msg[128];
     
     esp_err_t ret = send_motoman_cip_message(ip_address, MOTOMAN_CLASS_VARIABLE_EX, instance, 0,
                                              CIP_SERVICE_SET_ATTRIBUTE_ALL, data, sizeof(data),
                                              response, sizeof(response), &response_length,
-                                             timeout_ms, error_msg);
+                                             timeout_ms, error);
     
     if (ret != ESP_OK) {
-        if (error_message) {
-            snprintf(error_message, 128, "%s", error_msg);
-        }
         return ret;
     }
     
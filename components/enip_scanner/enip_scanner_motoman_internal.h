@@ -24,22 +24,25 @@
 #define ENIP_SCANNER_MOTOMAN_INTERNAL_H
 
 #include "enip_scanner.h"
+#include "enip_scanner_deadline_internal.h"
+#include "enip_scanner_context_internal.h"
 #include "lwip/ip4_addr.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/types.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // Forward declarations for shared functions from enip_scanner.c
-int create_tcp_socket(const ip4_addr_t *ip_addr, uint32_t timeout_ms);
-esp_err_t register_session(int sock, uint32_t *session_handle);
+int create_tcp_socket(const ip4_addr_t *ip_addr, enip_deadline_t deadline);
+esp_err_t register_session(int sock, uint32_t *session_handle, enip_deadline_t deadline);
 void unregister_session(int sock, uint32_t session_handle);
-esp_err_t send_data(int sock, const void *data, size_t len);
-esp_err_t recv_data(int sock, void *data, size_t len, uint32_t timeout_ms, size_t *bytes_received);
-extern SemaphoreHandle_t s_scanner_mutex;
-extern bool s_scanner_initialized;
+esp_err_t send_data(int sock, const void *data, size_t len, enip_deadline_t deadline);
+esp_err_t recv_data(int sock, void *data, size_t len, enip_deadline_t deadline, size_t *bytes_received);
+esp_err_t set_socket_deadline(int sock, enip_deadline_t deadline);
+ssize_t recv_available(int sock, void *data, size_t len, enip_deadline_t deadline);
 
 // EtherNet/IP constants (shared)
 #define ENIP_PORT 44818
@@ -0,0 +1,659 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_profile_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner.h"
+#include "enip_scanner_diag_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+
+#include "nvs.h"
+
+static const char *TAG = "enip_scanner_profile";
+
+#define PROFILE_NVS_NAMESPACE   "enip_scanner"
+#define PROFILE_NVS_KEY         "profiles"
+#define PROFILE_FORMAT_VERSION  1
+#define PROFILE_TAG_NAME_MAX    40
+
+#define PROFILE_ASSEMBLY_EXISTS     0x01    // Instance answered a read or was discovered
+#define PROFILE_ASSEMBLY_WRITABLE   0x02    // enip_scanner_is_assembly_writable() returned true
+
+#define PROFILE_FLAG_DISCOVERED     0x01    // The EXISTS instances are the complete discovery result
+
+typedef struct {
+    uint16_t instance;
+    uint16_t data_size;         // Bytes (0 = unknown)
+    uint8_t flags;              // PROFILE_ASSEMBLY_*
+    uint8_t reserved;
+} profile_assembly_t;
+
+typedef struct {
+    char name[PROFILE_TAG_NAME_MAX];
+    uint16_t cip_data_type;
+} profile_tag_t;
+
+// Stored as-is in NVS; change PROFILE_FORMAT_VERSION when the layout changes
+typedef struct {
+    // Identity from ListIdentity (all zero until the device has answered one)
+    uint16_t vendor_id;
+    uint16_t device_type;
+    uint16_t product_code;
+    uint8_t major_revision;
+    uint8_t minor_revision;
+    uint32_t serial_number;
+    ip4_addr_t ip_address;      // Address the device was last used at (0 = unbound)
+    uint32_t last_used;         // Use generation, for replacement when full
+    uint8_t flags;              // PROFILE_FLAG_*
+    uint8_t assembly_count;
+    uint8_t tag_count;
+    uint8_t reserved;           // Was the tag replacement index; tags are no longer replaced
+    profile_assembly_t assemblies[CONFIG_ENIP_SCANNER_PROFILE_ASSEMBLIES];
+    profile_tag_t tags[CONFIG_ENIP_SCANNER_PROFILE_TAGS];
+} device_profile_t;
+
+// Header and profiles are kept contiguous so the used part is written as one blob
+typedef struct {
+    uint16_t version;
+    uint16_t profile_size;
+    uint16_t count;
+    uint16_t reserved;
+    device_profile_t profiles[CONFIG_ENIP_SCANNER_PROFILE_DEVICES];
+} profile_store_t;
+
+static profile_store_t *s_store = NULL;
+static bool s_verified[CONFIG_ENIP_SCANNER_PROFILE_DEVICES];   // Confirmed by ListIdentity since boot
+static SemaphoreHandle_t s_profile_mutex = NULL;
+static uint32_t s_generation = 0;
+
+// Changes are written at most every CONFIG_ENIP_SCANNER_PROFILE_FLUSH_INTERVAL_S,
+// never from the request that made them
+static esp_timer_handle_t s_flush_timer = NULL;
+static bool s_dirty = false;    // Guarded by s_profile_mutex; the flush timer runs while set
+
+static bool profile_has_identity(const device_profile_t *profile)
+{
+    return profile->vendor_id != 0 || profile->product_code != 0 || profile->serial_number != 0;
+}
+
+static bool profile_is_device(const device_profile_t *profile, const enip_scanner_device_info_t *device)
+{
+    return profile->vendor_id == device->vendor_id &&
+           profile->product_code == device->product_code &&
+           profile->serial_number == device->serial_number;
+}
+
+static void profile_set_identity(device_profile_t *profile, const enip_scanner_device_info_t *device)
+{
+    profile->vendor_id = device->vendor_id;
+    profile->device_type = device->device_type;
+    profile->product_code = device->product_code;
+    profile->major_revision = device->major_revision;
+    profile->minor_revision = device->minor_revision;
+    profile->serial_number = device->serial_number;
+}
+
+static void profile_clear_metadata(device_profile_t *profile)
+{
+    profile->flags = 0;
+    profile->assembly_count = 0;
+    profile->tag_count = 0;
+    memset(profile->assemblies, 0, sizeof(profile->assemblies));
+    memset(profile->tags, 0, sizeof(profile->tags));
+}
+
+// Write the used part of the store (caller holds s_profile_mutex)
+static void profile_save_locked(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(PROFILE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS for profiles: %s", esp_err_to_name(ret));
+        return;
+    }
+    
+    size_t length = offsetof(profile_store_t, profiles) + s_store->count * sizeof(device_profile_t);
+    ret = nvs_set_blob(handle, PROFILE_NVS_KEY, s_store, length);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save device profiles: %s", esp_err_to_name(ret));
+    }
+}
+
+// Have the store written by the next flush (caller holds s_profile_mutex)
+static void profile_mark_dirty_locked(void)
+{
+    if (s_dirty) {
+        return;
+    }
+    esp_err_t ret = esp_timer_start_once(s_flush_timer, (uint64_t)CONFIG_ENIP_SCANNER_PROFILE_FLUSH_INTERVAL_S * 1000000);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to schedule a profile flush: %s", esp_err_to_name(ret));
+        return;
+    }
+    s_dirty = true;
+}
+
+static void profile_flush(void *arg)
+{
+    (void)arg;
+    xSemaphoreTake(s_profile_mutex, portMAX_DELAY);
+    if (s_dirty) {
+        s_dirty = false;
+        profile_save_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+static int profile_find_locked(const ip4_addr_t *ip_address)
+{
+    for (int i = 0; i < s_store->count; i++) {
+        if (s_store->profiles[i].ip_address.addr == ip_address->addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Take a profile for a new device: a free one, else the least recently used
+static int profile_allocate_locked(void)
+{
+    int index;
+    if (s_store->count < CONFIG_ENIP_SCANNER_PROFILE_DEVICES) {
+        index = s_store->count++;
+    } else {
+        index = 0;
+        for (int i = 1; i < s_store->count; i++) {
+            if ((int32_t)(s_store->profiles[i].last_used - s_store->profiles[index].last_used) < 0) {
+                index = i;
+            }
+        }
+    }
+    memset(&s_store->profiles[index], 0, sizeof(device_profile_t));
+    s_store->profiles[index].last_used = ++s_generation;
+    s_verified[index] = false;
+    return index;
+}
+
+static device_profile_t *profile_lookup_locked(const ip4_addr_t *ip_address, bool create)
+{
+    int index = profile_find_locked(ip_address);
+    if (index < 0) {
+        if (!create) {
+            return NULL;
+        }
+        index = profile_allocate_locked();
+        s_store->profiles[index].ip_address = *ip_address;
+    }
+    s_store->profiles[index].last_used = ++s_generation;
+    return &s_store->profiles[index];
+}
+
+// For the request path: takes a free profile for a new device but never
+// replaces one, so a busy scanner does not churn the store
+static device_profile_t *profile_lookup_no_evict_locked(const ip4_addr_t *ip_address)
+{
+    if (profile_find_locked(ip_address) < 0 && s_store->count >= CONFIG_ENIP_SCANNER_PROFILE_DEVICES) {
+        return NULL;
+    }
+    return profile_lookup_locked(ip_address, true);
+}
+
+static profile_assembly_t *profile_find_assembly(device_profile_t *profile, uint16_t assembly_instance, bool create)
+{
+    for (int i = 0; i < profile->assembly_count; i++) {
+        if (profile->assemblies[i].instance == assembly_instance) {
+            return &profile->assemblies[i];
+        }
+    }
+    if (!create || profile->assembly_count >= CONFIG_ENIP_SCANNER_PROFILE_ASSEMBLIES) {
+        return NULL;
+    }
+    profile_assembly_t *assembly = &profile->assemblies[profile->assembly_count++];
+    memset(assembly, 0, sizeof(*assembly));
+    assembly->instance = assembly_instance;
+    return assembly;
+}
+
+static bool profile_lock(void)
+{
+    return s_profile_mutex != NULL && xSemaphoreTake(s_profile_mutex, portMAX_DELAY) == pdTRUE;
+}
+
+esp_err_t profile_cache_init(void)
+{
+    if (s_profile_mutex != NULL) {
+        return ESP_OK;
+    }
+    
+    s_store = enip_mem_calloc(ENIP_MEM_COLD, 1, sizeof(profile_store_t));
+    if (s_store == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t args = {
+        .callback = profile_flush,
+        .name = "enip_profile",
+    };
+    esp_err_t timer_ret = esp_timer_create(&args, &s_flush_timer);
+    if (timer_ret != ESP_OK) {
+        enip_mem_free(s_store);
+        s_store = NULL;
+        return timer_ret;
+    }
+    s_profile_mutex = xSemaphoreCreateMutex();
+    if (s_profile_mutex == NULL) {
+        esp_timer_delete(s_flush_timer);
+        s_flush_timer = NULL;
+        enip_mem_free(s_store);
+        s_store = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    nvs_handle_t handle;
+    if (nvs_open(PROFILE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        size_t length = sizeof(profile_store_t);
+        esp_err_t ret = nvs_get_blob(handle, PROFILE_NVS_KEY, s_store, &length);
+        nvs_close(handle);
+        
+        if (ret == ESP_OK &&
+            (s_store->version != PROFILE_FORMAT_VERSION ||
+             s_store->profile_size != sizeof(device_profile_t) ||
+             s_store->count > CONFIG_ENIP_SCANNER_PROFILE_DEVICES ||
+             length != offsetof(profile_store_t, profiles) + s_store->count * sizeof(device_profile_t))) {
+            // Written by a build with a different layout or Kconfig sizes
+            ESP_LOGW(TAG, "Ignoring stored device profiles with a different format");
+            ret = ESP_ERR_INVALID_VERSION;
+        }
+        if (ret != ESP_OK) {
+            memset(s_store, 0, sizeof(profile_store_t));
+        }
+    }
+    
+    s_store->version = PROFILE_FORMAT_VERSION;
+    s_store->profile_size = sizeof(device_profile_t);
+    for (int i = 0; i < s_store->count; i++) {
+        if ((int32_t)(s_store->profiles[i].last_used - s_generation) > 0) {
+            s_generation = s_store->profiles[i].last_used;
+        }
+    }
+    
+    ESP_LOGI(TAG, "Loaded %u device profile(s)", s_store->count);
+    return ESP_OK;
+}
+
+void profile_note_identity(const enip_scanner_device_info_t *device)
+{
+    if (device == NULL || !profile_lock()) {
+        return;
+    }
+    
+    int by_address = profile_find_locked(&device->ip_address);
+    int by_identity = -1;
+    for (int i = 0; i < s_store->count; i++) {
+        if (profile_has_identity(&s_store->profiles[i]) && profile_is_device(&s_store->profiles[i], device)) {
+            by_identity = i;
+            break;
+        }
+    }
+    
+    bool changed = false;
+    if (by_address >= 0 && by_address != by_identity) {
+        device_profile_t *profile = &s_store->profiles[by_address];
+        if (!profile_has_identity(profile) && by_identity < 0) {
+            // Learned before the first ListIdentity: adopt this identity
+            profile_set_identity(profile, device);
+            by_identity = by_address;
+        } else {
+            // Another device answers at this address now; keep its old profile
+            // unbound in case it shows up elsewhere
+            profile->ip_address.addr = 0;
+            s_verified[by_address] = false;
+        }
+        changed = true;
+    }
+    
+    if (by_identity >= 0) {
+        device_profile_t *profile = &s_store->profiles[by_identity];
+        if (profile->ip_address.addr != device->ip_address.addr) {
+            ESP_LOGI(TAG, "Device %04X:%04X serial %08lX moved to " IPSTR,
+                     device->vendor_id, device->product_code, (unsigned long)device->serial_number,
+                     IP2STR(&device->ip_address));
+            profile->ip_address = device->ip_address;
+            changed = true;
+        }
+        if (profile->major_revision != device->major_revision ||
+            profile->minor_revision != device->minor_revision ||
+            profile->device_type != device->device_type) {
+            // New firmware may have a different object model
+            ESP_LOGI(TAG, "Device at " IPSTR " changed revision, dropping its profile", IP2STR(&device->ip_address));
+            profile_set_identity(profile, device);
+            profile_clear_metadata(profile);
+            changed = true;
+        }
+        s_verified[by_identity] = true;
+    }
+    
+    if (changed) {
+        profile_mark_dirty_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+bool profile_get_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t *data_size)
+{
+    if (ip_address == NULL || data_size == NULL || !profile_lock()) {
+        return false;
+    }
+    
+    bool found = false;
+    device_profile_t *profile = profile_lookup_locked(ip_address, false);
+    if (profile != NULL) {
+        profile_assembly_t *assembly = profile_find_assembly(profile, assembly_instance, false);
+        if (assembly != NULL && assembly->data_size != 0) {
+            *data_size = assembly->data_size;
+            found = true;
+        }
+    }
+    xSemaphoreGive(s_profile_mutex);
+    return found;
+}
+
+void profile_note_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t data_size)
+{
+    if (ip_address == NULL || data_size == 0 || !profile_lock()) {
+        return;
+    }
+    
+    // Called for every assembly read: only a new or different size is a change
+    device_profile_t *profile = profile_lookup_no_evict_locked(ip_address);
+    profile_assembly_t *assembly = profile != NULL ? profile_find_assembly(profile, assembly_instance, true) : NULL;
+    if (assembly != NULL && (assembly->data_size != data_size || !(assembly->flags & PROFILE_ASSEMBLY_EXISTS))) {
+        assembly->data_size = data_size;
+        assembly->flags |= PROFILE_ASSEMBLY_EXISTS;
+        profile_mark_dirty_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+void profile_forget_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+    if (ip_address == NULL || !profile_lock()) {
+        return;
+    }
+    
+    device_profile_t *profile = profile_lookup_locked(ip_address, false);
+    profile_assembly_t *assembly = profile != NULL ? profile_find_assembly(profile, assembly_instance, false) : NULL;
+    if (assembly != NULL) {
+        ESP_LOGD(TAG, "Forgetting assembly %u of " IPSTR, assembly_instance, IP2STR(ip_address));
+        *assembly = profile->assemblies[--profile->assembly_count];
+        profile->flags &= ~PROFILE_FLAG_DISCOVERED;
+        profile_mark_dirty_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+int profile_get_assemblies(const ip4_addr_t *ip_address, uint16_t *instances, int max_instances)
+{
+    if (ip_address == NULL || instances == NULL || !profile_lock()) {
+        return -1;
+    }
+    
+    int count = -1;
+    device_profile_t *profile = profile_lookup_locked(ip_address, false);
+    if (profile != NULL && (profile->flags & PROFILE_FLAG_DISCOVERED)) {
+        count = 0;
+        for (int i = 0; i < profile->assembly_count && count < max_instances; i++) {
+            if (profile->assemblies[i].flags & PROFILE_ASSEMBLY_EXISTS) {
+                instances[count++] = profile->assemblies[i].instance;
+            }
+        }
+    }
+    xSemaphoreGive(s_profile_mutex);
+    return count;
+}
+
+void profile_note_assemblies(const ip4_addr_t *ip_address, const uint16_t *instances, int count)
+{
+    if (ip_address == NULL || instances == NULL || count <= 0 || !profile_lock()) {
+        return;
+    }
+    
+    device_profile_t *profile = profile_lookup_locked(ip_address, true);
+    for (int i = 0; i < profile->assembly_count; i++) {
+        profile->assemblies[i].flags &= ~PROFILE_ASSEMBLY_EXISTS;
+    }
+    bool complete = true;
+    for (int i = 0; i < count; i++) {
+        profile_assembly_t *assembly = profile_find_assembly(profile, instances[i], true);
+        if (assembly == NULL) {
+            complete = false;
+            break;
+        }
+        assembly->flags |= PROFILE_ASSEMBLY_EXISTS;
+    }
+    // A list that did not fit is not cached as a discovery result
+    if (complete) {
+        profile->flags |= PROFILE_FLAG_DISCOVERED;
+    }
+    profile_mark_dirty_locked();
+    xSemaphoreGive(s_profile_mutex);
+}
+
+bool profile_get_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+    if (ip_address == NULL || !profile_lock()) {
+        return false;
+    }
+    
+    bool writable = false;
+    device_profile_t *profile = profile_lookup_locked(ip_address, false);
+    if (profile != NULL) {
+        profile_assembly_t *assembly = profile_find_assembly(profile, assembly_instance, false);
+        writable = assembly != NULL && (assembly->flags & PROFILE_ASSEMBLY_WRITABLE);
+    }
+    xSemaphoreGive(s_profile_mutex);
+    return writable;
+}
+
+void profile_note_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+    if (ip_address == NULL || !profile_lock()) {
+        return;
+    }
+    
+    device_profile_t *profile = profile_lookup_locked(ip_address, true);
+    profile_assembly_t *assembly = profile_find_assembly(profile, assembly_instance, true);
+    if (assembly != NULL && !(assembly->flags & PROFILE_ASSEMBLY_WRITABLE)) {
+        assembly->flags |= PROFILE_ASSEMBLY_EXISTS | PROFILE_ASSEMBLY_WRITABLE;
+        profile_mark_dirty_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+void profile_note_tag_type(const ip4_addr_t *ip_address, const char *tag_path, uint16_t cip_data_type)
+{
+    if (CONFIG_ENIP_SCANNER_PROFILE_TAGS == 0 || ip_address == NULL || tag_path == NULL ||
+        cip_data_type == 0 || strlen(tag_path) >= PROFILE_TAG_NAME_MAX || !profile_lock()) {
+        return;
+    }
+    
+    // Called for every tag read and write: a full table keeps the tags it has
+    // rather than replacing one per request
+    device_profile_t *profile = profile_lookup_no_evict_locked(ip_address);
+    profile_tag_t *tag = NULL;
+    for (int i = 0; profile != NULL && i < profile->tag_count; i++) {
+        if (strcmp(profile->tags[i].name, tag_path) == 0) {
+            tag = &profile->tags[i];
+            break;
+        }
+    }
+    if (tag == NULL && profile != NULL && profile->tag_count < CONFIG_ENIP_SCANNER_PROFILE_TAGS) {
+        tag = &profile->tags[profile->tag_count++];
+        strlcpy(tag->name, tag_path, sizeof(tag->name));
+        tag->cip_data_type = 0;
+    }
+    if (tag != NULL && tag->cip_data_type != cip_data_type) {
+        tag->cip_data_type = cip_data_type;
+        profile_mark_dirty_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+esp_err_t enip_scanner_profile_get_tag_type(const ip4_addr_t *ip_address, const char *tag_path, uint16_t *cip_data_type)
+{
+    if (ip_address == NULL || tag_path == NULL || cip_data_type == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!profile_lock()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    device_profile_t *profile = profile_lookup_locked(ip_address, false);
+    for (int i = 0; profile != NULL && i < profile->tag_count; i++) {
+        if (strcmp(profile->tags[i].name, tag_path) == 0) {
+            *cip_data_type = profile->tags[i].cip_data_type;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(s_profile_mutex);
+    return ret;
+}
+
+esp_err_t enip_scanner_profile_clear(const ip4_addr_t *ip_address)
+{
+    if (!profile_lock()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (ip_address == NULL) {
+        s_store->count = 0;
+        memset(s_verified, 0, sizeof(s_verified));
+    } else {
+        int index = profile_find_locked(ip_address);
+        if (index < 0) {
+            ret = ESP_ERR_NOT_FOUND;
+        } else {
+            s_store->count--;
+            s_store->profiles[index] = s_store->profiles[s_store->count];
+            s_verified[index] = s_verified[s_store->count];
+        }
+    }
+    if (ret == ESP_OK) {
+        // Written now, so a restart cannot bring the cleared profiles back
+        esp_timer_stop(s_flush_timer);
+        s_dirty = false;
+        profile_save_locked();
+    }
+    xSemaphoreGive(s_profile_mutex);
+    return ret;
+}
+
+bool enip_scanner_profile_is_verified(const ip4_addr_t *ip_address)
+{
+    if (ip_address == NULL || !profile_lock()) {
+        return false;
+    }
+    int index = profile_find_locked(ip_address);
+    bool verified = index >= 0 && s_verified[index];
+    xSemaphoreGive(s_profile_mutex);
+    return verified;
+}
+
+void profile_cache_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = 0;
+    footprint->items = 0;
+    if (!profile_lock()) {
+        return;
+    }
+    if (s_store != NULL) {
+        footprint->bytes = sizeof(*s_store);
+        footprint->items = s_store->count;
+    }
+    xSemaphoreGive(s_profile_mutex);
+}
+
+#else // !CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+
+esp_err_t profile_cache_init(void)
+{
+    return ESP_OK;
+}
+
+void profile_note_identity(const enip_scanner_device_info_t *device)
+{
+    (void)device;
+}
+
+bool profile_get_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t *data_size)
+{
+    return false;
+}
+
+void profile_note_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t data_size)
+{
+}
+
+void profile_forget_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+}
+
+int profile_get_assemblies(const ip4_addr_t *ip_address, uint16_t *instances, int max_instances)
+{
+    return -1;
+}
+
+void profile_note_assemblies(const ip4_addr_t *ip_address, const uint16_t *instances, int count)
+{
+}
+
+bool profile_get_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+    return false;
+}
+
+void profile_note_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance)
+{
+}
+
+void profile_note_tag_type(const ip4_addr_t *ip_address, const char *tag_path, uint16_t cip_data_type)
+{
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_PROFILE_INTERNAL_H
+#define ENIP_SCANNER_PROFILE_INTERNAL_H
+
+#include "enip_scanner.h"
+#include "lwip/ip4_addr.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Persistent device profile cache (enip_scanner_profile.c)
+// Remembers metadata that otherwise costs a probe per device after every
+// restart. Lookups are by address and succeed before the device has been
+// confirmed by ListIdentity; callers that act on a cached value must report
+// failures back (profile_forget_assembly()) so the next attempt probes again.
+// All functions are no-ops / misses unless CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE is set.
+esp_err_t profile_cache_init(void);
+
+// Check a ListIdentity reply against the stored profiles
+void profile_note_identity(const enip_scanner_device_info_t *device);
+
+// Assembly data size (Attribute 4 / length of Attribute 3)
+bool profile_get_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t *data_size);
+void profile_note_assembly_size(const ip4_addr_t *ip_address, uint16_t assembly_instance, uint16_t data_size);
+void profile_forget_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance);
+
+// Result of enip_scanner_discover_assemblies(); get returns -1 when not cached
+int profile_get_assemblies(const ip4_addr_t *ip_address, uint16_t *instances, int max_instances);
+void profile_note_assemblies(const ip4_addr_t *ip_address, const uint16_t *instances, int count);
+
+// Result of enip_scanner_is_assembly_writable() (only positive results are kept)
+bool profile_get_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance);
+void profile_note_writable(const ip4_addr_t *ip_address, uint16_t assembly_instance);
+
+// CIP data type of a tag, learned from reads and successful writes
+void profile_note_tag_type(const ip4_addr_t *ip_address, const char *tag_path, uint16_t cip_data_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_PROFILE_INTERNAL_H
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_qos_internal.h"
+#include "enip_scanner.h"
+#include "enip_scanner_log_internal.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_QOS
+
+static const char *TAG = "enip_qos";
+
+#define DSCP_MAX 63
+
+#if CONFIG_ENIP_SCANNER_IMPLICIT_PRIORITY_LOW
+#define DEFAULT_IMPLICIT_PRIORITY ENIP_SCANNER_PRIORITY_LOW
+#elif CONFIG_ENIP_SCANNER_IMPLICIT_PRIORITY_SCHEDULED
+#define DEFAULT_IMPLICIT_PRIORITY ENIP_SCANNER_PRIORITY_SCHEDULED
+#elif CONFIG_ENIP_SCANNER_IMPLICIT_PRIORITY_URGENT
+#define DEFAULT_IMPLICIT_PRIORITY ENIP_SCANNER_PRIORITY_URGENT
+#else
+#define DEFAULT_IMPLICIT_PRIORITY ENIP_SCANNER_PRIORITY_HIGH
+#endif
+
+static portMUX_TYPE s_qos_lock = portMUX_INITIALIZER_UNLOCKED;
+static enip_scanner_qos_config_t s_config = {
+    .dscp_urgent = CONFIG_ENIP_SCANNER_DSCP_URGENT,
+    .dscp_scheduled = CONFIG_ENIP_SCANNER_DSCP_SCHEDULED,
+    .dscp_high = CONFIG_ENIP_SCANNER_DSCP_HIGH,
+    .dscp_low = CONFIG_ENIP_SCANNER_DSCP_LOW,
+    .dscp_explicit = CONFIG_ENIP_SCANNER_DSCP_EXPLICIT,
+    .implicit_priority = DEFAULT_IMPLICIT_PRIORITY,
+};
+static enip_scanner_qos_stats_t s_stats;
+
+static void mark_socket(int sock, uint8_t dscp)
+{
+    // DSCP is the upper six bits of the former TOS byte; ECN bits stay zero
+    int tos = dscp << 2;
+    bool ok = setsockopt(sock, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0;
+    
+    taskENTER_CRITICAL(&s_qos_lock);
+    if (ok) {
+        s_stats.sockets_marked++;
+    } else {
+        s_stats.mark_failures++;
+    }
+    taskEXIT_CRITICAL(&s_qos_lock);
+    
+    if (!ok) {
+        ENIP_LOG_LIMITED(ESP_LOG_WARN, TAG, "Failed to set DSCP %u on socket %d: %d", dscp, sock, errno);
+    }
+}
+
+void qos_mark_explicit_socket(int sock)
+{
+    taskENTER_CRITICAL(&s_qos_lock);
+    uint8_t dscp = s_config.dscp_explicit;
+    taskEXIT_CRITICAL(&s_qos_lock);
+    mark_socket(sock, dscp);
+}
+
+void qos_mark_implicit_socket(int sock, uint8_t priority)
+{
+    uint8_t dscp;
+    taskENTER_CRITICAL(&s_qos_lock);
+    switch (priority) {
+        case ENIP_SCANNER_PRIORITY_URGENT:
+            dscp = s_config.dscp_urgent;
+            break;
+        case ENIP_SCANNER_PRIORITY_SCHEDULED:
+            dscp = s_config.dscp_scheduled;
+            break;
+        case ENIP_SCANNER_PRIORITY_HIGH:
+            dscp = s_config.dscp_high;
+            break;
+        default:
+            dscp = s_config.dscp_low;
+            break;
+    }
+    taskEXIT_CRITICAL(&s_qos_lock);
+    mark_socket(sock, dscp);
+}
+
+uint8_t qos_implicit_priority(void)
+{
+    taskENTER_CRITICAL(&s_qos_lock);
+    uint8_t priority = s_config.implicit_priority;
+    taskEXIT_CRITICAL(&s_qos_lock);
+    return priority;
+}
+
+esp_err_t enip_scanner_get_qos_config(enip_scanner_qos_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_qos_lock);
+    *config = s_config;
+    taskEXIT_CRITICAL(&s_qos_lock);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_set_qos_config(const enip_scanner_qos_config_t *config)
+{
+    if (config == NULL ||
+        config->dscp_urgent > DSCP_MAX || config->dscp_scheduled > DSCP_MAX ||
+        config->dscp_high > DSCP_MAX || config->dscp_low > DSCP_MAX ||
+        config->dscp_explicit > DSCP_MAX ||
+        config->implicit_priority > ENIP_SCANNER_PRIORITY_URGENT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_qos_lock);
+    s_config = *config;
+    taskEXIT_CRITICAL(&s_qos_lock);
+    
+    ESP_LOGI(TAG, "DSCP urgent=%u scheduled=%u high=%u low=%u explicit=%u, implicit priority %u",
+             config->dscp_urgent, config->dscp_scheduled, config->dscp_high,
+             config->dscp_low, config->dscp_explicit, config->implicit_priority);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_get_qos_stats(enip_scanner_qos_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    taskENTER_CRITICAL(&s_qos_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_qos_lock);
+    return ESP_OK;
+}
+
+#else
+
+void qos_mark_explicit_socket(int sock)
+{
+    (void)sock;
+}
+
+void qos_mark_implicit_socket(int sock, uint8_t priority)
+{
+    (void)sock;
+    (void)priority;
+}
+
+uint8_t qos_implicit_priority(void)
+{
+    return 1;   // High, as requested before DSCP marking existed
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_QOS
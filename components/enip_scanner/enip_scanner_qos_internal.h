@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_QOS_INTERNAL_H
+#define ENIP_SCANNER_QOS_INTERNAL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mark an explicit messaging socket (TCP sessions, List Identity) with the
+// explicit DSCP value. A failure is counted and logged, never fatal.
+void qos_mark_explicit_socket(int sock);
+
+// Mark a Class 1 socket with the DSCP value of the connection priority
+// (ENIP_SCANNER_PRIORITY_*) it was opened with.
+void qos_mark_implicit_socket(int sock, uint8_t priority);
+
+// Priority to request in the network connection parameters of a Forward Open
+uint8_t qos_implicit_priority(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_QOS_INTERNAL_H
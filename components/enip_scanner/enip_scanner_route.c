@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_route_internal.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "lwip/inet.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+static const char *TAG = "enip_scanner_route";
+
+#define CIP_SERVICE_UNCONNECTED_SEND 0x52
+#define CIP_CLASS_CONNECTION_MANAGER 0x06
+
+// Service (1) + Path Size (1) + Connection Manager path (4) + Priority/Tick (1)
+// + Timeout Ticks (1) + Message Request Size (2)
+#define UNCONNECTED_SEND_HEADER_SIZE 10
+// Route Path Size (1) + Reserved (1)
+#define UNCONNECTED_SEND_ROUTE_HEADER_SIZE 2
+
+// Append one port segment; link is either a number (slot / node) or an IPv4 address
+static esp_err_t route_append_port(enip_scanner_route_t *route, unsigned long port, const char *link)
+{
+    if (port == 0 || port > 14) {
+        // Ports 15 and up need the extended port field, which no chassis here uses
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    char *end = NULL;
+    unsigned long link_number = strtoul(link, &end, 10);
+    if (end != link && *end == '\0' && link_number <= 0xFF) {
+        if (route->size + 2 > sizeof(route->path)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        route->path[route->size++] = (uint8_t)port;
+        route->path[route->size++] = (uint8_t)link_number;
+        return ESP_OK;
+    }
+    
+    // Extended link address: ASCII IP address, segment padded to an even length
+    ip4_addr_t addr;
+    if (!inet_aton(link, &addr)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t link_length = strlen(link);
+    size_t segment_length = 2 + link_length + (link_length % 2);
+    if (route->size + segment_length > sizeof(route->path)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    route->path[route->size++] = (uint8_t)(0x10 | port);
+    route->path[route->size++] = (uint8_t)link_length;
+    memcpy(route->path + route->size, link, link_length);
+    route->size += link_length;
+    if (link_length % 2) {
+        route->path[route->size++] = 0x00;
+    }
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_route_parse(const char *text, enip_scanner_route_t *route)
+{
+    if (text == NULL || route == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memset(route, 0, sizeof(*route));
+    
+    // Work on a copy: "port,link,port,link,..."
+    char buffer[128];
+    if (strlcpy(buffer, text, sizeof(buffer)) >= sizeof(buffer)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    char *save = NULL;
+    char *token = strtok_r(buffer, ",", &save);
+    while (token != NULL) {
+        while (isspace((unsigned char)*token)) token++;
+        char *end = NULL;
+        unsigned long port = strtoul(token, &end, 10);
+        // strtok_r() put a NUL where the separator was; "1x" is not a port
+        bool digits = end != token;
+        while (isspace((unsigned char)*end)) end++;
+        if (!digits || *end != '\0') {
+            ESP_LOGE(TAG, "Route '%s': invalid port '%s'", text, token);
+            return ESP_ERR_INVALID_ARG;
+        }
+        
+        char *link = strtok_r(NULL, ",", &save);
+        if (link == NULL) {
+            ESP_LOGE(TAG, "Route '%s': port %lu has no link address", text, port);
+            return ESP_ERR_INVALID_ARG;
+        }
+        while (isspace((unsigned char)*link)) link++;
+        char *link_end = link + strlen(link);
+        while (link_end > link && isspace((unsigned char)link_end[-1])) *--link_end = '\0';
+        
+        esp_err_t ret = route_append_port(route, port, link);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Route '%s': invalid hop %lu,%s", text, port, link);
+            memset(route, 0, sizeof(*route));
+            return ret;
+        }
+        token = strtok_r(NULL, ",", &save);
+    }
+    return ESP_OK;
+}
+
+size_t cip_route_overhead(const enip_scanner_route_t *route, size_t message_length)
+{
+    if (route == NULL || route->size == 0) {
+        return 0;
+    }
+    return UNCONNECTED_SEND_HEADER_SIZE + (message_length % 2) +
+           UNCONNECTED_SEND_ROUTE_HEADER_SIZE + route->size + (route->size % 2);
+}
+
+// Pick the smallest tick that lets the timeout fit in 8 bits of ticks
+static void route_timeout_ticks(uint32_t timeout_ms, uint8_t *priority_time_tick, uint8_t *timeout_ticks)
+{
+    uint8_t tick = 0;
+    while (tick < 15 && ((timeout_ms + (1UL << tick) - 1) >> tick) > 0xFF) {
+        tick++;
+    }
+    uint32_t ticks = (timeout_ms + (1UL << tick) - 1) >> tick;
+    *priority_time_tick = tick;  // Priority bit 4 is reserved and left 0 (normal)
+    *timeout_ticks = (uint8_t)(ticks == 0 ? 1 : (ticks > 0xFF ? 0xFF : ticks));
+}
+
+esp_err_t cip_route_wrap(const enip_scanner_route_t *route, uint8_t *packet, size_t *packet_length,
+                         size_t packet_size, size_t message_offset, enip_deadline_t deadline)
+{
+    if (route == NULL || route->size == 0) {
+        return ESP_OK;
+    }
+    if (message_offset < 4 || message_offset > *packet_length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    size_t message_length = *packet_length - message_offset;
+    size_t wrapped_length = message_length + cip_route_overhead(route, message_length);
+    if (message_offset + wrapped_length > packet_size || wrapped_length > 0xFFFF) {
+        ESP_LOGE(TAG, "Routed request does not fit: %zu bytes", message_offset + wrapped_length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // The embedded request moves up to make room for the Unconnected Send header
+    uint8_t *message = packet + message_offset;
+    memmove(message + UNCONNECTED_SEND_HEADER_SIZE, message, message_length);
+    
+    uint8_t priority_time_tick;
+    uint8_t timeout_ticks;
+    route_timeout_ticks(enip_deadline_remaining_ms(deadline), &priority_time_tick, &timeout_ticks);
+    
+    size_t offset = 0;
+    message[offset++] = CIP_SERVICE_UNCONNECTED_SEND;
+    message[offset++] = 0x02;  // Path size: 2 words
+    message[offset++] = 0x20;  // 8-bit class segment
+    message[offset++] = CIP_CLASS_CONNECTION_MANAGER;
+    message[offset++] = 0x24;  // 8-bit instance segment
+    message[offset++] = 0x01;
+    message[offset++] = priority_time_tick;
+    message[offset++] = timeout_ticks;
+    uint16_t request_size = (uint16_t)message_length;
+    memcpy(message + offset, &request_size, 2);
+    offset += 2;
+    
+    offset += message_length;
+    if (message_length % 2) {
+        message[offset++] = 0x00;  // Pad the embedded request to a word boundary
+    }
+    
+    message[offset++] = (uint8_t)((route->size + 1) / 2);  // Route path size in words
+    message[offset++] = 0x00;  // Reserved
+    memcpy(message + offset, route->path, route->size);
+    offset += route->size;
+    if (route->size % 2) {
+        message[offset++] = 0x00;
+    }
+    
+    // Fix up the Unconnected Data Item length and the encapsulation length
+    uint16_t item_length = (uint16_t)offset;
+    memcpy(message - 2, &item_length, 2);
+    uint16_t enip_length = (uint16_t)(message_offset + offset - 24);
+    memcpy(packet + 2, &enip_length, 2);
+    
+    *packet_length = message_offset + offset;
+    return ESP_OK;
+}
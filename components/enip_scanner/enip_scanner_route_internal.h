@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_ROUTE_INTERNAL_H
+#define ENIP_SCANNER_ROUTE_INTERNAL_H
+
+#include "enip_scanner.h"
+#include "enip_scanner_deadline_internal.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Unconnected Send wrapping (enip_scanner_route.c)
+// A SendRRData packet is built as usual; cip_route_wrap() then moves the CIP
+// request found at message_offset into a Connection Manager Unconnected Send
+// carrying the route path, and fixes up the data item and encapsulation
+// lengths. The target's reply comes back unwrapped, so response parsing does
+// not change. Both functions are no-ops for a NULL or empty route.
+
+// Extra bytes cip_route_wrap() adds to a packet
+size_t cip_route_overhead(const enip_scanner_route_t *route, size_t message_length);
+
+esp_err_t cip_route_wrap(const enip_scanner_route_t *route, uint8_t *packet, size_t *packet_length,
+                         size_t packet_size, size_t message_offset, enip_deadline_t deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_ROUTE_INTERNAL_H
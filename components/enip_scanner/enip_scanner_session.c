@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_session_internal.h"
+#include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include <string.h>
+#include <errno.h>
+
+// Forward declarations for shared functions from enip_scanner.c
+int create_tcp_socket(const ip4_addr_t *ip_addr, enip_deadline_t deadline);
+esp_err_t register_session(int sock, uint32_t *session_handle, enip_deadline_t deadline);
+void unregister_session(int sock, uint32_t session_handle);
+esp_err_t send_data(int sock, const void *data, size_t len, enip_deadline_t deadline);
+esp_err_t recv_data(int sock, void *data, size_t len, enip_deadline_t deadline, size_t *bytes_received);
+
+static const char *TAG = "enip_scanner_session";
+
+// Open a new connection and register a session on it
+static esp_err_t session_connect(const ip4_addr_t *ip_addr, enip_deadline_t deadline,
+                                 int *sock, uint32_t *session_handle, enip_scanner_error_t *error)
+{
+    int new_sock = create_tcp_socket(ip_addr, deadline);
+    if (new_sock < 0) {
+        enip_error_set_errno(error, (errno == ETIMEDOUT) ? ENIP_ERR_TIMEOUT : ENIP_ERR_CONNECT, errno);
+        return ESP_FAIL;
+    }
+    
+    esp_err_t ret = register_session(new_sock, session_handle, deadline);
+    if (ret != ESP_OK) {
+        close(new_sock);
+        enip_error_set(error, ENIP_ERR_REGISTER_SESSION);
+        ESP_LOGE(TAG, "Session registration failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    *sock = new_sock;
+    return ESP_OK;
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+
+#define ENIP_LIST_IDENTITY 0x0063
+#define SESSION_POOL_TASK_PERIOD_MS 1000
+#define SESSION_PROBE_TIMEOUT_MS 2000
+#define SESSION_POOL_TASK_STACK_SIZE 3072
+
+typedef struct {
+    bool valid;                  // Slot holds an open socket with a registered session
+    bool in_use;                 // Checked out by a request or by the maintenance task
+    bool flush_pending;          // Close instead of pooling when released
+    ip4_addr_t ip_address;
+    int sock;
+    uint32_t session_handle;
+    TickType_t last_used;        // Last request completed on this session
+    TickType_t last_probe;       // Last request or successful probe
+} session_pool_entry_t;
+
+static session_pool_entry_t s_pool[CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE];
+static SemaphoreHandle_t s_pool_mutex = NULL;
+static TaskHandle_t s_pool_task_handle = NULL;
+
+static void session_set_keepalive(int sock)
+{
+    int enable = 1;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+    int idle = CONFIG_ENIP_SCANNER_SESSION_KEEPALIVE_IDLE_S;
+    int interval = CONFIG_ENIP_SCANNER_SESSION_KEEPALIVE_INTERVAL_S;
+    int count = CONFIG_ENIP_SCANNER_SESSION_KEEPALIVE_COUNT;
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+}
+
+// An idle session must have nothing to read: pending bytes mean the stream is
+// out of step, and a zero-length read or an error means the peer is gone
+static bool session_is_clean(int sock)
+{
+    uint8_t probe;
+    ssize_t ret = recv(sock, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+    }
+    return false;
+}
+
+static void session_close(int sock, uint32_t session_handle)
+{
+    unregister_session(sock, session_handle);
+    close(sock);
+}
+
+// Send ListIdentity on an idle session and consume the reply
+// Any traffic resets the device's encapsulation inactivity timer and refreshes
+// NAT/switch state; the reply proves the peer is still there
+static esp_err_t session_probe(int sock, uint32_t session_handle)
+{
+    enip_deadline_t deadline = enip_deadline_from_timeout(SESSION_PROBE_TIMEOUT_MS);
+    
+    uint8_t packet[24] = {0};
+    uint16_t cmd = ENIP_LIST_IDENTITY;
+    memcpy(packet, &cmd, 2);
+    memcpy(packet + 4, &session_handle, 4);
+    
+    esp_err_t ret = send_data(sock, packet, sizeof(packet), deadline);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    uint8_t header[24];
+    ret = recv_data(sock, header, sizeof(header), deadline, NULL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    uint16_t reply_cmd;
+    uint16_t reply_length;
+    memcpy(&reply_cmd, header, 2);
+    memcpy(&reply_length, header + 2, 2);
+    if (reply_cmd != ENIP_LIST_IDENTITY) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    
+    // Drain the identity item; its content is not needed here
+    uint8_t discard[64];
+    while (reply_length > 0) {
+        size_t chunk = reply_length > sizeof(discard) ? sizeof(discard) : reply_length;
+        ret = recv_data(sock, discard, chunk, deadline, NULL);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        reply_length -= chunk;
+    }
+    return ESP_OK;
+}
+
+// Probe idle sessions, reconnect dead ones and retire sessions idle for too long.
+// Idle times are real ticks, like the devices' own session timeouts, so the
+// virtual clock does not apply here.
+static void session_pool_task(void *arg)
+{
+    (void)arg;
+    const TickType_t probe_ticks = pdMS_TO_TICKS(CONFIG_ENIP_SCANNER_SESSION_IDLE_PROBE_MS);
+    const TickType_t max_idle_ticks = pdMS_TO_TICKS(CONFIG_ENIP_SCANNER_SESSION_MAX_IDLE_MS);
+    
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(SESSION_POOL_TASK_PERIOD_MS));
+        
+        for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+            session_pool_entry_t *entry = &s_pool[i];
+            
+            // Claim the slot so no request picks it up while it is probed
+            xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+            TickType_t now = xTaskGetTickCount();
+            bool retire = entry->valid && !entry->in_use && (now - entry->last_used) >= max_idle_ticks;
+            bool probe = entry->valid && !entry->in_use && !retire && (now - entry->last_probe) >= probe_ticks;
+            if (retire || probe) {
+                entry->in_use = true;
+            }
+            int sock = entry->sock;
+            uint32_t session_handle = entry->session_handle;
+            ip4_addr_t ip_address = entry->ip_address;
+            xSemaphoreGive(s_pool_mutex);
+            
+            if (retire) {
+                ESP_LOGD(TAG, "Closing idle session to " IPSTR, IP2STR(&ip_address));
+                session_close(sock, session_handle);
+                xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+                entry->valid = false;
+                entry->in_use = false;
+                xSemaphoreGive(s_pool_mutex);
+                continue;
+            }
+            if (!probe) {
+                continue;
+            }
+            
+            esp_err_t ret = ESP_FAIL;
+            if (session_is_clean(sock)) {
+                ret = session_probe(sock, session_handle);
+            }
+            
+            if (ret != ESP_OK) {
+                // Reconnect now so the next request does not pay for it
+                ESP_LOGW(TAG, "Pooled session to " IPSTR " is dead (%s), reconnecting",
+                         IP2STR(&ip_address), esp_err_to_name(ret));
+                close(sock);
+                ret = session_connect(&ip_address,
+                                      enip_deadline_from_timeout(CONFIG_ENIP_SCANNER_DEFAULT_TIMEOUT_MS),
+                                      &sock, &session_handle, NULL);
+                if (ret == ESP_OK) {
+                    session_set_keepalive(sock);
+                }
+            }
+            
+            xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+            if (ret == ESP_OK && !entry->flush_pending) {
+                entry->sock = sock;
+                entry->session_handle = session_handle;
+                entry->last_probe = xTaskGetTickCount();
+            } else {
+                if (ret == ESP_OK) {
+                    session_close(sock, session_handle);
+                }
+                entry->valid = false;
+            }
+            entry->flush_pending = false;
+            entry->in_use = false;
+            xSemaphoreGive(s_pool_mutex);
+        }
+    }
+}
+
+esp_err_t session_pool_init(void)
+{
+    if (s_pool_mutex == NULL) {
+        s_pool_mutex = xSemaphoreCreateMutex();
+        if (s_pool_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_pool_task_handle == NULL) {
+        if (xTaskCreate(session_pool_task, "enip_sess", SESSION_POOL_TASK_STACK_SIZE, NULL, 2, &s_pool_task_handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create session keep-alive task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t session_acquire(const ip4_addr_t *ip_addr, enip_deadline_t deadline,
+                          int *sock, uint32_t *session_handle, enip_scanner_error_t *error)
+{
+    while (s_pool_mutex != NULL) {
+        session_pool_entry_t *entry = NULL;
+        xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+        for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+            if (s_pool[i].valid && !s_pool[i].in_use && !s_pool[i].flush_pending &&
+                ip4_addr_cmp(&s_pool[i].ip_address, ip_addr)) {
+                entry = &s_pool[i];
+                entry->in_use = true;
+                break;
+            }
+        }
+        xSemaphoreGive(s_pool_mutex);
+        
+        if (entry == NULL) {
+            break;
+        }
+        if (session_is_clean(entry->sock)) {
+            *sock = entry->sock;
+            *session_handle = entry->session_handle;
+            return ESP_OK;
+        }
+        
+        // Closed behind our back since the last probe; drop it and look again
+        ESP_LOGD(TAG, "Discarding stale pooled session to " IPSTR, IP2STR(ip_addr));
+        close(entry->sock);
+        xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+        entry->valid = false;
+        entry->in_use = false;
+        xSemaphoreGive(s_pool_mutex);
+    }
+    
+    esp_err_t ret = session_connect(ip_addr, deadline, sock, session_handle, error);
+    if (ret == ESP_OK && s_pool_mutex != NULL) {
+        session_set_keepalive(*sock);
+    }
+    return ret;
+}
+
+void session_release(int sock, uint32_t session_handle, bool reusable)
+{
+    if (s_pool_mutex == NULL) {
+        session_close(sock, session_handle);
+        return;
+    }
+    
+    // Leftover bytes mean the request stopped short of the end of its response
+    if (reusable && !session_is_clean(sock)) {
+        reusable = false;
+    }
+    
+    struct sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    if (reusable && getpeername(sock, (struct sockaddr *)&peer, &peer_len) != 0) {
+        reusable = false;
+    }
+    
+    xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+    session_pool_entry_t *entry = NULL;
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+        if (s_pool[i].valid && s_pool[i].in_use && s_pool[i].sock == sock) {
+            entry = &s_pool[i];
+            break;
+        }
+    }
+    if (entry != NULL && (!reusable || entry->flush_pending)) {
+        entry->valid = false;
+        entry->in_use = false;
+        entry->flush_pending = false;
+        entry = NULL;
+        reusable = false;
+    }
+    if (entry == NULL && reusable) {
+        for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+            if (!s_pool[i].valid) {
+                entry = &s_pool[i];
+                entry->valid = true;
+                entry->flush_pending = false;
+                entry->sock = sock;
+                entry->session_handle = session_handle;
+                entry->ip_address.addr = peer.sin_addr.s_addr;
+                break;
+            }
+        }
+    }
+    if (entry != NULL) {
+        entry->in_use = false;
+        entry->last_used = xTaskGetTickCount();
+        entry->last_probe = entry->last_used;
+    }
+    xSemaphoreGive(s_pool_mutex);
+    
+    // Not pooled: pool full, flushed, or the stream cannot be trusted
+    if (entry == NULL) {
+        session_close(sock, session_handle);
+    }
+}
+
+esp_err_t enip_scanner_session_pool_flush(const ip4_addr_t *ip_address)
+{
+    if (s_pool_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+        xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+        session_pool_entry_t *entry = &s_pool[i];
+        bool match = entry->valid && (ip_address == NULL || ip4_addr_cmp(&entry->ip_address, ip_address));
+        bool close_now = match && !entry->in_use;
+        if (match && entry->in_use) {
+            entry->flush_pending = true;
+        }
+        int sock = entry->sock;
+        uint32_t session_handle = entry->session_handle;
+        if (close_now) {
+            entry->valid = false;
+        }
+        xSemaphoreGive(s_pool_mutex);
+        
+        if (close_now) {
+            session_close(sock, session_handle);
+        }
+    }
+    return ESP_OK;
+}
+
+void session_pool_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = sizeof(s_pool) + (s_pool_task_handle != NULL ? SESSION_POOL_TASK_STACK_SIZE : 0);
+    footprint->items = 0;
+    if (s_pool_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_pool_mutex, portMAX_DELAY);
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_SESSION_POOL_SIZE; i++) {
+        if (s_pool[i].valid) {
+            footprint->items++;
+        }
+    }
+    xSemaphoreGive(s_pool_mutex);
+}
+
+#else // !CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+
+esp_err_t session_pool_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t session_acquire(const ip4_addr_t *ip_addr, enip_deadline_t deadline,
+                          int *sock, uint32_t *session_handle, enip_scanner_error_t *error)
+{
+    return session_connect(ip_addr, deadline, sock, session_handle, error);
+}
+
+void session_release(int sock, uint32_t session_handle, bool reusable)
+{
+    (void)reusable;
+    unregister_session(sock, session_handle);
+    close(sock);
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
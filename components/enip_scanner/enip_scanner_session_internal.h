@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENIP_SCANNER_SESSION_INTERNAL_H
+#define ENIP_SCANNER_SESSION_INTERNAL_H
+
+#include "enip_scanner.h"
+#include "enip_scanner_deadline_internal.h"
+#include "lwip/ip4_addr.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Explicit messaging sessions (enip_scanner_session.c)
+// session_acquire() hands out a connected socket with a registered session,
+// reusing an idle pooled one when CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL is set.
+// Every acquired session must be given back with session_release(); pass
+// reusable = false whenever the request did not consume a complete response,
+// so a stream that is out of step is never handed to the next caller.
+esp_err_t session_acquire(const ip4_addr_t *ip_addr, enip_deadline_t deadline,
+                          int *sock, uint32_t *session_handle, enip_scanner_error_t *error);
+void session_release(int sock, uint32_t session_handle, bool reusable);
+esp_err_t session_pool_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENIP_SCANNER_SESSION_INTERNAL_H
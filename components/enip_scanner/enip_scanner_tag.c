@@ -22,8 +22,15 @@
 
 #include "enip_scanner_tag_internal.h"
 #include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_session_internal.h"
+#include "enip_scanner_route_internal.h"
+#include "enip_scanner_profile_internal.h"
+#include "enip_scanner_buffer_internal.h"
+#include "enip_scanner_diag_internal.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "lwip/sockets.h"
@@ -37,7 +44,7 @@
 extern esp_err_t tag_data_encode_write(uint16_t cip_data_type,
                                        const uint8_t *input_data, uint16_t input_length,
                                        uint8_t *output_buffer, size_t output_size,
-                                       uint16_t *output_length, char *error_msg);
+                                       uint16_t *output_length, enip_scanner_error_t *error);
 extern uint16_t tag_data_get_encoded_size(uint16_t cip_data_type, uint16_t input_length);
 
 static const char *TAG = "enip_scanner_tag";
@@ -150,51 +157,45 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
                                 const char *tag_path,
                                 enip_scanner_tag_result_t *result,
                                 uint32_t timeout_ms)
+{
+    return enip_scanner_read_tag_routed(ip_address, NULL, tag_path, result, timeout_ms);
+}
+
+static esp_err_t read_tag_routed(const ip4_addr_t *ip_address,
+                                 const enip_scanner_route_t *route,
+                                 const char *tag_path,
+                                 enip_scanner_tag_result_t *result,
+                                 uint32_t timeout_ms)
 {
     if (ip_address == NULL || tag_path == NULL || result == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    memset(result, 0, sizeof(enip_scanner_tag_result_t));
+    // Reset only the fields a caller inspects (no whole-struct clear)
     result->ip_address = *ip_address;
-    strncpy(result->tag_path, tag_path, sizeof(result->tag_path) - 1);
-    result->tag_path[sizeof(result->tag_path) - 1] = '\0';
+    strlcpy(result->tag_path, tag_path, sizeof(result->tag_path));
     result->success = false;
-    
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        snprintf(result->error_message, sizeof(result->error_message), "Scanner not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to acquire mutex");
-        return ESP_FAIL;
-    }
-    
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        snprintf(result->error_message, sizeof(result->error_message), "Scanner not initialized");
+    result->data = NULL;
+    result->data_length = 0;
+    result->cip_data_type = 0;
+    result->response_time_ms = 0;
+    enip_error_clear(&result->error);
+    
+    if (!scanner_is_ready()) {
+        enip_error_set(&result->error, ENIP_ERR_NOT_INITIALIZED);
         return ESP_ERR_INVALID_STATE;
     }
     
     uint32_t start_time = xTaskGetTickCount();
     
-    // Create TCP socket
-    int sock = create_tcp_socket(ip_address, timeout_ms);
-    if (sock < 0) {
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to connect to device");
-        return ESP_FAIL;
-    }
+    // One deadline bounds connect, session registration, send and every receive
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
     
-    // Register session
+    // Connect and register a session, or reuse a pooled one
+    int sock = -1;
     uint32_t session_handle = 0;
-    esp_err_t ret = register_session(sock, &session_handle);
+    esp_err_t ret = session_acquire(ip_address, deadline, &sock, &session_handle, &result->error);
     if (ret != ESP_OK) {
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to register session: %s", esp_err_to_name(ret));
         return ret;
     }
     
@@ -203,9 +204,8 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     uint8_t path_size_words = 0;
     ret = encode_tag_path(tag_path, cip_path, sizeof(cip_path), &path_size_words);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to encode tag path");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_PATH_ENCODE);
         return ret;
     }
     
@@ -273,6 +273,7 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     offset += 2;
     
     // CIP Message: Service + Path Size + Path + Element Count
+    size_t cip_message_offset = offset;
     packet[offset++] = cip_service;  // 0x4C (Read Tag)
     packet[offset++] = path_size_words;
     memcpy(packet + offset, cip_path, path_size_words * 2);
@@ -280,12 +281,19 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     memcpy(packet + offset, &element_count, 2);
     offset += 2;
     
+    // Controllers behind the connected device get the request via Unconnected Send
+    ret = cip_route_wrap(route, packet, &offset, sizeof(packet), cip_message_offset, deadline);
+    if (ret != ESP_OK) {
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_REQUEST_TOO_LARGE);
+        return ret;
+    }
+    
     // Send request
-    ret = send_data(sock, packet, offset);
+    ret = send_data(sock, packet, offset, deadline);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to send request");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SEND);
         return ret;
     }
     
@@ -294,26 +302,23 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     size_t bytes_received = 0;
     
     // Receive at least the ENIP header (24 bytes)
-    ssize_t recv_ret = recv(sock, response_buffer, sizeof(response_buffer), 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, sizeof(response_buffer), deadline);
     if (recv_ret < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             ESP_LOGE(TAG, "Receive timeout waiting for response");
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Timeout waiting for response");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_TIMEOUT);
             return ESP_ERR_TIMEOUT;
         }
         ESP_LOGE(TAG, "Failed to receive response: %d", errno);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to receive response");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_RECV);
         return ESP_FAIL;
     }
     if (recv_ret == 0) {
         ESP_LOGE(TAG, "Connection closed by peer");
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Connection closed by peer");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_PEER_CLOSED);
         return ESP_FAIL;
     }
     
@@ -321,7 +326,7 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     
     // Try to read more if we got a partial response
     if (bytes_received < 40) {
-        recv_ret = recv(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, deadline);
         if (recv_ret > 0) {
             bytes_received += recv_ret;
         }
@@ -329,9 +334,8 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     
     if (bytes_received < sizeof(enip_header_t) + 4) {
         ESP_LOGE(TAG, "Response too short: got %zu bytes", bytes_received);
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response too short");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -347,9 +351,8 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     
     if (header_offset + sizeof(enip_header_t) > bytes_received) {
         ESP_LOGE(TAG, "Response too short for header");
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response too short");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -358,16 +361,14 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     memcpy(&response_header, response_buffer + header_offset, sizeof(response_header));
     
     if (response_header.command != ENIP_SEND_RR_DATA) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Unexpected response command: 0x%04X", response_header.command);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_UNEXPECTED_COMMAND, response_header.command);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     if (response_header.status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Response error status: 0x%08lX", (unsigned long)response_header.status);
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(&result->error, ENIP_ERR_ENCAP_STATUS, response_header.status);
         return ESP_FAIL;
     }
     
@@ -383,12 +384,11 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
         }
         if (remaining > 0) {
             size_t additional_received = 0;
-            ret = recv_data(sock, response_buffer + bytes_received, remaining, timeout_ms, &additional_received);
+            ret = recv_data(sock, response_buffer + bytes_received, remaining, deadline, &additional_received);
             if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
                 ESP_LOGE(TAG, "Failed to receive remaining response data");
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive remaining response data");
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
             bytes_received += additional_received;
@@ -402,11 +402,10 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
         remaining_in_buffer -= 16;
     } else {
         uint8_t skip_buffer[16];
-        ret = recv_data(sock, skip_buffer, 16, timeout_ms, NULL);
+        ret = recv_data(sock, skip_buffer, 16, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive response structure");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -420,11 +419,10 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
         remaining_in_buffer -= 4;
     } else {
         uint8_t cip_header[4];
-        ret = recv_data(sock, cip_header, 4, timeout_ms, NULL);
+        ret = recv_data(sock, cip_header, 4, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive CIP header");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
         cip_status = cip_header[2];
@@ -432,48 +430,23 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     }
     
     if (cip_status != 0x00) {
-        const char* status_msg = (cip_status == 0x01) ? "Connection failure" :
-                                 (cip_status == 0x02) ? "Resource unavailable" :
-                                 (cip_status == 0x03) ? "Invalid parameter value" :
-                                 (cip_status == 0x04) ? "Path segment error" :
-                                 (cip_status == 0x05) ? "Path destination unknown" :
-                                 (cip_status == 0x06) ? "Partial transfer" :
-                                 (cip_status == 0x07) ? "Connection lost" :
-                                 (cip_status == 0x08) ? "Service not supported" :
-                                 (cip_status == 0x09) ? "Invalid attribute value" :
-                                 (cip_status == 0x0A) ? "Attribute list error" :
-                                 (cip_status == 0x0B) ? "Already in requested mode" :
-                                 (cip_status == 0x0C) ? "Object state conflict" :
-                                 (cip_status == 0x0D) ? "Object already exists" :
-                                 (cip_status == 0x0E) ? "Attribute not settable" :
-                                 (cip_status == 0x0F) ? "Privilege violation" :
-                                 (cip_status == 0x10) ? "Device state conflict" :
-                                 (cip_status == 0x11) ? "Reply data too large" :
-                                 (cip_status == 0x12) ? "Fragmentation of primitive value" :
-                                 (cip_status == 0x13) ? "Not enough data" :
-                                 (cip_status == 0x14) ? "Attribute not supported" :
-                                 (cip_status == 0x15) ? "Too much data" :
-                                 (cip_status == 0x16) ? "Object does not exist" :
-                                 (cip_status == 0x1A) ? "Invalid data type" :
-                                 (cip_status == 0x1B) ? "Invalid data type for service" :
-                                 (cip_status == 0x1C) ? "Data type mismatch" :
-                                 (cip_status == 0x1D) ? "Data size mismatch" :
-                                 "Unknown error";
-        
         bool is_program_tag = (strstr(result->tag_path, "Program:") != NULL);
         if (cip_status == 0x05 && is_program_tag) {
-            ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s (Micro800 does not support program-scoped tags externally)", 
-                     cip_status, result->tag_path, status_msg);
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), 
-                     "0x%02X (%s). Use global tags", cip_status, status_msg);
+            ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s (Micro800 does not support program-scoped tags externally, use global tags)", 
+                     cip_status, result->tag_path, enip_scanner_cip_status_name(cip_status));
         } else {
-            ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s", cip_status, result->tag_path, status_msg);
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "CIP error status: 0x%02X (%s)", cip_status, status_msg);
-        }
+            ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s", cip_status, result->tag_path,
+                     enip_scanner_cip_status_name(cip_status));
+        }
+        // First extended status word, when it already arrived with the header
+        uint16_t ext_status = 0;
+        uint8_t ext_words = 0;
+        if (additional_status_size > 0 && remaining_in_buffer >= 2) {
+            ext_status = response_buffer[bytes_already_read] | (response_buffer[bytes_already_read + 1] << 8);
+            ext_words = additional_status_size;
+        }
+        session_release(sock, session_handle, false);
+        enip_error_set_cip(&result->error, cip_status, ext_words, ext_status);
         return ESP_FAIL;
     }
     
@@ -484,12 +457,15 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
             bytes_already_read += safe_status_size;
             remaining_in_buffer -= safe_status_size;
         } else {
-            uint8_t *skip_buf = malloc(safe_status_size);
-            if (skip_buf) {
-                esp_err_t skip_ret = recv_data(sock, skip_buf, safe_status_size, timeout_ms, NULL);
-                free(skip_buf);
-                if (skip_ret != ESP_OK && skip_ret != ESP_ERR_TIMEOUT) {
-                }
+            // Part of it may already be buffered; only the rest is still on the socket
+            size_t unread = safe_status_size - remaining_in_buffer;
+            bytes_already_read += remaining_in_buffer;
+            remaining_in_buffer = 0;
+            ret = recv_discard(sock, unread, deadline);
+            if (ret != ESP_OK) {
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
+                return ret;
             }
         }
     }
@@ -501,11 +477,10 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
         bytes_already_read += 2;
         remaining_in_buffer -= 2;
     } else {
-        ret = recv_data(sock, &data_type, 2, timeout_ms, NULL);
+        ret = recv_data(sock, &data_type, 2, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data type");
+            session_release(sock, session_handle, false);
+            enip_error_set(&result->error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -522,22 +497,25 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
         cip_response_data_length = response_length - enip_overhead - cip_header_bytes;
     }
     
+    // Remember the type so later writes do not need to ask for it (direct targets only)
+    if (route == NULL || route->size == 0) {
+        profile_note_tag_type(ip_address, tag_path, data_type);
+    }
+    
     if (cip_response_data_length == 0) {
         result->data_length = 0;
         result->data = NULL;
         result->success = true;
         result->response_time_ms = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
-        unregister_session(sock, session_handle);
-        close(sock);
+        session_release(sock, session_handle, true);
         return ESP_OK;
     }
     
     // Allocate buffer for data
     uint8_t *data_buffer = malloc(cip_response_data_length);
     if (data_buffer == NULL) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        snprintf(result->error_message, sizeof(result->error_message), "Failed to allocate memory");
+        session_release(sock, session_handle, false);
+        enip_error_set(&result->error, ENIP_ERR_NO_MEMORY);
         return ESP_ERR_NO_MEM;
     }
     
@@ -549,21 +527,19 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
             memcpy(data_buffer, response_buffer + bytes_already_read, remaining_in_buffer);
             size_t bytes_from_buffer = remaining_in_buffer;
             size_t bytes_needed = cip_response_data_length - bytes_from_buffer;
-            ret = recv_data(sock, data_buffer + bytes_from_buffer, bytes_needed, timeout_ms, NULL);
+            ret = recv_data(sock, data_buffer + bytes_from_buffer, bytes_needed, deadline, NULL);
             if (ret != ESP_OK) {
                 free(data_buffer);
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data");
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
         } else {
-            ret = recv_data(sock, data_buffer, cip_response_data_length, timeout_ms, NULL);
+            ret = recv_data(sock, data_buffer, cip_response_data_length, deadline, NULL);
             if (ret != ESP_OK) {
                 free(data_buffer);
-                unregister_session(sock, session_handle);
-                close(sock);
-                snprintf(result->error_message, sizeof(result->error_message), "Failed to receive data");
+                session_release(sock, session_handle, false);
+                enip_error_set(&result->error, ENIP_ERR_RECV);
                 return ret;
             }
         }
@@ -575,12 +551,24 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
     result->response_time_ms = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
     
     
-    unregister_session(sock, session_handle);
-    close(sock);
+    session_release(sock, session_handle, true);
     
     return ESP_OK;
 }
 
+// Timed for the soak monitor like the assembly requests
+esp_err_t enip_scanner_read_tag_routed(const ip4_addr_t *ip_address,
+                                       const enip_scanner_route_t *route,
+                                       const char *tag_path,
+                                       enip_scanner_tag_result_t *result,
+                                       uint32_t timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = read_tag_routed(ip_address, route, tag_path, result, timeout_ms);
+    diag_record_request(start_us, ret == ESP_OK);
+    return ret;
+}
+
 // ============================================================================
 // Tag Write Operation
 // ============================================================================
@@ -591,61 +579,41 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
                                  uint16_t data_length,
                                  uint16_t cip_data_type,
                                  uint32_t timeout_ms,
-                                 char *error_message)
+                                 enip_scanner_error_t *error)
+{
+    return enip_scanner_write_tag_routed(ip_address, NULL, tag_path, data, data_length,
+                                         cip_data_type, timeout_ms, error);
+}
+
+static esp_err_t write_tag_routed(const ip4_addr_t *ip_address,
+                                  const enip_scanner_route_t *route,
+                                  const char *tag_path,
+                                  const uint8_t *data,
+                                  uint16_t data_length,
+                                  uint16_t cip_data_type,
+                                  uint32_t timeout_ms,
+                                  enip_scanner_error_t *error)
 {
     if (ip_address == NULL || tag_path == NULL || data == NULL || data_length == 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Invalid parameters");
-        }
+        enip_error_set(error, ENIP_ERR_INVALID_ARG);
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (error_message) {
-        error_message[0] = '\0';
-    }
+    enip_error_clear(error);
     
-    // Thread-safe check of initialization state
-    if (s_scanner_mutex == NULL) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
+    if (!scanner_is_ready()) {
+        enip_error_set(error, ENIP_ERR_NOT_INITIALIZED);
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (xSemaphoreTake(s_scanner_mutex, portMAX_DELAY) != pdTRUE) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to acquire mutex");
-        }
-        return ESP_FAIL;
-    }
+    // One deadline bounds connect, session registration, send and every receive
+    enip_deadline_t deadline = enip_deadline_from_timeout(timeout_ms);
     
-    bool initialized = s_scanner_initialized;
-    xSemaphoreGive(s_scanner_mutex);
-    
-    if (!initialized) {
-        if (error_message) {
-            snprintf(error_message, 128, "Scanner not initialized");
-        }
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    // Create TCP socket
-    int sock = create_tcp_socket(ip_address, timeout_ms);
-    if (sock < 0) {
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to connect to device");
-        }
-        return ESP_FAIL;
-    }
-    
-    // Register session
+    // Connect and register a session, or reuse a pooled one
+    int sock = -1;
     uint32_t session_handle = 0;
-    esp_err_t ret = register_session(sock, &session_handle);
+    esp_err_t ret = session_acquire(ip_address, deadline, &sock, &session_handle, error);
     if (ret != ESP_OK) {
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to register session");
-        }
         return ret;
     }
     
@@ -654,11 +622,8 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     uint8_t path_size_words = 0;
     ret = encode_tag_path(tag_path, cip_path, sizeof(cip_path), &path_size_words);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to encode tag path");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_PATH_ENCODE);
         return ret;
     }
     
@@ -668,10 +633,9 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     
     ret = tag_data_encode_write(cip_data_type, data, data_length,
                                 encoded_data_buffer, sizeof(encoded_data_buffer),
-                                &actual_encoded_length, error_message);
+                                &actual_encoded_length, error);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
+        session_release(sock, session_handle, false);
         return ret;
     }
     
@@ -687,14 +651,11 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     const size_t enip_header_size = 24;
     
     // Build complete packet
-    size_t total_packet_size = enip_header_size + enip_data_length;
-    uint8_t *packet = malloc(total_packet_size);
+    size_t total_packet_size = enip_header_size + enip_data_length + cip_route_overhead(route, cip_message_length);
+    uint8_t *packet = enip_buffer_alloc(total_packet_size);
     if (packet == NULL) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to allocate memory");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_NO_MEMORY);
         return ESP_ERR_NO_MEM;
     }
     
@@ -750,6 +711,7 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     offset += 2;
     
     // CIP Message: Service + Path Size + Path + DataType (2 bytes) + Element Count + Data
+    size_t cip_message_offset = offset;
     packet[offset++] = cip_service;  // 0x4D (Write Tag)
     packet[offset++] = path_size_words;
     memcpy(packet + offset, cip_path, path_size_words * 2);
@@ -761,26 +723,29 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     
     // Copy encoded data (with bounds check)
     if (offset + actual_encoded_length > total_packet_size) {
-        free(packet);
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Packet too large");
-        }
+        enip_buffer_free(packet);
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_REQUEST_TOO_LARGE);
         return ESP_ERR_INVALID_SIZE;
     }
     memcpy(packet + offset, encoded_data_buffer, actual_encoded_length);
     offset += actual_encoded_length;
     
+    // Controllers behind the connected device get the request via Unconnected Send
+    ret = cip_route_wrap(route, packet, &offset, total_packet_size, cip_message_offset, deadline);
+    if (ret != ESP_OK) {
+        enip_buffer_free(packet);
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_REQUEST_TOO_LARGE);
+        return ret;
+    }
+    
     // Send request
-    ret = send_data(sock, packet, offset);
-    free(packet);
+    ret = send_data(sock, packet, offset, deadline);
+    enip_buffer_free(packet);
     if (ret != ESP_OK) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to send request");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SEND);
         return ret;
     }
     
@@ -790,30 +755,21 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     size_t bytes_received = 0;
     
     // Receive at least the ENIP header (24 bytes)
-    ssize_t recv_ret = recv(sock, response_buffer, sizeof(response_buffer), 0);
+    ssize_t recv_ret = recv_available(sock, response_buffer, sizeof(response_buffer), deadline);
     if (recv_ret < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Timeout waiting for response");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_TIMEOUT);
             return ESP_ERR_TIMEOUT;
         }
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Failed to receive response: %d", errno);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_errno(error, ENIP_ERR_RECV, errno);
         return ESP_FAIL;
     }
     
     if (recv_ret == 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Connection closed by peer");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_PEER_CLOSED);
         return ESP_FAIL;
     }
     
@@ -821,7 +777,7 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     
     // Try to read more if we got a partial response
     if (bytes_received < 40) {
-        recv_ret = recv(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, 0);
+        recv_ret = recv_available(sock, response_buffer + bytes_received, sizeof(response_buffer) - bytes_received, deadline);
         if (recv_ret > 0) {
             bytes_received += recv_ret;
         }
@@ -829,11 +785,8 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     
     
     if (bytes_received < sizeof(enip_header_t)) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short: %zu bytes", bytes_received);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_SHORT_RESPONSE, bytes_received);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -848,11 +801,8 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     }
     
     if (header_offset + sizeof(enip_header_t) > bytes_received) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response too short");
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set(error, ENIP_ERR_SHORT_RESPONSE);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -861,20 +811,14 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     memcpy(&response_header, response_buffer + header_offset, sizeof(response_header));
     
     if (response_header.command != ENIP_SEND_RR_DATA) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Unexpected response command: 0x%04X", response_header.command);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_UNEXPECTED_COMMAND, response_header.command);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
     if (response_header.status != 0) {
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "Response error status: 0x%08lX", (unsigned long)response_header.status);
-        }
+        session_release(sock, session_handle, false);
+        enip_error_set_detail(error, ENIP_ERR_ENCAP_STATUS, response_header.status);
         return ESP_FAIL;
     }
     
@@ -888,13 +832,10 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
         remaining_in_buffer -= 16;
     } else {
         uint8_t skip_buffer[16];
-        ret = recv_data(sock, skip_buffer, 16, timeout_ms, NULL);
+        ret = recv_data(sock, skip_buffer, 16, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive response structure");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
     }
@@ -915,13 +856,10 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
         remaining_in_buffer -= 4;
     } else {
         uint8_t cip_header[4];
-        ret = recv_data(sock, cip_header, 4, timeout_ms, NULL);
+        ret = recv_data(sock, cip_header, 4, deadline, NULL);
         if (ret != ESP_OK) {
-            unregister_session(sock, session_handle);
-            close(sock);
-            if (error_message) {
-                snprintf(error_message, 128, "Failed to receive CIP header");
-            }
+            session_release(sock, session_handle, false);
+            enip_error_set(error, ENIP_ERR_RECV);
             return ret;
         }
         cip_status = cip_header[2];
@@ -929,16 +867,17 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
     }
     
     if (cip_status != 0x00) {
-        const char* status_msg = (cip_status == 0x05) ? "Object does not exist" :
-                                 (cip_status == 0x06) ? "Attribute does not exist" :
-                                 (cip_status == 0x0A) ? "Attribute not settable" :
-                                 (cip_status == 0x14) ? "Attribute not supported" : "Unknown error";
-        ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s", cip_status, tag_path ? tag_path : "(null)", status_msg);
-        unregister_session(sock, session_handle);
-        close(sock);
-        if (error_message) {
-            snprintf(error_message, 128, "CIP error status: 0x%02X (%s)", cip_status, status_msg);
-        }
+        ESP_LOGE(TAG, "CIP error status 0x%02X for tag '%s': %s", cip_status, tag_path ? tag_path : "(null)",
+                 enip_scanner_cip_status_name(cip_status));
+        // First extended status word, when it already arrived with the header
+        uint16_t ext_status = 0;
+        uint8_t ext_words = 0;
+        if (additional_status_size > 0 && remaining_in_buffer >= 2) {
+            ext_status = response_buffer[bytes_already_read] | (response_buffer[bytes_already_read + 1] << 8);
+            ext_words = additional_status_size;
+        }
+        session_release(sock, session_handle, false);
+        enip_error_set_cip(error, cip_status, ext_words, ext_status);
         return ESP_FAIL;
     }
     
@@ -949,22 +888,44 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
             bytes_already_read += safe_status_size;
             remaining_in_buffer -= safe_status_size;
         } else {
-            uint8_t *skip_buf = malloc(safe_status_size);
-            if (skip_buf) {
-                esp_err_t skip_ret = recv_data(sock, skip_buf, safe_status_size, timeout_ms, NULL);
-                free(skip_buf);
-                if (skip_ret != ESP_OK && skip_ret != ESP_ERR_TIMEOUT) {
-                }
+            // Part of it may already be buffered; only the rest is still on the socket
+            size_t unread = safe_status_size - remaining_in_buffer;
+            bytes_already_read += remaining_in_buffer;
+            remaining_in_buffer = 0;
+            ret = recv_discard(sock, unread, deadline);
+            if (ret != ESP_OK) {
+                session_release(sock, session_handle, false);
+                enip_error_set(error, ENIP_ERR_RECV);
+                return ret;
             }
         }
     }
     
-    unregister_session(sock, session_handle);
-    close(sock);
+    session_release(sock, session_handle, true);
+    
+    if (route == NULL || route->size == 0) {
+        profile_note_tag_type(ip_address, tag_path, cip_data_type);
+    }
     
     return ESP_OK;
 }
 
+esp_err_t enip_scanner_write_tag_routed(const ip4_addr_t *ip_address,
+                                        const enip_scanner_route_t *route,
+                                        const char *tag_path,
+                                        const uint8_t *data,
+                                        uint16_t data_length,
+                                        uint16_t cip_data_type,
+                                        uint32_t timeout_ms,
+                                        enip_scanner_error_t *error)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = write_tag_routed(ip_address, route, tag_path, data, data_length, cip_data_type,
+                                     timeout_ms, error);
+    diag_record_request(start_us, ret == ESP_OK);
+    return ret;
+}
+
 // ============================================================================
 // Tag Result Management
 // ============================================================================
@@ -21,6 +21,7 @@
  */
 
 #include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
 
 #if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
 #include "esp_log.h"
@@ -35,10 +36,10 @@ typedef struct {
     uint16_t cip_data_type;
     esp_err_t (*encode_write)(const uint8_t *input_data, uint16_t input_length,
                               uint8_t *output_buffer, size_t output_size,
-                              uint16_t *output_length, char *error_msg);
+                              uint16_t *output_length, enip_scanner_error_t *error);
     esp_err_t (*decode_read)(const uint8_t *input_data, uint16_t input_length,
                             uint8_t *output_buffer, size_t output_size,
-                            uint16_t *output_length, char *error_msg);
+                            uint16_t *output_length, enip_scanner_error_t *error);
     uint16_t (*get_encoded_size)(uint16_t input_length);
 } tag_data_type_handler_t;
 
@@ -48,9 +49,9 @@ typedef struct {
 
 static esp_err_t encode_standard(const uint8_t *input_data, uint16_t input_length,
                                  uint8_t *output_buffer, size_t output_size,
-                                 uint16_t *output_length, char *error_msg)
+                                 uint16_t *output_length, enip_scanner_error_t *error)
 {
-    (void)error_msg; // Unused for standard types
+    (void)error; // Unused for standard types
     if (output_size < input_length) {
         return ESP_ERR_INVALID_SIZE;
     }
@@ -61,9 +62,9 @@ static esp_err_t encode_standard(const uint8_t *input_data, uint16_t input_lengt
 
 static esp_err_t decode_standard(const uint8_t *input_data, uint16_t input_length,
                                 uint8_t *output_buffer, size_t output_size,
-                                uint16_t *output_length, char *error_msg)
+                                uint16_t *output_length, enip_scanner_error_t *error)
 {
-    (void)error_msg; // Unused for standard types
+    (void)error; // Unused for standard types
     if (output_size < input_length) {
         return ESP_ERR_INVALID_SIZE;
     }
@@ -83,7 +84,7 @@ static uint16_t get_standard_size(uint16_t input_length)
 
 static esp_err_t encode_string_write(const uint8_t *input_data, uint16_t input_length,
                                      uint8_t *output_buffer, size_t output_size,
-                                     uint16_t *output_length, char *error_msg)
+                                     uint16_t *output_length, enip_scanner_error_t *error)
 {
     // Remove null terminator if present
     uint16_t string_length = input_length;
@@ -93,17 +94,13 @@ static esp_err_t encode_string_write(const uint8_t *input_data, uint16_t input_l
     
     // Check max length (255 due to 1-byte length prefix)
     if (string_length > 255) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "String too long (max 255 characters)");
-        }
+        enip_error_set_detail(error, ENIP_ERR_DATA_SIZE, string_length);
         return ESP_ERR_INVALID_SIZE;
     }
     
     // Check output buffer size: 1 byte length + string bytes
     if (output_size < (1 + string_length)) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "Output buffer too small");
-        }
+        enip_error_set(error, ENIP_ERR_REQUEST_TOO_LARGE);
         return ESP_ERR_INVALID_SIZE;
     }
     
@@ -118,31 +115,24 @@ static esp_err_t encode_string_write(const uint8_t *input_data, uint16_t input_l
 
 static esp_err_t decode_string_read(const uint8_t *input_data, uint16_t input_length,
                                    uint8_t *output_buffer, size_t output_size,
-                                   uint16_t *output_length, char *error_msg)
+                                   uint16_t *output_length, enip_scanner_error_t *error)
 {
     // STRING format: [Length (1 byte)] [String bytes]
     if (input_length < 1) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "STRING data too short (need at least 1 byte)");
-        }
+        enip_error_set_detail(error, ENIP_ERR_DATA_SIZE, input_length);
         return ESP_ERR_INVALID_SIZE;
     }
     
     uint8_t str_length = input_data[0];
     
     if (input_length < (1 + str_length)) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "STRING data incomplete (length=%d, have=%d bytes)", 
-                     str_length, input_length);
-        }
+        enip_error_set_detail(error, ENIP_ERR_DATA_SIZE, input_length);
         return ESP_ERR_INVALID_SIZE;
     }
     
     // Check output buffer size
     if (output_size < str_length) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "Output buffer too small for STRING");
-        }
+        enip_error_set(error, ENIP_ERR_REQUEST_TOO_LARGE);
         return ESP_ERR_INVALID_SIZE;
     }
     
@@ -216,35 +206,31 @@ static const tag_data_type_handler_t *get_data_type_handler(uint16_t cip_data_ty
 esp_err_t tag_data_encode_write(uint16_t cip_data_type,
                                 const uint8_t *input_data, uint16_t input_length,
                                 uint8_t *output_buffer, size_t output_size,
-                                uint16_t *output_length, char *error_msg)
+                                uint16_t *output_length, enip_scanner_error_t *error)
 {
     const tag_data_type_handler_t *handler = get_data_type_handler(cip_data_type);
     if (handler == NULL) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "Unsupported data type: 0x%04X", cip_data_type);
-        }
+        enip_error_set_detail(error, ENIP_ERR_DATA_TYPE, cip_data_type);
         return ESP_ERR_NOT_SUPPORTED;
     }
     
     return handler->encode_write(input_data, input_length, output_buffer, 
-                                 output_size, output_length, error_msg);
+                                 output_size, output_length, error);
 }
 
 esp_err_t tag_data_decode_read(uint16_t cip_data_type,
                                const uint8_t *input_data, uint16_t input_length,
                                uint8_t *output_buffer, size_t output_size,
-                               uint16_t *output_length, char *error_msg)
+                               uint16_t *output_length, enip_scanner_error_t *error)
 {
     const tag_data_type_handler_t *handler = get_data_type_handler(cip_data_type);
     if (handler == NULL) {
-        if (error_msg) {
-            snprintf(error_msg, 128, "Unsupported data type: 0x%04X", cip_data_type);
-        }
+        enip_error_set_detail(error, ENIP_ERR_DATA_TYPE, cip_data_type);
         return ESP_ERR_NOT_SUPPORTED;
     }
     
     return handler->decode_read(input_data, input_length, output_buffer,
-                               output_size, output_length, error_msg);
+                               output_size, output_length, error);
 }
 
 uint16_t tag_data_get_encoded_size(uint16_t cip_data_type, uint16_t input_length)
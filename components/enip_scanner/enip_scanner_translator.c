@@ -0,0 +1,842 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+
+static const char *TAG = "enip_scanner_xlat";
+
+#define XLAT_TASK_STACK_SIZE 6144
+#define XLAT_MAX_DEVICES 16
+
+// One request of the compiled plan. Bindings that read the same point share a
+// read request; bindings that write into the same assembly or I/O group share a
+// write request whose data is the image written to the device.
+typedef struct {
+    uint8_t kind;               // enip_translator_point_kind_t
+    uint8_t type;               // Value type of data (tags: learned from the read)
+    uint8_t device;             // Index into s_devices
+    bool write;                 // Destination request; otherwise read every cycle
+    bool needs_seed;            // Only part of the image is mapped: read it once before writing
+    bool seeded;
+    bool valid;                 // Read: data holds this cycle's value
+    bool dirty;                 // Write: image changed (or must be rewritten) since the last successful write
+    ip4_addr_t ip_address;
+    uint16_t number;
+    char tag_path[64];
+    uint8_t *data;
+    uint16_t length;
+    uint16_t capacity;
+    esp_err_t last_result;
+} xlat_request_t;
+
+typedef struct {
+    enip_translator_binding_t binding;
+    enip_translator_binding_status_t status;
+    uint16_t source;            // Read request index
+    uint16_t destination;       // Write request index
+    bool has_previous;
+    double previous;            // Source value of the previous cycle (edge trigger)
+    bool has_written;
+    double written;             // Last value staged for the destination (change trigger)
+} xlat_slot_t;
+
+static xlat_slot_t *s_slots = NULL;
+static size_t s_slot_count = 0;
+static xlat_request_t *s_requests = NULL;
+static size_t s_request_count = 0;
+static ip4_addr_t s_devices[XLAT_MAX_DEVICES];
+static size_t s_device_count = 0;
+static enip_translator_status_t s_status;
+static SemaphoreHandle_t s_xlat_mutex = NULL;
+static TaskHandle_t s_xlat_task_handle = NULL;
+static volatile bool s_xlat_running = false;
+
+// ============================================================================
+// Values
+// ============================================================================
+
+static uint8_t type_size(uint8_t type)
+{
+    switch (type) {
+        case ENIP_TRANSLATOR_TYPE_INT:
+        case ENIP_TRANSLATOR_TYPE_UINT:
+            return 2;
+        case ENIP_TRANSLATOR_TYPE_DINT:
+        case ENIP_TRANSLATOR_TYPE_UDINT:
+        case ENIP_TRANSLATOR_TYPE_REAL:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+// Motoman points carry a fixed type; tag and assembly points name theirs
+static uint8_t point_type(const enip_translator_point_t *point)
+{
+    switch (point->kind) {
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_IO:
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_B:
+            return ENIP_TRANSLATOR_TYPE_USINT;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_REGISTER:
+            return ENIP_TRANSLATOR_TYPE_UINT;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_I:
+            return ENIP_TRANSLATOR_TYPE_INT;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_D:
+            return ENIP_TRANSLATOR_TYPE_DINT;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R:
+            return ENIP_TRANSLATOR_TYPE_REAL;
+        default:
+            return point->type;
+    }
+}
+
+static bool decode_value(const uint8_t *data, uint16_t length, uint16_t offset, uint8_t type, uint8_t bit,
+                         double *value)
+{
+    uint8_t size = type_size(type);
+    if (data == NULL || (uint32_t)offset + size > length) {
+        return false;
+    }
+    uint32_t raw = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        raw |= (uint32_t)data[offset + i] << (8 * i);
+    }
+    if (bit != ENIP_TRANSLATOR_NO_BIT) {
+        *value = (raw >> bit) & 1;
+        return true;
+    }
+    
+    switch (type) {
+        case ENIP_TRANSLATOR_TYPE_BOOL:
+            *value = raw != 0;
+            break;
+        case ENIP_TRANSLATOR_TYPE_SINT:
+            *value = (int8_t)raw;
+            break;
+        case ENIP_TRANSLATOR_TYPE_INT:
+            *value = (int16_t)raw;
+            break;
+        case ENIP_TRANSLATOR_TYPE_DINT:
+            *value = (int32_t)raw;
+            break;
+        case ENIP_TRANSLATOR_TYPE_REAL: {
+            float f;
+            memcpy(&f, &raw, sizeof(f));
+            *value = f;
+            break;
+        }
+        default:
+            *value = raw;
+            break;
+    }
+    return true;
+}
+
+// Store a value at offset; integers are rounded and saturated to the type's range
+static bool encode_value(uint8_t *data, uint16_t length, uint16_t offset, uint8_t type, uint8_t bit, double value)
+{
+    uint8_t size = type_size(type);
+    if (data == NULL || (uint32_t)offset + size > length) {
+        return false;
+    }
+    uint32_t raw = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        raw |= (uint32_t)data[offset + i] << (8 * i);
+    }
+    
+    if (bit != ENIP_TRANSLATOR_NO_BIT) {
+        raw = (value != 0) ? (raw | (1u << bit)) : (raw & ~(1u << bit));
+    } else if (type == ENIP_TRANSLATOR_TYPE_REAL) {
+        float f = (float)value;
+        memcpy(&raw, &f, sizeof(raw));
+    } else if (type == ENIP_TRANSLATOR_TYPE_BOOL) {
+        raw = value != 0;
+    } else {
+        static const double limits[][2] = {
+            [ENIP_TRANSLATOR_TYPE_SINT] = { INT8_MIN, INT8_MAX },
+            [ENIP_TRANSLATOR_TYPE_INT] = { INT16_MIN, INT16_MAX },
+            [ENIP_TRANSLATOR_TYPE_DINT] = { INT32_MIN, INT32_MAX },
+            [ENIP_TRANSLATOR_TYPE_USINT] = { 0, UINT8_MAX },
+            [ENIP_TRANSLATOR_TYPE_UINT] = { 0, UINT16_MAX },
+            [ENIP_TRANSLATOR_TYPE_UDINT] = { 0, UINT32_MAX },
+        };
+        double rounded = round(value);
+        if (isnan(rounded)) {
+            rounded = 0;
+        }
+        if (rounded < limits[type][0]) {
+            rounded = limits[type][0];
+        } else if (rounded > limits[type][1]) {
+            rounded = limits[type][1];
+        }
+        raw = (rounded < 0) ? (uint32_t)(int32_t)rounded : (uint32_t)rounded;
+    }
+    
+    for (uint8_t i = 0; i < size; i++) {
+        data[offset + i] = (uint8_t)(raw >> (8 * i));
+    }
+    return true;
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+static bool type_from_cip(uint16_t cip_data_type, uint8_t *type)
+{
+    switch (cip_data_type) {
+        case CIP_DATA_TYPE_BOOL:  *type = ENIP_TRANSLATOR_TYPE_BOOL;  return true;
+        case CIP_DATA_TYPE_SINT:  *type = ENIP_TRANSLATOR_TYPE_SINT;  return true;
+        case CIP_DATA_TYPE_INT:   *type = ENIP_TRANSLATOR_TYPE_INT;   return true;
+        case CIP_DATA_TYPE_DINT:  *type = ENIP_TRANSLATOR_TYPE_DINT;  return true;
+        case CIP_DATA_TYPE_USINT: *type = ENIP_TRANSLATOR_TYPE_USINT; return true;
+        case CIP_DATA_TYPE_BYTE:  *type = ENIP_TRANSLATOR_TYPE_USINT; return true;
+        case CIP_DATA_TYPE_UINT:  *type = ENIP_TRANSLATOR_TYPE_UINT;  return true;
+        case CIP_DATA_TYPE_WORD:  *type = ENIP_TRANSLATOR_TYPE_UINT;  return true;
+        case CIP_DATA_TYPE_UDINT: *type = ENIP_TRANSLATOR_TYPE_UDINT; return true;
+        case CIP_DATA_TYPE_DWORD: *type = ENIP_TRANSLATOR_TYPE_UDINT; return true;
+        case CIP_DATA_TYPE_REAL:  *type = ENIP_TRANSLATOR_TYPE_REAL;  return true;
+        default: return false;
+    }
+}
+
+static const uint16_t s_cip_types[] = {
+    [ENIP_TRANSLATOR_TYPE_BOOL] = CIP_DATA_TYPE_BOOL,
+    [ENIP_TRANSLATOR_TYPE_SINT] = CIP_DATA_TYPE_SINT,
+    [ENIP_TRANSLATOR_TYPE_INT] = CIP_DATA_TYPE_INT,
+    [ENIP_TRANSLATOR_TYPE_DINT] = CIP_DATA_TYPE_DINT,
+    [ENIP_TRANSLATOR_TYPE_USINT] = CIP_DATA_TYPE_USINT,
+    [ENIP_TRANSLATOR_TYPE_UINT] = CIP_DATA_TYPE_UINT,
+    [ENIP_TRANSLATOR_TYPE_UDINT] = CIP_DATA_TYPE_UDINT,
+    [ENIP_TRANSLATOR_TYPE_REAL] = CIP_DATA_TYPE_REAL,
+};
+#endif
+
+// ============================================================================
+// Plan
+// ============================================================================
+
+static bool request_store(xlat_request_t *request, const uint8_t *data, uint16_t length)
+{
+    if (length > request->capacity) {
+        uint8_t *grown = enip_mem_realloc(ENIP_MEM_HOT, request->data, length);
+        if (grown == NULL) {
+            return false;
+        }
+        request->data = grown;
+        request->capacity = length;
+    }
+    memcpy(request->data, data, length);
+    request->length = length;
+    return true;
+}
+
+// Requests are shared by points in the same assembly, tag, I/O group or variable
+static bool request_matches(const xlat_request_t *request, const enip_translator_point_t *point, bool write)
+{
+    if (request->write != write || request->kind != point->kind ||
+        !ip4_addr_cmp(&request->ip_address, &point->ip_address)) {
+        return false;
+    }
+    switch (point->kind) {
+        case ENIP_TRANSLATOR_POINT_TAG:
+            return strcmp(request->tag_path, point->tag_path) == 0;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_IO:
+            return request->number / 10 == point->number / 10;
+        default:
+            return request->number == point->number;
+    }
+}
+
+static int plan_request(const enip_translator_point_t *point, bool write)
+{
+    for (size_t i = 0; i < s_request_count; i++) {
+        if (request_matches(&s_requests[i], point, write)) {
+            return (int)i;
+        }
+    }
+    
+    size_t device = 0;
+    while (device < s_device_count && !ip4_addr_cmp(&s_devices[device], &point->ip_address)) {
+        device++;
+    }
+    if (device == s_device_count) {
+        if (s_device_count == XLAT_MAX_DEVICES) {
+            return -1;
+        }
+        s_devices[s_device_count++] = point->ip_address;
+    }
+    
+    xlat_request_t *request = &s_requests[s_request_count];
+    memset(request, 0, sizeof(*request));
+    request->kind = point->kind;
+    request->type = point_type(point);
+    request->device = (uint8_t)device;
+    request->write = write;
+    request->ip_address = point->ip_address;
+    request->number = point->number;
+    request->last_result = ESP_OK;
+    strlcpy(request->tag_path, point->tag_path, sizeof(request->tag_path));
+    
+    if (write) {
+        // The full assembly and the other signals of an I/O group keep their current values
+        request->needs_seed = point->kind == ENIP_TRANSLATOR_POINT_ASSEMBLY ||
+                              (point->kind == ENIP_TRANSLATOR_POINT_MOTOMAN_IO && point->bit != ENIP_TRANSLATOR_NO_BIT);
+        if (!request->needs_seed) {
+            request->capacity = request->length = type_size(request->type);
+            request->data = enip_mem_calloc(ENIP_MEM_HOT, 1, request->capacity);
+            if (request->data == NULL) {
+                return -1;
+            }
+        }
+    }
+    return (int)s_request_count++;
+}
+
+static bool point_supported(const enip_translator_point_t *point)
+{
+#if !CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+    if (point->kind == ENIP_TRANSLATOR_POINT_TAG) {
+        return false;
+    }
+#endif
+#if !CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
+    if (point->kind >= ENIP_TRANSLATOR_POINT_MOTOMAN_IO) {
+        return false;
+    }
+#endif
+    (void)point;
+    return true;
+}
+
+static bool point_valid(const enip_translator_point_t *point, bool write)
+{
+    if (point->kind > ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R || point->type > ENIP_TRANSLATOR_TYPE_REAL) {
+        return false;
+    }
+    if (point->bit != ENIP_TRANSLATOR_NO_BIT && point->bit >= type_size(point_type(point)) * 8) {
+        return false;
+    }
+    if (point->kind == ENIP_TRANSLATOR_POINT_TAG &&
+        (point->tag_path[0] == '\0' || (write && point->bit != ENIP_TRANSLATOR_NO_BIT))) {
+        return false;   // Bits of tags are read-only; write BOOL tags instead
+    }
+    return true;
+}
+
+static void free_plan(void)
+{
+    for (size_t i = 0; i < s_request_count; i++) {
+        enip_mem_free(s_requests[i].data);
+    }
+    enip_mem_free(s_requests);
+    enip_mem_free(s_slots);
+    s_requests = NULL;
+    s_slots = NULL;
+    s_request_count = 0;
+    s_slot_count = 0;
+    s_device_count = 0;
+}
+
+// ============================================================================
+// Scan cycle
+// ============================================================================
+
+static esp_err_t execute_read(xlat_request_t *request, uint32_t timeout_ms)
+{
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+    uint8_t value[4] = {0};
+    
+    switch (request->kind) {
+        case ENIP_TRANSLATOR_POINT_ASSEMBLY: {
+            enip_scanner_assembly_result_t result;
+            ret = enip_scanner_read_assembly(&request->ip_address, request->number, &result, timeout_ms);
+            if (ret == ESP_OK && (!result.success || !request_store(request, result.data, result.data_length))) {
+                ret = ESP_FAIL;
+            }
+            enip_scanner_free_assembly_result(&result);
+            return ret;
+        }
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+        case ENIP_TRANSLATOR_POINT_TAG: {
+            enip_scanner_tag_result_t result;
+            ret = enip_scanner_read_tag(&request->ip_address, request->tag_path, &result, timeout_ms);
+            if (ret == ESP_OK && (!result.success || !type_from_cip(result.cip_data_type, &request->type) ||
+                                  !request_store(request, result.data, result.data_length))) {
+                ret = ESP_FAIL;
+            }
+            enip_scanner_free_tag_result(&result);
+            return ret;
+        }
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_IO:
+            ret = enip_scanner_motoman_read_io(&request->ip_address, request->number, value, timeout_ms, NULL);
+            break;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_REGISTER: {
+            uint16_t reg = 0;
+            ret = enip_scanner_motoman_read_register(&request->ip_address, request->number, &reg, timeout_ms, NULL);
+            memcpy(value, &reg, sizeof(reg));
+            break;
+        }
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_B:
+            ret = enip_scanner_motoman_read_variable_b(&request->ip_address, request->number, value, timeout_ms, NULL);
+            break;
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_I: {
+            int16_t var = 0;
+            ret = enip_scanner_motoman_read_variable_i(&request->ip_address, request->number, &var, timeout_ms, NULL);
+            memcpy(value, &var, sizeof(var));
+            break;
+        }
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_D: {
+            int32_t var = 0;
+            ret = enip_scanner_motoman_read_variable_d(&request->ip_address, request->number, &var, timeout_ms, NULL);
+            memcpy(value, &var, sizeof(var));
+            break;
+        }
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R: {
+            float var = 0;
+            ret = enip_scanner_motoman_read_variable_r(&request->ip_address, request->number, &var, timeout_ms, NULL);
+            memcpy(value, &var, sizeof(var));
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+    
+    if (ret == ESP_OK && !request_store(request, value, type_size(request->type))) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    return ret;
+}
+
+static esp_err_t execute_write(const xlat_request_t *request, uint32_t timeout_ms)
+{
+    const uint8_t *data = request->data;
+    
+    switch (request->kind) {
+        case ENIP_TRANSLATOR_POINT_ASSEMBLY:
+            return enip_scanner_write_assembly(&request->ip_address, request->number, data, request->length,
+                                               timeout_ms, NULL);
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+        case ENIP_TRANSLATOR_POINT_TAG:
+            return enip_scanner_write_tag(&request->ip_address, request->tag_path, data, request->length,
+                                          s_cip_types[request->type], timeout_ms, NULL);
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_IO:
+            return enip_scanner_motoman_write_io(&request->ip_address, request->number, data[0], timeout_ms, NULL);
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_REGISTER:
+            return enip_scanner_motoman_write_register(&request->ip_address, request->number,
+                                                       (uint16_t)(data[0] | (data[1] << 8)), timeout_ms, NULL);
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_B:
+            return enip_scanner_motoman_write_variable_b(&request->ip_address, request->number, data[0],
+                                                         timeout_ms, NULL);
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_I:
+            return enip_scanner_motoman_write_variable_i(&request->ip_address, request->number,
+                                                         (int16_t)(data[0] | (data[1] << 8)), timeout_ms, NULL);
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_D: {
+            int32_t value;
+            memcpy(&value, data, sizeof(value));
+            return enip_scanner_motoman_write_variable_d(&request->ip_address, request->number, value,
+                                                         timeout_ms, NULL);
+        }
+        case ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R: {
+            float value;
+            memcpy(&value, data, sizeof(value));
+            return enip_scanner_motoman_write_variable_r(&request->ip_address, request->number, value,
+                                                         timeout_ms, NULL);
+        }
+#endif
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+// Points share an assembly request, so each one names its own type and offset;
+// any other request holds exactly one value
+static uint8_t value_type(const enip_translator_point_t *point, const xlat_request_t *request)
+{
+    return point->kind == ENIP_TRANSLATOR_POINT_ASSEMBLY ? point->type : request->type;
+}
+
+static uint16_t point_offset(const enip_translator_point_t *point)
+{
+    return point->kind == ENIP_TRANSLATOR_POINT_ASSEMBLY ? point->offset : 0;
+}
+
+// Map every binding from its source request into its destination request
+// Caller holds s_xlat_mutex
+static void evaluate_bindings_locked(void)
+{
+    for (size_t i = 0; i < s_slot_count; i++) {
+        xlat_slot_t *slot = &s_slots[i];
+        const enip_translator_binding_t *binding = &slot->binding;
+        if (!binding->enabled) {
+            continue;
+        }
+        
+        xlat_request_t *source = &s_requests[slot->source];
+        double value;
+        if (!source->valid) {
+            slot->status.failures++;
+            slot->status.last_result = source->last_result;
+            continue;
+        }
+        if (!decode_value(source->data, source->length, point_offset(&binding->source),
+                          value_type(&binding->source, source), binding->source.bit, &value)) {
+            slot->status.failures++;
+            slot->status.last_result = ESP_ERR_INVALID_SIZE;
+            continue;
+        }
+        
+        double out = value * binding->scale + binding->offset;
+        bool fire;
+        switch (binding->trigger) {
+            case ENIP_TRANSLATOR_TRIGGER_ON_CHANGE:
+                fire = !slot->has_written || out != slot->written;
+                break;
+            case ENIP_TRANSLATOR_TRIGGER_RISING_EDGE:
+                fire = slot->has_previous && slot->previous == 0 && value != 0;
+                break;
+            default:
+                fire = true;
+                break;
+        }
+        slot->has_previous = true;
+        slot->previous = value;
+        slot->status.valid = true;
+        slot->status.value = (float)out;
+        if (!fire) {
+            continue;
+        }
+        
+        xlat_request_t *destination = &s_requests[slot->destination];
+        if (destination->needs_seed && !destination->seeded) {
+            // Current device image not known yet; the change is retried next cycle
+            slot->status.last_result = ESP_ERR_INVALID_STATE;
+            continue;
+        }
+        if (!encode_value(destination->data, destination->length, point_offset(&binding->destination),
+                          value_type(&binding->destination, destination), binding->destination.bit, out)) {
+            slot->status.failures++;
+            slot->status.last_result = ESP_ERR_INVALID_SIZE;
+            continue;
+        }
+        destination->dirty = true;
+        slot->has_written = true;
+        slot->written = out;
+        slot->status.writes++;
+        slot->status.last_result = destination->last_result;
+    }
+}
+
+static void run_cycle(uint32_t timeout_ms, uint32_t *read_failures, uint32_t *write_failures)
+{
+    bool device_down[XLAT_MAX_DEVICES] = {false};
+    
+    // Reads, one device after the other so pooled sessions stay warm; a device
+    // that times out is skipped for the rest of the cycle
+    for (size_t d = 0; d < s_device_count && s_xlat_running; d++) {
+        for (size_t i = 0; i < s_request_count; i++) {
+            xlat_request_t *request = &s_requests[i];
+            if (request->device != d || (request->write && (!request->needs_seed || request->seeded))) {
+                continue;
+            }
+            if (device_down[d]) {
+                request->valid = false;
+                continue;
+            }
+            esp_err_t ret = execute_read(request, timeout_ms);
+            request->last_result = ret;
+            if (request->write) {
+                request->seeded = ret == ESP_OK;    // Destination image seeded from the device
+            } else {
+                request->valid = ret == ESP_OK;
+            }
+            if (ret != ESP_OK) {
+                (*read_failures)++;
+                device_down[d] = ret == ESP_ERR_TIMEOUT;
+            }
+        }
+    }
+    
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    evaluate_bindings_locked();
+    xSemaphoreGive(s_xlat_mutex);
+    
+    for (size_t d = 0; d < s_device_count && s_xlat_running; d++) {
+        for (size_t i = 0; i < s_request_count; i++) {
+            xlat_request_t *request = &s_requests[i];
+            if (request->device != d || !request->write || !request->dirty || device_down[d]) {
+                continue;
+            }
+            esp_err_t ret = execute_write(request, timeout_ms);
+            request->last_result = ret;
+            if (ret == ESP_OK) {
+                request->dirty = false;
+            } else {
+                (*write_failures)++;    // Stays dirty: retried next cycle
+                device_down[d] = ret == ESP_ERR_TIMEOUT;
+            }
+        }
+    }
+}
+
+static void translator_task(void *arg)
+{
+    (void)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(s_status.cycle_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    while (s_xlat_running) {
+        uint32_t read_failures = 0;
+        uint32_t write_failures = 0;
+        int64_t start_us = esp_timer_get_time();
+        run_cycle(CONFIG_ENIP_SCANNER_TRANSLATOR_TIMEOUT_MS, &read_failures, &write_failures);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+        
+        xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+        s_status.cycles++;
+        s_status.last_cycle_us = elapsed_us;
+        if (s_status.cycles == 1 || elapsed_us < s_status.min_cycle_us) {
+            s_status.min_cycle_us = elapsed_us;
+        }
+        if (elapsed_us > s_status.max_cycle_us) {
+            s_status.max_cycle_us = elapsed_us;
+        }
+        s_status.avg_cycle_us = (s_status.cycles == 1) ? elapsed_us :
+                                s_status.avg_cycle_us - s_status.avg_cycle_us / 16 + elapsed_us / 16;
+        s_status.read_failures += read_failures;
+        s_status.write_failures += write_failures;
+        bool overrun = elapsed_us > s_status.cycle_ms * 1000;
+        if (overrun) {
+            s_status.overruns++;
+        }
+        xSemaphoreGive(s_xlat_mutex);
+        
+        if (overrun) {
+            // Start the next cycle now instead of trying to catch up
+            vTaskDelay(1);
+            last_wake = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&last_wake, period);
+        }
+    }
+    
+    s_xlat_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t enip_scanner_translator_start(const enip_translator_binding_t *bindings, size_t count, uint32_t cycle_ms)
+{
+    if ((count > 0 && bindings == NULL) || cycle_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (count > CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!point_valid(&bindings[i].source, false) || !point_valid(&bindings[i].destination, true) ||
+            bindings[i].trigger > ENIP_TRANSLATOR_TRIGGER_RISING_EDGE) {
+            ESP_LOGE(TAG, "Binding %u is invalid", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (!point_supported(&bindings[i].source) || !point_supported(&bindings[i].destination)) {
+            ESP_LOGE(TAG, "Binding %u uses tag or Motoman support that is not enabled", (unsigned)i);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+    if (s_xlat_mutex == NULL) {
+        s_xlat_mutex = xSemaphoreCreateMutex();
+        if (s_xlat_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_xlat_running || s_xlat_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    free_plan();
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.cycle_ms = cycle_ms;
+    if (count == 0) {
+        xSemaphoreGive(s_xlat_mutex);
+        return ESP_OK;
+    }
+    
+    s_slots = enip_mem_calloc(ENIP_MEM_HOT, count, sizeof(xlat_slot_t));
+    s_requests = enip_mem_calloc(ENIP_MEM_HOT, count * 2, sizeof(xlat_request_t));
+    if (s_slots == NULL || s_requests == NULL) {
+        free_plan();
+        xSemaphoreGive(s_xlat_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Compile: one read per distinct source, one write per destination image
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < count && ret == ESP_OK; i++) {
+        xlat_slot_t *slot = &s_slots[i];
+        slot->binding = bindings[i];
+        slot->binding.name[sizeof(slot->binding.name) - 1] = '\0';
+        slot->binding.source.tag_path[sizeof(slot->binding.source.tag_path) - 1] = '\0';
+        slot->binding.destination.tag_path[sizeof(slot->binding.destination.tag_path) - 1] = '\0';
+        slot->status.last_result = ESP_OK;
+        s_slot_count = i + 1;
+        if (!slot->binding.enabled) {
+            continue;
+        }
+        int source = plan_request(&slot->binding.source, false);
+        int destination = plan_request(&slot->binding.destination, true);
+        if (source < 0 || destination < 0) {
+            ESP_LOGE(TAG, "Binding %u: more than %d devices or out of memory", (unsigned)i, XLAT_MAX_DEVICES);
+            ret = ESP_ERR_NO_MEM;
+            break;
+        }
+        slot->source = (uint16_t)source;
+        slot->destination = (uint16_t)destination;
+    }
+    if (ret != ESP_OK) {
+        free_plan();
+        xSemaphoreGive(s_xlat_mutex);
+        return ret;
+    }
+    
+    for (size_t i = 0; i < s_request_count; i++) {
+        if (s_requests[i].write) {
+            s_status.write_requests++;
+        } else {
+            s_status.read_requests++;
+        }
+    }
+    s_status.devices = s_device_count;
+    s_status.running = true;
+    s_xlat_running = true;
+    xSemaphoreGive(s_xlat_mutex);
+    
+    if (xTaskCreate(translator_task, "enip_xlat", XLAT_TASK_STACK_SIZE, NULL, 3, &s_xlat_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create translator task");
+        s_xlat_running = false;
+        s_status.running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "Translator started: %u bindings -> %u reads and %u writes on %u devices every %lu ms",
+             (unsigned)count, s_status.read_requests, s_status.write_requests, s_status.devices,
+             (unsigned long)cycle_ms);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_translator_stop(void)
+{
+    if (s_xlat_mutex == NULL || (!s_xlat_running && s_xlat_task_handle == NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_xlat_running = false;
+    while (s_xlat_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    s_status.running = false;
+    xSemaphoreGive(s_xlat_mutex);
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_translator_get_status(enip_translator_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_xlat_mutex == NULL) {
+        memset(status, 0, sizeof(*status));
+        return ESP_OK;
+    }
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    *status = s_status;
+    xSemaphoreGive(s_xlat_mutex);
+    return ESP_OK;
+}
+
+size_t enip_scanner_translator_get_count(void)
+{
+    return s_slot_count;
+}
+
+void translator_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = 0;
+    footprint->items = 0;
+    if (s_xlat_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    footprint->items = s_slot_count;
+    footprint->bytes = s_slot_count * sizeof(xlat_slot_t) + s_request_count * sizeof(xlat_request_t) +
+                       (s_xlat_running ? XLAT_TASK_STACK_SIZE : 0);
+    xSemaphoreGive(s_xlat_mutex);
+}
+
+esp_err_t enip_scanner_translator_get_binding(size_t index, enip_translator_binding_t *binding,
+                                              enip_translator_binding_status_t *status)
+{
+    if (s_xlat_mutex == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(s_xlat_mutex, portMAX_DELAY);
+    if (index >= s_slot_count) {
+        xSemaphoreGive(s_xlat_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (binding != NULL) {
+        *binding = s_slots[index].binding;
+    }
+    if (status != NULL) {
+        *status = s_slots[index].status;
+    }
+    xSemaphoreGive(s_xlat_mutex);
+    return ESP_OK;
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "enip_scanner_write_queue_internal.h"
+#include "enip_scanner_mem_internal.h"
+#include "enip_scanner.h"
+#include "enip_scanner_error_internal.h"
+#include "enip_scanner_log_internal.h"
+#include "enip_scanner_diag_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+
+static const char *TAG = "enip_scanner_wq";
+
+#define WRITE_QUEUE_TASK_STACK_SIZE 4096
+
+typedef enum {
+    WRITE_TARGET_ASSEMBLY = 0,
+    WRITE_TARGET_TAG,
+} write_target_kind_t;
+
+// One slot per (device, path). While a write for the slot is in flight, a new
+// value replaces the pending one instead of queueing behind it.
+typedef struct {
+    bool used;                   // Slot is bound to a target
+    bool pending;                // pending_data holds a value not yet written
+    bool in_flight;              // A worker is writing this target right now
+    write_target_kind_t kind;
+    ip4_addr_t ip_address;
+    uint16_t assembly_instance;
+    uint16_t cip_data_type;
+    char tag_path[128];
+    uint8_t *pending_data;
+    uint16_t pending_length;
+    uint32_t timeout_ms;
+    uint32_t coalesced;          // Values replaced since the last completed write
+    TickType_t last_activity;
+} write_slot_t;
+
+static write_slot_t s_slots[CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS];
+static SemaphoreHandle_t s_wq_mutex = NULL;
+static TaskHandle_t s_wq_tasks[CONFIG_ENIP_SCANNER_WRITE_QUEUE_WORKERS];
+static enip_scanner_write_complete_callback_t s_callback = NULL;
+static void *s_callback_user_data = NULL;
+static uint32_t s_next_slot = 0;
+
+static bool slot_matches(const write_slot_t *slot, write_target_kind_t kind, const ip4_addr_t *ip_address,
+                         uint16_t assembly_instance, const char *tag_path)
+{
+    if (!slot->used || slot->kind != kind || !ip4_addr_cmp(&slot->ip_address, ip_address)) {
+        return false;
+    }
+    if (kind == WRITE_TARGET_ASSEMBLY) {
+        return slot->assembly_instance == assembly_instance;
+    }
+    return strcmp(slot->tag_path, tag_path) == 0;
+}
+
+// Find the slot for a target, or bind a free one (must hold s_wq_mutex)
+static write_slot_t *slot_get(write_target_kind_t kind, const ip4_addr_t *ip_address,
+                              uint16_t assembly_instance, const char *tag_path)
+{
+    write_slot_t *idle = NULL;
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS; i++) {
+        write_slot_t *slot = &s_slots[i];
+        if (slot_matches(slot, kind, ip_address, assembly_instance, tag_path)) {
+            return slot;
+        }
+        // Unused slots first, then the least recently used idle one
+        if (!slot->pending && !slot->in_flight) {
+            if (idle == NULL || (idle->used && (!slot->used || slot->last_activity < idle->last_activity))) {
+                idle = slot;
+            }
+        }
+    }
+    if (idle == NULL) {
+        return NULL;
+    }
+    
+    memset(idle, 0, sizeof(*idle));
+    idle->used = true;
+    idle->kind = kind;
+    idle->ip_address = *ip_address;
+    idle->assembly_instance = assembly_instance;
+    if (tag_path != NULL) {
+        strlcpy(idle->tag_path, tag_path, sizeof(idle->tag_path));
+    }
+    return idle;
+}
+
+static esp_err_t write_queue_submit(write_target_kind_t kind, const ip4_addr_t *ip_address,
+                                    uint16_t assembly_instance, const char *tag_path,
+                                    const uint8_t *data, uint16_t data_length,
+                                    uint16_t cip_data_type, uint32_t timeout_ms)
+{
+    if (s_wq_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // Copy outside the lock; the caller's buffer is free to reuse on return
+    uint8_t *copy = enip_mem_alloc(ENIP_MEM_HOT, data_length);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, data, data_length);
+    
+    xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+    write_slot_t *slot = slot_get(kind, ip_address, assembly_instance, tag_path);
+    if (slot == NULL) {
+        xSemaphoreGive(s_wq_mutex);
+        enip_mem_free(copy);
+        ENIP_LOG_LIMITED(ESP_LOG_WARN, TAG, "All %d write slots busy, write to " IPSTR " rejected",
+                         CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS, IP2STR(ip_address));
+        return ESP_ERR_NO_MEM;
+    }
+    
+    uint8_t *replaced = NULL;
+    if (slot->pending) {
+        replaced = slot->pending_data;
+        slot->coalesced++;
+    }
+    slot->pending = true;
+    slot->pending_data = copy;
+    slot->pending_length = data_length;
+    slot->cip_data_type = cip_data_type;
+    slot->timeout_ms = timeout_ms;
+    slot->last_activity = xTaskGetTickCount();
+    xSemaphoreGive(s_wq_mutex);
+    
+    enip_mem_free(replaced);
+    
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_WRITE_QUEUE_WORKERS; i++) {
+        if (s_wq_tasks[i] != NULL) {
+            xTaskNotifyGive(s_wq_tasks[i]);
+        }
+    }
+    return ESP_OK;
+}
+
+// Take the next pending value whose target has no write in flight, scanning
+// round-robin so one busy target cannot starve the others (must hold s_wq_mutex)
+static write_slot_t *slot_take_next(void)
+{
+    for (int n = 0; n < CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS; n++) {
+        uint32_t i = (s_next_slot + n) % CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS;
+        write_slot_t *slot = &s_slots[i];
+        if (slot->pending && !slot->in_flight) {
+            s_next_slot = i + 1;
+            slot->pending = false;
+            slot->in_flight = true;
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static void write_queue_task(void *arg)
+{
+    (void)arg;
+    
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        while (1) {
+            xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+            write_slot_t *slot = slot_take_next();
+            if (slot == NULL) {
+                xSemaphoreGive(s_wq_mutex);
+                break;
+            }
+            // Only this worker touches the slot's target fields while in_flight is set
+            uint8_t *data = slot->pending_data;
+            uint16_t data_length = slot->pending_length;
+            uint16_t cip_data_type = slot->cip_data_type;
+            uint32_t timeout_ms = slot->timeout_ms;
+            uint32_t coalesced = slot->coalesced;
+            slot->pending_data = NULL;
+            slot->coalesced = 0;
+            xSemaphoreGive(s_wq_mutex);
+            
+            enip_scanner_error_t error = {0};
+            esp_err_t ret;
+            if (slot->kind == WRITE_TARGET_ASSEMBLY) {
+                ret = enip_scanner_write_assembly(&slot->ip_address, slot->assembly_instance,
+                                                  data, data_length, timeout_ms, &error);
+            } else {
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+                ret = enip_scanner_write_tag(&slot->ip_address, slot->tag_path, data, data_length,
+                                             cip_data_type, timeout_ms, &error);
+#else
+                (void)cip_data_type;
+                ret = ESP_ERR_NOT_SUPPORTED;
+#endif
+            }
+            enip_mem_free(data);
+            
+            if (ret != ESP_OK) {
+                char error_text[96];
+                ENIP_LOG_LIMITED(ESP_LOG_WARN, TAG, "Coalesced write to " IPSTR " failed: %s", IP2STR(&slot->ip_address),
+                                 enip_scanner_format_error(&error, error_text, sizeof(error_text)));
+            }
+            
+            xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+            enip_scanner_write_complete_callback_t callback = s_callback;
+            void *user_data = s_callback_user_data;
+            xSemaphoreGive(s_wq_mutex);
+            if (callback != NULL) {
+                callback(&slot->ip_address,
+                         slot->kind == WRITE_TARGET_ASSEMBLY ? slot->assembly_instance : 0,
+                         slot->kind == WRITE_TARGET_TAG ? slot->tag_path : NULL,
+                         ret, &error, coalesced, user_data);
+            }
+            
+            xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+            slot->in_flight = false;
+            slot->last_activity = xTaskGetTickCount();
+            xSemaphoreGive(s_wq_mutex);
+        }
+    }
+}
+
+esp_err_t write_queue_init(void)
+{
+    if (s_wq_mutex == NULL) {
+        s_wq_mutex = xSemaphoreCreateMutex();
+        if (s_wq_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_WRITE_QUEUE_WORKERS; i++) {
+        if (s_wq_tasks[i] == NULL) {
+            if (xTaskCreate(write_queue_task, "enip_wq", WRITE_QUEUE_TASK_STACK_SIZE, NULL, 4, &s_wq_tasks[i]) != pdPASS) {
+                ESP_LOGE(TAG, "Failed to create write queue task");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t enip_scanner_write_assembly_coalesced(const ip4_addr_t *ip_address, uint16_t assembly_instance,
+                                                const uint8_t *data, uint16_t data_length, uint32_t timeout_ms)
+{
+    if (ip_address == NULL || data == NULL || data_length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return write_queue_submit(WRITE_TARGET_ASSEMBLY, ip_address, assembly_instance, NULL,
+                              data, data_length, 0, timeout_ms);
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+esp_err_t enip_scanner_write_tag_coalesced(const ip4_addr_t *ip_address, const char *tag_path,
+                                           const uint8_t *data, uint16_t data_length,
+                                           uint16_t cip_data_type, uint32_t timeout_ms)
+{
+    if (ip_address == NULL || tag_path == NULL || data == NULL || data_length == 0 ||
+        strlen(tag_path) >= sizeof(((write_slot_t *)0)->tag_path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return write_queue_submit(WRITE_TARGET_TAG, ip_address, 0, tag_path,
+                              data, data_length, cip_data_type, timeout_ms);
+}
+#endif // CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+
+void enip_scanner_write_queue_set_callback(enip_scanner_write_complete_callback_t callback, void *user_data)
+{
+    if (s_wq_mutex == NULL) {
+        s_callback = callback;
+        s_callback_user_data = user_data;
+        return;
+    }
+    xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+    s_callback = callback;
+    s_callback_user_data = user_data;
+    xSemaphoreGive(s_wq_mutex);
+}
+
+void write_queue_get_footprint(diag_footprint_t *footprint)
+{
+    footprint->bytes = sizeof(s_slots);
+    footprint->items = 0;
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_WRITE_QUEUE_WORKERS; i++) {
+        if (s_wq_tasks[i] != NULL) {
+            footprint->bytes += WRITE_QUEUE_TASK_STACK_SIZE;
+        }
+    }
+    if (s_wq_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_wq_mutex, portMAX_DELAY);
+    for (int i = 0; i < CONFIG_ENIP_SCANNER_WRITE_QUEUE_SLOTS; i++) {
+        if (s_slots[i].pending) {
+            footprint->items++;
+            footprint->bytes += s_slots[i].pending_length;
+        }
+    }
+    xSemaphoreGive(s_wq_mutex);
+}
+
+#else // !CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+
+esp_err_t write_queue_init(void)
+{
+    return ESP_OK;
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "lwip/ip4_addr.h"
 #include "sdkconfig.h"
@@ -33,6 +34,89 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Protocol layer at which an operation failed
+ */
+typedef enum {
+    ENIP_ERR_LAYER_NONE   = 0,  // No error
+    ENIP_ERR_LAYER_API    = 1,  // Argument or scanner state
+    ENIP_ERR_LAYER_SOCKET = 2,  // TCP/UDP socket, connect, send or receive
+    ENIP_ERR_LAYER_ENCAP  = 3,  // EtherNet/IP encapsulation
+    ENIP_ERR_LAYER_CPF    = 4,  // Common Packet Format items
+    ENIP_ERR_LAYER_CIP    = 5,  // CIP message router response
+    ENIP_ERR_LAYER_DATA   = 6,  // Payload encoding/decoding or memory
+} enip_scanner_error_layer_t;
+
+/**
+ * @brief Error codes (upper nibble = enip_scanner_error_layer_t)
+ */
+typedef enum {
+    ENIP_ERR_NONE               = 0x00,
+    ENIP_ERR_INVALID_ARG        = 0x10,
+    ENIP_ERR_NOT_INITIALIZED    = 0x11,
+    ENIP_ERR_MUTEX              = 0x12,
+    ENIP_ERR_PATH_ENCODE        = 0x13,  // Tag or CIP path could not be encoded
+    ENIP_ERR_REQUEST_TOO_LARGE  = 0x14,
+    ENIP_ERR_SOCKET             = 0x20,  // sys_errno is set
+    ENIP_ERR_CONNECT            = 0x21,  // sys_errno is set
+    ENIP_ERR_SEND               = 0x22,
+    ENIP_ERR_RECV               = 0x23,  // sys_errno is set when available
+    ENIP_ERR_TIMEOUT            = 0x24,
+    ENIP_ERR_PEER_CLOSED        = 0x25,
+    ENIP_ERR_REGISTER_SESSION   = 0x30,
+    ENIP_ERR_SHORT_RESPONSE     = 0x31,  // detail = bytes received when known
+    ENIP_ERR_UNEXPECTED_COMMAND = 0x32,  // detail = command received
+    ENIP_ERR_ENCAP_STATUS       = 0x33,  // detail = encapsulation status
+    ENIP_ERR_ITEM_COUNT         = 0x40,  // detail = item count received
+    ENIP_ERR_ITEM_TYPE          = 0x41,  // detail = item type received
+    ENIP_ERR_ITEM_LENGTH        = 0x42,  // detail = item length received
+    ENIP_ERR_CIP_STATUS         = 0x50,  // cip_status / ext_status are set
+    ENIP_ERR_CIP_SHORT          = 0x51,  // detail = bytes available when known
+    ENIP_ERR_NO_DATA            = 0x52,
+    ENIP_ERR_NO_MEMORY          = 0x60,
+    ENIP_ERR_DATA_TYPE          = 0x61,  // detail = CIP data type
+    ENIP_ERR_DATA_SIZE          = 0x62,  // detail = offending length
+} enip_scanner_error_code_t;
+
+/**
+ * @brief Compact error information reported by scanner operations
+ *
+ * Filled in place of a formatted message; use enip_scanner_format_error()
+ * to produce text only when it is actually needed.
+ */
+typedef struct {
+    uint8_t layer;              // enip_scanner_error_layer_t
+    uint8_t code;               // enip_scanner_error_code_t
+    uint8_t cip_status;         // CIP general status (ENIP_ERR_CIP_STATUS)
+    uint8_t ext_status_size;    // CIP additional status size in words
+    uint16_t ext_status;        // First CIP additional (extended) status word
+    int16_t sys_errno;          // errno captured at the socket layer (0 if none)
+    uint32_t detail;            // Code-specific value (see enip_scanner_error_code_t)
+} enip_scanner_error_t;
+
+/**
+ * @brief Get the fixed description of an error code
+ * @param code Error code (enip_scanner_error_code_t)
+ * @return Static string, never NULL
+ */
+const char *enip_scanner_error_code_name(uint8_t code);
+
+/**
+ * @brief Get the name of a CIP general status code
+ * @param cip_status CIP general status
+ * @return Static string, never NULL
+ */
+const char *enip_scanner_cip_status_name(uint8_t cip_status);
+
+/**
+ * @brief Format an error as human-readable text
+ * @param error Error to format (NULL or ENIP_ERR_NONE yields an empty string)
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @return buffer, for use directly in log or JSON calls
+ */
+const char *enip_scanner_format_error(const enip_scanner_error_t *error, char *buffer, size_t buffer_size);
+
 /**
  * @brief EtherNet/IP scanner result structure
  */
@@ -60,15 +144,62 @@ typedef struct {
     uint8_t *data;              // Assembly data (allocated, caller must free)
     uint16_t data_length;       // Length of assembly data
     uint32_t response_time_ms;  // Response time in milliseconds
-    char error_message[128];   // Error message if scan failed
+    enip_scanner_error_t error; // Structured error if scan failed (see enip_scanner_format_error)
 } enip_scanner_assembly_result_t;
 
+/**
+ * @brief Maximum encoded size of a CIP route path in bytes
+ */
+#define ENIP_SCANNER_ROUTE_MAX_SIZE 32
+
+/**
+ * @brief CIP route path for reaching a target behind the connected device
+ *
+ * Encoded port segments, e.g. backplane port 1 / slot 0 is { 0x01, 0x00 }.
+ * A request with a non-empty route is sent to the connected device (e.g. a
+ * 1756-EN2T) as an Unconnected Send, which forwards it along the route.
+ * Build one with enip_scanner_route_parse(); size 0 addresses the device itself.
+ */
+typedef struct {
+    uint8_t size;                               // Encoded length in bytes (0 = no routing)
+    uint8_t path[ENIP_SCANNER_ROUTE_MAX_SIZE];  // Port segments
+} enip_scanner_route_t;
+
+/**
+ * @brief Parse a route path string
+ * @param text Comma-separated port/link pairs, e.g. "1,0" (backplane, slot 0) or
+ *             "1,2,2,192.168.2.10,1,0" (slot 2, out its Ethernet port to 192.168.2.10, slot 0)
+ * @param route Parsed route
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for malformed text,
+ *         ESP_ERR_INVALID_SIZE if the route exceeds ENIP_SCANNER_ROUTE_MAX_SIZE
+ */
+esp_err_t enip_scanner_route_parse(const char *text, enip_scanner_route_t *route);
+
 /**
  * @brief Initialize the EtherNet/IP scanner
  * @return ESP_OK on success
  */
 esp_err_t enip_scanner_init(void);
 
+/**
+ * @brief Tell the scanner the Ethernet link went down
+ * Pooled sessions are closed and open implicit connections stop producing at once,
+ * instead of each timing out on its own. Their parameters, callbacks and last O-to-T
+ * data are kept for enip_scanner_notify_link_up(). Call from the ETHERNET_EVENT_DISCONNECTED handler.
+ */
+void enip_scanner_notify_link_down(void);
+
+/**
+ * @brief Tell the scanner the interface has an IP address again
+ * Implicit connections suspended by enip_scanner_notify_link_down() are reopened in
+ * parallel and their last O-to-T data is written back; the I/O configuration resumes
+ * its polls immediately. Closing a suspended connection cancels its reopen.
+ * Call from the IP_EVENT_ETH_GOT_IP handler.
+ * @param address_changed true when the local address differs from the previous one;
+ *        sessions and connections still open are dropped and reopened first
+ */
+void enip_scanner_notify_link_up(bool address_changed);
+
 /**
  * @brief Scan for EtherNet/IP devices on the network
  * @param devices Array to store device information
@@ -89,6 +220,19 @@ int enip_scanner_scan_devices(enip_scanner_device_info_t *devices, int max_devic
 esp_err_t enip_scanner_read_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance, 
                                      enip_scanner_assembly_result_t *result, uint32_t timeout_ms);
 
+/**
+ * @brief Read assembly data from a target reached through a CIP route
+ * @param ip_address IP address of the connected device (e.g. the EtherNet/IP bridge)
+ * @param route Route from that device to the target (NULL or size 0 = the device itself)
+ * @param assembly_instance Assembly instance number
+ * @param result Pointer to store scan result (caller must free result->data)
+ * @param timeout_ms Timeout for the read in milliseconds
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t enip_scanner_read_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                            uint16_t assembly_instance, enip_scanner_assembly_result_t *result,
+                                            uint32_t timeout_ms);
+
 /**
  * @brief Free assembly scan result data
  * @param result Pointer to scan result
@@ -102,12 +246,28 @@ void enip_scanner_free_assembly_result(enip_scanner_assembly_result_t *result);
  * @param data Data to write
  * @param data_length Length of data to write
  * @param timeout_ms Timeout for the write in milliseconds
- * @param error_message Buffer to store error message (128 bytes)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_write_assembly(const ip4_addr_t *ip_address, uint16_t assembly_instance,
                                      const uint8_t *data, uint16_t data_length, uint32_t timeout_ms,
-                                     char *error_message);
+                                     enip_scanner_error_t *error);
+
+/**
+ * @brief Write assembly data to a target reached through a CIP route
+ * @param ip_address IP address of the connected device (e.g. the EtherNet/IP bridge)
+ * @param route Route from that device to the target (NULL or size 0 = the device itself)
+ * @param assembly_instance Assembly instance number
+ * @param data Data to write
+ * @param data_length Length of data to write
+ * @param timeout_ms Timeout for the write in milliseconds
+ * @param error Pointer to store structured error information (can be NULL)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t enip_scanner_write_assembly_routed(const ip4_addr_t *ip_address, const enip_scanner_route_t *route,
+                                             uint16_t assembly_instance, const uint8_t *data,
+                                             uint16_t data_length, uint32_t timeout_ms,
+                                             enip_scanner_error_t *error);
 
 /**
  * @brief Check if an assembly is writable
@@ -133,13 +293,13 @@ int enip_scanner_discover_assemblies(const ip4_addr_t *ip_address, uint16_t *ins
  * @param ip_address Target device IP address
  * @param session_handle Pointer to store session handle
  * @param timeout_ms Timeout for registration in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_register_session(const ip4_addr_t *ip_address,
                                         uint32_t *session_handle,
                                         uint32_t timeout_ms,
-                                        char *error_message);
+                                        enip_scanner_error_t *error);
 
 /**
  * @brief Unregister an EtherNet/IP session
@@ -152,6 +312,60 @@ esp_err_t enip_scanner_unregister_session(const ip4_addr_t *ip_address,
                                           uint32_t session_handle,
                                           uint32_t timeout_ms);
 
+#if CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+/**
+ * @brief Close pooled explicit messaging sessions
+ * Idle pooled sessions are unregistered and closed; sessions currently in use are
+ * closed when they are released. Use this after a device was replaced or re-addressed.
+ * @param ip_address Device whose sessions to close, or NULL for all devices
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the scanner is not initialized
+ */
+esp_err_t enip_scanner_session_pool_flush(const ip4_addr_t *ip_address);
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SESSION_POOL
+
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+/**
+ * @brief Completion callback for coalesced writes
+ * Called from a write queue task after each write actually sent to the device.
+ * @param ip_address Target device IP address
+ * @param assembly_instance Assembly instance (0 for tag writes)
+ * @param tag_path Tag path (NULL for assembly writes)
+ * @param result Result of the write
+ * @param error Structured error if the write failed
+ * @param coalesced Number of newer values that replaced an unsent one since the previous write
+ * @param user_data User data passed to enip_scanner_write_queue_set_callback()
+ */
+typedef void (*enip_scanner_write_complete_callback_t)(const ip4_addr_t *ip_address,
+                                                       uint16_t assembly_instance,
+                                                       const char *tag_path,
+                                                       esp_err_t result,
+                                                       const enip_scanner_error_t *error,
+                                                       uint32_t coalesced,
+                                                       void *user_data);
+
+/**
+ * @brief Queue an assembly write, keeping only the newest value per target
+ * Returns as soon as the data is copied. If a write to the same device and
+ * instance is already in flight, this value replaces any value still waiting
+ * behind it, so at most one write per target is ever queued.
+ * @param ip_address Target device IP address
+ * @param assembly_instance Assembly instance number
+ * @param data Data to write (copied)
+ * @param data_length Length of data to write
+ * @param timeout_ms Timeout for the write once it is sent
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if no write slot is free, error code otherwise
+ */
+esp_err_t enip_scanner_write_assembly_coalesced(const ip4_addr_t *ip_address, uint16_t assembly_instance,
+                                                const uint8_t *data, uint16_t data_length, uint32_t timeout_ms);
+
+/**
+ * @brief Set the callback invoked when a coalesced write completes
+ * @param callback Callback function, or NULL to disable
+ * @param user_data User data passed to the callback
+ */
+void enip_scanner_write_queue_set_callback(enip_scanner_write_complete_callback_t callback, void *user_data);
+#endif // CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+
 #if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
 
 /**
@@ -193,7 +407,7 @@ typedef struct {
     uint16_t data_length;       // Length of tag data in bytes
     uint16_t cip_data_type;     // CIP data type code (e.g., CIP_DATA_TYPE_DINT)
     uint32_t response_time_ms;  // Response time in milliseconds
-    char error_message[128];   // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_tag_result_t;
 
 /**
@@ -220,6 +434,21 @@ esp_err_t enip_scanner_read_tag(const ip4_addr_t *ip_address,
  */
 void enip_scanner_free_tag_result(enip_scanner_tag_result_t *result);
 
+/**
+ * @brief Read a tag from a controller reached through a CIP route
+ * @param ip_address IP address of the connected device (e.g. a 1756-EN2T)
+ * @param route Route to the controller, e.g. parsed from "1,0" for slot 0 (NULL = the device itself)
+ * @param tag_path Tag name/path
+ * @param result Pointer to store result (caller must free result->data)
+ * @param timeout_ms Timeout for the operation in milliseconds
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t enip_scanner_read_tag_routed(const ip4_addr_t *ip_address,
+                                       const enip_scanner_route_t *route,
+                                       const char *tag_path,
+                                       enip_scanner_tag_result_t *result,
+                                       uint32_t timeout_ms);
+
 /**
  * @brief Write a tag to an Allen-Bradley device (Micro800, CompactLogix, etc.)
  * @param ip_address Target device IP address
@@ -228,7 +457,7 @@ void enip_scanner_free_tag_result(enip_scanner_tag_result_t *result);
  * @param data_length Length of data to write in bytes
  * @param cip_data_type CIP data type code (e.g., CIP_DATA_TYPE_DINT)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note Tag names are case-sensitive and must match exactly
@@ -241,7 +470,45 @@ esp_err_t enip_scanner_write_tag(const ip4_addr_t *ip_address,
                                  uint16_t data_length,
                                  uint16_t cip_data_type,
                                  uint32_t timeout_ms,
-                                 char *error_message);
+                                 enip_scanner_error_t *error);
+
+/**
+ * @brief Write a tag on a controller reached through a CIP route
+ * @param ip_address IP address of the connected device (e.g. a 1756-EN2T)
+ * @param route Route to the controller (NULL = the device itself)
+ * @param tag_path Tag name/path
+ * @param data Data to write
+ * @param data_length Length of data to write in bytes
+ * @param cip_data_type CIP data type code
+ * @param timeout_ms Timeout for the operation in milliseconds
+ * @param error Pointer to store structured error information (can be NULL)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t enip_scanner_write_tag_routed(const ip4_addr_t *ip_address,
+                                        const enip_scanner_route_t *route,
+                                        const char *tag_path,
+                                        const uint8_t *data,
+                                        uint16_t data_length,
+                                        uint16_t cip_data_type,
+                                        uint32_t timeout_ms,
+                                        enip_scanner_error_t *error);
+
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+/**
+ * @brief Queue a tag write, keeping only the newest value per target
+ * Same semantics as enip_scanner_write_assembly_coalesced(), keyed on device and tag path.
+ * @param ip_address Target device IP address
+ * @param tag_path Tag name/path (max 127 characters)
+ * @param data Data to write (copied)
+ * @param data_length Length of data to write in bytes
+ * @param cip_data_type CIP data type code
+ * @param timeout_ms Timeout for the write once it is sent
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if no write slot is free, error code otherwise
+ */
+esp_err_t enip_scanner_write_tag_coalesced(const ip4_addr_t *ip_address, const char *tag_path,
+                                           const uint8_t *data, uint16_t data_length,
+                                           uint16_t cip_data_type, uint32_t timeout_ms);
+#endif // CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
 
 /**
  * @brief Get human-readable name for CIP data type
@@ -279,7 +546,7 @@ typedef struct {
     uint32_t data1;             // Status Data 1 (bits: Step, 1 cycle, Auto, Running, Safety speed, Teach, Play, Command remote)
     uint32_t data2;             // Status Data 2 (bits: Reserved, Hold (Pendant), Hold (external), Hold (Command), Alarm, Error, Servo on, Reserved)
     uint32_t response_time_ms;  // Response time in milliseconds
-    char error_message[128];   // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_status_t;
 
 /**
@@ -310,7 +577,7 @@ esp_err_t enip_scanner_motoman_read_status(const ip4_addr_t *ip_address,
  * @param signal_number Signal number (1-256: General input, 1001-1256: General output, etc.)
  * @param value Pointer to store I/O value (1 byte)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note Instance = signal_number / 10 (per Motoman manual)
@@ -329,7 +596,7 @@ esp_err_t enip_scanner_motoman_read_status(const ip4_addr_t *ip_address,
  *   - 8201-8220: Pseudo input
  */
 esp_err_t enip_scanner_motoman_read_io(const ip4_addr_t *ip_address, uint16_t signal_number,
-                                       uint8_t *value, uint32_t timeout_ms, char *error_message);
+                                       uint8_t *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write I/O data to Motoman controller
@@ -340,13 +607,13 @@ esp_err_t enip_scanner_motoman_read_io(const ip4_addr_t *ip_address, uint16_t si
  * @param signal_number Signal number (must be writable type)
  * @param value I/O value to write (1 byte)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note Only writable signal types: Network input (2501-2756), Network output (3501-3756), etc.
  */
 esp_err_t enip_scanner_motoman_write_io(const ip4_addr_t *ip_address, uint16_t signal_number,
-                                        uint8_t value, uint32_t timeout_ms, char *error_message);
+                                        uint8_t value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read byte-type variable (B) from Motoman controller
@@ -357,14 +624,14 @@ esp_err_t enip_scanner_motoman_write_io(const ip4_addr_t *ip_address, uint16_t s
  * @param variable_number Variable B number (0-based)
  * @param value Pointer to store variable value
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note Instance = variable_number + 1 (when RS022=0, default)
  * @note If RS022=1, instance = variable_number (not currently supported)
  */
 esp_err_t enip_scanner_motoman_read_variable_b(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               uint8_t *value, uint32_t timeout_ms, char *error_message);
+                                               uint8_t *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write byte-type variable (B) to Motoman controller
@@ -375,11 +642,11 @@ esp_err_t enip_scanner_motoman_read_variable_b(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable B number (0-based)
  * @param value Variable value to write
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_b(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 uint8_t value, uint32_t timeout_ms, char *error_message);
+                                                 uint8_t value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read integer-type variable (I) from Motoman controller
@@ -390,11 +657,11 @@ esp_err_t enip_scanner_motoman_write_variable_b(const ip4_addr_t *ip_address, ui
  * @param variable_number Variable I number (0-based)
  * @param value Pointer to store variable value (int16_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_read_variable_i(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               int16_t *value, uint32_t timeout_ms, char *error_message);
+                                               int16_t *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write integer-type variable (I) to Motoman controller
@@ -405,11 +672,11 @@ esp_err_t enip_scanner_motoman_read_variable_i(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable I number (0-based)
  * @param value Variable value to write (int16_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_i(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 int16_t value, uint32_t timeout_ms, char *error_message);
+                                                 int16_t value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read double precision integer-type variable (D) from Motoman controller
@@ -420,11 +687,11 @@ esp_err_t enip_scanner_motoman_write_variable_i(const ip4_addr_t *ip_address, ui
  * @param variable_number Variable D number (0-based)
  * @param value Pointer to store variable value (int32_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_read_variable_d(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               int32_t *value, uint32_t timeout_ms, char *error_message);
+                                               int32_t *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write double precision integer-type variable (D) to Motoman controller
@@ -435,11 +702,11 @@ esp_err_t enip_scanner_motoman_read_variable_d(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable D number (0-based)
  * @param value Variable value to write (int32_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_d(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 int32_t value, uint32_t timeout_ms, char *error_message);
+                                                 int32_t value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read real-type variable (R) from Motoman controller
@@ -450,11 +717,11 @@ esp_err_t enip_scanner_motoman_write_variable_d(const ip4_addr_t *ip_address, ui
  * @param variable_number Variable R number (0-based)
  * @param value Pointer to store variable value (float)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_read_variable_r(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               float *value, uint32_t timeout_ms, char *error_message);
+                                               float *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write real-type variable (R) to Motoman controller
@@ -465,11 +732,11 @@ esp_err_t enip_scanner_motoman_read_variable_r(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable R number (0-based)
  * @param value Variable value to write (float)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_r(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 float value, uint32_t timeout_ms, char *error_message);
+                                                 float value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read register data from Motoman controller
@@ -480,13 +747,13 @@ esp_err_t enip_scanner_motoman_write_variable_r(const ip4_addr_t *ip_address, ui
  * @param register_number Register number (0-999)
  * @param value Pointer to store register value (uint16_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note Instance = register_number + 1 (when RS022=0, default)
  */
 esp_err_t enip_scanner_motoman_read_register(const ip4_addr_t *ip_address, uint16_t register_number,
-                                             uint16_t *value, uint32_t timeout_ms, char *error_message);
+                                             uint16_t *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write register data to Motoman controller
@@ -497,11 +764,11 @@ esp_err_t enip_scanner_motoman_read_register(const ip4_addr_t *ip_address, uint1
  * @param register_number Register number (0-999)
  * @param value Register value to write (uint16_t)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_register(const ip4_addr_t *ip_address, uint16_t register_number,
-                                              uint16_t value, uint32_t timeout_ms, char *error_message);
+                                              uint16_t value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Motoman alarm structure
@@ -517,7 +784,7 @@ typedef struct {
     uint32_t alarm_data_type;   // Alarm data type (0-10, see manual)
     char alarm_date_time[17];   // Alarm occurrence date/time (16 bytes + null terminator, format: "2010/10/10 10:10")
     char alarm_string[33];      // Alarm name string (32 bytes + null terminator)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_alarm_t;
 
 /**
@@ -567,7 +834,7 @@ typedef struct {
     uint32_t line_number;       // Line number (0-9999)
     uint32_t step_number;       // Step number (1-9998)
     uint32_t speed_override;    // Speed override value (unit: 0.01%)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_job_info_t;
 
 /**
@@ -594,7 +861,7 @@ typedef struct {
     ip4_addr_t ip_address;      // Robot IP address
     bool success;               // Read was successful
     char axis_names[8][5];      // Axis coordinate names (8 axes, 4 bytes each + null terminator)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_axis_config_t;
 
 /**
@@ -632,7 +899,7 @@ typedef struct {
     uint32_t reservation;       // Reservation (or User coordinate number for Class 0x7F)
     uint32_t extended_configuration; // Extended configuration (7-axis robot: θL/θU/θB/θE/θW ≥ 180°)
     int32_t axis_data[8];       // Axis data (8 axes, 4 bytes each)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_position_t;
 
 /**
@@ -664,7 +931,7 @@ typedef struct {
     ip4_addr_t ip_address;      // Robot IP address
     bool success;               // Read was successful
     int32_t axis_deviation[8];  // Deviation of each axis position (8 axes, pulse values)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_position_deviation_t;
 
 /**
@@ -696,7 +963,7 @@ typedef struct {
     ip4_addr_t ip_address;      // Robot IP address
     bool success;               // Read was successful
     int32_t axis_torque[8];     // Torque of each axis (8 axes, percentage when nominal value is 100%)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_torque_t;
 
 /**
@@ -727,14 +994,14 @@ esp_err_t enip_scanner_motoman_read_torque(const ip4_addr_t *ip_address, uint16_
  * @param value Buffer to store variable value (must be at least 33 bytes for null terminator)
  * @param value_size Size of value buffer
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  * 
  * @note String variables are 32 bytes maximum
  * @note Instance = variable_number + 1 (when RS022=0, default)
  */
 esp_err_t enip_scanner_motoman_read_variable_s(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                               char *value, size_t value_size, uint32_t timeout_ms, char *error_message);
+                                               char *value, size_t value_size, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Write string-type variable (S) to Motoman controller
@@ -745,11 +1012,11 @@ esp_err_t enip_scanner_motoman_read_variable_s(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable S number (0-based)
  * @param value Variable value to write (max 32 bytes)
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_s(const ip4_addr_t *ip_address, uint16_t variable_number,
-                                                 const char *value, uint32_t timeout_ms, char *error_message);
+                                                 const char *value, uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Read robot position-type variable (P) from Motoman controller
@@ -777,12 +1044,12 @@ esp_err_t enip_scanner_motoman_read_variable_p(const ip4_addr_t *ip_address, uin
  * @param variable_number Variable P number (0-based)
  * @param position Position data to write
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_p(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                  const enip_scanner_motoman_position_t *position,
-                                                 uint32_t timeout_ms, char *error_message);
+                                                 uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Motoman base position structure
@@ -795,7 +1062,7 @@ typedef struct {
     bool success;               // Read was successful
     uint32_t data_type;         // Position data type: 0=Pulse, 16=Base
     int32_t axis_data[8];       // Axis data (8 axes, 4 bytes each)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_base_position_t;
 
 /**
@@ -823,12 +1090,12 @@ esp_err_t enip_scanner_motoman_read_variable_bp(const ip4_addr_t *ip_address, ui
  * @param variable_number Variable BP number (0-based)
  * @param position Base position data to write
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_bp(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                   const enip_scanner_motoman_base_position_t *position,
-                                                  uint32_t timeout_ms, char *error_message);
+                                                  uint32_t timeout_ms, enip_scanner_error_t *error);
 
 /**
  * @brief Motoman external axis position structure
@@ -841,7 +1108,7 @@ typedef struct {
     bool success;               // Read was successful
     uint32_t data_type;         // Position data type: 0=Pulse
     int32_t axis_data[8];       // Axis data (8 axes, 4 bytes each)
-    char error_message[128];    // Error message if read failed
+    enip_scanner_error_t error; // Structured error if read failed (see enip_scanner_format_error)
 } enip_scanner_motoman_external_position_t;
 
 /**
@@ -869,12 +1136,12 @@ esp_err_t enip_scanner_motoman_read_variable_ex(const ip4_addr_t *ip_address, ui
  * @param variable_number Variable EX number (0-based)
  * @param position External position data to write
  * @param timeout_ms Timeout for the operation in milliseconds
- * @param error_message Buffer to store error message (128 bytes, can be NULL)
+ * @param error Pointer to store structured error information (can be NULL)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t enip_scanner_motoman_write_variable_ex(const ip4_addr_t *ip_address, uint16_t variable_number,
                                                  const enip_scanner_motoman_external_position_t *position,
-                                                 uint32_t timeout_ms, char *error_message);
+                                                 uint32_t timeout_ms, enip_scanner_error_t *error);
 
 #endif // CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
 
@@ -896,6 +1163,32 @@ typedef void (*enip_implicit_data_callback_t)(
     void *user_data
 );
 
+/**
+ * @brief Descriptor of one received T-to-O frame
+ */
+typedef struct {
+    const ip4_addr_t *ip_address;       // Source device IP address
+    uint16_t assembly_instance;         // Assembly instance that produced the data
+    const uint8_t *data;                // Assembly data (valid only during the callback)
+    uint16_t data_length;
+    int64_t rx_time_us;                 // esp_timer time taken as soon as the frame was received
+    uint32_t encap_sequence;            // Sequenced Address item sequence number
+    uint16_t cip_sequence;              // CIP sequence count (Class 1 only)
+    bool has_encap_sequence;            // false when the frame used a Connection Address item
+    bool has_cip_sequence;              // false for Class 0 frames
+    uint32_t t_to_o_connection_id;      // Connection handle: T-to-O connection ID of the frame
+    uint32_t o_to_t_connection_id;
+    uint16_t connection_serial_number;  // Forward Open connection serial number
+} enip_implicit_frame_t;
+
+/**
+ * @brief Callback for received T-to-O frames with timing and sequence information
+ * Called from the connection's receive task right after the data callback.
+ * @param frame Frame descriptor (valid only during the callback)
+ * @param user_data User-provided context pointer
+ */
+typedef void (*enip_implicit_frame_callback_t)(const enip_implicit_frame_t *frame, void *user_data);
+
 /**
  * @brief Open an implicit messaging connection (I/O data) to an EtherNet/IP device
  * 
@@ -927,6 +1220,40 @@ esp_err_t enip_scanner_implicit_open(const ip4_addr_t *ip_address,
                                      uint32_t timeout_ms,
                                      bool exclusive_owner);  // true = PTP (Point-to-Point, exclusive owner), false = non-PTP (Multicast T-to-O, non-exclusive owner)
 
+/**
+ * @brief Maximum length of a produced tag name
+ */
+#define ENIP_SCANNER_PRODUCED_TAG_NAME_MAX 40
+
+/**
+ * @brief Open a Class 1 consumer connection to a Logix produced tag
+ * The Forward Open carries the route to the controller and the tag name as a
+ * symbolic segment. The controller then sends the tag at the RPI without any
+ * request traffic; the scanner only sends heartbeats. The tag must be a
+ * controller-scoped produced tag with a free consumer and unicast allowed.
+ * Close the connection with enip_scanner_implicit_close().
+ * @param ip_address IP address of the controller or its Ethernet module
+ * @param tag_name Produced tag name, controller scope, no members or elements
+ * @param route Route from the Ethernet module to the controller, e.g. "1,0" for
+ *              backplane slot 0; NULL or size 0 uses backplane slot 0
+ * @param tag_data_size Size of the tag data in bytes (e.g. 4 for a DINT, the UDT size for a structure)
+ * @param rpi_ms Requested Packet Interval in milliseconds (10-10000)
+ * @param callback Callback function to receive the tag data; assembly_instance is 0
+ * @param user_data User context pointer passed to callback
+ * @param timeout_ms Timeout for Forward Open operation in milliseconds
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid tag name, size or RPI,
+ *         ESP_ERR_INVALID_STATE if a connection to the device is already open,
+ *         or the error of the Forward Open
+ */
+esp_err_t enip_scanner_implicit_open_produced_tag(const ip4_addr_t *ip_address,
+                                                  const char *tag_name,
+                                                  const enip_scanner_route_t *route,
+                                                  uint16_t tag_data_size,
+                                                  uint32_t rpi_ms,
+                                                  enip_implicit_data_callback_t callback,
+                                                  void *user_data,
+                                                  uint32_t timeout_ms);
+
 /**
  * @brief Close an implicit messaging connection
  * @param ip_address Target device IP address
@@ -965,8 +1292,749 @@ esp_err_t enip_scanner_implicit_read_o_to_t_data(const ip4_addr_t *ip_address,
                                                   uint16_t *data_length,
                                                   uint16_t max_length);
 
+/**
+ * @brief Set a frame callback on an open implicit connection
+ * The frame callback gets every T-to-O frame with a microsecond receive timestamp,
+ * the encapsulation and CIP sequence numbers and the connection IDs, in addition
+ * to the data callback given to enip_scanner_implicit_open(). It is not called
+ * after the connection closes, and a reopened connection starts without one.
+ * @param ip_address Target device IP address
+ * @param callback Frame callback, or NULL to remove it
+ * @param user_data User context pointer passed to callback
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if ip_address is NULL,
+ *         ESP_ERR_NOT_FOUND if no connection to the device is open
+ */
+esp_err_t enip_scanner_implicit_set_frame_callback(const ip4_addr_t *ip_address,
+                                                   enip_implicit_frame_callback_t callback,
+                                                   void *user_data);
+
 #endif // CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
 
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+
+/**
+ * @brief Largest polled value kept for change detection (bytes)
+ */
+#define ENIP_SCANNER_IO_VALUE_MAX 64
+
+/**
+ * @brief Kind of I/O configuration entry
+ */
+typedef enum {
+    ENIP_IO_ENTRY_IMPLICIT = 0,         // Class 1 implicit connection
+    ENIP_IO_ENTRY_TAG = 1,              // Tag read every period_ms
+    ENIP_IO_ENTRY_MOTOMAN_STATUS = 2,   // Motoman status read every period_ms
+} enip_scanner_io_entry_type_t;
+
+/**
+ * @brief One entry of the I/O configuration (scan list)
+ *
+ * Fixed-size so a list can be stored as-is (see system_scan_list_save()).
+ */
+typedef struct {
+    uint8_t type;                   // enip_scanner_io_entry_type_t
+    bool enabled;                   // Entry is brought up by enip_scanner_io_start()
+    bool exclusive_owner;           // Implicit: exclusive owner (PTP) connection
+    uint8_t reserved;
+    ip4_addr_t ip_address;          // Target device
+    uint32_t period_ms;             // Implicit: RPI; tag / Motoman: poll period
+    uint16_t assembly_consumed;     // Implicit: O-to-T assembly instance
+    uint16_t assembly_produced;     // Implicit: T-to-O assembly instance
+    uint16_t size_consumed;         // Implicit: O-to-T size in bytes (0 = autodetect)
+    uint16_t size_produced;         // Implicit: T-to-O size in bytes (0 = autodetect)
+    char tag_path[64];              // Tag: tag name/path
+    char route[32];                 // Tag: optional CIP route, e.g. "1,0" (see enip_scanner_route_parse())
+} enip_scanner_io_entry_t;
+
+/**
+ * @brief State of an I/O configuration entry
+ */
+typedef enum {
+    ENIP_IO_STATE_DISABLED = 0,
+    ENIP_IO_STATE_STARTING,
+    ENIP_IO_STATE_RUNNING,
+    ENIP_IO_STATE_FAILED,           // Retried every CONFIG_ENIP_SCANNER_IO_RETRY_MS
+} enip_scanner_io_state_t;
+
+/**
+ * @brief Runtime status of an I/O configuration entry
+ */
+typedef struct {
+    uint8_t state;                  // enip_scanner_io_state_t
+    esp_err_t last_result;          // Result of the last open or poll
+    enip_scanner_error_t error;     // Structured error of the last poll (tag / Motoman)
+    uint32_t updates;               // T-to-O packets received or successful polls
+    uint32_t failures;              // Failed opens or polls
+    uint32_t last_update_ms;        // Tick time (ms) of the last data
+    uint32_t up_time_ms;            // Time from enip_scanner_io_start() until first running
+} enip_scanner_io_status_t;
+
+/**
+ * @brief Callback for data from I/O configuration entries
+ * Called with every T-to-O packet of implicit entries, and when a polled
+ * tag or Motoman status value changes (status: Data 1 then Data 2, 4 bytes each).
+ * Runs in scanner tasks; keep it short.
+ * @param index Entry index in the list given to enip_scanner_io_start()
+ * @param entry The entry
+ * @param data Data received
+ * @param data_length Length of data in bytes
+ * @param user_data User data passed to enip_scanner_io_set_callback()
+ */
+typedef void (*enip_scanner_io_data_callback_t)(size_t index,
+                                                const enip_scanner_io_entry_t *entry,
+                                                const uint8_t *data,
+                                                uint16_t data_length,
+                                                void *user_data);
+
+/**
+ * @brief Bring up an I/O configuration
+ * Opens all enabled implicit connections and takes the first sample of all
+ * polled entries in parallel (CONFIG_ENIP_SCANNER_IO_BRINGUP_WORKERS at a time),
+ * then keeps polling and reopens connections that fail or fall silent.
+ * Returns without waiting for the bring-up to finish.
+ * @param entries Entries (copied)
+ * @param count Number of entries (max CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a configuration is already running
+ */
+esp_err_t enip_scanner_io_start(const enip_scanner_io_entry_t *entries, size_t count);
+
+/**
+ * @brief Stop the running I/O configuration and close its implicit connections
+ * @param timeout_ms Timeout for each Forward Close in milliseconds
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if nothing is running
+ */
+esp_err_t enip_scanner_io_stop(uint32_t timeout_ms);
+
+/**
+ * @brief Number of entries in the current I/O configuration
+ */
+size_t enip_scanner_io_get_count(void);
+
+/**
+ * @brief Get an entry of the current I/O configuration and its status
+ * @param index Entry index
+ * @param entry Entry copy (can be NULL)
+ * @param status Status copy (can be NULL)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if index is out of range
+ */
+esp_err_t enip_scanner_io_get_status(size_t index, enip_scanner_io_entry_t *entry, enip_scanner_io_status_t *status);
+
+/**
+ * @brief Copy the latest input data of an I/O configuration entry
+ * Implicit entries return the last T-to-O data, tag and Motoman entries the
+ * last polled value (up to ENIP_SCANNER_IO_VALUE_MAX bytes). Served from
+ * memory; no request is sent to the device.
+ * @param index Entry index
+ * @param data Buffer for the data
+ * @param max_length Size of data; longer input is truncated
+ * @param data_length Pointer to store the number of bytes copied
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if index is out of range,
+ *         ESP_ERR_INVALID_STATE if the entry has no data yet
+ */
+esp_err_t enip_scanner_io_read_input(size_t index, uint8_t *data, uint16_t max_length, uint16_t *data_length);
+
+/**
+ * @brief Set the callback for I/O configuration data
+ * @param callback Callback function, or NULL to disable
+ * @param user_data User data passed to the callback
+ */
+void enip_scanner_io_set_callback(enip_scanner_io_data_callback_t callback, void *user_data);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+
+#if CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+
+/**
+ * @brief Get the CIP data type of a tag from the device profile cache
+ * The type is learned from tag reads and successful writes and survives restarts.
+ * @param ip_address IP address of the device
+ * @param tag_path Tag name/path as used for the read or write
+ * @param cip_data_type Cached CIP data type
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the tag type is not cached
+ */
+esp_err_t enip_scanner_profile_get_tag_type(const ip4_addr_t *ip_address, const char *tag_path, uint16_t *cip_data_type);
+
+/**
+ * @brief Check whether a device's cached profile was confirmed by ListIdentity since boot
+ * Profiles are used before confirmation; this only reports whether a scan has
+ * seen the same vendor, product, serial number and revision at the address.
+ * @param ip_address IP address of the device
+ * @return true if confirmed, false if unconfirmed or not cached
+ */
+bool enip_scanner_profile_is_verified(const ip4_addr_t *ip_address);
+
+/**
+ * @brief Remove cached device profiles from RAM and NVS
+ * @param ip_address Device to forget, or NULL to clear all profiles
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no profile exists for the address
+ */
+esp_err_t enip_scanner_profile_clear(const ip4_addr_t *ip_address);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+
+#if CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
+/**
+ * @brief Direction of a captured implicit frame
+ */
+typedef enum {
+    ENIP_CAPTURE_DIR_T_TO_O = 0,        // Received from the target
+    ENIP_CAPTURE_DIR_O_TO_T = 1,        // Sent by the scanner
+} enip_capture_direction_t;
+
+/**
+ * @brief Capture trigger condition
+ */
+typedef enum {
+    ENIP_CAPTURE_TRIGGER_MANUAL = 0,    // Only enip_scanner_capture_trigger()
+    ENIP_CAPTURE_TRIGGER_BIT_RISING,    // Bit changes from 0 to 1
+    ENIP_CAPTURE_TRIGGER_BIT_FALLING,   // Bit changes from 1 to 0
+    ENIP_CAPTURE_TRIGGER_BIT_CHANGE,    // Bit changes either way
+    ENIP_CAPTURE_TRIGGER_ABOVE,         // Value rises above the threshold
+    ENIP_CAPTURE_TRIGGER_BELOW,         // Value falls below the threshold
+    ENIP_CAPTURE_TRIGGER_TIMEOUT,       // No T-to-O frame for timeout_ms, or the connection timed out
+} enip_capture_trigger_t;
+
+/**
+ * @brief Capture state
+ */
+typedef enum {
+    ENIP_CAPTURE_IDLE = 0,              // Not recording; frames of the last capture stay readable
+    ENIP_CAPTURE_ARMED,                 // Recording into the pre-trigger ring
+    ENIP_CAPTURE_TRIGGERED,             // Recording post-trigger frames
+    ENIP_CAPTURE_COMPLETE,              // Frozen; frames can be downloaded
+} enip_capture_state_t;
+
+/**
+ * @brief Capture configuration
+ */
+typedef struct {
+    ip4_addr_t ip_address;              // Implicit connection to record
+    enip_capture_trigger_t trigger;
+    enip_capture_direction_t direction; // Frames the bit and value triggers look at
+    uint16_t offset;                    // Byte offset of the bit or value in the assembly data
+    uint8_t bit;                        // Bit number for bit triggers (0-7)
+    uint8_t width;                      // Value size for threshold triggers: 1, 2 or 4 bytes (little-endian)
+    bool is_signed;                     // Sign-extend the value before comparing
+    int32_t threshold;
+    uint32_t timeout_ms;                // Gap between T-to-O frames for ENIP_CAPTURE_TRIGGER_TIMEOUT
+    uint16_t pre_frames;                // Frames kept before the trigger
+    uint16_t post_frames;               // Frames recorded after the trigger
+} enip_scanner_capture_config_t;
+
+/**
+ * @brief Capture status
+ */
+typedef struct {
+    enip_capture_state_t state;
+    enip_scanner_capture_config_t config;
+    uint32_t frames_recorded;           // Frames recorded since arming
+    uint32_t frames_truncated;          // Frames longer than CONFIG_ENIP_SCANNER_CAPTURE_FRAME_BYTES
+    uint16_t frame_count;               // Frames readable with enip_scanner_capture_get_frame()
+    uint16_t trigger_index;             // Index of the first frame at or after the trigger
+    int64_t trigger_time_us;            // esp_timer time of the trigger (0 if not triggered)
+} enip_scanner_capture_status_t;
+
+/**
+ * @brief One captured frame
+ */
+typedef struct {
+    int64_t time_us;                    // esp_timer time the frame was received or sent
+    uint8_t direction;                  // enip_capture_direction_t
+    bool trigger;                       // The trigger fired on this frame
+    uint16_t length;                    // Frame length (CPF items, starting with the item count)
+    uint16_t data_offset;               // Offset of the assembly data in the frame
+    uint16_t data_length;               // Assembly data length
+    uint8_t data[CONFIG_ENIP_SCANNER_CAPTURE_FRAME_BYTES];  // Start of the frame
+} enip_scanner_capture_frame_t;
+
+/**
+ * @brief Arm a capture
+ * Starts recording the frames of the connection into the pre-trigger ring and
+ * evaluates the trigger on every frame. Frames of a previous capture are discarded.
+ * @param config Capture configuration (copied)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if pre_frames + post_frames + 1
+ *         exceeds CONFIG_ENIP_SCANNER_CAPTURE_FRAMES or the trigger is invalid
+ */
+esp_err_t enip_scanner_capture_arm(const enip_scanner_capture_config_t *config);
+
+/**
+ * @brief Trigger an armed capture now
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the capture is not armed
+ */
+esp_err_t enip_scanner_capture_trigger(void);
+
+/**
+ * @brief Stop recording; captured frames stay readable
+ * @return ESP_OK
+ */
+esp_err_t enip_scanner_capture_stop(void);
+
+/**
+ * @brief Get the capture status
+ * @param status Status copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if status is NULL
+ */
+esp_err_t enip_scanner_capture_get_status(enip_scanner_capture_status_t *status);
+
+/**
+ * @brief Get a captured frame, oldest first
+ * @param index Frame index (0 to frame_count - 1)
+ * @param frame Frame copy
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if index is out of range
+ */
+esp_err_t enip_scanner_capture_get_frame(uint16_t index, enip_scanner_capture_frame_t *frame);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+
+/**
+ * @brief Bit number meaning "the whole value"
+ */
+#define ENIP_TRANSLATOR_NO_BIT 0xFF
+
+/**
+ * @brief Kind of translator data point
+ */
+typedef enum {
+    ENIP_TRANSLATOR_POINT_TAG = 0,              // Allen-Bradley tag (requires tag support)
+    ENIP_TRANSLATOR_POINT_ASSEMBLY,             // Value or bit at a byte offset of an assembly instance
+    ENIP_TRANSLATOR_POINT_MOTOMAN_IO,           // Motoman I/O signal group, 8 signals per byte (Class 0x78)
+    ENIP_TRANSLATOR_POINT_MOTOMAN_REGISTER,     // Motoman register (Class 0x79)
+    ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_B,        // Motoman byte variable (Class 0x7A)
+    ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_I,        // Motoman integer variable (Class 0x7B)
+    ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_D,        // Motoman double integer variable (Class 0x7C)
+    ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R,        // Motoman real variable (Class 0x7D)
+} enip_translator_point_kind_t;
+
+/**
+ * @brief Value type of tag and assembly points (Motoman points imply their type)
+ */
+typedef enum {
+    ENIP_TRANSLATOR_TYPE_BOOL = 0,
+    ENIP_TRANSLATOR_TYPE_SINT,
+    ENIP_TRANSLATOR_TYPE_INT,
+    ENIP_TRANSLATOR_TYPE_DINT,
+    ENIP_TRANSLATOR_TYPE_USINT,
+    ENIP_TRANSLATOR_TYPE_UINT,
+    ENIP_TRANSLATOR_TYPE_UDINT,
+    ENIP_TRANSLATOR_TYPE_REAL,
+} enip_translator_value_type_t;
+
+/**
+ * @brief When a binding writes its destination
+ */
+typedef enum {
+    ENIP_TRANSLATOR_TRIGGER_ALWAYS = 0,         // Every cycle
+    ENIP_TRANSLATOR_TRIGGER_ON_CHANGE,          // When the value differs from the last one written
+    ENIP_TRANSLATOR_TRIGGER_RISING_EDGE,        // When the source changes from zero to non-zero
+} enip_translator_trigger_t;
+
+/**
+ * @brief Translator data point (source or destination of a binding)
+ */
+typedef struct {
+    uint8_t kind;                       // enip_translator_point_kind_t
+    uint8_t type;                       // enip_translator_value_type_t (tags: type of writes; reads use the tag's type)
+    uint8_t bit;                        // Bit of the value (0-31), or ENIP_TRANSLATOR_NO_BIT
+    ip4_addr_t ip_address;
+    uint16_t number;                    // Assembly instance, I/O signal (e.g. 2701), register or variable number
+    uint16_t offset;                    // Byte offset in the assembly
+    char tag_path[64];
+} enip_translator_point_t;
+
+/**
+ * @brief Translator binding: destination = source * scale + offset
+ */
+typedef struct {
+    enip_translator_point_t source;
+    enip_translator_point_t destination;
+    float scale;
+    float offset;
+    uint8_t trigger;                    // enip_translator_trigger_t
+    bool enabled;
+    char name[24];
+} enip_translator_binding_t;
+
+/**
+ * @brief Translator scan cycle statistics
+ */
+typedef struct {
+    bool running;
+    uint32_t cycle_ms;                  // Configured cycle time
+    uint32_t cycles;
+    uint32_t overruns;                  // Cycles that took longer than cycle_ms
+    uint32_t last_cycle_us;             // Measured time of the last cycle (reads, mapping and writes)
+    uint32_t min_cycle_us;
+    uint32_t max_cycle_us;
+    uint32_t avg_cycle_us;              // Moving average over about 16 cycles
+    uint16_t devices;                   // Devices in the compiled plan
+    uint16_t read_requests;             // Requests per cycle after merging bindings
+    uint16_t write_requests;            // Destination images after merging (written when changed)
+    uint32_t read_failures;
+    uint32_t write_failures;
+} enip_translator_status_t;
+
+/**
+ * @brief Status of one binding
+ */
+typedef struct {
+    bool valid;                         // value holds a source value read this run
+    float value;                        // Last destination value (after scaling)
+    uint32_t writes;                    // Values handed to the destination
+    uint32_t failures;                  // Cycles the source could not be read or mapped
+    esp_err_t last_result;
+} enip_translator_binding_status_t;
+
+/**
+ * @brief Start the translator
+ * Compiles the bindings into a plan that reads every distinct source once per
+ * cycle (all bindings on one assembly share a single read), merges destinations
+ * in the same assembly or I/O group into one write, and orders the requests by
+ * device. Runs the plan every cycle_ms in its own task.
+ * @param bindings Bindings (copied)
+ * @param count Number of bindings (max CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS)
+ * @param cycle_ms Scan cycle time in milliseconds
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running,
+ *         ESP_ERR_NOT_SUPPORTED if a binding uses tag or Motoman points that are not enabled
+ */
+esp_err_t enip_scanner_translator_start(const enip_translator_binding_t *bindings, size_t count, uint32_t cycle_ms);
+
+/**
+ * @brief Stop the translator
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t enip_scanner_translator_stop(void);
+
+/**
+ * @brief Get the scan cycle statistics
+ * @param status Status copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if status is NULL
+ */
+esp_err_t enip_scanner_translator_get_status(enip_translator_status_t *status);
+
+/**
+ * @brief Number of bindings of the running (or last run) translator
+ */
+size_t enip_scanner_translator_get_count(void);
+
+/**
+ * @brief Get a binding and its status
+ * @param index Binding index
+ * @param binding Binding copy (can be NULL)
+ * @param status Status copy (can be NULL)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if index is out of range
+ */
+esp_err_t enip_scanner_translator_get_binding(size_t index, enip_translator_binding_t *binding,
+                                              enip_translator_binding_status_t *status);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+
+/**
+ * @brief Rate-limited log statistics
+ */
+typedef struct {
+    uint32_t emitted;                   // Rate-limited messages that were logged
+    uint32_t suppressed;                // Messages dropped by the per-call-site rate limit
+} enip_scanner_log_stats_t;
+
+/**
+ * @brief Get the rate-limited log statistics
+ * Error paths that can repeat under a fault (socket errors, implicit receive
+ * and heartbeat loops) log at most CONFIG_ENIP_SCANNER_LOG_BURST messages per
+ * call site, then one per CONFIG_ENIP_SCANNER_LOG_INTERVAL_MS.
+ * @param stats Statistics copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t enip_scanner_get_log_stats(enip_scanner_log_stats_t *stats);
+
+#if CONFIG_ENIP_SCANNER_ENABLE_QOS
+
+/**
+ * @brief CIP connection priorities (network connection parameters bits 10-11)
+ */
+#define ENIP_SCANNER_PRIORITY_LOW       0
+#define ENIP_SCANNER_PRIORITY_HIGH      1
+#define ENIP_SCANNER_PRIORITY_SCHEDULED 2
+#define ENIP_SCANNER_PRIORITY_URGENT    3
+
+/**
+ * @brief DSCP marking, following the attributes of the CIP QoS object (class 0x48)
+ * Values are the 6-bit DSCP code points (0-63) written to the IP header of
+ * outgoing packets. The defaults are the QoS object defaults.
+ */
+typedef struct {
+    uint8_t dscp_urgent;                // Class 1 connections opened with urgent priority (default 55)
+    uint8_t dscp_scheduled;             // Scheduled priority (default 47)
+    uint8_t dscp_high;                  // High priority (default 43)
+    uint8_t dscp_low;                   // Low priority (default 31)
+    uint8_t dscp_explicit;              // Explicit messaging over TCP and List Identity (default 27)
+    uint8_t implicit_priority;          // ENIP_SCANNER_PRIORITY_* requested in Forward Open
+} enip_scanner_qos_config_t;
+
+/**
+ * @brief DSCP marking statistics
+ */
+typedef struct {
+    uint32_t sockets_marked;
+    uint32_t mark_failures;             // setsockopt(IP_TOS) rejected; the socket is used unmarked
+} enip_scanner_qos_stats_t;
+
+/**
+ * @brief Get the DSCP marking configuration
+ * @param config Configuration copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if config is NULL
+ */
+esp_err_t enip_scanner_get_qos_config(enip_scanner_qos_config_t *config);
+
+/**
+ * @brief Set the DSCP marking configuration
+ * Applies to sockets created afterwards: explicit sessions already open, pooled
+ * sessions and open implicit connections keep their marking until reopened.
+ * @param config New configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if config is NULL, a DSCP
+ *         value is above 63 or implicit_priority is above ENIP_SCANNER_PRIORITY_URGENT
+ */
+esp_err_t enip_scanner_set_qos_config(const enip_scanner_qos_config_t *config);
+
+/**
+ * @brief Get the DSCP marking statistics
+ * @param stats Statistics copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t enip_scanner_get_qos_stats(enip_scanner_qos_stats_t *stats);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_QOS
+
+#if CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
+
+/**
+ * @brief Packet buffer pool statistics
+ */
+typedef struct {
+    uint16_t blocks;                    // CONFIG_ENIP_SCANNER_BUFFER_POOL_BLOCKS
+    uint16_t block_size;                // Bytes per block
+    uint16_t in_use;                    // Blocks currently taken
+    uint16_t peak_in_use;
+    uint32_t allocations;               // Buffers served from the pool
+    uint32_t exhausted;                 // Heap fallbacks because every block was taken
+    uint32_t oversize;                  // Heap fallbacks because the buffer was larger than a block
+} enip_scanner_buffer_pool_stats_t;
+
+/**
+ * @brief Get the packet buffer pool statistics
+ * Explicit requests and response scratch buffers are taken from a static pool of
+ * fixed-size blocks instead of the heap.
+ * @param stats Statistics copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t enip_scanner_get_buffer_pool_stats(enip_scanner_buffer_pool_stats_t *stats);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
+
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+
+/**
+ * @brief Scanner heap usage per memory tier
+ */
+typedef struct {
+    uint32_t internal_bytes;            // Held in internal RAM: the hot tier and cold fallbacks
+    uint32_t internal_peak;
+    uint32_t psram_bytes;               // Held in PSRAM by the cold tier
+    uint32_t psram_peak;
+    uint32_t psram_fallbacks;           // Cold allocations PSRAM could not serve, placed in internal RAM
+    uint32_t failures;                  // Allocations no tier could serve
+    uint32_t psram_total;               // PSRAM heap of the whole system
+    uint32_t psram_free;
+} enip_scanner_memory_tier_stats_t;
+
+/**
+ * @brief Get the scanner's heap usage per memory tier
+ * Per-packet buffers are kept in internal RAM; large, rarely touched data such as
+ * the device profile cache goes to PSRAM.
+ * @param stats Statistics copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t enip_scanner_get_memory_tier_stats(enip_scanner_memory_tier_stats_t *stats);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
+/**
+ * @brief Maximum subsystems in a memory report
+ */
+#define ENIP_SCANNER_DIAG_MAX_SUBSYSTEMS 8
+
+/**
+ * @brief Memory held by one scanner subsystem
+ * Heap buffers, task stacks and static tables the subsystem owns. Socket buffers
+ * inside lwIP are not included.
+ */
+typedef struct {
+    const char *name;                   // "implicit", "sessions", "io_config", ...
+    uint32_t bytes;
+    uint16_t items;                     // Connections, pooled sessions, entries, bindings, ...
+} enip_scanner_subsystem_memory_t;
+
+/**
+ * @brief Stack usage of one task
+ */
+typedef struct {
+    char name[16];
+    uint32_t stack_free_min;            // Stack high-water mark: least free stack seen, in bytes
+    uint8_t priority;
+    uint8_t state;                      // eTaskState
+} enip_scanner_task_info_t;
+
+/**
+ * @brief Memory and task footprint report
+ */
+typedef struct {
+    uint32_t heap_total;
+    uint32_t heap_free;
+    uint32_t heap_min_free;             // Lowest free heap since boot
+    uint32_t heap_largest_free_block;
+    uint8_t fragmentation_pct;          // 100 - largest free block * 100 / free heap
+    uint8_t subsystem_count;
+    uint8_t task_count;                 // Entries in tasks, lowest free stack first
+    uint8_t tasks_total;                // Tasks in the system (0 without CONFIG_FREERTOS_USE_TRACE_FACILITY)
+    enip_scanner_subsystem_memory_t subsystems[ENIP_SCANNER_DIAG_MAX_SUBSYSTEMS];
+    enip_scanner_task_info_t tasks[CONFIG_ENIP_SCANNER_DIAG_MAX_TASKS];
+} enip_scanner_memory_report_t;
+
+/**
+ * @brief One heap sample of the trend
+ */
+typedef struct {
+    uint32_t uptime_s;
+    uint32_t free_bytes;
+    uint32_t largest_free_block;
+    uint8_t fragmentation_pct;
+    uint32_t requests;                  // Explicit requests since the previous sample (soak monitor only)
+    uint32_t latency_p99_ms;            // Their p99 latency (soak monitor only)
+} enip_scanner_heap_sample_t;
+
+/**
+ * @brief Build a memory and task footprint report
+ * The report is about 1 KB; allocate it rather than putting it on a small stack.
+ * @param report Report to fill
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if report is NULL
+ */
+esp_err_t enip_scanner_get_memory_report(enip_scanner_memory_report_t *report);
+
+/**
+ * @brief Get the heap trend
+ * The heap is sampled every CONFIG_ENIP_SCANNER_DIAG_SAMPLE_INTERVAL_S seconds
+ * from enip_scanner_init(); the last CONFIG_ENIP_SCANNER_DIAG_SAMPLES are kept.
+ * A free heap that keeps falling, or a fragmentation that keeps rising, between
+ * samples taken in the same operating state points to a leak.
+ * @param samples Array for the samples, oldest first
+ * @param max_samples Size of samples
+ * @return Number of samples copied
+ */
+size_t enip_scanner_get_heap_trend(enip_scanner_heap_sample_t *samples, size_t max_samples);
+
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+/**
+ * @brief Drift limits of a soak run, 0 to leave one unchecked
+ */
+typedef struct {
+    uint32_t max_heap_loss_bytes;       // Settled free heap below the baseline
+    uint32_t max_block_loss_bytes;      // Settled largest free block below the baseline
+    uint32_t max_latency_p99_ms;        // Explicit request p99 since the start
+} enip_scanner_soak_limits_t;
+
+/**
+ * @brief State of a soak run against its baseline
+ * The settled values are the highest of the last few heap samples, so requests
+ * in flight at one sample do not read as a leak.
+ */
+typedef struct {
+    uint32_t elapsed_s;
+    uint32_t baseline_free_bytes;
+    uint32_t settled_free_bytes;
+    int32_t heap_loss_bytes;            // Baseline - settled; negative when the heap grew
+    uint32_t baseline_largest_free_block;
+    uint32_t settled_largest_free_block;
+    int32_t block_loss_bytes;
+    uint32_t requests;                  // Explicit assembly and tag requests since the start
+    uint32_t failures;
+    uint32_t latency_p50_ms;            // Percentiles are bucket bounds (1, 2, 5, 10, 20, 50 ms, ...)
+    uint32_t latency_p95_ms;
+    uint32_t latency_p99_ms;
+    uint32_t latency_max_ms;
+    bool heap_exceeded;
+    bool block_exceeded;
+    bool latency_exceeded;
+} enip_scanner_soak_report_t;
+
+/**
+ * @brief Start a soak run
+ * Takes the current heap as the baseline and restarts the latency statistics.
+ * Start it after the application has warmed up (connections open, caches
+ * filled) so the first allocations are not counted as drift. Calling it again
+ * starts a new run. A breach of the limits is logged once per run.
+ * @param limits Drift limits
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if limits is NULL,
+ *         ESP_ERR_INVALID_STATE before enip_scanner_init()
+ */
+esp_err_t enip_scanner_soak_start(const enip_scanner_soak_limits_t *limits);
+
+/**
+ * @brief Compare the soak run against its baseline and limits
+ * @param report Report to fill
+ * @return ESP_OK within the limits, ESP_FAIL if a limit is exceeded,
+ *         ESP_ERR_INVALID_ARG if report is NULL, ESP_ERR_INVALID_STATE if no run was started
+ */
+esp_err_t enip_scanner_soak_check(enip_scanner_soak_report_t *report);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
+#if CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+
+/**
+ * @brief Run the scanner's timers on a virtual clock
+ * RPI scheduling, the implicit connection watchdog, reconnect retries, session
+ * probing and I/O supervision then read time from a clock that only moves with
+ * enip_scanner_virtual_clock_advance(), so hours of cycles and timeouts can be
+ * driven in seconds. The clock starts at the current real time. Socket timeouts
+ * and explicit-message deadlines stay on real time.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the virtual clock is already running
+ */
+esp_err_t enip_scanner_virtual_clock_enable(void);
+
+/**
+ * @brief Put the scanner's timers back on real time
+ * Timestamps taken on the virtual clock are ahead of real time; close implicit
+ * connections and stop the I/O configuration first.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the virtual clock is not running
+ */
+esp_err_t enip_scanner_virtual_clock_disable(void);
+
+/**
+ * @brief Advance the virtual clock
+ * Tasks waiting on scanner time wake within one tick of the clock passing their
+ * wake-up time. Advancing in steps no larger than the shortest RPI keeps every
+ * cycle visible to the scheduler and watchdogs.
+ * @param delta_us Microseconds to advance by
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if delta_us is negative,
+ *         ESP_ERR_INVALID_STATE if the virtual clock is not running
+ */
+esp_err_t enip_scanner_virtual_clock_advance(int64_t delta_us);
+
+/**
+ * @brief Current scanner time in microseconds, virtual or real
+ * @return Scanner time in microseconds
+ */
+int64_t enip_scanner_clock_now_us(void);
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_VIRTUAL_CLOCK
+
 #ifdef __cplusplus
 }
 #endif
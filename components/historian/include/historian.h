@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file historian.h
+ * @brief On-device historian for tag, assembly and Motoman position data
+ * 
+ * Samples configured channels through the EtherNet/IP scanner and records them
+ * in a circular, log-structured flash partition ("historian" in partitions.csv).
+ * Each 4 KB sector starts with a header holding its sequence number and time
+ * range; the headers form the time index used by historian_export().
+ * 
+ * Records inside a sector (all integers are LEB128 varints, values zigzag):
+ * - Key   (0x01): channel id, dt, value count, values
+ * - Delta (0x02): channel id, dt, difference to the previous value of each word
+ * - Run   (0x03): channel id, dt, number of unchanged samples, age (ms from
+ *                 the last of them to the record time)
+ * dt is milliseconds since the previous record in the sector (the first record
+ * is relative to the sector header time). Every channel starts each sector
+ * with a key record, so any sector decodes on its own.
+ */
+
+#ifndef HISTORIAN_H
+#define HISTORIAN_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "lwip/ip4_addr.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_HISTORIAN_ENABLE
+
+/**
+ * @brief Largest number of 32-bit values in one sample
+ */
+#define HISTORIAN_VALUES_MAX 8
+
+/**
+ * @brief Source of a historian channel
+ */
+typedef enum {
+    HISTORIAN_SOURCE_TAG = 0,               // Tag read (one value per element, up to HISTORIAN_VALUES_MAX)
+    HISTORIAN_SOURCE_ASSEMBLY = 1,          // Bytes of an assembly, as little-endian 32-bit words
+    HISTORIAN_SOURCE_MOTOMAN_POSITION = 2,  // Motoman current position (8 axes)
+} historian_source_t;
+
+/**
+ * @brief How exported CSV values are printed
+ */
+typedef enum {
+    HISTORIAN_FORMAT_INT = 0,
+    HISTORIAN_FORMAT_REAL = 1,              // Values are IEEE 754 single precision bit patterns
+} historian_format_t;
+
+/**
+ * @brief Historian channel configuration
+ */
+typedef struct {
+    uint16_t id;                    // Stored with every record; 0 = assign a new id in historian_set_channels()
+    uint8_t source;                 // historian_source_t
+    uint8_t format;                 // historian_format_t
+    bool enabled;
+    ip4_addr_t ip_address;          // Device to sample
+    uint32_t period_ms;             // Sample period
+    uint16_t instance;              // Assembly instance, or Motoman control group
+    uint16_t offset;                // Assembly: first byte
+    uint16_t length;                // Assembly: number of bytes (max 4 * HISTORIAN_VALUES_MAX)
+    char name[24];                  // Column name in CSV exports
+    char tag_path[64];              // Tag: tag name/path
+} historian_channel_t;
+
+/**
+ * @brief Historian status
+ */
+typedef struct {
+    bool running;                   // Sampling task is running
+    uint32_t sector_count;          // Sectors in the partition
+    uint32_t sectors_used;          // Sectors holding data
+    int64_t oldest_ms;              // Time of the oldest stored data (historian time)
+    int64_t newest_ms;              // Time of the newest record
+    uint32_t samples;               // Samples taken since start
+    uint32_t records;               // Records written since start (unchanged samples share run records)
+    uint32_t bytes_written;         // Record bytes written to flash since start
+    uint32_t sectors_erased;        // Sector erases since start
+    uint32_t read_failures;         // Failed channel reads since start
+} historian_status_t;
+
+/**
+ * @brief Export format
+ */
+typedef enum {
+    HISTORIAN_EXPORT_CSV = 0,       // "time_ms,channel,value..." lines
+    HISTORIAN_EXPORT_BINARY = 1,    // Raw sectors: 32-byte header followed by the sector's records
+} historian_export_format_t;
+
+/**
+ * @brief Sink for exported data
+ * @return ESP_OK to continue, anything else aborts the export with that error
+ */
+typedef esp_err_t (*historian_export_writer_t)(const void *data, size_t length, void *user_data);
+
+/**
+ * @brief Mount the historian partition and start sampling the stored channels
+ * Call after enip_scanner_init().
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the partition is missing,
+ *         ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t historian_start(void);
+
+/**
+ * @brief Stop sampling and write buffered records to flash
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t historian_stop(void);
+
+/**
+ * @brief Replace the channel configuration and save it to NVS
+ * Channels with id 0 get a new id; keep the id of a channel whose meaning is
+ * unchanged so its history stays one series.
+ * @param channels Channels (ids are assigned in place)
+ * @param count Number of channels (max CONFIG_HISTORIAN_MAX_CHANNELS)
+ * @return ESP_OK on success
+ */
+esp_err_t historian_set_channels(historian_channel_t *channels, size_t count);
+
+/**
+ * @brief Get the channel configuration
+ * @param channels Output array
+ * @param max_channels Size of the output array
+ * @return Number of channels copied
+ */
+size_t historian_get_channels(historian_channel_t *channels, size_t max_channels);
+
+/**
+ * @brief Get historian status
+ */
+esp_err_t historian_get_status(historian_status_t *status);
+
+/**
+ * @brief Write buffered records to flash now
+ */
+esp_err_t historian_flush(void);
+
+/**
+ * @brief Erase all recorded data
+ */
+esp_err_t historian_erase(void);
+
+/**
+ * @brief Current historian time in milliseconds
+ * Wall-clock (Unix) time once the system time is set; before that, continues
+ * from the newest record in the log so time never goes backwards across restarts.
+ */
+int64_t historian_now_ms(void);
+
+/**
+ * @brief Export recorded data in a time range
+ * Buffered records are flushed first. Sectors are located by binary search over
+ * the sector headers, so the cost depends on the range, not the log size.
+ * @param from_ms Start of range (historian time, inclusive)
+ * @param to_ms End of range (historian time, inclusive)
+ * @param format Export format (binary exports whole sectors overlapping the range)
+ * @param writer Called with consecutive pieces of the export
+ * @param user_data Passed to writer
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not mounted, or the writer's error
+ */
+esp_err_t historian_export(int64_t from_ms, int64_t to_ms, historian_export_format_t format,
+                           historian_export_writer_t writer, void *user_data);
+
+#endif // CONFIG_HISTORIAN_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HISTORIAN_H
@@ -0,0 +1,1159 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "historian.h"
+#include "enip_scanner.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <sys/time.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#if CONFIG_HISTORIAN_ENABLE
+
+static const char *TAG = "historian";
+
+#define HIST_SECTOR_SIZE        4096
+#define HIST_SECTOR_MAGIC       0x54534948  // "HIST"
+#define HIST_ERASED32           0xFFFFFFFFu
+#define HIST_VALID_EPOCH_S      1577836800  // 2020-01-01; earlier system time is not wall-clock time
+#define HIST_TASK_PERIOD_MS     10
+#define HIST_READ_TIMEOUT_MS    1000
+
+#define HIST_RECORD_KEY         0x01
+#define HIST_RECORD_DELTA       0x02
+#define HIST_RECORD_RUN         0x03
+
+// Worst-case record sizes: type, id, dt, then count and values or run length and age
+#define HIST_RECORD_MAX         (1 + 3 + 10 + 1 + HISTORIAN_VALUES_MAX * 10)
+#define HIST_RUN_RECORD_MAX     (1 + 3 + 10 + 5 + 10)
+// Kept free in every sector so open runs can be written when it is sealed
+#define HIST_SECTOR_RESERVE     (CONFIG_HISTORIAN_MAX_CHANNELS * HIST_RUN_RECORD_MAX)
+
+#define HIST_NVS_NAMESPACE      "historian"
+#define HIST_NVS_KEY_CHANNELS   "channels"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;      // One more than the sector written before it
+    int64_t first_ms;       // Time base of the sector's first record
+    int64_t last_ms;        // Time of the last record; erased until the sector is sealed
+    uint32_t used;          // Record bytes after the header; erased until the sector is sealed
+    uint32_t reserved;
+} hist_sector_header_t;
+
+#define HIST_HEADER_SIZE        sizeof(hist_sector_header_t)
+
+typedef struct {
+    historian_channel_t config;
+    int32_t last[HISTORIAN_VALUES_MAX];
+    uint8_t count;          // Values in last[]; 0 = no key record in the current sector yet
+    uint32_t run;           // Unchanged samples not written yet
+    int64_t run_last_ms;    // Time of the newest of them
+    int64_t next_due_ms;
+} hist_channel_state_t;
+
+// Stored channel list: this header followed by count channels
+typedef struct {
+    uint16_t channel_size;
+    uint16_t count;
+    uint16_t next_id;
+    uint16_t reserved;
+} hist_channel_blob_header_t;
+
+// Per-series state while decoding one sector
+typedef struct {
+    uint16_t id;
+    uint8_t count;
+    int32_t values[HISTORIAN_VALUES_MAX];
+    int64_t time_ms;
+} hist_series_t;
+
+typedef struct {
+    hist_series_t series[CONFIG_HISTORIAN_MAX_CHANNELS];
+    size_t series_count;
+    int64_t time_ms;        // Time of the last decoded record
+} hist_decoder_t;
+
+typedef void (*hist_emit_t)(const hist_series_t *series, int64_t time_ms, void *ctx);
+
+static const esp_partition_t *s_partition = NULL;
+static SemaphoreHandle_t s_hist_mutex = NULL;
+static TaskHandle_t s_hist_task_handle = NULL;
+static volatile bool s_hist_running = false;
+
+static hist_channel_state_t s_channels[CONFIG_HISTORIAN_MAX_CHANNELS];
+static size_t s_channel_count = 0;
+static uint16_t s_next_channel_id = 1;
+
+// Log position; the used sectors are a ring ending at s_head
+static uint32_t s_sector_count = 0;
+static uint32_t s_sectors_used = 0;
+static uint32_t s_head = 0;
+static uint32_t s_head_sequence = 0;
+static int64_t s_head_first_ms = 0;
+static uint32_t s_head_used = 0;        // Record bytes of the head sector, including buffered ones
+static uint32_t s_head_flushed = 0;     // Record bytes of the head sector already in flash
+static int64_t s_last_record_ms = 0;
+static int64_t s_time_offset_ms = 0;    // Added to uptime while the system time is not set
+static TickType_t s_last_flush = 0;
+
+static uint8_t s_buffer[CONFIG_HISTORIAN_BUFFER_SIZE];  // Head sector bytes [s_head_flushed, s_head_used)
+static historian_status_t s_stats;
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static size_t put_varint(uint8_t *out, uint64_t value)
+{
+    size_t length = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[length++] = byte | (value != 0 ? 0x80 : 0);
+    } while (value != 0);
+    return length;
+}
+
+static size_t get_varint(const uint8_t *in, size_t available, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < available && i < 10; i++) {
+        result |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+static hist_series_t *decoder_series(hist_decoder_t *decoder, uint16_t id, bool create)
+{
+    for (size_t i = 0; i < decoder->series_count; i++) {
+        if (decoder->series[i].id == id) {
+            return &decoder->series[i];
+        }
+    }
+    if (!create || decoder->series_count >= CONFIG_HISTORIAN_MAX_CHANNELS) {
+        return NULL;
+    }
+    hist_series_t *series = &decoder->series[decoder->series_count++];
+    memset(series, 0, sizeof(*series));
+    series->id = id;
+    return series;
+}
+
+// Decode one record and report its samples through emit (may be NULL)
+// Returns the record length, or 0 at the end of the data or on a malformed record
+static size_t decode_record(hist_decoder_t *decoder, const uint8_t *data, size_t size, hist_emit_t emit, void *ctx)
+{
+    if (size == 0 || data[0] < HIST_RECORD_KEY || data[0] > HIST_RECORD_RUN) {
+        return 0;   // Erased flash (0xFF) ends the sector
+    }
+    
+    uint8_t type = data[0];
+    size_t pos = 1;
+    uint64_t id, dt, value;
+    size_t n = get_varint(data + pos, size - pos, &id);
+    if (n == 0) {
+        return 0;
+    }
+    pos += n;
+    n = get_varint(data + pos, size - pos, &dt);
+    if (n == 0) {
+        return 0;
+    }
+    pos += n;
+    int64_t time_ms = decoder->time_ms + (int64_t)dt;
+    
+    hist_series_t *series = decoder_series(decoder, (uint16_t)id, type == HIST_RECORD_KEY);
+    if (series == NULL || (type != HIST_RECORD_KEY && series->count == 0)) {
+        return 0;
+    }
+    
+    if (type == HIST_RECORD_KEY) {
+        if (pos >= size || data[pos] == 0 || data[pos] > HISTORIAN_VALUES_MAX) {
+            return 0;
+        }
+        series->count = data[pos++];
+        for (uint8_t i = 0; i < series->count; i++) {
+            n = get_varint(data + pos, size - pos, &value);
+            if (n == 0) {
+                return 0;
+            }
+            pos += n;
+            series->values[i] = (int32_t)zigzag_decode(value);
+        }
+        series->time_ms = time_ms;
+        if (emit != NULL) {
+            emit(series, time_ms, ctx);
+        }
+    } else if (type == HIST_RECORD_DELTA) {
+        for (uint8_t i = 0; i < series->count; i++) {
+            n = get_varint(data + pos, size - pos, &value);
+            if (n == 0) {
+                return 0;
+            }
+            pos += n;
+            series->values[i] = (int32_t)((uint32_t)series->values[i] + (uint32_t)zigzag_decode(value));
+        }
+        series->time_ms = time_ms;
+        if (emit != NULL) {
+            emit(series, time_ms, ctx);
+        }
+    } else {
+        uint64_t run, age;
+        n = get_varint(data + pos, size - pos, &run);
+        if (n == 0) {
+            return 0;
+        }
+        pos += n;
+        n = get_varint(data + pos, size - pos, &age);
+        if (n == 0) {
+            return 0;
+        }
+        pos += n;
+        // The unchanged samples are spread evenly up to the newest one
+        int64_t start_ms = series->time_ms;
+        int64_t end_ms = time_ms - (int64_t)age;
+        for (uint64_t i = 1; emit != NULL && i <= run; i++) {
+            emit(series, start_ms + (end_ms - start_ms) * (int64_t)i / (int64_t)run, ctx);
+        }
+        series->time_ms = end_ms;
+    }
+    
+    decoder->time_ms = time_ms;
+    return pos;
+}
+
+// Decode a sector's records; returns the number of valid record bytes
+static size_t decode_sector(const hist_sector_header_t *header, const uint8_t *data, size_t size,
+                            int64_t *last_ms, hist_emit_t emit, void *ctx)
+{
+    hist_decoder_t *decoder = calloc(1, sizeof(hist_decoder_t));
+    if (decoder == NULL) {
+        return 0;
+    }
+    decoder->time_ms = header->first_ms;
+    
+    size_t pos = 0;
+    while (pos < size) {
+        size_t n = decode_record(decoder, data + pos, size - pos, emit, ctx);
+        if (n == 0) {
+            break;
+        }
+        pos += n;
+    }
+    if (last_ms != NULL) {
+        *last_ms = decoder->time_ms;
+    }
+    free(decoder);
+    return pos;
+}
+
+// ============================================================================
+// Log
+// ============================================================================
+
+int64_t historian_now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec >= HIST_VALID_EPOCH_S) {
+        return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    }
+    return s_time_offset_ms + esp_timer_get_time() / 1000;
+}
+
+static esp_err_t read_header(uint32_t sector, hist_sector_header_t *header)
+{
+    return esp_partition_read(s_partition, (size_t)sector * HIST_SECTOR_SIZE, header, sizeof(*header));
+}
+
+static void flush_buffer_locked(void)
+{
+    uint32_t pending = s_head_used - s_head_flushed;
+    if (pending > 0) {
+        size_t offset = (size_t)s_head * HIST_SECTOR_SIZE + HIST_HEADER_SIZE + s_head_flushed;
+        esp_err_t ret = esp_partition_write(s_partition, offset, s_buffer, pending);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write %" PRIu32 " bytes: %s", pending, esp_err_to_name(ret));
+        }
+        s_head_flushed = s_head_used;
+        s_stats.bytes_written += pending;
+    }
+    s_last_flush = xTaskGetTickCount();
+}
+
+static void append_locked(const uint8_t *record, size_t length, int64_t time_ms)
+{
+    if (s_head_used - s_head_flushed + length > sizeof(s_buffer)) {
+        flush_buffer_locked();
+    }
+    memcpy(s_buffer + (s_head_used - s_head_flushed), record, length);
+    s_head_used += length;
+    s_last_record_ms = time_ms;
+    s_stats.records++;
+}
+
+static size_t record_start(uint8_t *record, uint8_t type, uint16_t id, int64_t time_ms)
+{
+    size_t length = 0;
+    record[length++] = type;
+    length += put_varint(record + length, id);
+    length += put_varint(record + length, (uint64_t)(time_ms - s_last_record_ms));
+    return length;
+}
+
+static void write_run_locked(hist_channel_state_t *channel, int64_t time_ms)
+{
+    uint8_t record[HIST_RUN_RECORD_MAX];
+    if (time_ms < s_last_record_ms) {
+        time_ms = s_last_record_ms;
+    }
+    if (time_ms < channel->run_last_ms) {
+        time_ms = channel->run_last_ms;
+    }
+    size_t length = record_start(record, HIST_RECORD_RUN, channel->config.id, time_ms);
+    length += put_varint(record + length, channel->run);
+    length += put_varint(record + length, (uint64_t)(time_ms - channel->run_last_ms));
+    append_locked(record, length, time_ms);
+    channel->run = 0;
+}
+
+static void close_runs_locked(void)
+{
+    for (size_t i = 0; i < s_channel_count; i++) {
+        if (s_channels[i].run > 0 && s_channels[i].count > 0) {
+            write_run_locked(&s_channels[i], s_last_record_ms);
+        }
+    }
+}
+
+// Close open runs (they fit in the sector reserve), flush and record the sector's extent
+static void seal_head_locked(void)
+{
+    close_runs_locked();
+    flush_buffer_locked();
+    
+    struct {
+        int64_t last_ms;
+        uint32_t used;
+    } __attribute__((packed)) tail = { s_last_record_ms, s_head_used };
+    esp_partition_write(s_partition, (size_t)s_head * HIST_SECTOR_SIZE + offsetof(hist_sector_header_t, last_ms),
+                        &tail, sizeof(tail));
+}
+
+static esp_err_t open_sector_locked(uint32_t sector, uint32_t sequence, int64_t first_ms)
+{
+    esp_err_t ret = esp_partition_erase_range(s_partition, (size_t)sector * HIST_SECTOR_SIZE, HIST_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to erase sector %" PRIu32 ": %s", sector, esp_err_to_name(ret));
+        return ret;
+    }
+    s_stats.sectors_erased++;
+    
+    // Only the first half of the header is written now; the rest stays erased until sealing
+    hist_sector_header_t header = { .magic = HIST_SECTOR_MAGIC, .sequence = sequence, .first_ms = first_ms };
+    ret = esp_partition_write(s_partition, (size_t)sector * HIST_SECTOR_SIZE, &header,
+                              offsetof(hist_sector_header_t, last_ms));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    s_head = sector;
+    s_head_sequence = sequence;
+    s_head_first_ms = first_ms;
+    s_head_used = 0;
+    s_head_flushed = 0;
+    s_last_record_ms = first_ms;
+    if (s_sectors_used < s_sector_count) {
+        s_sectors_used++;
+    }
+    // Every channel starts the new sector with a key record
+    for (size_t i = 0; i < s_channel_count; i++) {
+        s_channels[i].count = 0;
+        s_channels[i].run = 0;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t advance_locked(int64_t time_ms)
+{
+    seal_head_locked();
+    if (time_ms < s_last_record_ms) {
+        time_ms = s_last_record_ms;
+    }
+    return open_sector_locked((s_head + 1) % s_sector_count, s_head_sequence + 1, time_ms);
+}
+
+static bool fits_locked(size_t length)
+{
+    return HIST_HEADER_SIZE + s_head_used + length <= HIST_SECTOR_SIZE - HIST_SECTOR_RESERVE;
+}
+
+// Close open runs for a flush or export. The reserve is kept for
+// seal_head_locked(), so when the runs no longer fit next to it the head is
+// sealed (which closes them) and the log moves on to the next sector.
+static void close_runs_checked_locked(void)
+{
+    size_t open_runs = 0;
+    for (size_t i = 0; i < s_channel_count; i++) {
+        if (s_channels[i].run > 0 && s_channels[i].count > 0) {
+            open_runs++;
+        }
+    }
+    if (open_runs == 0) {
+        return;
+    }
+    if (fits_locked(open_runs * HIST_RUN_RECORD_MAX)) {
+        close_runs_locked();
+    } else {
+        advance_locked(historian_now_ms());
+    }
+}
+
+static void sample_locked(hist_channel_state_t *channel, const int32_t *values, uint8_t count, int64_t time_ms)
+{
+    s_stats.samples++;
+    if (time_ms < s_last_record_ms) {
+        time_ms = s_last_record_ms;
+    }
+    
+    // Unchanged: extend the run instead of writing a record
+    if (channel->count == count && memcmp(channel->last, values, count * sizeof(int32_t)) == 0) {
+        channel->run++;
+        channel->run_last_ms = time_ms;
+        return;
+    }
+    
+    if (channel->run > 0) {
+        if (!fits_locked(HIST_RUN_RECORD_MAX) && advance_locked(time_ms) != ESP_OK) {
+            return;
+        }
+        if (channel->run > 0) {
+            write_run_locked(channel, time_ms);
+        }
+    }
+    if (!fits_locked(HIST_RECORD_MAX) && advance_locked(time_ms) != ESP_OK) {
+        return;
+    }
+    
+    uint8_t record[HIST_RECORD_MAX];
+    size_t length;
+    if (channel->count == count) {
+        length = record_start(record, HIST_RECORD_DELTA, channel->config.id, time_ms);
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t delta = (int32_t)((uint32_t)values[i] - (uint32_t)channel->last[i]);
+            length += put_varint(record + length, zigzag_encode(delta));
+        }
+    } else {
+        length = record_start(record, HIST_RECORD_KEY, channel->config.id, time_ms);
+        record[length++] = count;
+        for (uint8_t i = 0; i < count; i++) {
+            length += put_varint(record + length, zigzag_encode(values[i]));
+        }
+    }
+    append_locked(record, length, time_ms);
+    memcpy(channel->last, values, count * sizeof(int32_t));
+    channel->count = count;
+}
+
+// Find the newest sector and continue after it; a partly written head sector
+// (power loss) is parsed to find its end and sealed
+static esp_err_t mount_locked(void)
+{
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                           CONFIG_HISTORIAN_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        ESP_LOGE(TAG, "Partition '%s' not found", CONFIG_HISTORIAN_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sector_count = s_partition->size / HIST_SECTOR_SIZE;
+    if (s_sector_count < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    bool found = false;
+    hist_sector_header_t header;
+    for (uint32_t i = 0; i < s_sector_count; i++) {
+        if (read_header(i, &header) == ESP_OK && header.magic == HIST_SECTOR_MAGIC &&
+            (!found || (int32_t)(header.sequence - s_head_sequence) > 0)) {
+            s_head = i;
+            s_head_sequence = header.sequence;
+            found = true;
+        }
+    }
+    
+    s_sectors_used = 0;
+    if (!found) {
+        ESP_LOGI(TAG, "Empty log, %" PRIu32 " sectors", s_sector_count);
+        return open_sector_locked(0, 1, historian_now_ms());
+    }
+    
+    // Count the consecutive sectors behind the head
+    for (uint32_t k = 0; k < s_sector_count; k++) {
+        uint32_t sector = (s_head + s_sector_count - k) % s_sector_count;
+        if (read_header(sector, &header) != ESP_OK || header.magic != HIST_SECTOR_MAGIC ||
+            header.sequence != s_head_sequence - k) {
+            break;
+        }
+        s_sectors_used++;
+    }
+    
+    read_header(s_head, &header);
+    s_head_first_ms = header.first_ms;
+    int64_t last_ms = header.last_ms;
+    if (header.used == HIST_ERASED32) {
+        uint8_t *data = malloc(HIST_SECTOR_SIZE - HIST_HEADER_SIZE);
+        if (data == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_partition_read(s_partition, (size_t)s_head * HIST_SECTOR_SIZE + HIST_HEADER_SIZE,
+                           data, HIST_SECTOR_SIZE - HIST_HEADER_SIZE);
+        s_head_used = decode_sector(&header, data, HIST_SECTOR_SIZE - HIST_HEADER_SIZE, &last_ms, NULL, NULL);
+        free(data);
+        s_head_flushed = s_head_used;
+        s_last_record_ms = last_ms;
+        seal_head_locked();
+    }
+    
+    // Continue the time line of the log until the system time is set
+    s_time_offset_ms = last_ms + 1 - esp_timer_get_time() / 1000;
+    s_last_record_ms = last_ms;
+    
+    int64_t now_ms = historian_now_ms();
+    ESP_LOGI(TAG, "Mounted: %" PRIu32 " of %" PRIu32 " sectors used, newest record at %" PRId64 " ms",
+             s_sectors_used, s_sector_count, last_ms);
+    return open_sector_locked((s_head + 1) % s_sector_count, s_head_sequence + 1,
+                              now_ms > last_ms ? now_ms : last_ms);
+}
+
+// ============================================================================
+// Sampling
+// ============================================================================
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+// One value per element for integer and REAL tags, 32-bit words otherwise
+static uint8_t values_from_tag(uint16_t cip_data_type, const uint8_t *data, uint16_t length, int32_t *values)
+{
+    uint8_t count = 0;
+    switch (cip_data_type) {
+        case CIP_DATA_TYPE_BOOL:
+        case CIP_DATA_TYPE_USINT:
+        case CIP_DATA_TYPE_BYTE:
+            for (; count < length && count < HISTORIAN_VALUES_MAX; count++) {
+                values[count] = data[count];
+            }
+            return count;
+        case CIP_DATA_TYPE_SINT:
+            for (; count < length && count < HISTORIAN_VALUES_MAX; count++) {
+                values[count] = (int8_t)data[count];
+            }
+            return count;
+        case CIP_DATA_TYPE_INT:
+        case CIP_DATA_TYPE_UINT:
+        case CIP_DATA_TYPE_WORD:
+            for (; count < length / 2 && count < HISTORIAN_VALUES_MAX; count++) {
+                uint16_t word = data[count * 2] | (data[count * 2 + 1] << 8);
+                values[count] = (cip_data_type == CIP_DATA_TYPE_INT) ? (int16_t)word : word;
+            }
+            return count;
+        default:
+            break;
+    }
+    for (; count * 4 < length && count < HISTORIAN_VALUES_MAX; count++) {
+        uint8_t word[4] = {0};
+        memcpy(word, data + count * 4, (length - count * 4) < 4 ? (length - count * 4) : 4);
+        values[count] = (int32_t)(word[0] | (word[1] << 8) | (word[2] << 16) | ((uint32_t)word[3] << 24));
+    }
+    return count;
+}
+#endif
+
+static esp_err_t read_channel(const historian_channel_t *channel, int32_t *values, uint8_t *count)
+{
+    uint32_t timeout_ms = channel->period_ms < HIST_READ_TIMEOUT_MS ? channel->period_ms : HIST_READ_TIMEOUT_MS;
+    if (timeout_ms < 200) {
+        timeout_ms = 200;
+    }
+    *count = 0;
+    
+    switch (channel->source) {
+#if CONFIG_ENIP_SCANNER_ENABLE_TAG_SUPPORT
+        case HISTORIAN_SOURCE_TAG: {
+            enip_scanner_tag_result_t result;
+            esp_err_t ret = enip_scanner_read_tag(&channel->ip_address, channel->tag_path, &result, timeout_ms);
+            if (ret == ESP_OK && result.success) {
+                *count = values_from_tag(result.cip_data_type, result.data, result.data_length, values);
+            }
+            enip_scanner_free_tag_result(&result);
+            return (ret == ESP_OK && result.success && *count > 0) ? ESP_OK : ESP_FAIL;
+        }
+#endif
+        case HISTORIAN_SOURCE_ASSEMBLY: {
+            enip_scanner_assembly_result_t result;
+            esp_err_t ret = enip_scanner_read_assembly(&channel->ip_address, channel->instance, &result, timeout_ms);
+            if (ret == ESP_OK && result.success && channel->offset < result.data_length) {
+                uint16_t length = result.data_length - channel->offset;
+                if (length > channel->length) {
+                    length = channel->length;
+                }
+                for (; *count * 4 < length && *count < HISTORIAN_VALUES_MAX; (*count)++) {
+                    uint8_t word[4] = {0};
+                    uint16_t remaining = length - *count * 4;
+                    memcpy(word, result.data + channel->offset + *count * 4, remaining < 4 ? remaining : 4);
+                    values[*count] = (int32_t)(word[0] | (word[1] << 8) | (word[2] << 16) | ((uint32_t)word[3] << 24));
+                }
+            }
+            enip_scanner_free_assembly_result(&result);
+            return *count > 0 ? ESP_OK : ESP_FAIL;
+        }
+#if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
+        case HISTORIAN_SOURCE_MOTOMAN_POSITION: {
+            enip_scanner_motoman_position_t position;
+            esp_err_t ret = enip_scanner_motoman_read_position(&channel->ip_address, channel->instance,
+                                                                &position, timeout_ms);
+            if (ret != ESP_OK || !position.success) {
+                return ESP_FAIL;
+            }
+            memcpy(values, position.axis_data, sizeof(position.axis_data));
+            *count = 8;
+            return ESP_OK;
+        }
+#endif
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+static void historian_task(void *arg)
+{
+    while (s_hist_running) {
+        for (size_t i = 0; s_hist_running; i++) {
+            historian_channel_t config;
+            int64_t now_ms = historian_now_ms();
+            
+            // Claim the next due channel; the list may be replaced while it is read
+            xSemaphoreTake(s_hist_mutex, portMAX_DELAY);
+            if (i >= s_channel_count) {
+                xSemaphoreGive(s_hist_mutex);
+                break;
+            }
+            hist_channel_state_t *channel = &s_channels[i];
+            bool due = channel->config.enabled && channel->config.period_ms > 0 && now_ms >= channel->next_due_ms;
+            if (due) {
+                config = channel->config;
+                channel->next_due_ms += channel->config.period_ms;
+                if (channel->next_due_ms <= now_ms) {
+                    channel->next_due_ms = now_ms + channel->config.period_ms;  // Fell behind; do not burst
+                }
+            }
+            xSemaphoreGive(s_hist_mutex);
+            if (!due) {
+                continue;
+            }
+            
+            int32_t values[HISTORIAN_VALUES_MAX];
+            uint8_t count = 0;
+            esp_err_t ret = read_channel(&config, values, &count);
+            int64_t sample_ms = historian_now_ms();
+            
+            xSemaphoreTake(s_hist_mutex, portMAX_DELAY);
+            if (ret != ESP_OK) {
+                s_stats.read_failures++;
+            } else if (i < s_channel_count && s_channels[i].config.id == config.id) {
+                sample_locked(&s_channels[i], values, count, sample_ms);
+            }
+            xSemaphoreGive(s_hist_mutex);
+        }
+        
+        xSemaphoreTake(s_hist_mutex, portMAX_DELAY);
+        if ((xTaskGetTickCount() - s_last_flush) >= pdMS_TO_TICKS(CONFIG_HISTORIAN_FLUSH_MS)) {
+            close_runs_checked_locked();
+            flush_buffer_locked();
+        }
+        xSemaphoreGive(s_hist_mutex);
+        
+        vTaskDelay(pdMS_TO_TICKS(HIST_TASK_PERIOD_MS));
+    }
+    
+    xSemaphoreTake(s_hist_mutex, portMAX_DELAY);
+    close_runs_checked_locked();
+    flush_buffer_locked();
+    xSemaphoreGive(s_hist_mutex);
+    
+    s_hist_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+static void load_channels_locked(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(HIST_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    
+    size_t length = sizeof(hist_channel_blob_header_t) + sizeof(historian_channel_t) * CONFIG_HISTORIAN_MAX_CHANNELS;
+    uint8_t *blob = malloc(length);
+    if (blob != NULL && nvs_get_blob(handle, HIST_NVS_KEY_CHANNELS, blob, &length) == ESP_OK &&
+        length >= sizeof(hist_channel_blob_header_t)) {
+        hist_channel_blob_header_t *header = (hist_channel_blob_header_t *)blob;
+        if (header->channel_size != sizeof(historian_channel_t) ||
+            header->count > CONFIG_HISTORIAN_MAX_CHANNELS ||
+            length != sizeof(*header) + header->count * sizeof(historian_channel_t)) {
+            ESP_LOGW(TAG, "Ignoring stored channels with a different format");
+        } else {
+            const historian_channel_t *channels = (const historian_channel_t *)(blob + sizeof(*header));
+            memset(s_channels, 0, sizeof(s_channels));
+            for (size_t i = 0; i < header->count; i++) {
+                s_channels[i].config = channels[i];
+            }
+            s_channel_count = header->count;
+            s_next_channel_id = header->next_id;
+        }
+    }
+    free(blob);
+    nvs_close(handle);
+}
+
+static esp_err_t save_channels_locked(void)
+{
+    size_t length = sizeof(hist_channel_blob_header_t) + s_channel_count * sizeof(historian_channel_t);
+    uint8_t *blob = malloc(length);
+    if (blob == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    hist_channel_blob_header_t *header = (hist_channel_blob_header_t *)blob;
+    header->channel_size = sizeof(historian_channel_t);
+    header->count = s_channel_count;
+    header->next_id = s_next_channel_id;
+    header->reserved = 0;
+    historian_channel_t *channels = (historian_channel_t *)(blob + sizeof(*header));
+    for (size_t i = 0; i < s_channel_count; i++) {
+        channels[i] = s_channels[i].config;
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(HIST_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, HIST_NVS_KEY_CHANNELS, blob, length);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    free(blob);
+    return ret;
+}
+
+static bool historian_lock(void)
+{
+    if (s_hist_mutex == NULL) {
+        SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+        if (mutex == NULL) {
+            return false;
+        }
+        s_hist_mutex = mutex;
+    }
+    return xSemaphoreTake(s_hist_mutex, portMAX_DELAY) == pdTRUE;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t historian_start(void)
+{
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (s_hist_running || s_hist_task_handle != NULL) {
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    load_channels_locked();
+    esp_err_t ret = ESP_OK;
+    if (s_partition == NULL) {
+        ret = mount_locked();
+    }
+    if (ret != ESP_OK) {
+        s_partition = NULL;
+        xSemaphoreGive(s_hist_mutex);
+        return ret;
+    }
+    
+    memset(&s_stats, 0, sizeof(s_stats));
+    int64_t now_ms = historian_now_ms();
+    for (size_t i = 0; i < s_channel_count; i++) {
+        s_channels[i].next_due_ms = now_ms;
+    }
+    s_last_flush = xTaskGetTickCount();
+    s_hist_running = true;
+    
+    BaseType_t created = xTaskCreate(historian_task, "historian", 6144, NULL, 2, &s_hist_task_handle);
+    if (created != pdPASS) {
+        s_hist_running = false;
+        s_hist_task_handle = NULL;
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_hist_mutex);
+    
+    ESP_LOGI(TAG, "Historian started with %u channel(s)", (unsigned)s_channel_count);
+    return ESP_OK;
+}
+
+esp_err_t historian_stop(void)
+{
+    if (s_hist_mutex == NULL || !s_hist_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_hist_running = false;
+    while (s_hist_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(HIST_TASK_PERIOD_MS));
+    }
+    return ESP_OK;
+}
+
+esp_err_t historian_set_channels(historian_channel_t *channels, size_t count)
+{
+    if ((channels == NULL && count > 0) || count > CONFIG_HISTORIAN_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (channels[i].source > HISTORIAN_SOURCE_MOTOMAN_POSITION || channels[i].period_ms == 0 ||
+            (channels[i].source == HISTORIAN_SOURCE_ASSEMBLY &&
+             (channels[i].length == 0 || channels[i].length > HISTORIAN_VALUES_MAX * 4))) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Ids in the current sector must stay unambiguous: start a new one
+    if (s_partition != NULL && s_head_used > 0) {
+        advance_locked(historian_now_ms());
+    }
+    
+    int64_t now_ms = historian_now_ms();
+    memset(s_channels, 0, sizeof(s_channels));
+    for (size_t i = 0; i < count; i++) {
+        if (channels[i].id == 0) {
+            channels[i].id = s_next_channel_id++;
+            if (s_next_channel_id == 0) {
+                s_next_channel_id = 1;
+            }
+        }
+        channels[i].name[sizeof(channels[i].name) - 1] = '\0';
+        channels[i].tag_path[sizeof(channels[i].tag_path) - 1] = '\0';
+        s_channels[i].config = channels[i];
+        s_channels[i].next_due_ms = now_ms;
+    }
+    s_channel_count = count;
+    
+    esp_err_t ret = save_channels_locked();
+    xSemaphoreGive(s_hist_mutex);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save channels: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+size_t historian_get_channels(historian_channel_t *channels, size_t max_channels)
+{
+    if (channels == NULL || !historian_lock()) {
+        return 0;
+    }
+    if (s_channel_count == 0 && !s_hist_running) {
+        load_channels_locked();
+    }
+    size_t count = s_channel_count < max_channels ? s_channel_count : max_channels;
+    for (size_t i = 0; i < count; i++) {
+        channels[i] = s_channels[i].config;
+    }
+    xSemaphoreGive(s_hist_mutex);
+    return count;
+}
+
+esp_err_t historian_get_status(historian_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    *status = s_stats;
+    status->running = s_hist_running;
+    status->sector_count = s_sector_count;
+    status->sectors_used = s_sectors_used;
+    status->newest_ms = s_last_record_ms;
+    status->oldest_ms = s_head_first_ms;
+    if (s_partition != NULL && s_sectors_used > 1) {
+        hist_sector_header_t header;
+        if (read_header((s_head + s_sector_count - (s_sectors_used - 1)) % s_sector_count, &header) == ESP_OK) {
+            status->oldest_ms = header.first_ms;
+        }
+    }
+    xSemaphoreGive(s_hist_mutex);
+    return ESP_OK;
+}
+
+esp_err_t historian_flush(void)
+{
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (s_partition == NULL) {
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    close_runs_checked_locked();
+    flush_buffer_locked();
+    xSemaphoreGive(s_hist_mutex);
+    return ESP_OK;
+}
+
+esp_err_t historian_erase(void)
+{
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (s_partition == NULL) {
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = esp_partition_erase_range(s_partition, 0, (size_t)s_sector_count * HIST_SECTOR_SIZE);
+    if (ret == ESP_OK) {
+        s_sectors_used = 0;
+        ret = open_sector_locked(0, s_head_sequence + 1, historian_now_ms());
+    }
+    xSemaphoreGive(s_hist_mutex);
+    ESP_LOGI(TAG, "Log erased: %s", esp_err_to_name(ret));
+    return ret;
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+typedef struct {
+    historian_export_writer_t writer;
+    void *user_data;
+    esp_err_t result;
+    int64_t from_ms;
+    int64_t to_ms;
+    historian_channel_t channels[CONFIG_HISTORIAN_MAX_CHANNELS];
+    size_t channel_count;
+    char line[512];
+    size_t line_used;
+} hist_export_t;
+
+static void export_write(hist_export_t *export, const void *data, size_t length)
+{
+    if (export->result == ESP_OK) {
+        export->result = export->writer(data, length, export->user_data);
+    }
+}
+
+static void export_csv_sample(const hist_series_t *series, int64_t time_ms, void *ctx)
+{
+    hist_export_t *export = ctx;
+    if (time_ms < export->from_ms || time_ms > export->to_ms || export->result != ESP_OK) {
+        return;
+    }
+    
+    const historian_channel_t *channel = NULL;
+    for (size_t i = 0; i < export->channel_count; i++) {
+        if (export->channels[i].id == series->id) {
+            channel = &export->channels[i];
+            break;
+        }
+    }
+    
+    // Room for a full line; otherwise hand the buffered lines to the writer first
+    if (export->line_used + 64 + HISTORIAN_VALUES_MAX * 16 > sizeof(export->line)) {
+        export_write(export, export->line, export->line_used);
+        export->line_used = 0;
+    }
+    char *out = export->line + export->line_used;
+    size_t space = sizeof(export->line) - export->line_used;
+    int n;
+    if (channel != NULL && channel->name[0] != '\0') {
+        n = snprintf(out, space, "%" PRId64 ",%s", time_ms, channel->name);
+    } else {
+        n = snprintf(out, space, "%" PRId64 ",ch%u", time_ms, series->id);
+    }
+    for (uint8_t i = 0; i < series->count && n > 0 && (size_t)n < space; i++) {
+        if (channel != NULL && channel->format == HISTORIAN_FORMAT_REAL) {
+            float value;
+            memcpy(&value, &series->values[i], sizeof(value));
+            n += snprintf(out + n, space - n, ",%g", (double)value);
+        } else {
+            n += snprintf(out + n, space - n, ",%" PRId32, series->values[i]);
+        }
+    }
+    if (n > 0 && (size_t)n + 1 < space) {
+        out[n++] = '\n';
+        export->line_used += n;
+    }
+}
+
+esp_err_t historian_export(int64_t from_ms, int64_t to_ms, historian_export_format_t format,
+                           historian_export_writer_t writer, void *user_data)
+{
+    if (writer == NULL || from_ms > to_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!historian_lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (s_partition == NULL) {
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    hist_export_t *export = calloc(1, sizeof(hist_export_t));
+    uint8_t *data = malloc(HIST_SECTOR_SIZE);
+    if (export == NULL || data == NULL) {
+        free(export);
+        free(data);
+        xSemaphoreGive(s_hist_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Snapshot the log; sectors are read without the lock and checked afterwards
+    close_runs_checked_locked();
+    flush_buffer_locked();
+    uint32_t head = s_head;
+    uint32_t head_sequence = s_head_sequence;
+    uint32_t head_used = s_head_used;
+    int64_t head_last_ms = s_last_record_ms;
+    uint32_t used = s_sectors_used;
+    export->channel_count = s_channel_count;
+    for (size_t i = 0; i < s_channel_count; i++) {
+        export->channels[i] = s_channels[i].config;
+    }
+    xSemaphoreGive(s_hist_mutex);
+    
+    export->writer = writer;
+    export->user_data = user_data;
+    export->from_ms = from_ms;
+    export->to_ms = to_ms;
+    uint32_t oldest = (head + s_sector_count - (used - 1)) % s_sector_count;
+    
+    // Binary search over sector age for the first sector ending at or after from_ms
+    uint32_t low = 0, high = used;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t sector = (oldest + mid) % s_sector_count;
+        hist_sector_header_t header;
+        int64_t last_ms = head_last_ms;
+        if (sector != head && read_header(sector, &header) == ESP_OK) {
+            last_ms = (header.used == HIST_ERASED32) ? INT64_MAX : header.last_ms;
+        }
+        if (last_ms < from_ms) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    if (format == HISTORIAN_EXPORT_CSV) {
+        const char *title = "time_ms,channel,values\n";
+        export_write(export, title, strlen(title));
+    }
+    
+    for (uint32_t k = low; k < used && export->result == ESP_OK; k++) {
+        uint32_t sector = (oldest + k) % s_sector_count;
+        uint32_t sequence = head_sequence - (used - 1 - k);
+        hist_sector_header_t header;
+        if (read_header(sector, &header) != ESP_OK || header.magic != HIST_SECTOR_MAGIC || header.sequence != sequence) {
+            continue;   // Overwritten since the snapshot
+        }
+        if (header.first_ms > to_ms) {
+            break;
+        }
+        if (sector == head) {
+            header.last_ms = head_last_ms;
+            header.used = head_used;
+        }
+        uint32_t length = header.used <= HIST_SECTOR_SIZE - HIST_HEADER_SIZE ? header.used : 0;
+        esp_partition_read(s_partition, (size_t)sector * HIST_SECTOR_SIZE + HIST_HEADER_SIZE, data, length);
+        
+        hist_sector_header_t check;
+        if (read_header(sector, &check) != ESP_OK || check.sequence != sequence) {
+            continue;
+        }
+        
+        if (format == HISTORIAN_EXPORT_BINARY) {
+            export_write(export, &header, sizeof(header));
+            export_write(export, data, length);
+        } else {
+            decode_sector(&header, data, length, NULL, export_csv_sample, export);
+        }
+    }
+    
+    if (format == HISTORIAN_EXPORT_CSV && export->line_used > 0) {
+        export_write(export, export->line, export->line_used);
+    }
+    
+    esp_err_t ret = export->result;
+    free(export);
+    free(data);
+    return ret;
+}
+
+#endif // CONFIG_HISTORIAN_ENABLE
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file modbus_server.h
+ * @brief Modbus TCP server view of the I/O configuration process image
+ * 
+ * Every entry of the running I/O configuration (see enip_scanner_io_start())
+ * owns a block of CONFIG_MODBUS_SERVER_BLOCK_REGISTERS registers starting at
+ * index * CONFIG_MODBUS_SERVER_BLOCK_REGISTERS:
+ * - Input registers (FC 04): input image - T-to-O data of implicit entries,
+ *   the last polled value of tag and Motoman status entries
+ * - Holding registers (FC 03, 06, 16): O-to-T image of implicit entries
+ * - Discrete inputs (FC 02) and coils (FC 01, 05, 15): the bits of the same
+ *   two images, starting at bit index * CONFIG_MODBUS_SERVER_BLOCK_REGISTERS * 16
+ * Register n holds bytes 2n (low) and 2n+1 (high) of the image, so INT and
+ * DINT values read as in the device's assembly.
+ * 
+ * All requests are served from memory. Writes update the O-to-T data sent by
+ * the next implicit heartbeat. Entries without data yet answer with Modbus
+ * exception 0x0B (gateway target failed to respond).
+ */
+
+#ifndef MODBUS_SERVER_H
+#define MODBUS_SERVER_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_MODBUS_SERVER_ENABLE
+
+/**
+ * @brief Modbus server statistics
+ */
+typedef struct {
+    bool running;
+    uint8_t clients;                    // Connected clients
+    uint32_t requests;                  // Requests answered
+    uint32_t writes;                    // Write requests applied to O-to-T data
+    uint32_t exceptions;                // Requests answered with an exception
+} modbus_server_status_t;
+
+/**
+ * @brief Start the Modbus TCP server on CONFIG_MODBUS_SERVER_PORT
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t modbus_server_start(void);
+
+/**
+ * @brief Stop the server and close all client connections
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t modbus_server_stop(void);
+
+/**
+ * @brief Get the server statistics
+ * @param status Status copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if status is NULL
+ */
+esp_err_t modbus_server_get_status(modbus_server_status_t *status);
+
+#endif // CONFIG_MODBUS_SERVER_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MODBUS_SERVER_H
@@ -0,0 +1,607 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file modbus_server.c
+ * @brief Modbus TCP server serving the I/O configuration images from memory
+ */
+
+#include "modbus_server.h"
+#include "enip_scanner.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <errno.h>
+
+#if CONFIG_MODBUS_SERVER_ENABLE
+
+static const char *TAG = "modbus_server";
+
+#define MODBUS_TASK_STACK_SIZE 4096
+#define MODBUS_MBAP_SIZE 7
+#define MODBUS_PDU_MAX 253
+#define MODBUS_ADU_MAX (MODBUS_MBAP_SIZE + MODBUS_PDU_MAX)  // 260: the unit id is in the MBAP header
+#define MODBUS_IMAGE_MAX (CONFIG_MODBUS_SERVER_BLOCK_REGISTERS * 2)
+#define MODBUS_BIT_BLOCK ((uint32_t)CONFIG_MODBUS_SERVER_BLOCK_REGISTERS * 16)
+
+// Function codes
+#define MODBUS_FC_READ_COILS 0x01
+#define MODBUS_FC_READ_DISCRETE_INPUTS 0x02
+#define MODBUS_FC_READ_HOLDING_REGISTERS 0x03
+#define MODBUS_FC_READ_INPUT_REGISTERS 0x04
+#define MODBUS_FC_WRITE_SINGLE_COIL 0x05
+#define MODBUS_FC_WRITE_SINGLE_REGISTER 0x06
+#define MODBUS_FC_WRITE_MULTIPLE_COILS 0x0F
+#define MODBUS_FC_WRITE_MULTIPLE_REGISTERS 0x10
+
+// Exception codes
+#define MODBUS_EX_ILLEGAL_FUNCTION 0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS 0x02
+#define MODBUS_EX_ILLEGAL_VALUE 0x03
+#define MODBUS_EX_DEVICE_FAILURE 0x04
+#define MODBUS_EX_GATEWAY_TARGET 0x0B
+
+typedef struct {
+    int sock;
+    uint16_t fill;
+    uint8_t rx[MODBUS_ADU_MAX];
+} modbus_client_t;
+
+static modbus_client_t s_clients[CONFIG_MODBUS_SERVER_MAX_CLIENTS];
+static uint8_t s_image[MODBUS_IMAGE_MAX];       // Image of the entry being served (server task only)
+static modbus_server_status_t s_status;
+static portMUX_TYPE s_status_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_server_task_handle = NULL;
+static volatile bool s_server_running = false;
+
+static uint16_t get_u16_be(const uint8_t *data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+// ============================================================================
+// Process image
+// ============================================================================
+
+// Copy the input or output image of an I/O entry into s_image
+// Returns 0 or a Modbus exception code
+static uint8_t load_image(size_t index, bool output, uint16_t *length, ip4_addr_t *ip_address)
+{
+    enip_scanner_io_entry_t entry;
+    enip_scanner_io_status_t status;
+    if (enip_scanner_io_get_status(index, &entry, &status) != ESP_OK) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    
+    if (!output) {
+        esp_err_t ret = enip_scanner_io_read_input(index, s_image, sizeof(s_image), length);
+        return ret == ESP_OK ? 0 : MODBUS_EX_GATEWAY_TARGET;
+    }
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    if (entry.type != ENIP_IO_ENTRY_IMPLICIT) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;   // Only implicit connections have an output image
+    }
+    if (status.state != ENIP_IO_STATE_RUNNING ||
+        enip_scanner_implicit_read_o_to_t_data(&entry.ip_address, s_image, length, sizeof(s_image)) != ESP_OK) {
+        return MODBUS_EX_GATEWAY_TARGET;
+    }
+    if (ip_address != NULL) {
+        *ip_address = entry.ip_address;
+    }
+    return 0;
+#else
+    (void)ip_address;
+    return MODBUS_EX_ILLEGAL_ADDRESS;
+#endif
+}
+
+static uint8_t store_image(const ip4_addr_t *ip_address, uint16_t length)
+{
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+    if (enip_scanner_implicit_write_data(ip_address, s_image, length) != ESP_OK) {
+        return MODBUS_EX_DEVICE_FAILURE;
+    }
+    portENTER_CRITICAL(&s_status_lock);
+    s_status.writes++;
+    portEXIT_CRITICAL(&s_status_lock);
+    return 0;
+#else
+    (void)ip_address;
+    (void)length;
+    return MODBUS_EX_ILLEGAL_FUNCTION;
+#endif
+}
+
+// Map a register range onto an entry; the range must not cross a block
+static uint8_t locate_registers(uint16_t address, uint16_t quantity, size_t *index, uint16_t *first)
+{
+    *index = address / CONFIG_MODBUS_SERVER_BLOCK_REGISTERS;
+    *first = address % CONFIG_MODBUS_SERVER_BLOCK_REGISTERS;
+    if (*first + quantity > CONFIG_MODBUS_SERVER_BLOCK_REGISTERS) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    return 0;
+}
+
+static uint8_t locate_bits(uint16_t address, uint16_t quantity, size_t *index, uint32_t *first)
+{
+    *index = address / MODBUS_BIT_BLOCK;
+    *first = address % MODBUS_BIT_BLOCK;
+    if (*first + quantity > MODBUS_BIT_BLOCK) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Request handling
+// ============================================================================
+
+static uint8_t read_registers(const uint8_t *request, size_t length, bool holding, uint8_t *response,
+                              size_t *response_length)
+{
+    if (length != 5) {
+        return MODBUS_EX_ILLEGAL_VALUE;
+    }
+    uint16_t address = get_u16_be(&request[1]);
+    uint16_t quantity = get_u16_be(&request[3]);
+    if (quantity == 0 || quantity > 125) {
+        return MODBUS_EX_ILLEGAL_VALUE;
+    }
+    
+    size_t index;
+    uint16_t first;
+    uint16_t image_length = 0;
+    uint8_t ex = locate_registers(address, quantity, &index, &first);
+    if (ex == 0) {
+        ex = load_image(index, holding, &image_length, NULL);
+    }
+    if (ex != 0) {
+        return ex;
+    }
+    if ((first + quantity) * 2 > image_length + 1) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;   // An odd last byte reads as the low half of a register
+    }
+    
+    response[1] = (uint8_t)(quantity * 2);
+    for (uint16_t i = 0; i < quantity; i++) {
+        uint16_t byte = (first + i) * 2;
+        response[2 + i * 2] = byte + 1 < image_length ? s_image[byte + 1] : 0;
+        response[3 + i * 2] = s_image[byte];
+    }
+    *response_length = 2 + quantity * 2;
+    return 0;
+}
+
+static uint8_t read_bits(const uint8_t *request, size_t length, bool coils, uint8_t *response,
+                         size_t *response_length)
+{
+    if (length != 5) {
+        return MODBUS_EX_ILLEGAL_VALUE;
+    }
+    uint16_t address = get_u16_be(&request[1]);
+    uint16_t quantity = get_u16_be(&request[3]);
+    if (quantity == 0 || quantity > 2000) {
+        return MODBUS_EX_ILLEGAL_VALUE;
+    }
+    
+    size_t index;
+    uint32_t first;
+    uint16_t image_length = 0;
+    uint8_t ex = locate_bits(address, quantity, &index, &first);
+    if (ex == 0) {
+        ex = load_image(index, coils, &image_length, NULL);
+    }
+    if (ex != 0) {
+        return ex;
+    }
+    if (first + quantity > (uint32_t)image_length * 8) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    
+    uint8_t byte_count = (uint8_t)((quantity + 7) / 8);
+    response[1] = byte_count;
+    memset(&response[2], 0, byte_count);
+    for (uint16_t i = 0; i < quantity; i++) {
+        uint32_t bit = first + i;
+        if (s_image[bit / 8] & (1 << (bit % 8))) {
+            response[2 + i / 8] |= 1 << (i % 8);
+        }
+    }
+    *response_length = 2 + byte_count;
+    return 0;
+}
+
+static uint8_t write_registers(const uint8_t *request, size_t length, uint8_t *response, size_t *response_length)
+{
+    uint16_t address = get_u16_be(&request[1]);
+    uint16_t quantity;
+    const uint8_t *values;
+    
+    if (request[0] == MODBUS_FC_WRITE_SINGLE_REGISTER) {
+        if (length != 5) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        quantity = 1;
+        values = &request[3];
+    } else {
+        if (length < 6) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        quantity = get_u16_be(&request[3]);
+        if (quantity == 0 || quantity > 123 || request[5] != quantity * 2 || length != 6 + (size_t)quantity * 2) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        values = &request[6];
+    }
+    
+    size_t index;
+    uint16_t first;
+    uint16_t image_length = 0;
+    ip4_addr_t ip_address;
+    uint8_t ex = locate_registers(address, quantity, &index, &first);
+    if (ex == 0) {
+        ex = load_image(index, true, &image_length, &ip_address);
+    }
+    if (ex != 0) {
+        return ex;
+    }
+    if ((first + quantity) * 2 > image_length + 1) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    
+    for (uint16_t i = 0; i < quantity; i++) {
+        uint16_t byte = (first + i) * 2;
+        s_image[byte] = values[i * 2 + 1];
+        if (byte + 1 < image_length) {
+            s_image[byte + 1] = values[i * 2];
+        }
+    }
+    ex = store_image(&ip_address, image_length);
+    if (ex != 0) {
+        return ex;
+    }
+    
+    // Single write echoes the request; multiple write returns address and quantity
+    memcpy(&response[1], &request[1], 4);
+    *response_length = 5;
+    return 0;
+}
+
+static uint8_t write_coils(const uint8_t *request, size_t length, uint8_t *response, size_t *response_length)
+{
+    uint16_t address = get_u16_be(&request[1]);
+    uint16_t quantity;
+    uint8_t single[1];
+    const uint8_t *values;
+    
+    if (request[0] == MODBUS_FC_WRITE_SINGLE_COIL) {
+        uint16_t value = length == 5 ? get_u16_be(&request[3]) : 1;
+        if (value != 0xFF00 && value != 0x0000) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        quantity = 1;
+        single[0] = value == 0xFF00;
+        values = single;
+    } else {
+        if (length < 6) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        quantity = get_u16_be(&request[3]);
+        if (quantity == 0 || quantity > 1968 || request[5] != (quantity + 7) / 8 ||
+            length != 6 + (size_t)request[5]) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        values = &request[6];
+    }
+    
+    size_t index;
+    uint32_t first;
+    uint16_t image_length = 0;
+    ip4_addr_t ip_address;
+    uint8_t ex = locate_bits(address, quantity, &index, &first);
+    if (ex == 0) {
+        ex = load_image(index, true, &image_length, &ip_address);
+    }
+    if (ex != 0) {
+        return ex;
+    }
+    if (first + quantity > (uint32_t)image_length * 8) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    
+    for (uint16_t i = 0; i < quantity; i++) {
+        uint32_t bit = first + i;
+        if (values[i / 8] & (1 << (i % 8))) {
+            s_image[bit / 8] |= 1 << (bit % 8);
+        } else {
+            s_image[bit / 8] &= ~(1 << (bit % 8));
+        }
+    }
+    ex = store_image(&ip_address, image_length);
+    if (ex != 0) {
+        return ex;
+    }
+    
+    memcpy(&response[1], &request[1], 4);
+    *response_length = 5;
+    return 0;
+}
+
+// Build the response PDU for one request PDU
+static size_t process_pdu(const uint8_t *request, size_t length, uint8_t *response)
+{
+    size_t response_length = 0;
+    uint8_t ex;
+    
+    response[0] = request[0];
+    switch (request[0]) {
+        case MODBUS_FC_READ_COILS:
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            ex = read_bits(request, length, request[0] == MODBUS_FC_READ_COILS, response, &response_length);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            ex = read_registers(request, length, request[0] == MODBUS_FC_READ_HOLDING_REGISTERS, response,
+                                &response_length);
+            break;
+        case MODBUS_FC_WRITE_SINGLE_COIL:
+        case MODBUS_FC_WRITE_MULTIPLE_COILS:
+            ex = length >= 5 ? write_coils(request, length, response, &response_length) : MODBUS_EX_ILLEGAL_VALUE;
+            break;
+        case MODBUS_FC_WRITE_SINGLE_REGISTER:
+        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+            ex = length >= 5 ? write_registers(request, length, response, &response_length) : MODBUS_EX_ILLEGAL_VALUE;
+            break;
+        default:
+            ex = MODBUS_EX_ILLEGAL_FUNCTION;
+            break;
+    }
+    
+    portENTER_CRITICAL(&s_status_lock);
+    s_status.requests++;
+    if (ex != 0) {
+        s_status.exceptions++;
+    }
+    portEXIT_CRITICAL(&s_status_lock);
+    
+    if (ex != 0) {
+        response[0] = request[0] | 0x80;
+        response[1] = ex;
+        return 2;
+    }
+    return response_length;
+}
+
+// ============================================================================
+// Connections
+// ============================================================================
+
+static void client_close(modbus_client_t *client)
+{
+    close(client->sock);
+    client->sock = -1;
+    client->fill = 0;
+    portENTER_CRITICAL(&s_status_lock);
+    s_status.clients--;
+    portEXIT_CRITICAL(&s_status_lock);
+}
+
+// Answer every complete request in the receive buffer
+// Returns false when the client has to be dropped
+static bool client_process(modbus_client_t *client)
+{
+    while (client->fill >= MODBUS_MBAP_SIZE) {
+        uint16_t protocol = get_u16_be(&client->rx[2]);
+        uint16_t mbap_length = get_u16_be(&client->rx[4]);
+        if (protocol != 0 || mbap_length < 2 || mbap_length > MODBUS_PDU_MAX + 1) {
+            ESP_LOGW(TAG, "Malformed MBAP header, closing client");
+            return false;
+        }
+        size_t frame_length = 6 + mbap_length;
+        if (client->fill < frame_length) {
+            return true;
+        }
+        
+        uint8_t response[MODBUS_ADU_MAX];
+        size_t pdu_length = process_pdu(&client->rx[MODBUS_MBAP_SIZE], mbap_length - 1, &response[MODBUS_MBAP_SIZE]);
+        memcpy(response, client->rx, MODBUS_MBAP_SIZE);     // Transaction, protocol and unit id are echoed
+        response[4] = (uint8_t)((pdu_length + 1) >> 8);
+        response[5] = (uint8_t)(pdu_length + 1);
+        if (send(client->sock, response, MODBUS_MBAP_SIZE + pdu_length, 0) < 0) {
+            return false;
+        }
+        
+        client->fill -= frame_length;
+        memmove(client->rx, client->rx + frame_length, client->fill);
+    }
+    return true;
+}
+
+static void client_accept(int listen_sock)
+{
+    int sock = accept(listen_sock, NULL, NULL);
+    if (sock < 0) {
+        return;
+    }
+    for (int i = 0; i < CONFIG_MODBUS_SERVER_MAX_CLIENTS; i++) {
+        if (s_clients[i].sock < 0) {
+            struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+            setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            int flag = 1;
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+            s_clients[i].sock = sock;
+            s_clients[i].fill = 0;
+            portENTER_CRITICAL(&s_status_lock);
+            s_status.clients++;
+            portEXIT_CRITICAL(&s_status_lock);
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "Too many clients, connection refused");
+    close(sock);
+}
+
+static void modbus_server_task(void *arg)
+{
+    int listen_sock = (int)(intptr_t)arg;
+    
+    while (s_server_running) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(listen_sock, &read_fds);
+        int max_fd = listen_sock;
+        for (int i = 0; i < CONFIG_MODBUS_SERVER_MAX_CLIENTS; i++) {
+            if (s_clients[i].sock >= 0) {
+                FD_SET(s_clients[i].sock, &read_fds);
+                if (s_clients[i].sock > max_fd) {
+                    max_fd = s_clients[i].sock;
+                }
+            }
+        }
+        
+        // Short timeout so that modbus_server_stop() is noticed
+        struct timeval tv = { .tv_sec = 0, .tv_usec = 200000 };
+        int ready = select(max_fd + 1, &read_fds, NULL, NULL, &tv);
+        if (ready < 0) {
+            ESP_LOGE(TAG, "select failed: errno=%d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        if (ready == 0) {
+            continue;
+        }
+        
+        for (int i = 0; i < CONFIG_MODBUS_SERVER_MAX_CLIENTS; i++) {
+            modbus_client_t *client = &s_clients[i];
+            if (client->sock < 0 || !FD_ISSET(client->sock, &read_fds)) {
+                continue;
+            }
+            int received = recv(client->sock, client->rx + client->fill, sizeof(client->rx) - client->fill, 0);
+            if (received <= 0) {
+                client_close(client);
+                continue;
+            }
+            client->fill += received;
+            if (!client_process(client)) {
+                client_close(client);
+            }
+        }
+        if (FD_ISSET(listen_sock, &read_fds)) {
+            client_accept(listen_sock);
+        }
+    }
+    
+    for (int i = 0; i < CONFIG_MODBUS_SERVER_MAX_CLIENTS; i++) {
+        if (s_clients[i].sock >= 0) {
+            client_close(&s_clients[i]);
+        }
+    }
+    close(listen_sock);
+    s_server_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t modbus_server_start(void)
+{
+    if (s_server_running || s_server_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno=%d", errno);
+        return ESP_FAIL;
+    }
+    int opt = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    server_addr.sin_port = htons(CONFIG_MODBUS_SERVER_PORT);
+    if (bind(listen_sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0 ||
+        listen(listen_sock, CONFIG_MODBUS_SERVER_MAX_CLIENTS) < 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno=%d", CONFIG_MODBUS_SERVER_PORT, errno);
+        close(listen_sock);
+        return ESP_FAIL;
+    }
+    
+    for (int i = 0; i < CONFIG_MODBUS_SERVER_MAX_CLIENTS; i++) {
+        s_clients[i].sock = -1;
+        s_clients[i].fill = 0;
+    }
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.running = true;
+    s_server_running = true;
+    
+    if (xTaskCreate(modbus_server_task, "modbus_srv", MODBUS_TASK_STACK_SIZE, (void *)(intptr_t)listen_sock, 4,
+                    &s_server_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create server task");
+        s_server_running = false;
+        s_status.running = false;
+        close(listen_sock);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "Modbus TCP server listening on port %d (%d registers per I/O entry)",
+             CONFIG_MODBUS_SERVER_PORT, CONFIG_MODBUS_SERVER_BLOCK_REGISTERS);
+    return ESP_OK;
+}
+
+esp_err_t modbus_server_stop(void)
+{
+    if (!s_server_running && s_server_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_server_running = false;
+    while (s_server_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    
+    portENTER_CRITICAL(&s_status_lock);
+    s_status.running = false;
+    portEXIT_CRITICAL(&s_status_lock);
+    return ESP_OK;
+}
+
+esp_err_t modbus_server_get_status(modbus_server_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_status_lock);
+    *status = s_status;
+    portEXIT_CRITICAL(&s_status_lock);
+    return ESP_OK;
+}
+
+#endif // CONFIG_MODBUS_SERVER_ENABLE
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file mqtt_publisher.h
+ * @brief Change-only, batched MQTT publishing of I/O configuration data
+ * 
+ * Regions of the input data of I/O configuration entries (see
+ * enip_scanner_io_read_input()) are sampled every CONFIG_MQTT_PUBLISHER_SAMPLE_MS.
+ * Every CONFIG_MQTT_PUBLISHER_INTERVAL_MS the regions that changed since they
+ * were last published are sent as one message to <prefix>/io:
+ * 
+ *   {"seq":42,"ts":1700000000123,"d":{"line_speed":"e803","e2":"01000000"}}
+ * 
+ * seq counts messages, ts is the sample time in ms (Unix time once the clock
+ * is set), and each value is the region's bytes in hex. After every (re)connect
+ * the first batch carries all regions, so subscribers can resynchronize.
+ */
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_MQTT_PUBLISHER_ENABLE
+
+/**
+ * @brief Region of an I/O configuration entry's input data
+ */
+typedef struct {
+    uint8_t entry;                      // I/O configuration entry index
+    uint16_t offset;                    // First byte
+    uint16_t length;                    // Bytes (0 = to the end, up to CONFIG_MQTT_PUBLISHER_REGION_BYTES)
+    char name[24];                      // Key in the payload, [A-Za-z0-9_.-] (empty: "e<entry>" or "e<entry>_<offset>")
+} mqtt_publisher_region_t;
+
+/**
+ * @brief Publisher statistics
+ */
+typedef struct {
+    bool running;
+    bool connected;
+    uint16_t regions;                   // Regions being sampled
+    uint32_t changes;                   // Region changes seen while sampling
+    uint32_t messages;                  // Messages handed to the MQTT client
+    uint32_t values;                    // Region values published
+    uint32_t bytes;                     // Payload bytes published
+    uint32_t deferred;                  // Batches held back (not connected or outbox full)
+    uint32_t outbox_bytes;              // Unacknowledged bytes at the last batch
+} mqtt_publisher_status_t;
+
+/**
+ * @brief Connect to CONFIG_MQTT_PUBLISHER_BROKER_URI and start publishing
+ * Does nothing when no broker is configured. Without regions set, the whole
+ * input of every I/O configuration entry is published.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t mqtt_publisher_start(void);
+
+/**
+ * @brief Stop publishing and disconnect
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t mqtt_publisher_stop(void);
+
+/**
+ * @brief Choose the regions to publish
+ * @param regions Regions (copied), or NULL to publish every entry's whole input
+ * @param count Number of regions (max CONFIG_MQTT_PUBLISHER_MAX_REGIONS)
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if count is too large,
+ *         ESP_ERR_INVALID_ARG if a name uses other characters than [A-Za-z0-9_.-]
+ */
+esp_err_t mqtt_publisher_set_regions(const mqtt_publisher_region_t *regions, size_t count);
+
+/**
+ * @brief Get the publisher statistics
+ * @param status Status copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if status is NULL
+ */
+esp_err_t mqtt_publisher_get_status(mqtt_publisher_status_t *status);
+
+#endif // CONFIG_MQTT_PUBLISHER_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MQTT_PUBLISHER_H
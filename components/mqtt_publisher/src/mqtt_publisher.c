@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file mqtt_publisher.c
+ * @brief Samples I/O regions and publishes batched changes over MQTT
+ */
+
+#include "mqtt_publisher.h"
+#include "enip_scanner.h"
+#include "esp_log.h"
+#include "mqtt_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#if CONFIG_MQTT_PUBLISHER_ENABLE
+
+static const char *TAG = "mqtt_publisher";
+
+#define MQTT_TASK_STACK_SIZE 4096
+#define MQTT_INPUT_MAX 512              // Largest input image read from an I/O entry
+#define MQTT_TOPIC_MAX 96
+#define MQTT_HEADER_MAX 64              // {"seq":...,"ts":...,"d":{
+
+typedef struct {
+    uint8_t pending[CONFIG_MQTT_PUBLISHER_REGION_BYTES];    // Latest sample
+    uint8_t published[CONFIG_MQTT_PUBLISHER_REGION_BYTES];  // Value in the last message
+    uint16_t pending_length;
+    uint16_t published_length;
+    bool valid;                         // pending holds a sample
+    bool sent;                          // published holds a value
+} region_state_t;
+
+static mqtt_publisher_region_t s_regions[CONFIG_MQTT_PUBLISHER_MAX_REGIONS];
+static size_t s_region_count = 0;       // 0: one region per I/O entry
+static region_state_t s_states[CONFIG_MQTT_PUBLISHER_MAX_REGIONS];
+static uint8_t s_input[MQTT_INPUT_MAX];
+static char s_payload[CONFIG_MQTT_PUBLISHER_PAYLOAD_BYTES];
+static char s_topic_io[MQTT_TOPIC_MAX];
+static char s_topic_status[MQTT_TOPIC_MAX];
+static uint32_t s_seq = 0;
+
+static mqtt_publisher_status_t s_status;
+static SemaphoreHandle_t s_mqtt_mutex = NULL;
+static esp_mqtt_client_handle_t s_client = NULL;
+static TaskHandle_t s_mqtt_task_handle = NULL;
+static volatile bool s_mqtt_running = false;
+static volatile bool s_connected = false;
+static volatile bool s_resync = false;  // Next batch carries every region
+
+static int64_t now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// Region i of the current configuration; in automatic mode, the whole input of entry i
+// Caller holds s_mqtt_mutex
+static size_t region_count_locked(void)
+{
+    if (s_region_count > 0) {
+        return s_region_count;
+    }
+    size_t entries = enip_scanner_io_get_count();
+    return entries < CONFIG_MQTT_PUBLISHER_MAX_REGIONS ? entries : CONFIG_MQTT_PUBLISHER_MAX_REGIONS;
+}
+
+static void region_get_locked(size_t index, mqtt_publisher_region_t *region)
+{
+    if (s_region_count > 0) {
+        *region = s_regions[index];
+    } else {
+        memset(region, 0, sizeof(*region));
+        region->entry = (uint8_t)index;
+    }
+    if (region->name[0] == '\0') {
+        if (region->offset == 0) {
+            snprintf(region->name, sizeof(region->name), "e%u", region->entry);
+        } else {
+            snprintf(region->name, sizeof(region->name), "e%u_%u", region->entry, region->offset);
+        }
+    }
+}
+
+// ============================================================================
+// Sampling and batching
+// ============================================================================
+
+// Caller holds s_mqtt_mutex
+static void sample_regions_locked(void)
+{
+    size_t count = region_count_locked();
+    for (size_t i = 0; i < count; i++) {
+        mqtt_publisher_region_t region;
+        region_get_locked(i, &region);
+        
+        uint16_t input_length = 0;
+        if (enip_scanner_io_read_input(region.entry, s_input, sizeof(s_input), &input_length) != ESP_OK ||
+            region.offset >= input_length) {
+            continue;
+        }
+        uint16_t length = input_length - region.offset;
+        if (region.length > 0 && region.length < length) {
+            length = region.length;
+        }
+        if (length > CONFIG_MQTT_PUBLISHER_REGION_BYTES) {
+            length = CONFIG_MQTT_PUBLISHER_REGION_BYTES;
+        }
+        
+        region_state_t *state = &s_states[i];
+        if (!state->valid || length != state->pending_length ||
+            memcmp(state->pending, s_input + region.offset, length) != 0) {
+            memcpy(state->pending, s_input + region.offset, length);
+            state->pending_length = length;
+            state->valid = true;
+            s_status.changes++;
+        }
+    }
+}
+
+// Returns false if the client did not take the message
+static bool publish_payload_locked(size_t length)
+{
+    int msg_id = esp_mqtt_client_enqueue(s_client, s_topic_io, s_payload, (int)length,
+                                         CONFIG_MQTT_PUBLISHER_QOS, 0, true);
+    if (msg_id < 0) {
+        ESP_LOGW(TAG, "Failed to queue batch (%u bytes)", (unsigned)length);
+        return false;
+    }
+    s_status.messages++;
+    s_status.bytes += length;
+    return true;
+}
+
+// Record the regions of a queued message as published
+static void commit_regions_locked(const uint8_t *regions, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        region_state_t *state = &s_states[regions[i]];
+        memcpy(state->published, state->pending, state->pending_length);
+        state->published_length = state->pending_length;
+        state->sent = true;
+        s_status.values++;
+    }
+}
+
+// Start a message: {"seq":N,"ts":T,"d":{
+static size_t payload_open(int64_t ts)
+{
+    return (size_t)snprintf(s_payload, sizeof(s_payload), "{\"seq\":%lu,\"ts\":%lld,\"d\":{",
+                            (unsigned long)s_seq++, (long long)ts);
+}
+
+// Publish every region whose latest sample differs from what subscribers have
+// Changes stay pending while the broker is unreachable or the outbox is full
+// Caller holds s_mqtt_mutex
+static void publish_batch_locked(void)
+{
+    int outbox = s_client != NULL ? esp_mqtt_client_get_outbox_size(s_client) : 0;
+    s_status.outbox_bytes = outbox > 0 ? (uint32_t)outbox : 0;
+    if (!s_connected || outbox > CONFIG_MQTT_PUBLISHER_OUTBOX_LIMIT) {
+        s_status.deferred++;
+        return;
+    }
+    
+    bool resync = s_resync;
+    s_resync = false;
+    int64_t ts = now_ms();
+    size_t length = 0;
+    size_t in_message = 0;
+    uint8_t message_regions[CONFIG_MQTT_PUBLISHER_MAX_REGIONS];   // Committed once the message is queued
+    size_t count = region_count_locked();
+    
+    for (size_t i = 0; i < count; i++) {
+        region_state_t *state = &s_states[i];
+        if (!state->valid) {
+            continue;
+        }
+        if (!resync && state->sent && state->pending_length == state->published_length &&
+            memcmp(state->pending, state->published, state->pending_length) == 0) {
+            continue;
+        }
+        
+        mqtt_publisher_region_t region;
+        region_get_locked(i, &region);
+        // "name":"hex", plus the closing "}}"
+        size_t needed = strlen(region.name) + 6 + state->pending_length * 2 + 2;
+        if (in_message > 0 && length + needed > sizeof(s_payload) - 1) {
+            length += snprintf(s_payload + length, sizeof(s_payload) - length, "}}");
+            if (!publish_payload_locked(length)) {
+                // This message's regions stay pending for the next batch
+                s_resync = s_resync || resync;
+                return;
+            }
+            commit_regions_locked(message_regions, in_message);
+            in_message = 0;
+        }
+        if (needed > sizeof(s_payload) - MQTT_HEADER_MAX) {
+            ESP_LOGW(TAG, "Region %s does not fit in CONFIG_MQTT_PUBLISHER_PAYLOAD_BYTES", region.name);
+            state->sent = false;
+            state->valid = false;           // Dropped until it changes again
+            continue;
+        }
+        if (in_message == 0) {
+            length = payload_open(ts);
+        }
+        
+        length += snprintf(s_payload + length, sizeof(s_payload) - length, "%s\"%s\":\"",
+                           in_message > 0 ? "," : "", region.name);
+        for (uint16_t b = 0; b < state->pending_length; b++) {
+            length += snprintf(s_payload + length, sizeof(s_payload) - length, "%02x", state->pending[b]);
+        }
+        s_payload[length++] = '"';
+        message_regions[in_message++] = (uint8_t)i;
+    }
+    
+    if (in_message > 0) {
+        length += snprintf(s_payload + length, sizeof(s_payload) - length, "}}");
+        if (publish_payload_locked(length)) {
+            commit_regions_locked(message_regions, in_message);
+        } else {
+            s_resync = s_resync || resync;
+        }
+    }
+}
+
+static void mqtt_publisher_task(void *arg)
+{
+    (void)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_batch = last_wake;
+    TickType_t sample_period = pdMS_TO_TICKS(CONFIG_MQTT_PUBLISHER_SAMPLE_MS);
+    TickType_t batch_period = pdMS_TO_TICKS(CONFIG_MQTT_PUBLISHER_INTERVAL_MS);
+    if (sample_period == 0) {
+        sample_period = 1;
+    }
+    
+    while (s_mqtt_running) {
+        vTaskDelayUntil(&last_wake, sample_period);
+        
+        xSemaphoreTake(s_mqtt_mutex, portMAX_DELAY);
+        sample_regions_locked();
+        if (xTaskGetTickCount() - last_batch >= batch_period) {
+            last_batch = xTaskGetTickCount();
+            publish_batch_locked();
+        }
+        s_status.regions = (uint16_t)region_count_locked();
+        xSemaphoreGive(s_mqtt_mutex);
+    }
+    
+    s_mqtt_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    (void)handler_args;
+    (void)base;
+    (void)event_data;
+    
+    switch ((esp_mqtt_event_id_t)event_id) {
+        case MQTT_EVENT_CONNECTED:
+            ESP_LOGI(TAG, "Connected to %s", CONFIG_MQTT_PUBLISHER_BROKER_URI);
+            esp_mqtt_client_publish(s_client, s_topic_status, "online", 0, 1, 1);
+            s_resync = true;
+            s_connected = true;
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            if (s_connected) {
+                ESP_LOGW(TAG, "Disconnected from broker");
+            }
+            s_connected = false;
+            break;
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t mqtt_publisher_start(void)
+{
+    if (CONFIG_MQTT_PUBLISHER_BROKER_URI[0] == '\0') {
+        ESP_LOGI(TAG, "No broker configured, MQTT publishing is off");
+        return ESP_OK;
+    }
+    if (s_mqtt_mutex == NULL) {
+        s_mqtt_mutex = xSemaphoreCreateMutex();
+        if (s_mqtt_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_mqtt_running || s_mqtt_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    snprintf(s_topic_io, sizeof(s_topic_io), "%s/io", CONFIG_MQTT_PUBLISHER_TOPIC_PREFIX);
+    snprintf(s_topic_status, sizeof(s_topic_status), "%s/status", CONFIG_MQTT_PUBLISHER_TOPIC_PREFIX);
+    
+    esp_mqtt_client_config_t config = {
+        .broker.address.uri = CONFIG_MQTT_PUBLISHER_BROKER_URI,
+        .session.last_will = {
+            .topic = s_topic_status,
+            .msg = "offline",
+            .qos = 1,
+            .retain = 1,
+        },
+    };
+    s_client = esp_mqtt_client_init(&config);
+    if (s_client == NULL) {
+        ESP_LOGE(TAG, "Failed to create MQTT client");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_mqtt_client_register_event(s_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+    
+    xSemaphoreTake(s_mqtt_mutex, portMAX_DELAY);
+    memset(s_states, 0, sizeof(s_states));
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.running = true;
+    s_mqtt_running = true;
+    xSemaphoreGive(s_mqtt_mutex);
+    
+    esp_err_t ret = esp_mqtt_client_start(s_client);
+    if (ret == ESP_OK &&
+        xTaskCreate(mqtt_publisher_task, "mqtt_pub", MQTT_TASK_STACK_SIZE, NULL, 3, &s_mqtt_task_handle) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start MQTT publisher: %s", esp_err_to_name(ret));
+        s_mqtt_running = false;
+        s_status.running = false;
+        esp_mqtt_client_destroy(s_client);
+        s_client = NULL;
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Publishing I/O changes to %s every %d ms", s_topic_io, CONFIG_MQTT_PUBLISHER_INTERVAL_MS);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_publisher_stop(void)
+{
+    if (s_mqtt_mutex == NULL || (!s_mqtt_running && s_mqtt_task_handle == NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_mqtt_running = false;
+    while (s_mqtt_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    
+    if (s_connected) {
+        esp_mqtt_client_publish(s_client, s_topic_status, "offline", 0, 1, 1);
+    }
+    esp_mqtt_client_destroy(s_client);     // Stops the client task
+    s_client = NULL;
+    s_connected = false;
+    
+    xSemaphoreTake(s_mqtt_mutex, portMAX_DELAY);
+    s_status.running = false;
+    s_status.connected = false;
+    xSemaphoreGive(s_mqtt_mutex);
+    return ESP_OK;
+}
+
+// Names go into the JSON payload as they are, so only characters that need no escaping
+static bool region_name_valid(const char *name, size_t size)
+{
+    for (size_t i = 0; i < size && name[i] != '\0'; i++) {
+        char c = name[i];
+        if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+              c == '_' || c == '.' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t mqtt_publisher_set_regions(const mqtt_publisher_region_t *regions, size_t count)
+{
+    if (count > CONFIG_MQTT_PUBLISHER_MAX_REGIONS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (regions == NULL) {
+        count = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!region_name_valid(regions[i].name, sizeof(regions[i].name))) {
+            ESP_LOGE(TAG, "Region %u: name may only use A-Z, a-z, 0-9, '_', '.' and '-'", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (s_mqtt_mutex == NULL) {
+        s_mqtt_mutex = xSemaphoreCreateMutex();
+        if (s_mqtt_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    xSemaphoreTake(s_mqtt_mutex, portMAX_DELAY);
+    if (count > 0) {
+        memcpy(s_regions, regions, count * sizeof(mqtt_publisher_region_t));
+        for (size_t i = 0; i < count; i++) {
+            s_regions[i].name[sizeof(s_regions[i].name) - 1] = '\0';
+        }
+    }
+    s_region_count = count;
+    memset(s_states, 0, sizeof(s_states));  // New layout: everything is sent again
+    xSemaphoreGive(s_mqtt_mutex);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_publisher_get_status(mqtt_publisher_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mqtt_mutex == NULL) {
+        memset(status, 0, sizeof(*status));
+        return ESP_OK;
+    }
+    xSemaphoreTake(s_mqtt_mutex, portMAX_DELAY);
+    *status = s_status;
+    status->connected = s_connected;
+    xSemaphoreGive(s_mqtt_mutex);
+    return ESP_OK;
+}
+
+#endif // CONFIG_MQTT_PUBLISHER_ENABLE
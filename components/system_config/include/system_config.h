@@ -25,6 +25,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "lwip/ip4_addr.h"
 
 #ifdef __cplusplus
@@ -76,6 +77,49 @@ bool system_motoman_rs022_load(bool *instance_direct);
  */
 bool system_motoman_rs022_save(bool instance_direct);
 
+/**
+ * @brief Load the boot-time I/O scan list from NVS
+ * Entries are stored as fixed-size records (enip_scanner_io_entry_t). A list
+ * saved with a different record size is ignored rather than misread.
+ * @param entries Buffer for the entries
+ * @param entry_size Size of one entry in bytes
+ * @param max_entries Capacity of entries
+ * @param count Pointer to store the number of entries loaded (0 if none)
+ * @return true if a list was loaded, false if none is saved or it could not be read
+ */
+bool system_scan_list_load(void *entries, size_t entry_size, size_t max_entries, size_t *count);
+
+/**
+ * @brief Save the boot-time I/O scan list to NVS
+ * @param entries Entries to save (may be NULL when count is 0)
+ * @param entry_size Size of one entry in bytes
+ * @param count Number of entries (0 clears the list)
+ * @return true on success, false on error
+ */
+bool system_scan_list_save(const void *entries, size_t entry_size, size_t count);
+
+/**
+ * @brief Load the translator bindings and cycle time from NVS
+ * Bindings are stored as fixed-size records (enip_translator_binding_t) like the scan list.
+ * @param bindings Buffer for the bindings
+ * @param entry_size Size of one binding in bytes
+ * @param max_entries Capacity of bindings
+ * @param count Pointer to store the number of bindings loaded
+ * @param cycle_ms Pointer to store the cycle time
+ * @return true if a translator map was loaded, false if none is saved or it could not be read
+ */
+bool system_translator_load(void *bindings, size_t entry_size, size_t max_entries, size_t *count, uint32_t *cycle_ms);
+
+/**
+ * @brief Save the translator bindings and cycle time to NVS
+ * @param bindings Bindings to save (may be NULL when count is 0)
+ * @param entry_size Size of one binding in bytes
+ * @param count Number of bindings (0 clears the map)
+ * @param cycle_ms Cycle time in milliseconds
+ * @return true on success, false on error
+ */
+bool system_translator_save(const void *bindings, size_t entry_size, size_t count, uint32_t cycle_ms);
+
 #ifdef __cplusplus
 }
 #endif
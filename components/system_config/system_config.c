@@ -26,11 +26,21 @@
 #include "esp_log.h"
 #include "sdkconfig.h"
 #include <string.h>
+#include <stdlib.h>
 
 static const char *TAG = "system_config";
 static const char *NVS_NAMESPACE = "system";
 static const char *NVS_KEY_IPCONFIG = "ipconfig";
 static const char *NVS_KEY_RS022 = "rs022";
+static const char *NVS_KEY_SCAN_LIST = "scanlist";
+static const char *NVS_KEY_TRANSLATOR = "xlatmap";
+static const char *NVS_KEY_TRANSLATOR_CYCLE = "xlatcycle";
+
+// Stored record list: this header followed by count records of entry_size bytes
+typedef struct {
+    uint16_t entry_size;
+    uint16_t count;
+} record_list_header_t;
 
 void system_ip_config_get_defaults(system_ip_config_t *config)
 {
@@ -184,3 +194,157 @@ bool system_motoman_rs022_save(bool instance_direct)
     ESP_LOGI(TAG, "RS022 instance mapping saved (direct=%s)", instance_direct ? "true" : "false");
     return true;
 }
+
+static bool record_list_load(const char *key, const char *what, void *entries, size_t entry_size, size_t max_entries,
+                             size_t *count)
+{
+    if (entries == NULL || count == NULL || entry_size == 0) {
+        return false;
+    }
+    *count = 0;
+    
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+        }
+        return false;
+    }
+    
+    size_t blob_size = 0;
+    err = nvs_get_blob(handle, key, NULL, &blob_size);
+    if (err != ESP_OK || blob_size < sizeof(record_list_header_t)) {
+        nvs_close(handle);
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to read %s: %s", what, esp_err_to_name(err));
+        }
+        return false;
+    }
+    
+    uint8_t *blob = malloc(blob_size);
+    if (blob == NULL) {
+        nvs_close(handle);
+        return false;
+    }
+    err = nvs_get_blob(handle, key, blob, &blob_size);
+    nvs_close(handle);
+    
+    record_list_header_t header;
+    memcpy(&header, blob, sizeof(header));
+    if (err != ESP_OK || header.entry_size != entry_size ||
+        blob_size != sizeof(header) + (size_t)header.count * entry_size) {
+        ESP_LOGW(TAG, "Saved %s does not match this firmware (record %u bytes, expected %zu), ignoring",
+                 what, header.entry_size, entry_size);
+        free(blob);
+        return false;
+    }
+    
+    size_t loaded = header.count;
+    if (loaded > max_entries) {
+        ESP_LOGW(TAG, "Saved %s has %zu entries, only %zu used", what, loaded, max_entries);
+        loaded = max_entries;
+    }
+    memcpy(entries, blob + sizeof(header), loaded * entry_size);
+    free(blob);
+    
+    *count = loaded;
+    ESP_LOGI(TAG, "Loaded %s (%zu entries)", what, loaded);
+    return true;
+}
+
+static bool record_list_save(const char *key, const char *what, const void *entries, size_t entry_size, size_t count)
+{
+    if ((entries == NULL && count > 0) || entry_size == 0 || entry_size > UINT16_MAX || count > UINT16_MAX) {
+        return false;
+    }
+    
+    size_t blob_size = sizeof(record_list_header_t) + count * entry_size;
+    uint8_t *blob = malloc(blob_size);
+    if (blob == NULL) {
+        return false;
+    }
+    record_list_header_t header = { .entry_size = (uint16_t)entry_size, .count = (uint16_t)count };
+    memcpy(blob, &header, sizeof(header));
+    if (count > 0) {
+        memcpy(blob + sizeof(header), entries, count * entry_size);
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+        free(blob);
+        return false;
+    }
+    
+    err = nvs_set_blob(handle, key, blob, blob_size);
+    free(blob);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save %s: %s", what, esp_err_to_name(err));
+        nvs_close(handle);
+        return false;
+    }
+    
+    err = nvs_commit(handle);
+    nvs_close(handle);
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit %s: %s", what, esp_err_to_name(err));
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "Saved %s (%zu entries)", what, count);
+    return true;
+}
+
+bool system_scan_list_load(void *entries, size_t entry_size, size_t max_entries, size_t *count)
+{
+    return record_list_load(NVS_KEY_SCAN_LIST, "scan list", entries, entry_size, max_entries, count);
+}
+
+bool system_scan_list_save(const void *entries, size_t entry_size, size_t count)
+{
+    return record_list_save(NVS_KEY_SCAN_LIST, "scan list", entries, entry_size, count);
+}
+
+bool system_translator_load(void *bindings, size_t entry_size, size_t max_entries, size_t *count, uint32_t *cycle_ms)
+{
+    if (cycle_ms == NULL || !record_list_load(NVS_KEY_TRANSLATOR, "translator map", bindings, entry_size,
+                                              max_entries, count)) {
+        return false;
+    }
+    
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t err = nvs_get_u32(handle, NVS_KEY_TRANSLATOR_CYCLE, cycle_ms);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+bool system_translator_save(const void *bindings, size_t entry_size, size_t count, uint32_t cycle_ms)
+{
+    if (!record_list_save(NVS_KEY_TRANSLATOR, "translator map", bindings, entry_size, count)) {
+        return false;
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+        return false;
+    }
+    err = nvs_set_u32(handle, NVS_KEY_TRANSLATOR_CYCLE, cycle_ms);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save translator cycle time: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
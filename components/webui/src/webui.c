@@ -25,6 +25,9 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "esp_heap_caps.h"
+#include "cJSON.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
@@ -32,6 +35,14 @@
 static const char *TAG = "webui";
 static httpd_handle_t s_server = NULL;
 
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+// JSON trees and response strings are built once per request: PSRAM is fast enough
+static void *webui_json_malloc(size_t size)
+{
+    return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_DEFAULT);
+}
+#endif
+
 esp_err_t webui_init(void)
 {
     if (s_server != NULL) {
@@ -39,6 +50,14 @@ esp_err_t webui_init(void)
         return ESP_OK;
     }
     
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+    cJSON_Hooks hooks = {
+        .malloc_fn = webui_json_malloc,
+        .free_fn = heap_caps_free,
+    };
+    cJSON_InitHooks(&hooks);
+#endif
+    
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.max_uri_handlers = 80;  // Expanded for full Motoman read-only pages + APIs
     config.max_open_sockets = 7;
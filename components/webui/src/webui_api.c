@@ -23,6 +23,9 @@
 #include "webui_api.h"
 #include "enip_scanner.h"
 #include "system_config.h"
+#if CONFIG_HISTORIAN_ENABLE
+#include "historian.h"
+#endif
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_http_server.h"
@@ -59,6 +62,18 @@ static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, esp_err_t htt
     return ESP_OK;
 }
 
+// Optional "route" member (e.g. "1,0") for targets behind the addressed device;
+// absent or empty means the device itself
+static bool parse_route_param(cJSON *json, enip_scanner_route_t *route)
+{
+    memset(route, 0, sizeof(*route));
+    cJSON *route_item = cJSON_GetObjectItem(json, "route");
+    if (route_item == NULL) {
+        return true;
+    }
+    return cJSON_IsString(route_item) && enip_scanner_route_parse(route_item->valuestring, route) == ESP_OK;
+}
+
 // Forward declarations
 static esp_err_t api_scanner_register_session_handler(httpd_req_t *req);
 static esp_err_t api_scanner_unregister_session_handler(httpd_req_t *req);
@@ -97,7 +112,7 @@ static esp_err_t api_scanner_motoman_set_rs022_handler(httpd_req_t *req);
 // GET /api/scanner/scan
 static esp_err_t api_scanner_scan_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "GET /api/scanner/scan");
+    ESP_LOGD(TAG, "GET /api/scanner/scan");
     
     cJSON *response = cJSON_CreateObject();
     cJSON *devices = cJSON_CreateArray();
@@ -147,7 +162,7 @@ static esp_err_t api_scanner_scan_handler(httpd_req_t *req)
 // POST /api/scanner/read-assembly
 static esp_err_t api_scanner_read_assembly_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/read-assembly");
+    ESP_LOGD(TAG, "POST /api/scanner/read-assembly");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -180,6 +195,13 @@ static esp_err_t api_scanner_read_assembly_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
+    enip_scanner_route_t route;
+    if (!parse_route_param(json, &route)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid route");
+        return ESP_FAIL;
+    }
+    
     uint16_t assembly_instance = (uint16_t)instance_item->valueint;
     uint32_t timeout_ms = 5000;
     cJSON *timeout_item = cJSON_GetObjectItem(json, "timeout_ms");
@@ -190,7 +212,7 @@ static esp_err_t api_scanner_read_assembly_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     enip_scanner_assembly_result_t result;
-    esp_err_t err = enip_scanner_read_assembly(&ip_addr, assembly_instance, &result, timeout_ms);
+    esp_err_t err = enip_scanner_read_assembly_routed(&ip_addr, &route, assembly_instance, &result, timeout_ms);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -234,7 +256,9 @@ static esp_err_t api_scanner_read_assembly_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddNumberToObject(response, "assembly_instance", result.assembly_instance);
         cJSON_AddBoolToObject(response, "success", false);
-        cJSON_AddStringToObject(response, "error", result.error_message);
+        char error_text[128];
+        enip_scanner_format_error(&result.error, error_text, sizeof(error_text));
+        cJSON_AddStringToObject(response, "error", error_text);
         cJSON_AddStringToObject(response, "status", "error");
         
         enip_scanner_free_assembly_result(&result);
@@ -245,7 +269,7 @@ static esp_err_t api_scanner_read_assembly_handler(httpd_req_t *req)
 // POST /api/scanner/write-assembly
 static esp_err_t api_scanner_write_assembly_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/write-assembly");
+    ESP_LOGD(TAG, "POST /api/scanner/write-assembly");
     
     char content[2048];  // Increased size for larger data payloads
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -279,12 +303,20 @@ static esp_err_t api_scanner_write_assembly_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
+    enip_scanner_route_t route;
+    if (!parse_route_param(json, &route)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid route");
+        return ESP_FAIL;
+    }
+    
     uint16_t assembly_instance = (uint16_t)instance_item->valueint;
     uint32_t timeout_ms = 5000;
     cJSON *timeout_item = cJSON_GetObjectItem(json, "timeout_ms");
     if (timeout_item != NULL && cJSON_IsNumber(timeout_item)) {
         timeout_ms = (uint32_t)timeout_item->valueint;
     }
+    bool coalesce = cJSON_IsTrue(cJSON_GetObjectItem(json, "coalesce"));
     
     // Extract data array
     int data_array_size = cJSON_GetArraySize(data_item);
@@ -314,8 +346,33 @@ static esp_err_t api_scanner_write_assembly_handler(httpd_req_t *req)
     
     cJSON_Delete(json);
     
-    char error_message[128];
-    esp_err_t err = enip_scanner_write_assembly(&ip_addr, assembly_instance, write_data, data_array_size, timeout_ms, error_message);
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+    // Slider-style updates: queue and answer at once, newer values replace unsent ones
+    // (routed writes are always sent synchronously)
+    if (coalesce && route.size == 0) {
+        esp_err_t err = enip_scanner_write_assembly_coalesced(&ip_addr, assembly_instance, write_data,
+                                                              data_array_size, timeout_ms);
+        free(write_data);
+        
+        char ip_str[16];
+        snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&ip_addr));
+        cJSON *response = cJSON_CreateObject();
+        cJSON_AddStringToObject(response, "ip_address", ip_str);
+        cJSON_AddNumberToObject(response, "assembly_instance", assembly_instance);
+        cJSON_AddBoolToObject(response, "success", err == ESP_OK);
+        cJSON_AddStringToObject(response, "status", err == ESP_OK ? "queued" : "error");
+        if (err != ESP_OK) {
+            cJSON_AddStringToObject(response, "error", esp_err_to_name(err));
+        }
+        return send_json_response(req, response, err);
+    }
+#else
+    (void)coalesce;
+#endif
+    
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_write_assembly_routed(&ip_addr, &route, assembly_instance, write_data, data_array_size,
+                                                      timeout_ms, &error);
     
     free(write_data);
     
@@ -337,7 +394,9 @@ static esp_err_t api_scanner_write_assembly_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddNumberToObject(response, "assembly_instance", assembly_instance);
         cJSON_AddBoolToObject(response, "success", false);
-        cJSON_AddStringToObject(response, "error", error_message);
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        cJSON_AddStringToObject(response, "error", error_text);
         cJSON_AddStringToObject(response, "status", "error");
         return send_json_response(req, response, ESP_FAIL);
     }
@@ -346,7 +405,7 @@ static esp_err_t api_scanner_write_assembly_handler(httpd_req_t *req)
 // POST /api/scanner/check-writable
 static esp_err_t api_scanner_check_writable_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/check-writable");
+    ESP_LOGD(TAG, "POST /api/scanner/check-writable");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -405,7 +464,7 @@ static esp_err_t api_scanner_check_writable_handler(httpd_req_t *req)
 // POST /api/scanner/discover-assemblies
 static esp_err_t api_scanner_discover_assemblies_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/discover-assemblies");
+    ESP_LOGD(TAG, "POST /api/scanner/discover-assemblies");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -468,7 +527,7 @@ static esp_err_t api_scanner_discover_assemblies_handler(httpd_req_t *req)
 // POST /api/scanner/register-session
 static esp_err_t api_scanner_register_session_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/register-session");
+    ESP_LOGD(TAG, "POST /api/scanner/register-session");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -507,16 +566,18 @@ static esp_err_t api_scanner_register_session_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     uint32_t session_handle = 0;
-    char error_msg[128];
-    esp_err_t err = enip_scanner_register_session(&ip_addr, &session_handle, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_register_session(&ip_addr, &session_handle, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     if (err == ESP_OK) {
         cJSON_AddStringToObject(response, "status", "ok");
         cJSON_AddNumberToObject(response, "session_handle", session_handle);
     } else {
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
         cJSON_AddStringToObject(response, "status", "error");
-        cJSON_AddStringToObject(response, "error", error_msg);
+        cJSON_AddStringToObject(response, "error", error_text);
     }
     
     return send_json_response(req, response, err);
@@ -525,7 +586,7 @@ static esp_err_t api_scanner_register_session_handler(httpd_req_t *req)
 // POST /api/scanner/unregister-session
 static esp_err_t api_scanner_unregister_session_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/unregister-session");
+    ESP_LOGD(TAG, "POST /api/scanner/unregister-session");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -583,7 +644,7 @@ static esp_err_t api_scanner_unregister_session_handler(httpd_req_t *req)
 // GET /api/status
 static esp_err_t api_status_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "GET /api/status");
+    ESP_LOGD(TAG, "GET /api/status");
     
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
@@ -598,7 +659,7 @@ static esp_err_t api_status_handler(httpd_req_t *req)
 // POST /api/scanner/read-tag
 static esp_err_t api_scanner_read_tag_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/read-tag");
+    ESP_LOGD(TAG, "POST /api/scanner/read-tag");
     
     // Get content length
     size_t content_len = req->content_len;
@@ -667,6 +728,13 @@ static esp_err_t api_scanner_read_tag_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
+    enip_scanner_route_t route;
+    if (!parse_route_param(json, &route)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid route");
+        return ESP_FAIL;
+    }
+    
     const char *tag_path_json = tag_path_item->valuestring;
     const char *ip_str_param = ip_item->valuestring;
     
@@ -681,13 +749,13 @@ static esp_err_t api_scanner_read_tag_handler(httpd_req_t *req)
         timeout_ms = (uint32_t)timeout_item->valueint;
     }
     
-    ESP_LOGI(TAG, "Reading tag '%s' from %s with timeout %lu ms", tag_path, ip_str_param, timeout_ms);
+    ESP_LOGD(TAG, "Reading tag '%s' from %s with timeout %lu ms", tag_path, ip_str_param, timeout_ms);
     
     cJSON_Delete(json);
     
     enip_scanner_tag_result_t result;
     memset(&result, 0, sizeof(result));
-    esp_err_t err = enip_scanner_read_tag(&ip_addr, tag_path, &result, timeout_ms);
+    esp_err_t err = enip_scanner_read_tag_routed(&ip_addr, &route, tag_path, &result, timeout_ms);
     
     cJSON *response = cJSON_CreateObject();
     if (response == NULL) {
@@ -787,7 +855,9 @@ static esp_err_t api_scanner_read_tag_handler(httpd_req_t *req)
         }
         cJSON_AddBoolToObject(response, "success", false);
         
-        const char *error_msg = (result.error_message[0] != '\0') ? result.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&result.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         ESP_LOGE(TAG, "Tag read failed: %s (err=%d)", error_msg, err);
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
@@ -801,7 +871,7 @@ static esp_err_t api_scanner_read_tag_handler(httpd_req_t *req)
 // POST /api/scanner/write-tag
 static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/write-tag");
+    ESP_LOGD(TAG, "POST /api/scanner/write-tag");
     
     char content[2048];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -822,9 +892,10 @@ static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
     cJSON *cip_data_type_item = cJSON_GetObjectItem(json, "cip_data_type");
     cJSON *data_item = cJSON_GetObjectItem(json, "data");
     
-    if (ip_item == NULL || tag_path_item == NULL || cip_data_type_item == NULL || data_item == NULL ||
+    // cip_data_type may be omitted when the device profile cache knows the tag
+    if (ip_item == NULL || tag_path_item == NULL || data_item == NULL ||
         !cJSON_IsString(ip_item) || !cJSON_IsString(tag_path_item) || 
-        !cJSON_IsNumber(cip_data_type_item) || !cJSON_IsArray(data_item)) {
+        (cip_data_type_item != NULL && !cJSON_IsNumber(cip_data_type_item)) || !cJSON_IsArray(data_item)) {
         cJSON_Delete(json);
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid parameters");
         return ESP_FAIL;
@@ -837,17 +908,38 @@ static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
+    enip_scanner_route_t route;
+    if (!parse_route_param(json, &route)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid route");
+        return ESP_FAIL;
+    }
+    
     // Copy tag_path before deleting JSON (cJSON strings are part of JSON object)
     char tag_path[128];
     strncpy(tag_path, tag_path_item->valuestring, sizeof(tag_path) - 1);
     tag_path[sizeof(tag_path) - 1] = '\0';
     
-    uint16_t cip_data_type = (uint16_t)cip_data_type_item->valueint;
+    uint16_t cip_data_type = 0;
+    if (cip_data_type_item != NULL) {
+        cip_data_type = (uint16_t)cip_data_type_item->valueint;
+    }
+#if CONFIG_ENIP_SCANNER_ENABLE_PROFILE_CACHE
+    else if (route.size == 0) {
+        enip_scanner_profile_get_tag_type(&ip_addr, tag_path, &cip_data_type);
+    }
+#endif
+    if (cip_data_type == 0) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing cip_data_type (tag type not cached)");
+        return ESP_FAIL;
+    }
     uint32_t timeout_ms = 5000;
     cJSON *timeout_item = cJSON_GetObjectItem(json, "timeout_ms");
     if (timeout_item != NULL && cJSON_IsNumber(timeout_item)) {
         timeout_ms = (uint32_t)timeout_item->valueint;
     }
+    bool coalesce = cJSON_IsTrue(cJSON_GetObjectItem(json, "coalesce"));
     
     // Extract data array
     int data_array_size = cJSON_GetArraySize(data_item);
@@ -877,9 +969,31 @@ static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
     
     cJSON_Delete(json);  // Safe to delete now - tag_path is copied
     
-    char error_message[128];
-    esp_err_t err = enip_scanner_write_tag(&ip_addr, tag_path, write_data, data_array_size, 
-                                          cip_data_type, timeout_ms, error_message);
+#if CONFIG_ENIP_SCANNER_ENABLE_WRITE_COALESCING
+    if (coalesce && route.size == 0) {
+        esp_err_t err = enip_scanner_write_tag_coalesced(&ip_addr, tag_path, write_data, data_array_size,
+                                                         cip_data_type, timeout_ms);
+        free(write_data);
+        
+        char ip_str[16];
+        snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&ip_addr));
+        cJSON *response = cJSON_CreateObject();
+        cJSON_AddStringToObject(response, "ip_address", ip_str);
+        cJSON_AddStringToObject(response, "tag_path", tag_path);
+        cJSON_AddBoolToObject(response, "success", err == ESP_OK);
+        cJSON_AddStringToObject(response, "status", err == ESP_OK ? "queued" : "error");
+        if (err != ESP_OK) {
+            cJSON_AddStringToObject(response, "error", esp_err_to_name(err));
+        }
+        return send_json_response(req, response, ESP_OK);
+    }
+#else
+    (void)coalesce;
+#endif
+    
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_write_tag_routed(&ip_addr, &route, tag_path, write_data, data_array_size,
+                                                 cip_data_type, timeout_ms, &error);
     
     free(write_data);
     
@@ -901,7 +1015,9 @@ static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddStringToObject(response, "tag_path", tag_path);
         cJSON_AddBoolToObject(response, "success", false);
-        cJSON_AddStringToObject(response, "error", error_message);
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        cJSON_AddStringToObject(response, "error", error_text);
         cJSON_AddStringToObject(response, "status", "error");
         // Return HTTP 200 with error JSON (not 500) - CIP errors are client/request errors, not server errors
         return send_json_response(req, response, ESP_OK);
@@ -913,7 +1029,7 @@ static esp_err_t api_scanner_write_tag_handler(httpd_req_t *req)
 // GET /api/network/config
 static esp_err_t api_network_config_get_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "GET /api/network/config");
+    ESP_LOGD(TAG, "GET /api/network/config");
     
     system_ip_config_t config;
     bool loaded = system_ip_config_load(&config);
@@ -998,13 +1114,865 @@ static esp_err_t api_network_config_get_handler(httpd_req_t *req)
     return send_json_response(req, response, ESP_OK);
 }
 
-// POST /api/network/config
-static esp_err_t api_network_config_set_handler(httpd_req_t *req)
+// POST /api/network/config
+static esp_err_t api_network_config_set_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "POST /api/network/config");
+    
+    size_t content_len = req->content_len;
+    if (content_len == 0 || content_len > 1024) {
+        ESP_LOGE(TAG, "Invalid request body size: %zu", content_len);
+        return send_json_response(req, cJSON_CreateString("Invalid request body size"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    char *content = malloc(content_len + 1);
+    if (content == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for request body");
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    int total_received = 0;
+    while (total_received < content_len) {
+        int ret = httpd_req_recv(req, content + total_received, content_len - total_received);
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Failed to receive request body: %d", ret);
+            free(content);
+            return send_json_response(req, cJSON_CreateString("Invalid request body"), HTTPD_400_BAD_REQUEST);
+        }
+        total_received += ret;
+    }
+    content[content_len] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    free(content);
+    
+    if (json == NULL) {
+        ESP_LOGE(TAG, "Failed to parse JSON");
+        return send_json_response(req, cJSON_CreateString("Invalid JSON"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    system_ip_config_t config;
+    memset(&config, 0, sizeof(config));
+    
+    cJSON *use_dhcp_item = cJSON_GetObjectItem(json, "use_dhcp");
+    if (use_dhcp_item != NULL && cJSON_IsBool(use_dhcp_item)) {
+        config.use_dhcp = cJSON_IsTrue(use_dhcp_item);
+    } else {
+        config.use_dhcp = true;  // Default to DHCP
+    }
+    
+    if (!config.use_dhcp) {
+        // Parse static IP configuration
+        cJSON *ip_item = cJSON_GetObjectItem(json, "ip_address");
+        cJSON *netmask_item = cJSON_GetObjectItem(json, "netmask");
+        cJSON *gateway_item = cJSON_GetObjectItem(json, "gateway");
+        cJSON *dns1_item = cJSON_GetObjectItem(json, "dns1");
+        cJSON *dns2_item = cJSON_GetObjectItem(json, "dns2");
+        
+        ip4_addr_t ip_addr;
+        if (ip_item != NULL && cJSON_IsString(ip_item)) {
+            if (inet_aton(ip_item->valuestring, &ip_addr)) {
+                config.ip_address = ip_addr.addr;
+            } else {
+                cJSON_Delete(json);
+                return send_json_response(req, cJSON_CreateString("Invalid IP address"), HTTPD_400_BAD_REQUEST);
+            }
+        }
+        
+        if (netmask_item != NULL && cJSON_IsString(netmask_item)) {
+            if (inet_aton(netmask_item->valuestring, &ip_addr)) {
+                config.netmask = ip_addr.addr;
+            }
+        }
+        
+        if (gateway_item != NULL && cJSON_IsString(gateway_item)) {
+            if (inet_aton(gateway_item->valuestring, &ip_addr)) {
+                config.gateway = ip_addr.addr;
+            }
+        }
+        
+        if (dns1_item != NULL && cJSON_IsString(dns1_item)) {
+            if (inet_aton(dns1_item->valuestring, &ip_addr)) {
+                config.dns1 = ip_addr.addr;
+            }
+        }
+        
+        if (dns2_item != NULL && cJSON_IsString(dns2_item)) {
+            if (inet_aton(dns2_item->valuestring, &ip_addr)) {
+                config.dns2 = ip_addr.addr;
+            }
+        }
+    }
+    
+    cJSON_Delete(json);
+    
+    // Save to NVS
+    if (system_ip_config_save(&config)) {
+        cJSON *response = cJSON_CreateObject();
+        cJSON_AddBoolToObject(response, "success", true);
+        cJSON_AddStringToObject(response, "message", "Configuration saved successfully. Please restart the device for changes to take effect.");
+        return send_json_response(req, response, ESP_OK);
+    } else {
+        cJSON *response = cJSON_CreateObject();
+        cJSON_AddBoolToObject(response, "success", false);
+        cJSON_AddStringToObject(response, "error", "Failed to save configuration");
+        return send_json_response(req, response, HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+
+static const char *io_entry_type_names[] = { "implicit", "tag", "motoman_status" };
+static const char *io_state_names[] = { "disabled", "starting", "running", "failed" };
+
+static cJSON *io_entry_to_json(const enip_scanner_io_entry_t *entry)
+{
+    cJSON *item = cJSON_CreateObject();
+    char ip_str[16];
+    snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&entry->ip_address));
+    
+    cJSON_AddStringToObject(item, "type", entry->type <= ENIP_IO_ENTRY_MOTOMAN_STATUS ?
+                            io_entry_type_names[entry->type] : "unknown");
+    cJSON_AddBoolToObject(item, "enabled", entry->enabled);
+    cJSON_AddStringToObject(item, "ip_address", ip_str);
+    cJSON_AddNumberToObject(item, "period_ms", entry->period_ms);
+    if (entry->type == ENIP_IO_ENTRY_IMPLICIT) {
+        cJSON_AddNumberToObject(item, "assembly_consumed", entry->assembly_consumed);
+        cJSON_AddNumberToObject(item, "assembly_produced", entry->assembly_produced);
+        cJSON_AddNumberToObject(item, "size_consumed", entry->size_consumed);
+        cJSON_AddNumberToObject(item, "size_produced", entry->size_produced);
+        cJSON_AddBoolToObject(item, "exclusive_owner", entry->exclusive_owner);
+    } else if (entry->type == ENIP_IO_ENTRY_TAG) {
+        cJSON_AddStringToObject(item, "tag_path", entry->tag_path);
+        cJSON_AddStringToObject(item, "route", entry->route);
+    }
+    return item;
+}
+
+// Returns NULL on success, or a message describing the first invalid field
+static const char *io_entry_from_json(cJSON *item, enip_scanner_io_entry_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    
+    cJSON *type_item = cJSON_GetObjectItem(item, "type");
+    cJSON *ip_item = cJSON_GetObjectItem(item, "ip_address");
+    if (type_item == NULL || !cJSON_IsString(type_item)) {
+        return "Missing entry type";
+    }
+    size_t type_count = sizeof(io_entry_type_names) / sizeof(io_entry_type_names[0]);
+    entry->type = type_count;
+    for (size_t i = 0; i < type_count; i++) {
+        if (strcmp(type_item->valuestring, io_entry_type_names[i]) == 0) {
+            entry->type = i;
+        }
+    }
+    if (entry->type == type_count) {
+        return "Invalid entry type";
+    }
+    if (ip_item == NULL || !cJSON_IsString(ip_item) || !inet_aton(ip_item->valuestring, &entry->ip_address)) {
+        return "Invalid IP address";
+    }
+    
+    cJSON *enabled_item = cJSON_GetObjectItem(item, "enabled");
+    entry->enabled = enabled_item == NULL || cJSON_IsTrue(enabled_item);
+    cJSON *period_item = cJSON_GetObjectItem(item, "period_ms");
+    entry->period_ms = cJSON_IsNumber(period_item) ? (uint32_t)period_item->valueint : 0;
+    if (entry->period_ms == 0) {
+        return "Invalid period_ms";
+    }
+    
+    if (entry->type == ENIP_IO_ENTRY_IMPLICIT) {
+        cJSON *consumed_item = cJSON_GetObjectItem(item, "assembly_consumed");
+        cJSON *produced_item = cJSON_GetObjectItem(item, "assembly_produced");
+        cJSON *size_consumed_item = cJSON_GetObjectItem(item, "size_consumed");
+        cJSON *size_produced_item = cJSON_GetObjectItem(item, "size_produced");
+        cJSON *exclusive_item = cJSON_GetObjectItem(item, "exclusive_owner");
+        if (!cJSON_IsNumber(consumed_item) || !cJSON_IsNumber(produced_item)) {
+            return "Missing assembly instances";
+        }
+        entry->assembly_consumed = (uint16_t)consumed_item->valueint;
+        entry->assembly_produced = (uint16_t)produced_item->valueint;
+        entry->size_consumed = cJSON_IsNumber(size_consumed_item) ? (uint16_t)size_consumed_item->valueint : 0;
+        entry->size_produced = cJSON_IsNumber(size_produced_item) ? (uint16_t)size_produced_item->valueint : 0;
+        entry->exclusive_owner = exclusive_item == NULL || cJSON_IsTrue(exclusive_item);
+    } else if (entry->type == ENIP_IO_ENTRY_TAG) {
+        cJSON *tag_item = cJSON_GetObjectItem(item, "tag_path");
+        cJSON *route_item = cJSON_GetObjectItem(item, "route");
+        if (tag_item == NULL || !cJSON_IsString(tag_item) || tag_item->valuestring[0] == '\0' ||
+            strlen(tag_item->valuestring) >= sizeof(entry->tag_path)) {
+            return "Invalid tag_path";
+        }
+        strlcpy(entry->tag_path, tag_item->valuestring, sizeof(entry->tag_path));
+        if (route_item != NULL) {
+            enip_scanner_route_t route;
+            if (!cJSON_IsString(route_item) || strlen(route_item->valuestring) >= sizeof(entry->route) ||
+                enip_scanner_route_parse(route_item->valuestring, &route) != ESP_OK) {
+                return "Invalid route";
+            }
+            strlcpy(entry->route, route_item->valuestring, sizeof(entry->route));
+        }
+    }
+    return NULL;
+}
+
+// GET /api/io-config
+static esp_err_t api_io_config_get_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/io-config");
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON *entries = cJSON_CreateArray();
+    size_t count = enip_scanner_io_get_count();
+    
+    if (count > 0) {
+        // Running configuration with live status
+        for (size_t i = 0; i < count; i++) {
+            enip_scanner_io_entry_t entry;
+            enip_scanner_io_status_t status;
+            if (enip_scanner_io_get_status(i, &entry, &status) != ESP_OK) {
+                break;
+            }
+            cJSON *item = io_entry_to_json(&entry);
+            cJSON_AddStringToObject(item, "state", status.state <= ENIP_IO_STATE_FAILED ?
+                                    io_state_names[status.state] : "unknown");
+            cJSON_AddStringToObject(item, "last_result", esp_err_to_name(status.last_result));
+            cJSON_AddNumberToObject(item, "updates", status.updates);
+            cJSON_AddNumberToObject(item, "failures", status.failures);
+            cJSON_AddNumberToObject(item, "last_update_ms", status.last_update_ms);
+            cJSON_AddNumberToObject(item, "up_time_ms", status.up_time_ms);
+            cJSON_AddItemToArray(entries, item);
+        }
+    } else {
+        // Nothing running: report the stored configuration
+        enip_scanner_io_entry_t *stored = calloc(CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES, sizeof(enip_scanner_io_entry_t));
+        if (stored != NULL) {
+            if (system_scan_list_load(stored, sizeof(enip_scanner_io_entry_t),
+                                      CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES, &count)) {
+                for (size_t i = 0; i < count; i++) {
+                    cJSON_AddItemToArray(entries, io_entry_to_json(&stored[i]));
+                }
+            }
+            free(stored);
+        }
+    }
+    
+    cJSON_AddBoolToObject(response, "running", enip_scanner_io_get_count() > 0);
+    cJSON_AddNumberToObject(response, "max_entries", CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES);
+    cJSON_AddItemToObject(response, "entries", entries);
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
+// POST /api/io-config
+// Body: {"entries": [...]}; saved to NVS and applied immediately
+static esp_err_t api_io_config_set_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "POST /api/io-config");
+    
+    size_t content_len = req->content_len;
+    if (content_len == 0 || content_len > 8192) {
+        ESP_LOGE(TAG, "Invalid request body size: %zu", content_len);
+        return send_json_response(req, cJSON_CreateString("Invalid request body size"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    char *content = malloc(content_len + 1);
+    if (content == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for request body");
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    int total_received = 0;
+    while (total_received < content_len) {
+        int ret = httpd_req_recv(req, content + total_received, content_len - total_received);
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Failed to receive request body: %d", ret);
+            free(content);
+            return send_json_response(req, cJSON_CreateString("Invalid request body"), HTTPD_400_BAD_REQUEST);
+        }
+        total_received += ret;
+    }
+    content[content_len] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    free(content);
+    
+    if (json == NULL) {
+        ESP_LOGE(TAG, "Failed to parse JSON");
+        return send_json_response(req, cJSON_CreateString("Invalid JSON"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    cJSON *entries_item = cJSON_GetObjectItem(json, "entries");
+    int count = cJSON_GetArraySize(entries_item);
+    if (!cJSON_IsArray(entries_item) || count > CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Invalid entries"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    enip_scanner_io_entry_t *entries = calloc(count > 0 ? count : 1, sizeof(enip_scanner_io_entry_t));
+    if (entries == NULL) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const char *error = io_entry_from_json(cJSON_GetArrayItem(entries_item, i), &entries[i]);
+        if (error != NULL) {
+            cJSON *response = cJSON_CreateObject();
+            cJSON_AddBoolToObject(response, "success", false);
+            cJSON_AddNumberToObject(response, "index", i);
+            cJSON_AddStringToObject(response, "error", error);
+            free(entries);
+            cJSON_Delete(json);
+            return send_json_response(req, response, HTTPD_400_BAD_REQUEST);
+        }
+    }
+    cJSON_Delete(json);
+    
+    cJSON *response = cJSON_CreateObject();
+    if (!system_scan_list_save(entries, sizeof(enip_scanner_io_entry_t), count)) {
+        free(entries);
+        cJSON_AddBoolToObject(response, "success", false);
+        cJSON_AddStringToObject(response, "error", "Failed to save I/O configuration");
+        return send_json_response(req, response, HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    // Apply: tear down the running configuration and bring up the new one
+    enip_scanner_io_stop(5000);
+    esp_err_t ret = count > 0 ? enip_scanner_io_start(entries, count) : ESP_OK;
+    free(entries);
+    
+    cJSON_AddBoolToObject(response, "success", ret == ESP_OK);
+    cJSON_AddNumberToObject(response, "count", count);
+    cJSON_AddStringToObject(response, "status", ret == ESP_OK ? "ok" : "error");
+    if (ret != ESP_OK) {
+        cJSON_AddStringToObject(response, "error", esp_err_to_name(ret));
+    }
+    return send_json_response(req, response, ESP_OK);
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+
+#if CONFIG_HISTORIAN_ENABLE
+
+static const char *historian_source_names[] = { "tag", "assembly", "motoman_position" };
+
+static cJSON *historian_channel_to_json(const historian_channel_t *channel)
+{
+    cJSON *item = cJSON_CreateObject();
+    char ip_str[16];
+    snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&channel->ip_address));
+    
+    cJSON_AddNumberToObject(item, "id", channel->id);
+    cJSON_AddStringToObject(item, "name", channel->name);
+    cJSON_AddStringToObject(item, "source", channel->source <= HISTORIAN_SOURCE_MOTOMAN_POSITION ?
+                            historian_source_names[channel->source] : "unknown");
+    cJSON_AddStringToObject(item, "format", channel->format == HISTORIAN_FORMAT_REAL ? "real" : "int");
+    cJSON_AddBoolToObject(item, "enabled", channel->enabled);
+    cJSON_AddStringToObject(item, "ip_address", ip_str);
+    cJSON_AddNumberToObject(item, "period_ms", channel->period_ms);
+    if (channel->source == HISTORIAN_SOURCE_TAG) {
+        cJSON_AddStringToObject(item, "tag_path", channel->tag_path);
+    } else if (channel->source == HISTORIAN_SOURCE_ASSEMBLY) {
+        cJSON_AddNumberToObject(item, "instance", channel->instance);
+        cJSON_AddNumberToObject(item, "offset", channel->offset);
+        cJSON_AddNumberToObject(item, "length", channel->length);
+    } else {
+        cJSON_AddNumberToObject(item, "control_group", channel->instance);
+    }
+    return item;
+}
+
+// Returns NULL on success, or a message describing the first invalid field
+static const char *historian_channel_from_json(cJSON *item, historian_channel_t *channel)
+{
+    memset(channel, 0, sizeof(*channel));
+    
+    cJSON *source_item = cJSON_GetObjectItem(item, "source");
+    cJSON *ip_item = cJSON_GetObjectItem(item, "ip_address");
+    if (source_item == NULL || !cJSON_IsString(source_item)) {
+        return "Missing source";
+    }
+    size_t source_count = sizeof(historian_source_names) / sizeof(historian_source_names[0]);
+    channel->source = source_count;
+    for (size_t i = 0; i < source_count; i++) {
+        if (strcmp(source_item->valuestring, historian_source_names[i]) == 0) {
+            channel->source = i;
+        }
+    }
+    if (channel->source == source_count) {
+        return "Invalid source";
+    }
+    if (ip_item == NULL || !cJSON_IsString(ip_item) || !inet_aton(ip_item->valuestring, &channel->ip_address)) {
+        return "Invalid IP address";
+    }
+    
+    // Keeping the id lets exports continue the same series across edits
+    cJSON *id_item = cJSON_GetObjectItem(item, "id");
+    channel->id = cJSON_IsNumber(id_item) ? (uint16_t)id_item->valueint : 0;
+    cJSON *name_item = cJSON_GetObjectItem(item, "name");
+    if (cJSON_IsString(name_item)) {
+        strlcpy(channel->name, name_item->valuestring, sizeof(channel->name));
+    }
+    cJSON *format_item = cJSON_GetObjectItem(item, "format");
+    channel->format = (cJSON_IsString(format_item) && strcmp(format_item->valuestring, "real") == 0) ?
+                      HISTORIAN_FORMAT_REAL : HISTORIAN_FORMAT_INT;
+    cJSON *enabled_item = cJSON_GetObjectItem(item, "enabled");
+    channel->enabled = enabled_item == NULL || cJSON_IsTrue(enabled_item);
+    cJSON *period_item = cJSON_GetObjectItem(item, "period_ms");
+    channel->period_ms = cJSON_IsNumber(period_item) ? (uint32_t)period_item->valueint : 0;
+    if (channel->period_ms == 0) {
+        return "Invalid period_ms";
+    }
+    
+    if (channel->source == HISTORIAN_SOURCE_TAG) {
+        cJSON *tag_item = cJSON_GetObjectItem(item, "tag_path");
+        if (tag_item == NULL || !cJSON_IsString(tag_item) || tag_item->valuestring[0] == '\0' ||
+            strlen(tag_item->valuestring) >= sizeof(channel->tag_path)) {
+            return "Invalid tag_path";
+        }
+        strlcpy(channel->tag_path, tag_item->valuestring, sizeof(channel->tag_path));
+    } else if (channel->source == HISTORIAN_SOURCE_ASSEMBLY) {
+        cJSON *instance_item = cJSON_GetObjectItem(item, "instance");
+        cJSON *offset_item = cJSON_GetObjectItem(item, "offset");
+        cJSON *length_item = cJSON_GetObjectItem(item, "length");
+        if (!cJSON_IsNumber(instance_item)) {
+            return "Missing instance";
+        }
+        channel->instance = (uint16_t)instance_item->valueint;
+        channel->offset = cJSON_IsNumber(offset_item) ? (uint16_t)offset_item->valueint : 0;
+        channel->length = cJSON_IsNumber(length_item) ? (uint16_t)length_item->valueint : 4;
+        if (channel->length == 0 || channel->length > HISTORIAN_VALUES_MAX * 4) {
+            return "Invalid length";
+        }
+    } else {
+        cJSON *group_item = cJSON_GetObjectItem(item, "control_group");
+        channel->instance = cJSON_IsNumber(group_item) ? (uint16_t)group_item->valueint : 1;
+    }
+    return NULL;
+}
+
+// GET /api/historian/status
+static esp_err_t api_historian_status_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/historian/status");
+    
+    historian_status_t status;
+    historian_get_status(&status);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "running", status.running);
+    cJSON_AddNumberToObject(response, "sector_count", status.sector_count);
+    cJSON_AddNumberToObject(response, "sectors_used", status.sectors_used);
+    cJSON_AddNumberToObject(response, "oldest_ms", (double)status.oldest_ms);
+    cJSON_AddNumberToObject(response, "newest_ms", (double)status.newest_ms);
+    cJSON_AddNumberToObject(response, "now_ms", (double)historian_now_ms());
+    cJSON_AddNumberToObject(response, "samples", status.samples);
+    cJSON_AddNumberToObject(response, "records", status.records);
+    cJSON_AddNumberToObject(response, "bytes_written", status.bytes_written);
+    cJSON_AddNumberToObject(response, "sectors_erased", status.sectors_erased);
+    cJSON_AddNumberToObject(response, "read_failures", status.read_failures);
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
+// GET /api/historian/channels
+static esp_err_t api_historian_channels_get_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/historian/channels");
+    
+    historian_channel_t *channels = calloc(CONFIG_HISTORIAN_MAX_CHANNELS, sizeof(historian_channel_t));
+    if (channels == NULL) {
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    size_t count = historian_get_channels(channels, CONFIG_HISTORIAN_MAX_CHANNELS);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON *items = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        cJSON_AddItemToArray(items, historian_channel_to_json(&channels[i]));
+    }
+    free(channels);
+    
+    cJSON_AddNumberToObject(response, "max_channels", CONFIG_HISTORIAN_MAX_CHANNELS);
+    cJSON_AddItemToObject(response, "channels", items);
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
+// POST /api/historian/channels
+// Body: {"channels": [...]}; saved to NVS and sampled from the next period on
+static esp_err_t api_historian_channels_set_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "POST /api/historian/channels");
+    
+    size_t content_len = req->content_len;
+    if (content_len == 0 || content_len > 8192) {
+        ESP_LOGE(TAG, "Invalid request body size: %zu", content_len);
+        return send_json_response(req, cJSON_CreateString("Invalid request body size"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    char *content = malloc(content_len + 1);
+    if (content == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for request body");
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    int total_received = 0;
+    while (total_received < content_len) {
+        int ret = httpd_req_recv(req, content + total_received, content_len - total_received);
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Failed to receive request body: %d", ret);
+            free(content);
+            return send_json_response(req, cJSON_CreateString("Invalid request body"), HTTPD_400_BAD_REQUEST);
+        }
+        total_received += ret;
+    }
+    content[content_len] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    free(content);
+    
+    if (json == NULL) {
+        ESP_LOGE(TAG, "Failed to parse JSON");
+        return send_json_response(req, cJSON_CreateString("Invalid JSON"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    cJSON *channels_item = cJSON_GetObjectItem(json, "channels");
+    int count = cJSON_GetArraySize(channels_item);
+    if (!cJSON_IsArray(channels_item) || count > CONFIG_HISTORIAN_MAX_CHANNELS) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Invalid channels"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    historian_channel_t *channels = calloc(count > 0 ? count : 1, sizeof(historian_channel_t));
+    if (channels == NULL) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const char *error = historian_channel_from_json(cJSON_GetArrayItem(channels_item, i), &channels[i]);
+        if (error != NULL) {
+            cJSON *response = cJSON_CreateObject();
+            cJSON_AddBoolToObject(response, "success", false);
+            cJSON_AddNumberToObject(response, "index", i);
+            cJSON_AddStringToObject(response, "error", error);
+            free(channels);
+            cJSON_Delete(json);
+            return send_json_response(req, response, HTTPD_400_BAD_REQUEST);
+        }
+    }
+    cJSON_Delete(json);
+    
+    esp_err_t ret = historian_set_channels(channels, count);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", ret == ESP_OK);
+    if (ret == ESP_OK) {
+        // Return the assigned ids
+        cJSON *items = cJSON_CreateArray();
+        for (int i = 0; i < count; i++) {
+            cJSON_AddItemToArray(items, historian_channel_to_json(&channels[i]));
+        }
+        cJSON_AddItemToObject(response, "channels", items);
+        cJSON_AddStringToObject(response, "status", "ok");
+    } else {
+        cJSON_AddStringToObject(response, "error", esp_err_to_name(ret));
+    }
+    free(channels);
+    return send_json_response(req, response, ret == ESP_OK ? ESP_OK : HTTPD_500_INTERNAL_SERVER_ERROR);
+}
+
+static esp_err_t historian_export_chunk(const void *data, size_t length, void *user_data)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)user_data, (const char *)data, length);
+}
+
+// GET /api/historian/export?from=<ms>&to=<ms>&format=csv|bin
+// Streams the samples in [from, to] (default: everything) as chunked CSV, or
+// the raw sectors (32-byte header followed by records) for offline decoding
+static esp_err_t api_historian_export_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/historian/export");
+    
+    int64_t from_ms = 0;
+    int64_t to_ms = INT64_MAX;
+    historian_export_format_t format = HISTORIAN_EXPORT_CSV;
+    
+    char query[128];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[24];
+        if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+            from_ms = strtoll(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "to", value, sizeof(value)) == ESP_OK) {
+            to_ms = strtoll(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+            if (strcmp(value, "bin") == 0) {
+                format = HISTORIAN_EXPORT_BINARY;
+            } else if (strcmp(value, "csv") != 0) {
+                return send_json_response(req, cJSON_CreateString("Invalid format"), HTTPD_400_BAD_REQUEST);
+            }
+        }
+    }
+    if (from_ms > to_ms) {
+        return send_json_response(req, cJSON_CreateString("Invalid time range"), HTTPD_400_BAD_REQUEST);
+    }
+    
+    if (format == HISTORIAN_EXPORT_BINARY) {
+        httpd_resp_set_type(req, "application/octet-stream");
+        httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"historian.bin\"");
+    } else {
+        httpd_resp_set_type(req, "text/csv");
+        httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"historian.csv\"");
+    }
+    
+    esp_err_t ret = historian_export(from_ms, to_ms, format, historian_export_chunk, req);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Historian export ended early: %s", esp_err_to_name(ret));
+    }
+    // Terminate the chunked response either way
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+#endif // CONFIG_HISTORIAN_ENABLE
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+
+static const char *xlat_kind_names[] = {
+    "tag", "assembly", "motoman_io", "motoman_register",
+    "motoman_var_b", "motoman_var_i", "motoman_var_d", "motoman_var_r"
+};
+static const char *xlat_type_names[] = { "bool", "sint", "int", "dint", "usint", "uint", "udint", "real" };
+static const char *xlat_trigger_names[] = { "always", "on_change", "rising_edge" };
+
+// Index of name in names, or count if not found
+static size_t xlat_name_index(const char *name, const char **names, size_t count)
+{
+    size_t i = 0;
+    while (i < count && strcmp(name, names[i]) != 0) {
+        i++;
+    }
+    return i;
+}
+
+static cJSON *xlat_point_to_json(const enip_translator_point_t *point)
+{
+    cJSON *item = cJSON_CreateObject();
+    char ip_str[16];
+    snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&point->ip_address));
+    
+    cJSON_AddStringToObject(item, "kind", point->kind <= ENIP_TRANSLATOR_POINT_MOTOMAN_VAR_R ?
+                            xlat_kind_names[point->kind] : "unknown");
+    cJSON_AddStringToObject(item, "ip_address", ip_str);
+    if (point->kind == ENIP_TRANSLATOR_POINT_TAG) {
+        cJSON_AddStringToObject(item, "tag_path", point->tag_path);
+    } else {
+        cJSON_AddNumberToObject(item, "number", point->number);
+    }
+    if (point->kind == ENIP_TRANSLATOR_POINT_ASSEMBLY) {
+        cJSON_AddNumberToObject(item, "offset", point->offset);
+    }
+    if (point->kind <= ENIP_TRANSLATOR_POINT_ASSEMBLY) {
+        cJSON_AddStringToObject(item, "type", point->type <= ENIP_TRANSLATOR_TYPE_REAL ?
+                                xlat_type_names[point->type] : "unknown");
+    }
+    if (point->bit != ENIP_TRANSLATOR_NO_BIT) {
+        cJSON_AddNumberToObject(item, "bit", point->bit);
+    }
+    return item;
+}
+
+// Returns NULL on success, or a message describing the first invalid field
+static const char *xlat_point_from_json(cJSON *item, enip_translator_point_t *point)
+{
+    memset(point, 0, sizeof(*point));
+    point->bit = ENIP_TRANSLATOR_NO_BIT;
+    
+    cJSON *kind_item = cJSON_GetObjectItem(item, "kind");
+    cJSON *ip_item = cJSON_GetObjectItem(item, "ip_address");
+    if (kind_item == NULL || !cJSON_IsString(kind_item)) {
+        return "Missing point kind";
+    }
+    size_t kind_count = sizeof(xlat_kind_names) / sizeof(xlat_kind_names[0]);
+    point->kind = xlat_name_index(kind_item->valuestring, xlat_kind_names, kind_count);
+    if (point->kind >= kind_count) {
+        return "Invalid point kind";
+    }
+    if (ip_item == NULL || !cJSON_IsString(ip_item) || !inet_aton(ip_item->valuestring, &point->ip_address)) {
+        return "Invalid IP address";
+    }
+    
+    if (point->kind == ENIP_TRANSLATOR_POINT_TAG) {
+        cJSON *tag_item = cJSON_GetObjectItem(item, "tag_path");
+        if (tag_item == NULL || !cJSON_IsString(tag_item) || tag_item->valuestring[0] == '\0' ||
+            strlen(tag_item->valuestring) >= sizeof(point->tag_path)) {
+            return "Invalid tag_path";
+        }
+        strlcpy(point->tag_path, tag_item->valuestring, sizeof(point->tag_path));
+    } else {
+        cJSON *number_item = cJSON_GetObjectItem(item, "number");
+        if (!cJSON_IsNumber(number_item)) {
+            return "Missing number";
+        }
+        point->number = (uint16_t)number_item->valueint;
+    }
+    cJSON *offset_item = cJSON_GetObjectItem(item, "offset");
+    point->offset = cJSON_IsNumber(offset_item) ? (uint16_t)offset_item->valueint : 0;
+    
+    cJSON *type_item = cJSON_GetObjectItem(item, "type");
+    if (type_item != NULL) {
+        size_t type_count = sizeof(xlat_type_names) / sizeof(xlat_type_names[0]);
+        point->type = cJSON_IsString(type_item) ?
+                      xlat_name_index(type_item->valuestring, xlat_type_names, type_count) : type_count;
+        if (point->type >= type_count) {
+            return "Invalid type";
+        }
+    } else if (point->kind <= ENIP_TRANSLATOR_POINT_ASSEMBLY) {
+        point->type = ENIP_TRANSLATOR_TYPE_DINT;
+    }
+    
+    cJSON *bit_item = cJSON_GetObjectItem(item, "bit");
+    if (bit_item != NULL) {
+        if (!cJSON_IsNumber(bit_item) || bit_item->valueint < 0 || bit_item->valueint > 31) {
+            return "Invalid bit";
+        }
+        point->bit = (uint8_t)bit_item->valueint;
+    }
+    return NULL;
+}
+
+// Returns NULL on success, or a message describing the first invalid field
+static const char *xlat_binding_from_json(cJSON *item, enip_translator_binding_t *binding)
+{
+    memset(binding, 0, sizeof(*binding));
+    
+    const char *error = xlat_point_from_json(cJSON_GetObjectItem(item, "source"), &binding->source);
+    if (error != NULL) {
+        return error;
+    }
+    error = xlat_point_from_json(cJSON_GetObjectItem(item, "destination"), &binding->destination);
+    if (error != NULL) {
+        return error;
+    }
+    
+    cJSON *name_item = cJSON_GetObjectItem(item, "name");
+    if (cJSON_IsString(name_item)) {
+        strlcpy(binding->name, name_item->valuestring, sizeof(binding->name));
+    }
+    cJSON *scale_item = cJSON_GetObjectItem(item, "scale");
+    cJSON *offset_item = cJSON_GetObjectItem(item, "offset");
+    binding->scale = cJSON_IsNumber(scale_item) ? (float)scale_item->valuedouble : 1.0f;
+    binding->offset = cJSON_IsNumber(offset_item) ? (float)offset_item->valuedouble : 0.0f;
+    cJSON *enabled_item = cJSON_GetObjectItem(item, "enabled");
+    binding->enabled = enabled_item == NULL || cJSON_IsTrue(enabled_item);
+    
+    cJSON *trigger_item = cJSON_GetObjectItem(item, "trigger");
+    if (trigger_item != NULL) {
+        size_t trigger_count = sizeof(xlat_trigger_names) / sizeof(xlat_trigger_names[0]);
+        binding->trigger = cJSON_IsString(trigger_item) ?
+                           xlat_name_index(trigger_item->valuestring, xlat_trigger_names, trigger_count) :
+                           trigger_count;
+        if (binding->trigger >= trigger_count) {
+            return "Invalid trigger";
+        }
+    } else {
+        binding->trigger = ENIP_TRANSLATOR_TRIGGER_ON_CHANGE;
+    }
+    return NULL;
+}
+
+static cJSON *xlat_binding_to_json(const enip_translator_binding_t *binding)
+{
+    cJSON *item = cJSON_CreateObject();
+    cJSON_AddStringToObject(item, "name", binding->name);
+    cJSON_AddBoolToObject(item, "enabled", binding->enabled);
+    cJSON_AddItemToObject(item, "source", xlat_point_to_json(&binding->source));
+    cJSON_AddItemToObject(item, "destination", xlat_point_to_json(&binding->destination));
+    cJSON_AddNumberToObject(item, "scale", binding->scale);
+    cJSON_AddNumberToObject(item, "offset", binding->offset);
+    cJSON_AddStringToObject(item, "trigger", binding->trigger <= ENIP_TRANSLATOR_TRIGGER_RISING_EDGE ?
+                            xlat_trigger_names[binding->trigger] : "unknown");
+    return item;
+}
+
+// GET /api/translator
+static esp_err_t api_translator_get_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/translator");
+    
+    enip_translator_status_t status;
+    enip_scanner_translator_get_status(&status);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON *bindings = cJSON_CreateArray();
+    size_t count = enip_scanner_translator_get_count();
+    uint32_t cycle_ms = status.cycle_ms;
+    
+    if (count > 0) {
+        // Compiled map with live values
+        for (size_t i = 0; i < count; i++) {
+            enip_translator_binding_t binding;
+            enip_translator_binding_status_t binding_status;
+            if (enip_scanner_translator_get_binding(i, &binding, &binding_status) != ESP_OK) {
+                break;
+            }
+            cJSON *item = xlat_binding_to_json(&binding);
+            cJSON_AddBoolToObject(item, "valid", binding_status.valid);
+            cJSON_AddNumberToObject(item, "value", binding_status.value);
+            cJSON_AddNumberToObject(item, "writes", binding_status.writes);
+            cJSON_AddNumberToObject(item, "failures", binding_status.failures);
+            cJSON_AddStringToObject(item, "last_result", esp_err_to_name(binding_status.last_result));
+            cJSON_AddItemToArray(bindings, item);
+        }
+    } else {
+        // Nothing compiled: report the stored map
+        enip_translator_binding_t *stored = calloc(CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS,
+                                                   sizeof(enip_translator_binding_t));
+        if (stored != NULL) {
+            if (system_translator_load(stored, sizeof(enip_translator_binding_t),
+                                       CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS, &count, &cycle_ms)) {
+                for (size_t i = 0; i < count; i++) {
+                    cJSON_AddItemToArray(bindings, xlat_binding_to_json(&stored[i]));
+                }
+            }
+            free(stored);
+        }
+    }
+    
+    cJSON_AddBoolToObject(response, "running", status.running);
+    cJSON_AddNumberToObject(response, "cycle_ms", cycle_ms);
+    cJSON_AddNumberToObject(response, "max_bindings", CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS);
+    cJSON_AddNumberToObject(response, "cycles", status.cycles);
+    cJSON_AddNumberToObject(response, "overruns", status.overruns);
+    cJSON_AddNumberToObject(response, "last_cycle_us", status.last_cycle_us);
+    cJSON_AddNumberToObject(response, "min_cycle_us", status.min_cycle_us);
+    cJSON_AddNumberToObject(response, "max_cycle_us", status.max_cycle_us);
+    cJSON_AddNumberToObject(response, "avg_cycle_us", status.avg_cycle_us);
+    cJSON_AddNumberToObject(response, "devices", status.devices);
+    cJSON_AddNumberToObject(response, "read_requests", status.read_requests);
+    cJSON_AddNumberToObject(response, "write_requests", status.write_requests);
+    cJSON_AddNumberToObject(response, "read_failures", status.read_failures);
+    cJSON_AddNumberToObject(response, "write_failures", status.write_failures);
+    cJSON_AddItemToObject(response, "bindings", bindings);
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
+// POST /api/translator
+// Body: {"cycle_ms": 100, "bindings": [...]}; saved to NVS and applied immediately
+static esp_err_t api_translator_set_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/network/config");
+    ESP_LOGD(TAG, "POST /api/translator");
     
     size_t content_len = req->content_len;
-    if (content_len == 0 || content_len > 1024) {
+    if (content_len == 0 || content_len > CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS * 512) {
         ESP_LOGE(TAG, "Invalid request body size: %zu", content_len);
         return send_json_response(req, cJSON_CreateString("Invalid request body size"), HTTPD_400_BAD_REQUEST);
     }
@@ -1035,75 +2003,424 @@ static esp_err_t api_network_config_set_handler(httpd_req_t *req)
         return send_json_response(req, cJSON_CreateString("Invalid JSON"), HTTPD_400_BAD_REQUEST);
     }
     
-    system_ip_config_t config;
-    memset(&config, 0, sizeof(config));
+    cJSON *cycle_item = cJSON_GetObjectItem(json, "cycle_ms");
+    cJSON *bindings_item = cJSON_GetObjectItem(json, "bindings");
+    int count = cJSON_GetArraySize(bindings_item);
+    if (!cJSON_IsNumber(cycle_item) || cycle_item->valueint <= 0 || !cJSON_IsArray(bindings_item) ||
+        count > CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Invalid cycle_ms or bindings"), HTTPD_400_BAD_REQUEST);
+    }
+    uint32_t cycle_ms = (uint32_t)cycle_item->valueint;
     
-    cJSON *use_dhcp_item = cJSON_GetObjectItem(json, "use_dhcp");
-    if (use_dhcp_item != NULL && cJSON_IsBool(use_dhcp_item)) {
-        config.use_dhcp = cJSON_IsTrue(use_dhcp_item);
-    } else {
-        config.use_dhcp = true;  // Default to DHCP
+    enip_translator_binding_t *bindings = calloc(count > 0 ? count : 1, sizeof(enip_translator_binding_t));
+    if (bindings == NULL) {
+        cJSON_Delete(json);
+        return send_json_response(req, cJSON_CreateString("Out of memory"), HTTPD_500_INTERNAL_SERVER_ERROR);
     }
     
-    if (!config.use_dhcp) {
-        // Parse static IP configuration
-        cJSON *ip_item = cJSON_GetObjectItem(json, "ip_address");
-        cJSON *netmask_item = cJSON_GetObjectItem(json, "netmask");
-        cJSON *gateway_item = cJSON_GetObjectItem(json, "gateway");
-        cJSON *dns1_item = cJSON_GetObjectItem(json, "dns1");
-        cJSON *dns2_item = cJSON_GetObjectItem(json, "dns2");
-        
-        ip4_addr_t ip_addr;
-        if (ip_item != NULL && cJSON_IsString(ip_item)) {
-            if (inet_aton(ip_item->valuestring, &ip_addr)) {
-                config.ip_address = ip_addr.addr;
-            } else {
-                cJSON_Delete(json);
-                return send_json_response(req, cJSON_CreateString("Invalid IP address"), HTTPD_400_BAD_REQUEST);
-            }
+    for (int i = 0; i < count; i++) {
+        const char *error = xlat_binding_from_json(cJSON_GetArrayItem(bindings_item, i), &bindings[i]);
+        if (error != NULL) {
+            cJSON *response = cJSON_CreateObject();
+            cJSON_AddBoolToObject(response, "success", false);
+            cJSON_AddNumberToObject(response, "index", i);
+            cJSON_AddStringToObject(response, "error", error);
+            free(bindings);
+            cJSON_Delete(json);
+            return send_json_response(req, response, HTTPD_400_BAD_REQUEST);
         }
-        
-        if (netmask_item != NULL && cJSON_IsString(netmask_item)) {
-            if (inet_aton(netmask_item->valuestring, &ip_addr)) {
-                config.netmask = ip_addr.addr;
-            }
+    }
+    cJSON_Delete(json);
+    
+    // Apply first so that a map the engine rejects is not saved
+    enip_scanner_translator_stop();
+    esp_err_t ret = enip_scanner_translator_start(bindings, count, cycle_ms);
+    
+    cJSON *response = cJSON_CreateObject();
+    if (ret == ESP_OK && !system_translator_save(bindings, sizeof(enip_translator_binding_t), count, cycle_ms)) {
+        free(bindings);
+        cJSON_AddBoolToObject(response, "success", false);
+        cJSON_AddStringToObject(response, "error", "Failed to save translator map");
+        return send_json_response(req, response, HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    free(bindings);
+    
+    cJSON_AddBoolToObject(response, "success", ret == ESP_OK);
+    cJSON_AddNumberToObject(response, "count", count);
+    cJSON_AddStringToObject(response, "status", ret == ESP_OK ? "ok" : "error");
+    if (ret != ESP_OK) {
+        cJSON_AddStringToObject(response, "error", esp_err_to_name(ret));
+    }
+    return send_json_response(req, response, ESP_OK);
+}
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
+static const char *task_state_names[] = { "running", "ready", "blocked", "suspended", "deleted", "invalid" };
+#if CONFIG_ENIP_SCANNER_ENABLE_QOS
+static const char *qos_priority_names[] = { "low", "high", "scheduled", "urgent" };
+#endif
+
+// GET /api/diagnostics/memory
+static esp_err_t api_diagnostics_memory_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/diagnostics/memory");
+    
+    enip_scanner_memory_report_t *report = malloc(sizeof(*report));
+    enip_scanner_heap_sample_t *samples = calloc(CONFIG_ENIP_SCANNER_DIAG_SAMPLES, sizeof(*samples));
+    if (report == NULL || samples == NULL) {
+        free(report);
+        free(samples);
+        cJSON *response = cJSON_CreateObject();
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "error", "Out of memory");
+        return send_json_response(req, response, HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    enip_scanner_get_memory_report(report);
+    size_t sample_count = enip_scanner_get_heap_trend(samples, CONFIG_ENIP_SCANNER_DIAG_SAMPLES);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON *heap = cJSON_AddObjectToObject(response, "heap");
+    cJSON_AddNumberToObject(heap, "total", report->heap_total);
+    cJSON_AddNumberToObject(heap, "free", report->heap_free);
+    cJSON_AddNumberToObject(heap, "min_free", report->heap_min_free);
+    cJSON_AddNumberToObject(heap, "largest_free_block", report->heap_largest_free_block);
+    cJSON_AddNumberToObject(heap, "fragmentation_pct", report->fragmentation_pct);
+    
+    cJSON *subsystems = cJSON_AddArrayToObject(response, "subsystems");
+    for (uint8_t i = 0; i < report->subsystem_count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", report->subsystems[i].name);
+        cJSON_AddNumberToObject(item, "bytes", report->subsystems[i].bytes);
+        cJSON_AddNumberToObject(item, "items", report->subsystems[i].items);
+        cJSON_AddItemToArray(subsystems, item);
+    }
+    
+    cJSON *tasks = cJSON_AddArrayToObject(response, "tasks");
+    for (uint8_t i = 0; i < report->task_count; i++) {
+        const enip_scanner_task_info_t *task = &report->tasks[i];
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", task->name);
+        cJSON_AddNumberToObject(item, "stack_free_min", task->stack_free_min);
+        cJSON_AddNumberToObject(item, "priority", task->priority);
+        cJSON_AddStringToObject(item, "state", task->state < 6 ? task_state_names[task->state] : "unknown");
+        cJSON_AddItemToArray(tasks, item);
+    }
+    cJSON_AddNumberToObject(response, "tasks_total", report->tasks_total);
+    
+    cJSON *trend = cJSON_AddArrayToObject(response, "trend");
+    for (size_t i = 0; i < sample_count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "uptime_s", samples[i].uptime_s);
+        cJSON_AddNumberToObject(item, "free", samples[i].free_bytes);
+        cJSON_AddNumberToObject(item, "largest_free_block", samples[i].largest_free_block);
+        cJSON_AddNumberToObject(item, "fragmentation_pct", samples[i].fragmentation_pct);
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+        cJSON_AddNumberToObject(item, "requests", samples[i].requests);
+        cJSON_AddNumberToObject(item, "latency_p99_ms", samples[i].latency_p99_ms);
+#endif
+        cJSON_AddItemToArray(trend, item);
+    }
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_BUFFER_POOL
+    enip_scanner_buffer_pool_stats_t pool;
+    enip_scanner_get_buffer_pool_stats(&pool);
+    cJSON *pool_json = cJSON_AddObjectToObject(response, "buffer_pool");
+    cJSON_AddNumberToObject(pool_json, "in_use", pool.in_use);
+    cJSON_AddNumberToObject(pool_json, "peak_in_use", pool.peak_in_use);
+    cJSON_AddNumberToObject(pool_json, "exhausted", pool.exhausted);
+    cJSON_AddNumberToObject(pool_json, "oversize", pool.oversize);
+#endif
+    
+    enip_scanner_log_stats_t log_stats;
+    enip_scanner_get_log_stats(&log_stats);
+    cJSON_AddNumberToObject(response, "log_suppressed", log_stats.suppressed);
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_QOS
+    enip_scanner_qos_config_t qos;
+    enip_scanner_qos_stats_t qos_stats;
+    enip_scanner_get_qos_config(&qos);
+    enip_scanner_get_qos_stats(&qos_stats);
+    cJSON *qos_json = cJSON_AddObjectToObject(response, "qos");
+    cJSON_AddNumberToObject(qos_json, "urgent", qos.dscp_urgent);
+    cJSON_AddNumberToObject(qos_json, "scheduled", qos.dscp_scheduled);
+    cJSON_AddNumberToObject(qos_json, "high", qos.dscp_high);
+    cJSON_AddNumberToObject(qos_json, "low", qos.dscp_low);
+    cJSON_AddNumberToObject(qos_json, "explicit", qos.dscp_explicit);
+    cJSON_AddStringToObject(qos_json, "implicit_priority",
+                            qos_priority_names[qos.implicit_priority & 0x03]);
+    cJSON_AddNumberToObject(qos_json, "sockets_marked", qos_stats.sockets_marked);
+    cJSON_AddNumberToObject(qos_json, "mark_failures", qos_stats.mark_failures);
+#endif
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+    enip_scanner_memory_tier_stats_t tiers;
+    enip_scanner_get_memory_tier_stats(&tiers);
+    cJSON *tiers_json = cJSON_AddObjectToObject(response, "memory_tiers");
+    cJSON_AddNumberToObject(tiers_json, "internal_bytes", tiers.internal_bytes);
+    cJSON_AddNumberToObject(tiers_json, "internal_peak", tiers.internal_peak);
+    cJSON_AddNumberToObject(tiers_json, "psram_bytes", tiers.psram_bytes);
+    cJSON_AddNumberToObject(tiers_json, "psram_peak", tiers.psram_peak);
+    cJSON_AddNumberToObject(tiers_json, "psram_fallbacks", tiers.psram_fallbacks);
+    cJSON_AddNumberToObject(tiers_json, "failures", tiers.failures);
+    cJSON_AddNumberToObject(tiers_json, "psram_total", tiers.psram_total);
+    cJSON_AddNumberToObject(tiers_json, "psram_free", tiers.psram_free);
+#endif
+    
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+    enip_scanner_soak_report_t soak;
+    esp_err_t soak_ret = enip_scanner_soak_check(&soak);
+    if (soak_ret != ESP_ERR_INVALID_STATE) {
+        cJSON *soak_json = cJSON_AddObjectToObject(response, "soak");
+        cJSON_AddBoolToObject(soak_json, "passed", soak_ret == ESP_OK);
+        cJSON_AddNumberToObject(soak_json, "elapsed_s", soak.elapsed_s);
+        cJSON_AddNumberToObject(soak_json, "baseline_free", soak.baseline_free_bytes);
+        cJSON_AddNumberToObject(soak_json, "settled_free", soak.settled_free_bytes);
+        cJSON_AddNumberToObject(soak_json, "heap_loss", soak.heap_loss_bytes);
+        cJSON_AddNumberToObject(soak_json, "baseline_largest_free_block", soak.baseline_largest_free_block);
+        cJSON_AddNumberToObject(soak_json, "settled_largest_free_block", soak.settled_largest_free_block);
+        cJSON_AddNumberToObject(soak_json, "block_loss", soak.block_loss_bytes);
+        cJSON_AddNumberToObject(soak_json, "requests", soak.requests);
+        cJSON_AddNumberToObject(soak_json, "failures", soak.failures);
+        cJSON_AddNumberToObject(soak_json, "latency_p50_ms", soak.latency_p50_ms);
+        cJSON_AddNumberToObject(soak_json, "latency_p95_ms", soak.latency_p95_ms);
+        cJSON_AddNumberToObject(soak_json, "latency_p99_ms", soak.latency_p99_ms);
+        cJSON_AddNumberToObject(soak_json, "latency_max_ms", soak.latency_max_ms);
+        cJSON_AddBoolToObject(soak_json, "heap_exceeded", soak.heap_exceeded);
+        cJSON_AddBoolToObject(soak_json, "block_exceeded", soak.block_exceeded);
+        cJSON_AddBoolToObject(soak_json, "latency_exceeded", soak.latency_exceeded);
+    }
+#endif
+    
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    free(report);
+    free(samples);
+    return send_json_response(req, response, ESP_OK);
+}
+
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+// POST /api/diagnostics/soak
+// Starts a soak run; the body holds the drift limits, any left out are not checked
+static esp_err_t api_diagnostics_soak_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "POST /api/diagnostics/soak");
+    
+    char content[256];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret < 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request body");
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+    
+    enip_scanner_soak_limits_t limits = {0};
+    if (ret > 0) {
+        cJSON *json = cJSON_Parse(content);
+        if (json == NULL) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
         }
-        
-        if (gateway_item != NULL && cJSON_IsString(gateway_item)) {
-            if (inet_aton(gateway_item->valuestring, &ip_addr)) {
-                config.gateway = ip_addr.addr;
-            }
+        cJSON *item = cJSON_GetObjectItem(json, "max_heap_loss");
+        limits.max_heap_loss_bytes = cJSON_IsNumber(item) ? (uint32_t)item->valuedouble : 0;
+        item = cJSON_GetObjectItem(json, "max_block_loss");
+        limits.max_block_loss_bytes = cJSON_IsNumber(item) ? (uint32_t)item->valuedouble : 0;
+        item = cJSON_GetObjectItem(json, "max_latency_p99_ms");
+        limits.max_latency_p99_ms = cJSON_IsNumber(item) ? (uint32_t)item->valuedouble : 0;
+        cJSON_Delete(json);
+    }
+    
+    esp_err_t err = enip_scanner_soak_start(&limits);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", err == ESP_OK);
+    cJSON_AddStringToObject(response, "status", err == ESP_OK ? "ok" : "error");
+    if (err != ESP_OK) {
+        cJSON_AddStringToObject(response, "error", esp_err_to_name(err));
+    }
+    return send_json_response(req, response, ESP_OK);
+}
+#endif // CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+
+#endif // CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
+#if CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
+static const char *capture_trigger_names[] = {
+    "manual", "bit_rising", "bit_falling", "bit_change", "above", "below", "timeout"
+};
+static const char *capture_state_names[] = { "idle", "armed", "triggered", "complete" };
+
+// GET /api/scanner/capture
+static esp_err_t api_scanner_capture_status_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/scanner/capture");
+    
+    enip_scanner_capture_status_t status;
+    enip_scanner_capture_get_status(&status);
+    char ip_str[16];
+    snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&status.config.ip_address));
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "state", capture_state_names[status.state]);
+    cJSON_AddStringToObject(response, "ip_address", ip_str);
+    cJSON_AddStringToObject(response, "trigger", capture_trigger_names[status.config.trigger]);
+    cJSON_AddNumberToObject(response, "pre_frames", status.config.pre_frames);
+    cJSON_AddNumberToObject(response, "post_frames", status.config.post_frames);
+    cJSON_AddNumberToObject(response, "frames_recorded", status.frames_recorded);
+    cJSON_AddNumberToObject(response, "frames_truncated", status.frames_truncated);
+    cJSON_AddNumberToObject(response, "frame_count", status.frame_count);
+    cJSON_AddNumberToObject(response, "trigger_index", status.trigger_index);
+    cJSON_AddNumberToObject(response, "trigger_time_us", (double)status.trigger_time_us);
+    cJSON_AddNumberToObject(response, "max_frames", CONFIG_ENIP_SCANNER_CAPTURE_FRAMES);
+    cJSON_AddStringToObject(response, "status", "ok");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
+// POST /api/scanner/capture
+// Body: {"action": "arm", "ip_address": "...", "trigger": "bit_rising", "offset": 0, "bit": 0, ...}
+//       {"action": "trigger"} or {"action": "stop"}
+static esp_err_t api_scanner_capture_control_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "POST /api/scanner/capture");
+    
+    char content[512];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request body");
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    cJSON *action_item = cJSON_GetObjectItem(json, "action");
+    if (action_item == NULL || !cJSON_IsString(action_item)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing action");
+        return ESP_FAIL;
+    }
+    
+    esp_err_t err;
+    if (strcmp(action_item->valuestring, "arm") == 0) {
+        enip_scanner_capture_config_t config = {0};
+        cJSON *ip_item = cJSON_GetObjectItem(json, "ip_address");
+        if (ip_item == NULL || !cJSON_IsString(ip_item) || !inet_aton(ip_item->valuestring, &config.ip_address)) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid IP address");
+            return ESP_FAIL;
         }
         
-        if (dns1_item != NULL && cJSON_IsString(dns1_item)) {
-            if (inet_aton(dns1_item->valuestring, &ip_addr)) {
-                config.dns1 = ip_addr.addr;
+        cJSON *trigger_item = cJSON_GetObjectItem(json, "trigger");
+        size_t trigger_count = sizeof(capture_trigger_names) / sizeof(capture_trigger_names[0]);
+        size_t trigger = cJSON_IsString(trigger_item) ? trigger_count : 0;
+        for (size_t i = 0; cJSON_IsString(trigger_item) && i < trigger_count; i++) {
+            if (strcmp(trigger_item->valuestring, capture_trigger_names[i]) == 0) {
+                trigger = i;
             }
         }
-        
-        if (dns2_item != NULL && cJSON_IsString(dns2_item)) {
-            if (inet_aton(dns2_item->valuestring, &ip_addr)) {
-                config.dns2 = ip_addr.addr;
-            }
+        if (trigger == trigger_count) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid trigger");
+            return ESP_FAIL;
         }
+        config.trigger = (enip_capture_trigger_t)trigger;
+        
+        cJSON *direction_item = cJSON_GetObjectItem(json, "direction");
+        config.direction = (cJSON_IsString(direction_item) && strcmp(direction_item->valuestring, "o_to_t") == 0) ?
+                           ENIP_CAPTURE_DIR_O_TO_T : ENIP_CAPTURE_DIR_T_TO_O;
+        cJSON *item = cJSON_GetObjectItem(json, "offset");
+        config.offset = cJSON_IsNumber(item) ? (uint16_t)item->valueint : 0;
+        item = cJSON_GetObjectItem(json, "bit");
+        config.bit = cJSON_IsNumber(item) ? (uint8_t)item->valueint : 0;
+        item = cJSON_GetObjectItem(json, "width");
+        config.width = cJSON_IsNumber(item) ? (uint8_t)item->valueint : 2;
+        config.is_signed = cJSON_IsTrue(cJSON_GetObjectItem(json, "signed"));
+        item = cJSON_GetObjectItem(json, "threshold");
+        config.threshold = cJSON_IsNumber(item) ? (int32_t)item->valuedouble : 0;
+        item = cJSON_GetObjectItem(json, "timeout_ms");
+        config.timeout_ms = cJSON_IsNumber(item) ? (uint32_t)item->valueint : 0;
+        item = cJSON_GetObjectItem(json, "pre_frames");
+        config.pre_frames = cJSON_IsNumber(item) ? (uint16_t)item->valueint : CONFIG_ENIP_SCANNER_CAPTURE_FRAMES / 2;
+        item = cJSON_GetObjectItem(json, "post_frames");
+        config.post_frames = cJSON_IsNumber(item) ? (uint16_t)item->valueint :
+                             CONFIG_ENIP_SCANNER_CAPTURE_FRAMES - 1 - config.pre_frames;
+        err = enip_scanner_capture_arm(&config);
+    } else if (strcmp(action_item->valuestring, "trigger") == 0) {
+        err = enip_scanner_capture_trigger();
+    } else if (strcmp(action_item->valuestring, "stop") == 0) {
+        err = enip_scanner_capture_stop();
+    } else {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid action");
+        return ESP_FAIL;
     }
-    
     cJSON_Delete(json);
     
-    // Save to NVS
-    if (system_ip_config_save(&config)) {
-        cJSON *response = cJSON_CreateObject();
-        cJSON_AddBoolToObject(response, "success", true);
-        cJSON_AddStringToObject(response, "message", "Configuration saved successfully. Please restart the device for changes to take effect.");
-        return send_json_response(req, response, ESP_OK);
-    } else {
-        cJSON *response = cJSON_CreateObject();
-        cJSON_AddBoolToObject(response, "success", false);
-        cJSON_AddStringToObject(response, "error", "Failed to save configuration");
-        return send_json_response(req, response, HTTPD_500_INTERNAL_SERVER_ERROR);
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", err == ESP_OK);
+    cJSON_AddStringToObject(response, "status", err == ESP_OK ? "ok" : "error");
+    if (err != ESP_OK) {
+        cJSON_AddStringToObject(response, "error", esp_err_to_name(err));
+    }
+    return send_json_response(req, response, ESP_OK);
+}
+
+// GET /api/scanner/capture/frames
+// Streams the captured frames as CSV, one frame per line, with the frame bytes in hex
+static esp_err_t api_scanner_capture_frames_handler(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/scanner/capture/frames");
+    
+    enip_scanner_capture_status_t status;
+    enip_scanner_capture_get_status(&status);
+    
+    enip_scanner_capture_frame_t *frame = malloc(sizeof(enip_scanner_capture_frame_t));
+    char *line = malloc(96 + CONFIG_ENIP_SCANNER_CAPTURE_FRAME_BYTES * 2);
+    if (frame == NULL || line == NULL) {
+        free(frame);
+        free(line);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    
+    httpd_resp_set_type(req, "text/csv");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"capture.csv\"");
+    const char *title = "index,time_us,direction,trigger,length,data_offset,data_length,frame\n";
+    esp_err_t err = httpd_resp_send_chunk(req, title, strlen(title));
+    
+    for (uint16_t i = 0; i < status.frame_count && err == ESP_OK; i++) {
+        if (enip_scanner_capture_get_frame(i, frame) != ESP_OK) {
+            break;
+        }
+        int n = snprintf(line, 96, "%u,%lld,%s,%d,%u,%u,%u,", i, (long long)frame->time_us,
+                         frame->direction == ENIP_CAPTURE_DIR_T_TO_O ? "t_to_o" : "o_to_t",
+                         frame->trigger ? 1 : 0,
+                         frame->length, frame->data_offset, frame->data_length);
+        uint16_t stored = frame->length < sizeof(frame->data) ? frame->length : sizeof(frame->data);
+        for (uint16_t b = 0; b < stored; b++) {
+            n += sprintf(line + n, "%02X", frame->data[b]);
+        }
+        line[n++] = '\n';
+        err = httpd_resp_send_chunk(req, line, n);
     }
+    
+    free(frame);
+    free(line);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
 }
 
+#endif // CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+
 #if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
 
 // Global connection status storage (simplified - in production, use proper connection tracking)
@@ -1137,7 +2454,7 @@ static void implicit_data_callback(const ip4_addr_t *ip_address,
 // POST /api/scanner/implicit/open
 static esp_err_t api_scanner_implicit_open_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/implicit/open");
+    ESP_LOGD(TAG, "POST /api/scanner/implicit/open");
     
     char content[512];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1359,7 +2676,7 @@ static esp_err_t api_scanner_implicit_open_handler(httpd_req_t *req)
 // POST /api/scanner/implicit/close
 static esp_err_t api_scanner_implicit_close_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/implicit/close");
+    ESP_LOGD(TAG, "POST /api/scanner/implicit/close");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1436,7 +2753,7 @@ static esp_err_t api_scanner_implicit_close_handler(httpd_req_t *req)
 // POST /api/scanner/implicit/write-data
 static esp_err_t api_scanner_implicit_write_data_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/implicit/write-data");
+    ESP_LOGD(TAG, "POST /api/scanner/implicit/write-data");
     
     char content[1024];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1579,7 +2896,7 @@ static esp_err_t api_scanner_implicit_write_data_handler(httpd_req_t *req)
 // GET /api/scanner/implicit/status
 static esp_err_t api_scanner_implicit_status_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "GET /api/scanner/implicit/status");
+    ESP_LOGD(TAG, "GET /api/scanner/implicit/status");
     
     cJSON *response = cJSON_CreateObject();
     
@@ -1657,7 +2974,7 @@ static esp_err_t api_scanner_implicit_status_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-position-variable
 static esp_err_t api_scanner_motoman_read_position_variable_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-position-variable");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-position-variable");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1740,7 +3057,9 @@ static esp_err_t api_scanner_motoman_read_position_variable_handler(httpd_req_t
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddNumberToObject(response, "variable_number", variable_number);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (position.error_message[0] != '\0') ? position.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&position.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -1751,7 +3070,7 @@ static esp_err_t api_scanner_motoman_read_position_variable_handler(httpd_req_t
 // POST /api/scanner/motoman/read-alarm
 static esp_err_t api_scanner_motoman_read_alarm_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-alarm");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-alarm");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1816,7 +3135,8 @@ static esp_err_t api_scanner_motoman_read_alarm_handler(httpd_req_t *req)
     } else {
         if (alarm_instance < 1 || alarm_instance > 4) {
             err = ESP_ERR_INVALID_ARG;
-            snprintf(alarm.error_message, sizeof(alarm.error_message), "Invalid alarm instance (must be 1-4)");
+            alarm.error.layer = ENIP_ERR_LAYER_API;
+            alarm.error.code = ENIP_ERR_INVALID_ARG;
         } else {
             err = enip_scanner_motoman_read_alarm(&ip_addr, (uint8_t)alarm_instance, &alarm, timeout_ms);
         }
@@ -1849,7 +3169,9 @@ static esp_err_t api_scanner_motoman_read_alarm_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "alarm_type", alarm_type);
         cJSON_AddNumberToObject(response, "alarm_instance", alarm_instance);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (alarm.error_message[0] != '\0') ? alarm.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&alarm.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -1860,7 +3182,7 @@ static esp_err_t api_scanner_motoman_read_alarm_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-job-info
 static esp_err_t api_scanner_motoman_read_job_info_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-job-info");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-job-info");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -1923,7 +3245,9 @@ static esp_err_t api_scanner_motoman_read_job_info_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (job_info.error_message[0] != '\0') ? job_info.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&job_info.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -1934,7 +3258,7 @@ static esp_err_t api_scanner_motoman_read_job_info_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-axis-config
 static esp_err_t api_scanner_motoman_read_axis_config_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-axis-config");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-axis-config");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2003,7 +3327,9 @@ static esp_err_t api_scanner_motoman_read_axis_config_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (config.error_message[0] != '\0') ? config.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&config.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2014,7 +3340,7 @@ static esp_err_t api_scanner_motoman_read_axis_config_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-position
 static esp_err_t api_scanner_motoman_read_position_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-position");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-position");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2088,7 +3414,9 @@ static esp_err_t api_scanner_motoman_read_position_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (position.error_message[0] != '\0') ? position.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&position.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2099,7 +3427,7 @@ static esp_err_t api_scanner_motoman_read_position_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-position-deviation
 static esp_err_t api_scanner_motoman_read_position_deviation_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-position-deviation");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-position-deviation");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2168,7 +3496,9 @@ static esp_err_t api_scanner_motoman_read_position_deviation_handler(httpd_req_t
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (deviation.error_message[0] != '\0') ? deviation.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&deviation.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2179,7 +3509,7 @@ static esp_err_t api_scanner_motoman_read_position_deviation_handler(httpd_req_t
 // POST /api/scanner/motoman/read-torque
 static esp_err_t api_scanner_motoman_read_torque_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-torque");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-torque");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2248,7 +3578,9 @@ static esp_err_t api_scanner_motoman_read_torque_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (torque.error_message[0] != '\0') ? torque.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&torque.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2259,7 +3591,7 @@ static esp_err_t api_scanner_motoman_read_torque_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-io
 static esp_err_t api_scanner_motoman_read_io_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-io");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-io");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2301,8 +3633,8 @@ static esp_err_t api_scanner_motoman_read_io_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     uint8_t value = 0;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_io(&ip_addr, signal_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_io(&ip_addr, signal_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2323,7 +3655,9 @@ static esp_err_t api_scanner_motoman_read_io_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2334,7 +3668,7 @@ static esp_err_t api_scanner_motoman_read_io_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-register
 static esp_err_t api_scanner_motoman_read_register_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-register");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-register");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2376,8 +3710,8 @@ static esp_err_t api_scanner_motoman_read_register_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     uint16_t value = 0;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_register(&ip_addr, register_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_register(&ip_addr, register_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2398,7 +3732,9 @@ static esp_err_t api_scanner_motoman_read_register_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2409,7 +3745,7 @@ static esp_err_t api_scanner_motoman_read_register_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-variable-b
 static esp_err_t api_scanner_motoman_read_variable_b_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-variable-b");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-variable-b");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2451,8 +3787,8 @@ static esp_err_t api_scanner_motoman_read_variable_b_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     uint8_t value = 0;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_variable_b(&ip_addr, variable_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_variable_b(&ip_addr, variable_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2473,7 +3809,9 @@ static esp_err_t api_scanner_motoman_read_variable_b_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2484,7 +3822,7 @@ static esp_err_t api_scanner_motoman_read_variable_b_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-variable-i
 static esp_err_t api_scanner_motoman_read_variable_i_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-variable-i");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-variable-i");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2526,8 +3864,8 @@ static esp_err_t api_scanner_motoman_read_variable_i_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     int16_t value = 0;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_variable_i(&ip_addr, variable_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_variable_i(&ip_addr, variable_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2548,7 +3886,9 @@ static esp_err_t api_scanner_motoman_read_variable_i_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2559,7 +3899,7 @@ static esp_err_t api_scanner_motoman_read_variable_i_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-variable-d
 static esp_err_t api_scanner_motoman_read_variable_d_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-variable-d");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-variable-d");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2601,8 +3941,8 @@ static esp_err_t api_scanner_motoman_read_variable_d_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     int32_t value = 0;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_variable_d(&ip_addr, variable_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_variable_d(&ip_addr, variable_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2623,7 +3963,9 @@ static esp_err_t api_scanner_motoman_read_variable_d_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2634,7 +3976,7 @@ static esp_err_t api_scanner_motoman_read_variable_d_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-variable-r
 static esp_err_t api_scanner_motoman_read_variable_r_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-variable-r");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-variable-r");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2676,8 +4018,8 @@ static esp_err_t api_scanner_motoman_read_variable_r_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     float value = 0.0f;
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_variable_r(&ip_addr, variable_number, &value, timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_variable_r(&ip_addr, variable_number, &value, timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2698,7 +4040,9 @@ static esp_err_t api_scanner_motoman_read_variable_r_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2709,7 +4053,7 @@ static esp_err_t api_scanner_motoman_read_variable_r_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-variable-s
 static esp_err_t api_scanner_motoman_read_variable_s_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-variable-s");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-variable-s");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2751,8 +4095,8 @@ static esp_err_t api_scanner_motoman_read_variable_s_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     char value[33] = {0};
-    char error_msg[128] = {0};
-    esp_err_t err = enip_scanner_motoman_read_variable_s(&ip_addr, variable_number, value, sizeof(value), timeout_ms, error_msg);
+    enip_scanner_error_t error = {0};
+    esp_err_t err = enip_scanner_motoman_read_variable_s(&ip_addr, variable_number, value, sizeof(value), timeout_ms, &error);
     
     cJSON *response = cJSON_CreateObject();
     
@@ -2773,7 +4117,9 @@ static esp_err_t api_scanner_motoman_read_variable_s_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *err_msg = (error_msg[0] != '\0') ? error_msg : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&error, error_text, sizeof(error_text));
+        const char *err_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", err_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -2784,7 +4130,7 @@ static esp_err_t api_scanner_motoman_read_variable_s_handler(httpd_req_t *req)
 // GET /api/scanner/motoman/rs022
 static esp_err_t api_scanner_motoman_get_rs022_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "GET /api/scanner/motoman/rs022");
+    ESP_LOGD(TAG, "GET /api/scanner/motoman/rs022");
     
     bool instance_direct = false;
     system_motoman_rs022_load(&instance_direct);
@@ -2800,7 +4146,7 @@ static esp_err_t api_scanner_motoman_get_rs022_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/rs022
 static esp_err_t api_scanner_motoman_set_rs022_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/rs022");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/rs022");
     
     char content[128];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2846,7 +4192,7 @@ static esp_err_t api_scanner_motoman_set_rs022_handler(httpd_req_t *req)
 // POST /api/scanner/motoman/read-status
 static esp_err_t api_scanner_motoman_read_status_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "POST /api/scanner/motoman/read-status");
+    ESP_LOGD(TAG, "POST /api/scanner/motoman/read-status");
     
     char content[256];
     int ret = httpd_req_recv(req, content, sizeof(content) - 1);
@@ -2913,7 +4259,9 @@ static esp_err_t api_scanner_motoman_read_status_handler(httpd_req_t *req)
         
         cJSON_AddStringToObject(response, "ip_address", ip_str);
         cJSON_AddBoolToObject(response, "success", false);
-        const char *error_msg = (status.error_message[0] != '\0') ? status.error_message : "Unknown error";
+        char error_text[128];
+        enip_scanner_format_error(&status.error, error_text, sizeof(error_text));
+        const char *error_msg = (error_text[0] != '\0') ? error_text : "Unknown error";
         cJSON_AddStringToObject(response, "error", error_msg);
         cJSON_AddStringToObject(response, "status", "error");
         
@@ -3061,6 +4409,33 @@ esp_err_t webui_api_register(httpd_handle_t server)
     ESP_LOGI(TAG, "Implicit messaging API endpoints registered");
 #endif
 
+#if CONFIG_ENIP_SCANNER_ENABLE_CAPTURE
+    httpd_uri_t scanner_capture_status_uri = {
+        .uri = "/api/scanner/capture",
+        .method = HTTP_GET,
+        .handler = api_scanner_capture_status_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &scanner_capture_status_uri);
+    
+    httpd_uri_t scanner_capture_control_uri = {
+        .uri = "/api/scanner/capture",
+        .method = HTTP_POST,
+        .handler = api_scanner_capture_control_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &scanner_capture_control_uri);
+    
+    httpd_uri_t scanner_capture_frames_uri = {
+        .uri = "/api/scanner/capture/frames",
+        .method = HTTP_GET,
+        .handler = api_scanner_capture_frames_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &scanner_capture_frames_uri);
+    ESP_LOGI(TAG, "Capture API endpoints registered");
+#endif
+
 #if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
     httpd_uri_t scanner_motoman_read_position_variable_uri = {
         .uri = "/api/scanner/motoman/read-position-variable",
@@ -3215,6 +4590,99 @@ esp_err_t webui_api_register(httpd_handle_t server)
     httpd_register_uri_handler(server, &scanner_motoman_set_rs022_uri);
     ESP_LOGI(TAG, "Motoman RS022 POST endpoint registered");
 #endif
+
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+    httpd_uri_t io_config_get_uri = {
+        .uri = "/api/io-config",
+        .method = HTTP_GET,
+        .handler = api_io_config_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &io_config_get_uri);
+
+    httpd_uri_t io_config_set_uri = {
+        .uri = "/api/io-config",
+        .method = HTTP_POST,
+        .handler = api_io_config_set_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &io_config_set_uri);
+    ESP_LOGI(TAG, "I/O configuration API endpoints registered");
+#endif
+
+#if CONFIG_HISTORIAN_ENABLE
+    httpd_uri_t historian_status_uri = {
+        .uri = "/api/historian/status",
+        .method = HTTP_GET,
+        .handler = api_historian_status_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &historian_status_uri);
+
+    httpd_uri_t historian_channels_get_uri = {
+        .uri = "/api/historian/channels",
+        .method = HTTP_GET,
+        .handler = api_historian_channels_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &historian_channels_get_uri);
+
+    httpd_uri_t historian_channels_set_uri = {
+        .uri = "/api/historian/channels",
+        .method = HTTP_POST,
+        .handler = api_historian_channels_set_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &historian_channels_set_uri);
+
+    httpd_uri_t historian_export_uri = {
+        .uri = "/api/historian/export",
+        .method = HTTP_GET,
+        .handler = api_historian_export_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &historian_export_uri);
+    ESP_LOGI(TAG, "Historian API endpoints registered");
+#endif
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+    httpd_uri_t translator_get_uri = {
+        .uri = "/api/translator",
+        .method = HTTP_GET,
+        .handler = api_translator_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &translator_get_uri);
+
+    httpd_uri_t translator_set_uri = {
+        .uri = "/api/translator",
+        .method = HTTP_POST,
+        .handler = api_translator_set_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &translator_set_uri);
+    ESP_LOGI(TAG, "Translator API endpoints registered");
+#endif
+
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+    httpd_uri_t diagnostics_memory_uri = {
+        .uri = "/api/diagnostics/memory",
+        .method = HTTP_GET,
+        .handler = api_diagnostics_memory_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &diagnostics_memory_uri);
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+    httpd_uri_t diagnostics_soak_uri = {
+        .uri = "/api/diagnostics/soak",
+        .method = HTTP_POST,
+        .handler = api_diagnostics_soak_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &diagnostics_soak_uri);
+#endif
+    ESP_LOGI(TAG, "Diagnostics API endpoint registered");
+#endif
     
     ESP_LOGI(TAG, "Web UI API endpoints registered");
     return ESP_OK;
@@ -119,6 +119,9 @@ static const char index_page[] =
 "    navHtml += '<a href=\"/implicit\">Implicit I/O</a>';"
 #endif
 "    navHtml += '<a href=\"/network\">Network</a>';"
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+"    navHtml += '<a href=\"/diagnostics\">Diagnostics</a>';"
+#endif
 #if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
 "    navHtml += '<div style=\"margin-top:8px;display:grid;grid-template-columns:repeat(4,1fr);gap:6px\">';"
 "    navHtml += '<a style=\"display:block;text-align:center;margin:0\" href=\"/motoman-status\">Motoman Status</a>';"
@@ -2208,6 +2211,81 @@ static esp_err_t webui_network_config_handler(httpd_req_t *req)
     return ret;
 }
 
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+static const char diagnostics_page[] =
+"<!DOCTYPE html><html><head><meta charset=\"UTF-8\"><title>Diagnostics</title>"
+"<style>"
+"body{font-family:Arial;margin:20px;background:#f5f5f5}"
+".c{max-width:800px;margin:0 auto;background:#fff;padding:20px;border-radius:8px;box-shadow:0 2px 4px rgba(0,0,0,0.1)}"
+"h1{color:#333;border-bottom:2px solid #4CAF50;padding-bottom:10px}"
+"h2{color:#555;font-size:18px;margin-top:20px}"
+".n{margin-bottom:20px;padding:10px;background:#f9f9f9;border-radius:5px;display:grid;grid-template-columns:repeat(4,1fr);gap:6px}"
+".n a{display:block;margin:0;padding:8px 15px;background:#4CAF50;color:#fff;text-decoration:none;border-radius:4px;text-align:center}"
+".n a:hover{background:#45a049}"
+".e{color:#f44336;background:#ffebee;padding:10px;border-radius:4px;margin:10px 0}"
+"table{width:100%;border-collapse:collapse;margin:10px 0}"
+"table th,table td{padding:6px 8px;border-bottom:1px solid #eee;text-align:left}"
+"table th{color:#555}"
+".w{color:#f44336;font-weight:bold}"
+"</style></head><body>"
+"<div class=\"c\"><h1>Diagnostics</h1>"
+"<div class=\"n\"><a href=\"/\">Assembly I/O</a>"
+#if CONFIG_ENIP_SCANNER_ENABLE_IMPLICIT_SUPPORT
+"<a href=\"/implicit\">Implicit I/O</a>"
+#endif
+"<a href=\"/network\">Network</a></div>"
+"<h2>Heap</h2><div id=\"heap\"></div>"
+"<h2>Subsystems</h2><div id=\"subsystems\"></div>"
+"<h2>Tasks (lowest free stack first)</h2><div id=\"tasks\"></div>"
+"<h2>Heap trend</h2><div id=\"trend\"></div>"
+#if CONFIG_ENIP_SCANNER_ENABLE_SOAK_MONITOR
+"<h2>Soak run</h2><div id=\"soak\"></div>"
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_QOS
+"<h2>QoS marking (DSCP)</h2><div id=\"qos\"></div>"
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_MEMORY_TIERS
+"<h2>Memory tiers</h2><div id=\"tiers\"></div>"
+#endif
+"</div>"
+"<script>"
+"function kb(v){return (v/1024).toFixed(1)+' KB';}"
+"function table(head,rows){var h='<table><tr>';head.forEach(function(x){h+='<th>'+x+'</th>';});h+='</tr>';"
+"rows.forEach(function(r){h+='<tr>';r.forEach(function(x){h+='<td>'+x+'</td>';});h+='</tr>';});return h+'</table>';}"
+"function load(){"
+"fetch('/api/diagnostics/memory').then(function(x){return x.json();}).then(function(d){"
+"var hp=d.heap;"
+"document.getElementById('heap').innerHTML=table(['Total','Free','Minimum free','Largest block','Fragmentation'],"
+"[[kb(hp.total),kb(hp.free),kb(hp.min_free),kb(hp.largest_free_block),hp.fragmentation_pct+' %']]);"
+"document.getElementById('subsystems').innerHTML=table(['Subsystem','Bytes','Items'],"
+"d.subsystems.map(function(s){return [s.name,kb(s.bytes),s.items];}));"
+"document.getElementById('tasks').innerHTML=(d.tasks.length?'':'<div class=\"e\">Task list needs CONFIG_FREERTOS_USE_TRACE_FACILITY</div>')+"
+"table(['Task','Free stack (min)','Priority','State'],"
+"d.tasks.map(function(t){var f=t.stack_free_min<512?'<span class=\"w\">'+t.stack_free_min+' B</span>':t.stack_free_min+' B';return [t.name,f,t.priority,t.state];}));"
+"var lat=d.trend.length&&d.trend[0].requests!==undefined;"
+"document.getElementById('trend').innerHTML=table(['Uptime (s)','Free','Largest block','Fragmentation'].concat(lat?['Requests','p99']:[]),"
+"d.trend.slice().reverse().map(function(s){var r=[s.uptime_s,kb(s.free),kb(s.largest_free_block),s.fragmentation_pct+' %'];"
+"return lat?r.concat([s.requests,s.latency_p99_ms+' ms']):r;}));"
+"if(document.getElementById('soak')){var k=d.soak;document.getElementById('soak').innerHTML=!k?'<div>No soak run started (POST /api/diagnostics/soak)</div>':"
+"table(['Elapsed (s)','Heap lost','Largest block lost','Requests','Failures','p50','p95','p99','Max','Result'],"
+"[[k.elapsed_s,k.heap_loss+' B',k.block_loss+' B',k.requests,k.failures,k.latency_p50_ms+' ms',k.latency_p95_ms+' ms',"
+"k.latency_p99_ms+' ms',k.latency_max_ms+' ms',k.passed?'Within limits':'<span class=\"w\">Limit exceeded</span>']]);}"
+"if(d.qos){var q=d.qos;document.getElementById('qos').innerHTML=table(['Urgent','Scheduled','High','Low','Explicit','I/O priority','Sockets marked','Failures'],"
+"[[q.urgent,q.scheduled,q.high,q.low,q.explicit,q.implicit_priority,q.sockets_marked,q.mark_failures]]);}"
+"if(d.memory_tiers){var m=d.memory_tiers;document.getElementById('tiers').innerHTML=table(['Tier','Held','Peak'],"
+"[['Internal (hot)',kb(m.internal_bytes),kb(m.internal_peak)],['PSRAM (cold)',kb(m.psram_bytes),kb(m.psram_peak)]])+"
+"table(['PSRAM total','PSRAM free','Cold in internal RAM','Failures'],[[kb(m.psram_total),kb(m.psram_free),m.psram_fallbacks,m.failures]]);}"
+"}).catch(function(e){document.getElementById('heap').innerHTML='<div class=\"e\">Error: '+e.message+'</div>';});"
+"}"
+"document.addEventListener('DOMContentLoaded',function(){load();setInterval(load,5000);});"
+"</script></body></html>";
+
+static esp_err_t webui_diagnostics_handler(httpd_req_t *req)
+{
+    return webui_send_page(req, diagnostics_page);
+}
+#endif // CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+
 // Register HTML page handlers
 esp_err_t webui_html_register(httpd_handle_t server)
 {
@@ -2269,6 +2347,17 @@ esp_err_t webui_html_register(httpd_handle_t server)
     httpd_register_uri_handler(server, &network_config_uri);
     ESP_LOGI(TAG, "Network config page registered (/network)");
     
+#if CONFIG_ENIP_SCANNER_ENABLE_DIAGNOSTICS
+    httpd_uri_t diagnostics_uri = {
+        .uri = "/diagnostics",
+        .method = HTTP_GET,
+        .handler = webui_diagnostics_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &diagnostics_uri);
+    ESP_LOGI(TAG, "Diagnostics page registered (/diagnostics)");
+#endif
+    
 #if CONFIG_ENIP_SCANNER_ENABLE_MOTOMAN_SUPPORT
     httpd_uri_t motoman_position_uri = {
         .uri = "/motoman-position",
@@ -51,11 +51,21 @@
 #include "enip_scanner.h"
 #include "webui.h"
 #include "udp_discovery.h"
+#if CONFIG_HISTORIAN_ENABLE
+#include "historian.h"
+#endif
+#if CONFIG_MODBUS_SERVER_ENABLE
+#include "modbus_server.h"
+#endif
+#if CONFIG_MQTT_PUBLISHER_ENABLE
+#include "mqtt_publisher.h"
+#endif
 
 static const char *TAG = "main";
 static struct netif *s_netif = NULL;
 static SemaphoreHandle_t s_netif_mutex = NULL;
 static bool s_services_initialized = false;
+static esp_ip4_addr_t s_last_ip = {0};        // Address of the previous got-IP, to spot a change
 esp_eth_handle_t s_eth_handle = NULL;
 
 
@@ -136,6 +146,55 @@ static void configure_netif(esp_netif_t *netif) {
     }
 }
 
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+// Bring up the saved scan list: implicit connections and polls start in parallel
+static void start_io_config(void)
+{
+    enip_scanner_io_entry_t *entries = calloc(CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES, sizeof(enip_scanner_io_entry_t));
+    if (entries == NULL) {
+        ESP_LOGW(TAG, "No memory to load I/O configuration");
+        return;
+    }
+    
+    size_t count = 0;
+    if (system_scan_list_load(entries, sizeof(enip_scanner_io_entry_t), CONFIG_ENIP_SCANNER_IO_MAX_ENTRIES, &count) &&
+        count > 0) {
+        esp_err_t ret = enip_scanner_io_start(entries, count);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // Already running since an earlier got-IP; it reconnects on its own
+            ESP_LOGD(TAG, "I/O configuration already running");
+        } else if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to start I/O configuration: %s", esp_err_to_name(ret));
+        }
+    }
+    free(entries);
+}
+#endif
+
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+// Run the saved translator map
+static void start_translator(void)
+{
+    enip_translator_binding_t *bindings = calloc(CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS,
+                                                 sizeof(enip_translator_binding_t));
+    if (bindings == NULL) {
+        ESP_LOGW(TAG, "No memory to load translator map");
+        return;
+    }
+    
+    size_t count = 0;
+    uint32_t cycle_ms = 0;
+    if (system_translator_load(bindings, sizeof(enip_translator_binding_t), CONFIG_ENIP_SCANNER_TRANSLATOR_MAX_BINDINGS,
+                               &count, &cycle_ms) && count > 0) {
+        esp_err_t ret = enip_scanner_translator_start(bindings, count, cycle_ms);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            ESP_LOGW(TAG, "Failed to start translator: %s", esp_err_to_name(ret));
+        }
+    }
+    free(bindings);
+}
+#endif
+
 static void ethernet_event_handler(void *arg, esp_event_base_t event_base,
                                    int32_t event_id, void *event_data)
 {
@@ -155,6 +214,8 @@ static void ethernet_event_handler(void *arg, esp_event_base_t event_base,
     case ETHERNET_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "Ethernet Link Down");
         s_services_initialized = false;  // Allow re-initialization when link comes back up
+        // Drop sessions and suspend connections now rather than waiting for each to time out
+        enip_scanner_notify_link_down();
         break;
     case ETHERNET_EVENT_START:
         ESP_LOGI(TAG, "Ethernet Started");
@@ -208,6 +269,11 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
     xSemaphoreGive(s_netif_mutex);
     
     if (netif_to_use != NULL) {
+        // Reopen what the scanner suspended at link down (no-op before it is initialized)
+        bool address_changed = s_last_ip.addr != 0 && s_last_ip.addr != ip_info->ip.addr;
+        s_last_ip = ip_info->ip;
+        enip_scanner_notify_link_up(address_changed);
+        
         // Initialize services only once (IP_EVENT_ETH_GOT_IP can fire multiple times)
         // Check and set flag atomically to prevent race condition
         bool should_init = false;
@@ -222,6 +288,40 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
             if (scanner_ret != ESP_OK) {
                 ESP_LOGW(TAG, "Failed to initialize EtherNet/IP scanner: %s", esp_err_to_name(scanner_ret));
             }
+#if CONFIG_ENIP_SCANNER_ENABLE_IO_CONFIG
+            else {
+                start_io_config();
+            }
+#endif
+#if CONFIG_HISTORIAN_ENABLE
+            if (scanner_ret == ESP_OK) {
+                esp_err_t historian_ret = historian_start();
+                if (historian_ret != ESP_OK && historian_ret != ESP_ERR_INVALID_STATE) {
+                    ESP_LOGW(TAG, "Failed to start historian: %s", esp_err_to_name(historian_ret));
+                }
+            }
+#endif
+#if CONFIG_ENIP_SCANNER_ENABLE_TRANSLATOR
+            if (scanner_ret == ESP_OK) {
+                start_translator();
+            }
+#endif
+#if CONFIG_MODBUS_SERVER_ENABLE
+            if (scanner_ret == ESP_OK) {
+                esp_err_t modbus_ret = modbus_server_start();
+                if (modbus_ret != ESP_OK && modbus_ret != ESP_ERR_INVALID_STATE) {
+                    ESP_LOGW(TAG, "Failed to start Modbus TCP server: %s", esp_err_to_name(modbus_ret));
+                }
+            }
+#endif
+#if CONFIG_MQTT_PUBLISHER_ENABLE
+            if (scanner_ret == ESP_OK) {
+                esp_err_t mqtt_ret = mqtt_publisher_start();
+                if (mqtt_ret != ESP_OK && mqtt_ret != ESP_ERR_INVALID_STATE) {
+                    ESP_LOGW(TAG, "Failed to start MQTT publisher: %s", esp_err_to_name(mqtt_ret));
+                }
+            }
+#endif
             
             // Initialize Web UI (disable for testing connection close/reopen)
             // Set to 0 to disable web UI and test connection behavior in isolation